@@ -33,6 +33,36 @@ sshsNode caerMainloopGetSourceNode(int16_t sourceID); // Can be NULL.
 void *caerMainloopGetSourceState(int16_t sourceID);   // Can be NULL.
 sshsNode caerMainloopGetSourceInfo(int16_t sourceID); // Can be NULL.
 
+/**
+ * Take a reference on an event packet received as input in moduleRun(),
+ * so that it stays valid after the current mainloop run is over.
+ * The packet must be treated as immutable from then on; modules that
+ * modify their inputs get a private copy if a reference is held.
+ * Every successful call must be paired with caerMainloopPacketRelease(),
+ * which may be called from any thread.
+ *
+ * @param packet the event packet to keep around.
+ *
+ * @return the same packet on success, NULL on memory allocation failure.
+ */
+caerEventPacketHeaderConst caerMainloopPacketRetain(caerEventPacketHeaderConst packet);
+
+/**
+ * Drop a reference on an event packet. The packet memory is freed once
+ * the last reference is gone. Packets that were never retained are
+ * freed directly, so this also works for packets owned by the caller.
+ *
+ * @param packet the event packet to release. Can be NULL.
+ */
+void caerMainloopPacketRelease(caerEventPacketHeaderConst packet);
+
+/**
+ * Release all event packets in a container, then free the container itself.
+ *
+ * @param container the event packet container to release. Can be NULL.
+ */
+void caerMainloopPacketContainerRelease(caerEventPacketContainer container);
+
 #ifdef __cplusplus
 }
 #endif
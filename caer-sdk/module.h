@@ -140,6 +140,8 @@ void caerModuleLog(caerModuleData moduleData, enum caer_log_level logLevel, cons
 bool caerModuleSetSubSystemString(caerModuleData moduleData, const char *subSystemString);
 void caerModuleConfigDefaultListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
 	const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue);
+void caerModuleConfigDefaultChangeSetListener(
+	sshsNode node, void *userData, const struct sshs_node_attr_change *changes, size_t numChanges);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,119 @@
+#ifndef CAER_SDK_QUEUE_H_
+#define CAER_SDK_QUEUE_H_
+
+#ifdef __cplusplus
+
+#include <cstdint>
+#include <cstdlib>
+
+#else
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Single-producer, single-consumer queue of pointers, for handing data off
+ * between two threads. Putting and getting is lock-free, exactly like with the
+ * libcaer ring-buffer. In addition, either side can wait for the other one to
+ * make progress (data available, space available), without having to poll:
+ * the waiting thread sleeps in the kernel (futex on Linux, condition variable
+ * elsewhere) and is woken up by the other side only when it actually waits.
+ * NULL cannot be stored, it signals an empty queue.
+ */
+typedef struct caer_queue *caerQueue;
+
+caerQueue caerQueueInit(size_t size);
+void caerQueueFree(caerQueue queue);
+
+/**
+ * Put an element into the queue. Producer side only.
+ *
+ * @param queue queue to put into.
+ * @param elem element to put, cannot be NULL.
+ *
+ * @return true on success, false if the queue is full.
+ */
+bool caerQueuePut(caerQueue queue, void *elem);
+
+/**
+ * Put an element into the queue, waiting for space to be available if it is full.
+ * Producer side only.
+ *
+ * @param queue queue to put into.
+ * @param elem element to put, cannot be NULL.
+ * @param timeoutUs maximum time to wait, in µs.
+ *
+ * @return true on success, false if the queue stayed full, or on caerQueueWakeUp().
+ */
+bool caerQueuePutWait(caerQueue queue, void *elem, uint32_t timeoutUs);
+
+/**
+ * Get the next element from the queue. Consumer side only.
+ *
+ * @param queue queue to get from.
+ *
+ * @return next element, or NULL if the queue is empty.
+ */
+void *caerQueueGet(caerQueue queue);
+
+/**
+ * Get the next element from the queue, waiting for data to be available if it
+ * is empty. Consumer side only.
+ *
+ * @param queue queue to get from.
+ * @param timeoutUs maximum time to wait, in µs.
+ *
+ * @return next element, or NULL if the queue stayed empty, or on caerQueueWakeUp().
+ */
+void *caerQueueGetWait(caerQueue queue, uint32_t timeoutUs);
+
+/**
+ * Look at the next element in the queue, without removing it. Consumer side only.
+ *
+ * @param queue queue to look into.
+ *
+ * @return next element, or NULL if the queue is empty.
+ */
+void *caerQueueLook(caerQueue queue);
+
+/**
+ * Wait for the consumer to have taken all elements out of the queue.
+ * Producer side only.
+ *
+ * @param queue queue to wait on.
+ * @param timeoutUs maximum time to wait, in µs.
+ *
+ * @return true if the queue is empty, false if it still wasn't, or on caerQueueWakeUp().
+ */
+bool caerQueueWaitEmpty(caerQueue queue, uint32_t timeoutUs);
+
+/**
+ * Count the elements currently in the queue, for statistics. Can be called
+ * from any thread, the result is only a snapshot while the queue is in use.
+ *
+ * @param queue queue to look at.
+ *
+ * @return number of elements in the queue.
+ */
+size_t caerQueueOccupancy(caerQueue queue);
+
+/**
+ * Wake up all threads currently waiting on this queue, so they can check
+ * for other conditions, like having to shut down. Can be called from any thread.
+ *
+ * @param queue queue whose waiters to wake up.
+ */
+void caerQueueWakeUp(caerQueue queue);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CAER_SDK_QUEUE_H_ */
@@ -89,6 +89,15 @@ typedef void (*sshsNodeChangeListener)(
 typedef void (*sshsAttributeChangeListener)(sshsNode node, void *userData, enum sshs_node_attribute_events event,
 	const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue);
 
+struct sshs_node_attr_change {
+	const char *key;
+	enum sshs_node_attr_value_type type;
+	union sshs_node_attr_value value;
+};
+
+typedef void (*sshsAttributeChangeSetListener)(
+	sshsNode node, void *userData, const struct sshs_node_attr_change *changes, size_t numChanges);
+
 typedef void (*sshsAttributeReadModifier)(
 	void *userData, const char *key, enum sshs_node_attr_value_type attrType, union sshs_node_attr_value *attrValue);
 
@@ -105,6 +114,32 @@ void sshsNodeAddAttributeListener(sshsNode node, void *userData, sshsAttributeCh
 void sshsNodeRemoveAttributeListener(sshsNode node, void *userData, sshsAttributeChangeListener attribute_changed);
 void sshsNodeRemoveAllAttributeListeners(sshsNode node);
 
+// Change set listeners are called once per committed transaction, with all
+// attributes it modified, and once per single attribute modification, with
+// just that one, always synchronously and with the node locked.
+// Attribute listeners are still called for every modified attribute, so
+// register either kind, not both, to hear about each modification once.
+void sshsNodeAddAttributeChangeSetListener(
+	sshsNode node, void *userData, sshsAttributeChangeSetListener change_set_changed);
+void sshsNodeRemoveAttributeChangeSetListener(
+	sshsNode node, void *userData, sshsAttributeChangeSetListener change_set_changed);
+void sshsNodeRemoveAllAttributeChangeSetListeners(sshsNode node);
+
+// Transactions: collect puts to several attributes of a node, then apply them
+// atomically on commit. All values are validated first, and if any attribute
+// doesn't exist, is read-only or out of range, nothing is changed. Attribute
+// listeners are called only after all values are in place.
+// Commit and abort free the transaction.
+typedef struct sshs_node_transaction *sshsNodeTransaction;
+
+sshsNodeTransaction sshsNodeTransactionBegin(sshsNode node);
+void sshsNodeTransactionPut(sshsNodeTransaction transaction, const char *key, enum sshs_node_attr_value_type type,
+	union sshs_node_attr_value value);
+bool sshsNodeTransactionPutFromString(
+	sshsNodeTransaction transaction, const char *key, const char *type, const char *value);
+bool sshsNodeTransactionCommit(sshsNodeTransaction transaction);
+void sshsNodeTransactionAbort(sshsNodeTransaction transaction);
+
 void sshsNodeAddAttributeReadModifier(sshsNode node, const char *key, enum sshs_node_attr_value_type type,
 	void *userData, sshsAttributeReadModifier modify_read);
 void sshsNodeRemoveAttributeReadModifier(sshsNode node, const char *key, enum sshs_node_attr_value_type type);
@@ -164,6 +199,8 @@ bool sshsNodeExportNodeToXML(sshsNode node, int fd);
 bool sshsNodeExportSubTreeToXML(sshsNode node, int fd);
 bool sshsNodeImportNodeFromXML(sshsNode node, int fd, bool strict);
 bool sshsNodeImportSubTreeFromXML(sshsNode node, int fd, bool strict);
+bool sshsNodeExportSubTreeToBinary(sshsNode node, int fd);
+bool sshsNodeImportSubTreeFromBinary(sshsNode node, int fd, bool strict);
 
 bool sshsNodeStringToAttributeConverter(sshsNode node, const char *key, const char *type, const char *value);
 const char **sshsNodeGetChildNames(sshsNode node, size_t *numNames);
@@ -192,6 +229,18 @@ void sshsNodeCreateAttributeFileChooser(
 typedef struct sshs_struct *sshs;
 typedef void (*sshsErrorLogCallback)(const char *msg);
 
+// Attribute listener dispatch: SYNCHRONOUS calls listeners directly inside
+// the put/create/remove call (default). THREAD queues changes, coalescing
+// consecutive modifications of the same attribute, and delivers them on a
+// dedicated thread. MANUAL queues the same way, but only delivers when
+// sshsDispatchListenerNotifications() is called. Node listeners are always
+// synchronous.
+enum sshs_listener_dispatch_mode {
+	SSHS_DISPATCH_SYNCHRONOUS = 0,
+	SSHS_DISPATCH_THREAD      = 1,
+	SSHS_DISPATCH_MANUAL      = 2,
+};
+
 sshs sshsGetGlobal(void);
 void sshsSetGlobalErrorLogCallback(sshsErrorLogCallback error_log_cb);
 sshsErrorLogCallback sshsGetGlobalErrorLogCallback(void);
@@ -202,6 +251,11 @@ bool sshsExistsRelativeNode(sshsNode node, const char *nodePath);
 sshsNode sshsGetRelativeNode(sshsNode node, const char *nodePath);
 bool sshsBeginTransaction(sshs st, const char *nodePaths[], size_t nodePathsLength);
 bool sshsEndTransaction(sshs st, const char *nodePaths[], size_t nodePathsLength);
+// Do not call these from inside listeners.
+void sshsSetListenerDispatchMode(sshs st, enum sshs_listener_dispatch_mode mode);
+enum sshs_listener_dispatch_mode sshsGetListenerDispatchMode(sshs st);
+size_t sshsDispatchListenerNotifications(sshs st);
+uint64_t sshsGetChangeCount(sshs st);
 
 #ifdef __cplusplus
 }
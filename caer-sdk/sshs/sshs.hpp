@@ -85,6 +85,58 @@ inline bool sshsNodePut(sshsNode node, const char *key, const std::string &value
 	return (sshsNodePutString(node, key, value.c_str()));
 }
 
+inline void sshsNodeTransactionPut(sshsNodeTransaction transaction, const char *key, bool value) {
+	union sshs_node_attr_value newValue;
+	newValue.boolean = value;
+	sshsNodeTransactionPut(transaction, key, SSHS_BOOL, newValue);
+}
+
+inline void sshsNodeTransactionPut(sshsNodeTransaction transaction, const char *key, int8_t value) {
+	union sshs_node_attr_value newValue;
+	newValue.ibyte = value;
+	sshsNodeTransactionPut(transaction, key, SSHS_BYTE, newValue);
+}
+
+inline void sshsNodeTransactionPut(sshsNodeTransaction transaction, const char *key, int16_t value) {
+	union sshs_node_attr_value newValue;
+	newValue.ishort = value;
+	sshsNodeTransactionPut(transaction, key, SSHS_SHORT, newValue);
+}
+
+inline void sshsNodeTransactionPut(sshsNodeTransaction transaction, const char *key, int32_t value) {
+	union sshs_node_attr_value newValue;
+	newValue.iint = value;
+	sshsNodeTransactionPut(transaction, key, SSHS_INT, newValue);
+}
+
+inline void sshsNodeTransactionPut(sshsNodeTransaction transaction, const char *key, int64_t value) {
+	union sshs_node_attr_value newValue;
+	newValue.ilong = value;
+	sshsNodeTransactionPut(transaction, key, SSHS_LONG, newValue);
+}
+
+inline void sshsNodeTransactionPut(sshsNodeTransaction transaction, const char *key, float value) {
+	union sshs_node_attr_value newValue;
+	newValue.ffloat = value;
+	sshsNodeTransactionPut(transaction, key, SSHS_FLOAT, newValue);
+}
+
+inline void sshsNodeTransactionPut(sshsNodeTransaction transaction, const char *key, double value) {
+	union sshs_node_attr_value newValue;
+	newValue.ddouble = value;
+	sshsNodeTransactionPut(transaction, key, SSHS_DOUBLE, newValue);
+}
+
+inline void sshsNodeTransactionPut(sshsNodeTransaction transaction, const char *key, const char *value) {
+	union sshs_node_attr_value newValue;
+	newValue.string = const_cast<char *>(value);
+	sshsNodeTransactionPut(transaction, key, SSHS_STRING, newValue);
+}
+
+inline void sshsNodeTransactionPut(sshsNodeTransaction transaction, const char *key, const std::string &value) {
+	sshsNodeTransactionPut(transaction, key, value.c_str());
+}
+
 // Additional getter for std::string.
 inline std::string sshsNodeGetStdString(sshsNode node, const char *key) {
 	char *str = sshsNodeGetString(node, key);
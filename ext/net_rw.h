@@ -1,12 +1,21 @@
 #ifndef CAER_SDK_NET_RW_H_
 #define CAER_SDK_NET_RW_H_
 
+#include <errno.h>
+#include <limits.h>
+#include <poll.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
+#ifndef IOV_MAX
+// Minimum guaranteed by POSIX.
+#define IOV_MAX 16
+#endif
+
 /**
  * Write N bytes to the socket S from buffer B.
  *
@@ -84,6 +93,64 @@ static inline bool writeUntilDone(int fd, const uint8_t *buffer, size_t bytesToW
 	return (true);
 }
 
+/**
+ * Write all buffers in the I/O vector IOV to the file descriptor FD, in order,
+ * with as few system calls as possible. Partial writes are resumed where they
+ * stopped, which modifies the contents of IOV. Each writev() call takes at most
+ * IOV_MAX buffers. Interrupted calls are retried, and on a non-blocking FD the
+ * function waits for it to become writable again.
+ *
+ * @param fd file descriptor FD.
+ * @param iov I/O vector IOV.
+ * @param iovCount number of buffers in IOV.
+ *
+ * @return Return the number of writev() calls done on success, -1 on failure.
+ */
+static inline ssize_t writevUntilDone(int fd, struct iovec *iov, int iovCount) {
+	ssize_t syscalls = 0;
+
+	while (iovCount > 0) {
+		ssize_t writeResult = writev(fd, iov, (iovCount > IOV_MAX) ? (IOV_MAX) : (iovCount));
+		if (writeResult < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+
+			if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+				struct pollfd pollFd = {.fd = fd, .events = POLLOUT, .revents = 0};
+
+				if ((poll(&pollFd, 1, -1) < 0) && (errno != EINTR)) {
+					// Error. Sets errno.
+					return (-1);
+				}
+
+				continue;
+			}
+
+			// Error. Sets errno.
+			return (-1);
+		}
+
+		syscalls++;
+
+		// Skip fully written buffers, then adjust the partially written one.
+		size_t written = (size_t) writeResult;
+
+		while ((iovCount > 0) && (written >= iov->iov_len)) {
+			written -= iov->iov_len;
+			iov++;
+			iovCount--;
+		}
+
+		if (iovCount > 0) {
+			iov->iov_base = (uint8_t *) iov->iov_base + written;
+			iov->iov_len -= written;
+		}
+	}
+
+	return (syscalls);
+}
+
 /**
  * Read N bytes from the file descriptor FD into buffer B.
  *
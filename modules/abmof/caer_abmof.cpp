@@ -152,7 +152,8 @@ static bool caerABMOFInit(caerModuleData moduleData) {
 
 
 	// Add config listeners last, to avoid having them dangling if Init doesn't succeed.
-	sshsNodeAddAttributeListener(moduleData->moduleNode, moduleData, &caerModuleConfigDefaultListener);
+	sshsNodeAddAttributeChangeSetListener(
+		moduleData->moduleNode, moduleData, &caerModuleConfigDefaultChangeSetListener);
 	sshsNodeAddAttributeListener(moduleData->moduleNode, moduleData->moduleState, &caerABMOFConfigCustom);
 
 	// Nothing that can fail here.
@@ -266,7 +267,8 @@ static void caerABMOFConfigCustom(sshsNode node, void *userData, enum sshs_node_
 
 static void caerABMOFExit(caerModuleData moduleData) {
 	// Remove listener, which can reference invalid memory in userData.
-	sshsNodeRemoveAttributeListener(moduleData->moduleNode, moduleData, &caerModuleConfigDefaultListener);
+	sshsNodeRemoveAttributeChangeSetListener(
+		moduleData->moduleNode, moduleData, &caerModuleConfigDefaultChangeSetListener);
 	sshsNodeRemoveAttributeListener(moduleData->moduleNode, moduleData->moduleState, &caerABMOFConfigCustom);
 
 	sshsNodeRemoveAllAttributeReadModifiers(moduleData->moduleNode);
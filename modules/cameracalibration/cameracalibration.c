@@ -123,7 +123,8 @@ static bool caerCameraCalibrationInit(caerModuleData moduleData) {
 	}
 
 	// Add config listeners last, to avoid having them dangling if Init doesn't succeed.
-	sshsNodeAddAttributeListener(moduleData->moduleNode, moduleData, &caerModuleConfigDefaultListener);
+	sshsNodeAddAttributeChangeSetListener(
+		moduleData->moduleNode, moduleData, &caerModuleConfigDefaultChangeSetListener);
 
 	return (true);
 }
@@ -196,7 +197,8 @@ static void caerCameraCalibrationConfig(caerModuleData moduleData) {
 
 static void caerCameraCalibrationExit(caerModuleData moduleData) {
 	// Remove listener, which can reference invalid memory in userData.
-	sshsNodeRemoveAttributeListener(moduleData->moduleNode, moduleData, &caerModuleConfigDefaultListener);
+	sshsNodeRemoveAttributeChangeSetListener(
+		moduleData->moduleNode, moduleData, &caerModuleConfigDefaultChangeSetListener);
 
 	CameraCalibrationState state = moduleData->moduleState;
 
@@ -135,7 +135,8 @@ static bool caerDVSNoiseFilterInit(caerModuleData moduleData) {
 		moduleData->moduleNode, "refractoryPeriodFiltered", SSHS_LONG, moduleData->moduleState, &statisticsPassthrough);
 
 	// Add config listeners last, to avoid having them dangling if Init doesn't succeed.
-	sshsNodeAddAttributeListener(moduleData->moduleNode, moduleData, &caerModuleConfigDefaultListener);
+	sshsNodeAddAttributeChangeSetListener(
+		moduleData->moduleNode, moduleData, &caerModuleConfigDefaultChangeSetListener);
 	sshsNodeAddAttributeListener(moduleData->moduleNode, moduleData->moduleState, &caerDVSNoiseFilterConfigCustom);
 
 	// Nothing that can fail here.
@@ -204,7 +205,8 @@ static void caerDVSNoiseFilterConfigCustom(sshsNode node, void *userData, enum s
 
 static void caerDVSNoiseFilterExit(caerModuleData moduleData) {
 	// Remove listener, which can reference invalid memory in userData.
-	sshsNodeRemoveAttributeListener(moduleData->moduleNode, moduleData, &caerModuleConfigDefaultListener);
+	sshsNodeRemoveAttributeChangeSetListener(
+		moduleData->moduleNode, moduleData, &caerModuleConfigDefaultChangeSetListener);
 	sshsNodeRemoveAttributeListener(moduleData->moduleNode, moduleData->moduleState, &caerDVSNoiseFilterConfigCustom);
 
 	sshsNodeRemoveAllAttributeReadModifiers(moduleData->moduleNode);
@@ -97,7 +97,8 @@ static bool caerFrameEnhancerInit(caerModuleData moduleData) {
 	caerFrameEnhancerConfig(moduleData);
 
 	// Add config listeners last, to avoid having them dangling if Init doesn't succeed.
-	sshsNodeAddAttributeListener(moduleData->moduleNode, moduleData, &caerModuleConfigDefaultListener);
+	sshsNodeAddAttributeChangeSetListener(
+		moduleData->moduleNode, moduleData, &caerModuleConfigDefaultChangeSetListener);
 
 	// Nothing that can fail here.
 	return (true);
@@ -203,7 +204,8 @@ static void caerFrameEnhancerConfig(caerModuleData moduleData) {
 
 static void caerFrameEnhancerExit(caerModuleData moduleData) {
 	// Remove listener, which can reference invalid memory in userData.
-	sshsNodeRemoveAttributeListener(moduleData->moduleNode, moduleData, &caerModuleConfigDefaultListener);
+	sshsNodeRemoveAttributeChangeSetListener(
+		moduleData->moduleNode, moduleData, &caerModuleConfigDefaultChangeSetListener);
 
 	sshsNode sourceInfoNode = sshsGetRelativeNode(moduleData->moduleNode, "sourceInfo/");
 	sshsNodeClearSubTree(sourceInfoNode, true);
@@ -60,7 +60,8 @@ static bool caerFrameStatisticsInit(caerModuleData moduleData) {
 	caerFrameStatisticsConfig(moduleData);
 
 	// Add config listeners last, to avoid having them dangling if Init doesn't succeed.
-	sshsNodeAddAttributeListener(moduleData->moduleNode, moduleData, &caerModuleConfigDefaultListener);
+	sshsNodeAddAttributeChangeSetListener(
+		moduleData->moduleNode, moduleData, &caerModuleConfigDefaultChangeSetListener);
 
 	cv::namedWindow(moduleData->moduleSubSystemString,
 		cv::WindowFlags::WINDOW_AUTOSIZE | cv::WindowFlags::WINDOW_KEEPRATIO | cv::WindowFlags::WINDOW_GUI_EXPANDED);
@@ -123,7 +124,8 @@ static void caerFrameStatisticsExit(caerModuleData moduleData) {
 	cv::destroyWindow(moduleData->moduleSubSystemString);
 
 	// Remove listener, which can reference invalid memory in userData.
-	sshsNodeRemoveAttributeListener(moduleData->moduleNode, moduleData, &caerModuleConfigDefaultListener);
+	sshsNodeRemoveAttributeChangeSetListener(
+		moduleData->moduleNode, moduleData, &caerModuleConfigDefaultChangeSetListener);
 }
 
 static void caerFrameStatisticsConfig(caerModuleData moduleData) {
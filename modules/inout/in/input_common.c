@@ -1,4 +1,12 @@
+#if defined(OS_LINUX)
+// recvmmsg() is a GNU extension.
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE 1
+#endif
+#endif
+
 #include "input_common.h"
+#include "../inout_tsserialize.h"
 #include "caer-sdk/cross/portable_threads.h"
 #include "caer-sdk/cross/portable_time.h"
 #include "caer-sdk/mainloop.h"
@@ -9,6 +17,18 @@
 #include <png.h>
 #endif
 
+#ifdef ENABLE_INOUT_GZIP_DECOMPRESSION
+#include <zlib.h>
+#endif
+
+#ifdef ENABLE_INOUT_ZSTD_DECOMPRESSION
+#include <zstd.h>
+#endif
+
+#ifdef ENABLE_INOUT_LZ4_DECOMPRESSION
+#include <lz4frame.h>
+#endif
+
 #include <libcaer/events/common.h>
 #include <libcaer/events/frame.h>
 #include <libcaer/events/packetContainer.h>
@@ -18,8 +38,62 @@
 
 #include <libcaer/devices/dynapse.h> // CONSTANTS only.
 
+#if !defined(OS_WINDOWS)
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+#if !defined(OS_LINUX)
+// No recvmmsg(), datagrams are received one by one with recvmsg().
+struct mmsghdr {
+	struct msghdr msg_hdr;
+	unsigned int msg_len;
+};
+#endif
+#endif
+
 #define MAX_HEADER_LINE_SIZE 1024
 
+// Size of the file window mapped at once for memory-mapped file input.
+// Must be a multiple of the page size. Bounds address space usage, so
+// huge files can be played back on 32-bit systems too.
+#define MMAP_WINDOW_SIZE (64 * 1024 * 1024)
+
+// Magic numbers at the start of compressed files. Zstandard files can also
+// start with a skippable frame, magic 0x184D2A50 to 0x184D2A5F.
+#define STREAM_MAGIC_GZIP "\x1F\x8B"
+#define STREAM_MAGIC_ZSTD "\x28\xB5\x2F\xFD"
+#define STREAM_MAGIC_ZSTD_SKIPPABLE "\x2A\x4D\x18"
+#define STREAM_MAGIC_LZ4 "\x04\x22\x4D\x18"
+
+// Packet index file, stored next to the input file, to support seeking.
+// Little-endian header (magic, version, source ID, file size and mtime,
+// data start offset, number of entries) followed by fixed-size entries.
+#define INDEX_FILE_SUFFIX ".idx"
+#define INDEX_FILE_MAGIC "caerPIDX"
+#define INDEX_FILE_VERSION 1
+#define INDEX_FILE_HEADER_SIZE 48
+#define INDEX_FILE_ENTRY_SIZE 36
+
+// Playback pacing modes, in the order of enum input_pacing_mode. Packet containers
+// committed later than PACING_LATE_THRESHOLD (in µs) are counted as late.
+#define PACING_MODES "Delay,Timestamps,Unlimited"
+#define PACING_LATE_THRESHOLD 1000
+
+// UDP datagram size: network header followed by up to AEDAT3_MAX_UDP_SIZE bytes
+// of event packet data. Bit 63 of the sequence number marks an event packet's
+// first message, the sequence number increases by one with each message.
+#define UDP_MESSAGE_SIZE (AEDAT3_NETWORK_HEADER_LENGTH + AEDAT3_MAX_UDP_SIZE)
+#define UDP_PACKET_START_BIT 0x8000000000000000LLU
+
+// Passed from the reader to the assembler thread in place of a packet,
+// to mark where the packets read after a seek begin.
+static struct caer_event_packet_header seekMarker;
+#define SEEK_MARKER (&seekMarker)
+
 enum input_reader_state {
 	READER_OK    = 0,
 	EOF_REACHED  = 1,
@@ -29,6 +103,20 @@ enum input_reader_state {
 };
 
 static bool newInputBuffer(inputCommonState state);
+static void mmapInputInit(inputCommonState state);
+static ssize_t mmapInputNextWindow(inputCommonState state);
+static void mmapInputClose(inputCommonState state);
+static bool streamDecoderInit(inputCommonState state, size_t readAheadSize);
+static void streamDecoderExit(inputCommonState state);
+static bool streamDecoderFill(inputCommonState state);
+static int streamDecoderDecode(inputCommonState state, size_t *consumed, uint8_t *buffer, size_t bufferSize,
+	size_t *produced);
+static ssize_t streamDecoderRead(inputCommonState state, uint8_t *buffer, size_t bufferSize);
+static void indexInit(inputCommonState state);
+static void indexExit(inputCommonState state);
+static void inputSeek(inputCommonState state, int64_t timestamp, double fraction);
+static void inputReaderSeek(inputCommonState state);
+static bool inputAssemblerSeek(inputCommonState state);
 static bool parseNetworkHeader(inputCommonState state);
 static char *getFileHeaderLine(inputCommonState state);
 static void parseSourceString(char *sourceString, inputCommonState state);
@@ -37,15 +125,44 @@ static bool parseHeader(inputCommonState state);
 static bool parseData(inputCommonState state);
 static int aedat2GetPacket(inputCommonState state, int16_t chipID);
 static int aedat3GetPacket(inputCommonState state, bool isAEDAT30);
+static bool finishPacket(
+	inputCommonState state, caerEventPacketHeader packet, packetData packetInfoData, bool isAEDAT30);
 static void aedat30ChangeOrigin(inputCommonState state, caerEventPacketHeader packet);
 static bool decompressTimestampSerialize(inputCommonState state, caerEventPacketHeader packet, size_t packetSize);
 static bool decompressEventPacket(inputCommonState state, caerEventPacketHeader packet, size_t packetSize);
+static bool decompressPoolInit(inputCommonState state, size_t workersNumber, size_t jobsSize);
+static void decompressPoolExit(inputCommonState state);
+static int decompressPoolForward(inputCommonState state, size_t maxPending);
+static bool decompressPoolSubmit(
+	inputCommonState state, caerEventPacketHeader packet, packetData packetInfoData, bool isAEDAT30);
+static void replayCacheInit(inputCommonState state, size_t storeLimit);
+static void replayCacheExit(inputCommonState state);
+static void replayCacheDisable(inputCommonState state, const char *reason);
+static void replayCacheAdd(inputCommonState state, caerEventPacketHeader packet);
+static bool replayCachePut(inputCommonState state, caerEventPacketHeader cached, int64_t timeOffset);
+static bool replayCacheLoop(inputCommonState state);
+static bool udpInputInit(inputCommonState state, size_t batchSize, size_t windowSize, int64_t reorderTimeout);
+static void udpInputExit(inputCommonState state);
+static int udpInputReceive(inputCommonState state, int timeoutMs);
+static void udpInputAddBatch(inputCommonState state);
+static bool udpInputAddMessage(inputCommonState state, struct input_common_udp_message *message);
+static void udpInputResync(inputCommonState state);
+static void udpInputAdvance(inputCommonState state, int64_t targetSequenceNumber);
+static void udpInputSkip(inputCommonState state);
+static int64_t udpInputPacketComplete(inputCommonState state);
+static size_t udpInputDeliver(inputCommonState state, uint8_t *buffer, size_t bufferSize);
+static ssize_t udpInputNextBuffer(inputCommonState state);
 static int inputReaderThread(void *stateArg);
 
 static bool addToPacketContainer(inputCommonState state, caerEventPacketHeader newPacket, packetData newPacketData);
+static caerEventPacketHeader pendingPacketCompact(struct input_common_pending_packet *pending);
+static int32_t findCutoffIndex(inputCommonState state, caerEventPacketHeader packet);
+static int32_t countValidEvents(caerEventPacketHeader packet, int32_t start, int32_t end);
 static caerEventPacketContainer generatePacketContainer(inputCommonState state, bool forceFlush);
 static void commitPacketContainer(inputCommonState state, bool forceFlush);
 static void doTimeDelay(inputCommonState state);
+static void doTimestampPacing(inputCommonState state, caerEventPacketContainer packetContainer);
+static int32_t pacingModeParse(const char *mode);
 static void doPacketContainerCommit(inputCommonState state, caerEventPacketContainer packetContainer, bool force);
 static bool handleTSReset(inputCommonState state);
 static void getPacketInfo(caerEventPacketHeader packet, packetData packetInfoData);
@@ -53,6 +170,8 @@ static int inputAssemblerThread(void *stateArg);
 
 static void caerInputCommonConfigListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
 	const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue);
+static void statisticsPassthrough(
+	void *userData, const char *key, enum sshs_node_attr_value_type type, union sshs_node_attr_value *value);
 static int packetsFirstTypeThenSizeCmp(const void *a, const void *b);
 
 static bool newInputBuffer(inputCommonState state) {
@@ -92,244 +211,1478 @@ static bool newInputBuffer(inputCommonState state) {
 	return (true);
 }
 
-static bool parseNetworkHeader(inputCommonState state) {
-	// Network header is 20 bytes long. Use struct to interpret.
-	struct aedat3_network_header networkHeader = caerParseNetworkHeader(state->dataBuffer->buffer);
-	state->dataBuffer->bufferPosition += AEDAT3_NETWORK_HEADER_LENGTH;
+static void mmapInputInit(inputCommonState state) {
+#if !defined(OS_WINDOWS)
+	struct stat fileStat;
 
-	// Check header values.
-	if (networkHeader.magicNumber != AEDAT3_NETWORK_MAGIC_NUMBER) {
-		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "AEDAT 3.X magic number not found. Invalid network stream.");
-		return (false);
+	if ((fstat(state->fileDescriptor, &fileStat) != 0) || !S_ISREG(fileStat.st_mode)) {
+		caerModuleLog(state->parentModule, CAER_LOG_INFO, "Input is not a regular file, not memory-mapping it.");
+		return;
 	}
 
-	state->header.isAEDAT3     = true;
-	state->header.majorVersion = 3;
+	state->mmap.enabled    = true;
+	state->mmap.fileSize   = (size_t) fileStat.st_size;
+	state->mmap.nextOffset = 0;
+	state->mmap.window     = NULL;
+	state->mmap.windowSize = 0;
 
-	if (state->isNetworkMessageBased) {
-		// For message based streams, use the sequence number.
-		// TODO: Network: check this for missing packets in message mode!
-		state->header.networkSequenceNumber = networkHeader.sequenceNumber;
-	}
-	else {
-		// For stream based transports, this is always zero.
-		if (networkHeader.sequenceNumber != 0) {
-			caerModuleLog(state->parentModule, CAER_LOG_ERROR, "SequenceNumber is not zero. Invalid network stream.");
-			return (false);
-		}
+	caerModuleLog(state->parentModule, CAER_LOG_DEBUG, "Reading input file through memory mapping.");
+#else
+	caerModuleLog(state->parentModule, CAER_LOG_INFO, "Memory-mapped file input not supported on this platform.");
+#endif
+}
+
+/**
+ * Map the next window of the input file and make it the current data to parse.
+ * Packets can span two windows, parsing handles that like for read buffers.
+ *
+ * @return size of new window in bytes, 0 on EOF, -1 on error (errno set).
+ */
+static ssize_t mmapInputNextWindow(inputCommonState state) {
+#if !defined(OS_WINDOWS)
+	mmapInputClose(state);
+
+	if (state->mmap.nextOffset >= state->mmap.fileSize) {
+		return (0);
 	}
 
-	if (networkHeader.versionNumber != AEDAT3_NETWORK_VERSION) {
-		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Unsupported AEDAT version. Invalid network stream.");
-		return (false);
+	size_t windowSize = state->mmap.fileSize - state->mmap.nextOffset;
+	if (windowSize > MMAP_WINDOW_SIZE) {
+		windowSize = MMAP_WINDOW_SIZE;
 	}
 
-	state->header.minorVersion = networkHeader.versionNumber;
+	void *window
+		= mmap(NULL, windowSize, PROT_READ, MAP_PRIVATE, state->fileDescriptor, (off_t) state->mmap.nextOffset);
+	if (window == MAP_FAILED) {
+		return (-1);
+	}
 
-	// All formats are supported.
-	state->header.formatID = networkHeader.formatNumber;
+	// Data is read once and in order: ask for aggressive read-ahead, and
+	// start loading the whole window right away.
+	madvise(window, windowSize, MADV_SEQUENTIAL);
+	madvise(window, windowSize, MADV_WILLNEED);
 
-	// TODO: Network: get sourceInfo node info via config-server side-channel.
-	state->header.sourceID = networkHeader.sourceID;
+	state->mmap.window     = window;
+	state->mmap.windowSize = windowSize;
+	state->mmap.nextOffset += windowSize;
 
-	sshsNodeCreateShort(state->sourceInfoNode, "polaritySizeX", 240, 1, INT16_MAX,
-		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Polarity events width.");
-	sshsNodeCreateShort(state->sourceInfoNode, "polaritySizeY", 180, 1, INT16_MAX,
-		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Polarity events height.");
-	sshsNodeCreateShort(state->sourceInfoNode, "frameSizeX", 240, 1, INT16_MAX,
-		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Frame events width.");
-	sshsNodeCreateShort(state->sourceInfoNode, "frameSizeY", 180, 1, INT16_MAX,
-		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Frame events height.");
-	sshsNodeCreateShort(state->sourceInfoNode, "dataSizeX", 240, 1, INT16_MAX,
-		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Data width.");
-	sshsNodeCreateShort(state->sourceInfoNode, "dataSizeY", 180, 1, INT16_MAX,
-		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Data height.");
-	sshsNodeCreateShort(state->sourceInfoNode, "visualizerSizeX", 240, 1, INT16_MAX,
-		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Visualization width.");
-	sshsNodeCreateShort(state->sourceInfoNode, "visualizerSizeY", 180, 1, INT16_MAX,
-		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Visualization height.");
+#if defined(POSIX_FADV_WILLNEED)
+	// Also get the following window into the page cache, while this one is parsed.
+	if (state->mmap.nextOffset < state->mmap.fileSize) {
+		posix_fadvise(state->fileDescriptor, (off_t) state->mmap.nextOffset, MMAP_WINDOW_SIZE, POSIX_FADV_WILLNEED);
+	}
+#endif
 
-	// TODO: Network: add sourceString.
+	state->dataView.buffer         = window;
+	state->dataView.bufferUsedSize = windowSize;
+	state->dataView.bufferPosition = 0;
 
-	// We're done!
-	atomic_store(&state->header.isValidHeader, true);
+	return ((ssize_t) windowSize);
+#else
+	UNUSED_ARGUMENT(state);
 
-	return (true);
+	errno = ENOTSUP;
+	return (-1);
+#endif
 }
 
-static char *getFileHeaderLine(inputCommonState state) {
-	simpleBuffer buf = state->dataBuffer;
+static void mmapInputClose(inputCommonState state) {
+#if !defined(OS_WINDOWS)
+	if (state->mmap.window != NULL) {
+		munmap(state->mmap.window, state->mmap.windowSize);
 
-	if (buf->buffer[buf->bufferPosition] == '#') {
-		size_t headerLinePos = 0;
-		char *headerLine     = malloc(MAX_HEADER_LINE_SIZE);
-		if (headerLine == NULL) {
-			// Failed to allocate memory.
-			return (NULL);
-		}
+		state->mmap.window     = NULL;
+		state->mmap.windowSize = 0;
+	}
+#else
+	UNUSED_ARGUMENT(state);
+#endif
+}
 
-		headerLine[headerLinePos++] = '#';
-		buf->bufferPosition++;
+/**
+ * Detect compressed input files from their magic number, and prepare to decode
+ * them while reading. Compressed files can't be memory-mapped or indexed.
+ *
+ * @param state common input data structure.
+ * @param readAheadSize size in bytes of the buffer for compressed data.
+ *
+ * @return true if the file is uncompressed or can be decoded, false otherwise.
+ */
+static bool streamDecoderInit(inputCommonState state, size_t readAheadSize) {
+	struct input_common_stream_decoder_data *decoder = &state->streamDecoder;
 
-		while (buf->buffer[buf->bufferPosition] != '\n') {
-			if (headerLinePos >= (MAX_HEADER_LINE_SIZE - 2)) { // -1 for terminating new-line, -1 for end NUL char.
-				// Overlong header line, refuse it.
-				free(headerLine);
-				return (NULL);
-			}
+	decoder->format = STREAM_UNCOMPRESSED;
 
-			headerLine[headerLinePos++] = (char) buf->buffer[buf->bufferPosition];
-			buf->bufferPosition++;
-		}
+#if !defined(OS_WINDOWS)
+	struct stat fileStat;
 
-		// Found terminating new-line character.
-		headerLine[headerLinePos++] = '\n';
-		buf->bufferPosition++;
+	if ((fstat(state->fileDescriptor, &fileStat) != 0) || !S_ISREG(fileStat.st_mode)) {
+		return (true);
+	}
 
-		// Now let's just verify that the previous character was indeed a carriage-return.
-		if (headerLine[headerLinePos - 2] == '\r') {
-			// Valid, terminate it and return it.
-			headerLine[headerLinePos] = '\0';
+	// Peek at the start of the file, without moving the file position.
+	uint8_t magic[4];
 
-			return (headerLine);
-		}
-		else {
-			// Invalid header line. No Windows line-ending.
-			free(headerLine);
-			return (NULL);
-		}
+	if (pread(state->fileDescriptor, magic, sizeof(magic), 0) != (ssize_t) sizeof(magic)) {
+		return (true);
 	}
 
-	// Invalid header line. Doesn't begin with #.
-	return (NULL);
-}
-
-static void parseSourceString(char *sourceString, inputCommonState state) {
-	// Create SourceInfo node.
-	int16_t dvsSizeX = 0, dvsSizeY = 0;
-	int16_t apsSizeX = 0, apsSizeY = 0;
-	int16_t dataSizeX = 0, dataSizeY = 0;
-	int16_t visualizerSizeX = 0, visualizerSizeY = 0;
+	const char *formatName = NULL;
 
-	// Determine sizes via known chip information.
-	if (caerStrEquals(sourceString, "DVS128")) {
-		dvsSizeX = dvsSizeY = 128;
+	if (memcmp(magic, STREAM_MAGIC_GZIP, 2) == 0) {
+		decoder->format = STREAM_GZIP;
+		formatName      = "gzip";
 	}
-	else if (caerStrEquals(sourceString, "DAVIS240A") || caerStrEquals(sourceString, "DAVIS240B")
-			 || caerStrEquals(sourceString, "DAVIS240C")) {
-		dvsSizeX = apsSizeX = 240;
-		dvsSizeY = apsSizeY = 180;
-	}
-	else if (caerStrEquals(sourceString, "DAVIS128")) {
-		dvsSizeX = apsSizeX = dvsSizeY = apsSizeY = 128;
-	}
-	else if (caerStrEquals(sourceString, "DAVIS346A") || caerStrEquals(sourceString, "DAVIS346B")
-			 || caerStrEquals(sourceString, "DAVIS346Cbsi") || caerStrEquals(sourceString, "DAVIS346")
-			 || caerStrEquals(sourceString, "DAVIS346bsi")) {
-		dvsSizeX = apsSizeX = 346;
-		dvsSizeY = apsSizeY = 260;
-	}
-	else if (caerStrEquals(sourceString, "DAVIS640")) {
-		dvsSizeX = apsSizeX = 640;
-		dvsSizeY = apsSizeY = 480;
-	}
-	else if (caerStrEquals(sourceString, "DAVISHet640") || caerStrEquals(sourceString, "DAVIS640het")) {
-		dvsSizeX = 320;
-		dvsSizeY = 240;
-		apsSizeX = 640;
-		apsSizeY = 480;
-	}
-	else if (caerStrEquals(sourceString, "DAVIS208")) {
-		dvsSizeX = apsSizeX = 208;
-		dvsSizeY = apsSizeY = 192;
-	}
-	else if (caerStrEquals(sourceString, "DYNAPSE")) {
-		dataSizeX = DYNAPSE_X4BOARD_NEUX;
-		dataSizeY = DYNAPSE_X4BOARD_NEUY;
-	}
-	else if (caerStrEqualsUpTo(sourceString, "File,", 5)) {
-		sscanf(sourceString + 5,
-			"dvsSizeX=%" SCNi16 ",dvsSizeY=%" SCNi16 ",apsSizeX=%" SCNi16 ",apsSizeY=%" SCNi16 ","
-			"dataSizeX=%" SCNi16 ",dataSizeY=%" SCNi16 ",visualizerSizeX=%" SCNi16 ",visualizerSizeY=%" SCNi16 "\r\n",
-			&dvsSizeX, &dvsSizeY, &apsSizeX, &apsSizeY, &dataSizeX, &dataSizeY, &visualizerSizeX, &visualizerSizeY);
-	}
-	else if (caerStrEqualsUpTo(sourceString, "Network,", 8)) {
-		sscanf(sourceString + 8,
-			"dvsSizeX=%" SCNi16 ",dvsSizeY=%" SCNi16 ",apsSizeX=%" SCNi16 ",apsSizeY=%" SCNi16 ","
-			"dataSizeX=%" SCNi16 ",dataSizeY=%" SCNi16 ",visualizerSizeX=%" SCNi16 ",visualizerSizeY=%" SCNi16 "\r\n",
-			&dvsSizeX, &dvsSizeY, &apsSizeX, &apsSizeY, &dataSizeX, &dataSizeY, &visualizerSizeX, &visualizerSizeY);
+	else if ((memcmp(magic, STREAM_MAGIC_ZSTD, 4) == 0)
+			 || (((magic[0] & 0xF0) == 0x50) && (memcmp(magic + 1, STREAM_MAGIC_ZSTD_SKIPPABLE, 3) == 0))) {
+		decoder->format = STREAM_ZSTD;
+		formatName      = "zstd";
 	}
-	else if (caerStrEqualsUpTo(sourceString, "Processor,", 10)) {
-		sscanf(sourceString + 10,
-			"dvsSizeX=%" SCNi16 ",dvsSizeY=%" SCNi16 ",apsSizeX=%" SCNi16 ",apsSizeY=%" SCNi16 ","
-			"dataSizeX=%" SCNi16 ",dataSizeY=%" SCNi16 ",visualizerSizeX=%" SCNi16 ",visualizerSizeY=%" SCNi16 "\r\n",
-			&dvsSizeX, &dvsSizeY, &apsSizeX, &apsSizeY, &dataSizeX, &dataSizeY, &visualizerSizeX, &visualizerSizeY);
+	else if (memcmp(magic, STREAM_MAGIC_LZ4, 4) == 0) {
+		decoder->format = STREAM_LZ4;
+		formatName      = "lz4";
 	}
 	else {
-		// Default fall-back of 640x480 (VGA).
-		caerModuleLog(state->parentModule, CAER_LOG_WARNING,
-			"Impossible to determine display sizes from Source information/string. Falling back to 640x480 (VGA).");
-		dvsSizeX = apsSizeX = 640;
-		dvsSizeY = apsSizeY = 480;
+		return (true);
 	}
 
-	// Put size information inside sourceInfo node.
-	if (dvsSizeX != 0 && dvsSizeY != 0) {
-		sshsNodeCreateShort(state->sourceInfoNode, "polaritySizeX", dvsSizeX, 1, INT16_MAX,
-			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Polarity events width.");
-		sshsNodeCreateShort(state->sourceInfoNode, "polaritySizeY", dvsSizeY, 1, INT16_MAX,
-			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Polarity events height.");
-	}
+	switch (decoder->format) {
+#ifdef ENABLE_INOUT_GZIP_DECOMPRESSION
+		case STREAM_GZIP: {
+			z_stream *gzip = calloc(1, sizeof(z_stream));
+			if (gzip == NULL) {
+				break;
+			}
 
-	if (apsSizeX != 0 && apsSizeY != 0) {
-		sshsNodeCreateShort(state->sourceInfoNode, "frameSizeX", apsSizeX, 1, INT16_MAX,
-			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Frame events width.");
-		sshsNodeCreateShort(state->sourceInfoNode, "frameSizeY", apsSizeY, 1, INT16_MAX,
-			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Frame events height.");
-	}
+			// Window bits 15 + 16: gzip header and trailer, not zlib.
+			if (inflateInit2(gzip, 15 + 16) != Z_OK) {
+				free(gzip);
+				break;
+			}
 
-	if (dataSizeX == 0 && dataSizeY == 0) {
-		// Try to auto-discover dataSize, if it was not previously set, based on the
-		// presence of DVS or APS sizes. If they don't exist either, this will be 0.
-		dataSizeX = (dvsSizeX > apsSizeX) ? (dvsSizeX) : (apsSizeX);
-		dataSizeY = (dvsSizeY > apsSizeY) ? (dvsSizeY) : (apsSizeY);
+			decoder->context = gzip;
+			break;
+		}
+#endif
+
+#ifdef ENABLE_INOUT_ZSTD_DECOMPRESSION
+		case STREAM_ZSTD:
+			decoder->context = ZSTD_createDStream();
+			if ((decoder->context != NULL) && ZSTD_isError(ZSTD_initDStream(decoder->context))) {
+				ZSTD_freeDStream(decoder->context);
+				decoder->context = NULL;
+			}
+			break;
+#endif
+
+#ifdef ENABLE_INOUT_LZ4_DECOMPRESSION
+		case STREAM_LZ4: {
+			LZ4F_dctx *lz4 = NULL;
+
+			if (!LZ4F_isError(LZ4F_createDecompressionContext(&lz4, LZ4F_VERSION))) {
+				decoder->context = lz4;
+			}
+			break;
+		}
+#endif
+
+		default:
+			caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+				"Input file is %s compressed, but support for it was not compiled in.", formatName);
+			decoder->format = STREAM_UNCOMPRESSED;
+			return (false);
 	}
 
-	if (dataSizeX != 0 && dataSizeY != 0) {
-		sshsNodeCreateShort(state->sourceInfoNode, "dataSizeX", dataSizeX, 1, INT16_MAX,
-			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Data width.");
-		sshsNodeCreateShort(state->sourceInfoNode, "dataSizeY", dataSizeY, 1, INT16_MAX,
-			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Data height.");
+	if (decoder->context == NULL) {
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to initialize %s decoder.", formatName);
+		decoder->format = STREAM_UNCOMPRESSED;
+		return (false);
 	}
 
-	if (visualizerSizeX != 0 && visualizerSizeY != 0) {
-		sshsNodeCreateShort(state->sourceInfoNode, "visualizerSizeX", visualizerSizeX, 1, INT16_MAX,
-			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Visualization width.");
-		sshsNodeCreateShort(state->sourceInfoNode, "visualizerSizeY", visualizerSizeY, 1, INT16_MAX,
-			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Visualization height.");
+	decoder->readAhead = malloc(readAheadSize);
+	if (decoder->readAhead == NULL) {
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to allocate memory for compressed data.");
+		streamDecoderExit(state);
+		return (false);
 	}
 
-	// Generate source string for output modules.
-	size_t sourceStringFileLength = (size_t) snprintf(NULL, 0,
-		"#Source %" PRIu16 ": File,"
-		"dvsSizeX=%" PRIi16 ",dvsSizeY=%" PRIi16 ",apsSizeX=%" PRIi16 ",apsSizeY=%" PRIi16 ","
-		"dataSizeX=%" PRIi16 ",dataSizeY=%" PRIi16 ",visualizerSizeX=%" PRIi16 ",visualizerSizeY=%" PRIi16 "\r\n"
-		"#-Source %" PRIi16 ": %s\r\n",
-		state->parentModule->moduleID, dvsSizeX, dvsSizeY, apsSizeX, apsSizeY, dataSizeX, dataSizeY, visualizerSizeX,
-		visualizerSizeY, state->header.sourceID, sourceString);
+	decoder->readAheadSize     = readAheadSize;
+	decoder->readAheadUsed     = 0;
+	decoder->readAheadPosition = 0;
+	decoder->inputEnd          = false;
+	decoder->frameOpen         = false;
 
-	char sourceStringFile[sourceStringFileLength + 1];
-	snprintf(sourceStringFile, sourceStringFileLength + 1,
-		"#Source %" PRIu16 ": File,"
-		"dvsSizeX=%" PRIi16 ",dvsSizeY=%" PRIi16 ",apsSizeX=%" PRIi16 ",apsSizeY=%" PRIi16 ","
-		"dataSizeX=%" PRIi16 ",dataSizeY=%" PRIi16 ",visualizerSizeX=%" PRIi16 ",visualizerSizeY=%" PRIi16 "\r\n"
-		"#-Source %" PRIi16 ": %s\r\n",
-		state->parentModule->moduleID, dvsSizeX, dvsSizeY, apsSizeX, apsSizeY, dataSizeX, dataSizeY, visualizerSizeX,
-		visualizerSizeY, state->header.sourceID, sourceString);
-	sourceStringFile[sourceStringFileLength] = '\0';
+#if defined(POSIX_FADV_SEQUENTIAL)
+	// Read once and in order: let the kernel read ahead aggressively too.
+	posix_fadvise(state->fileDescriptor, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
 
-	sshsNodeCreateString(state->sourceInfoNode, "sourceString", sourceStringFile, 1, 2048,
-		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Device source information.");
+	caerModuleLog(
+		state->parentModule, CAER_LOG_INFO, "Input file is %s compressed, decoding while reading.", formatName);
+#else
+	UNUSED_ARGUMENT(readAheadSize);
+#endif
+
+	return (true);
+}
+
+static void streamDecoderExit(inputCommonState state) {
+	struct input_common_stream_decoder_data *decoder = &state->streamDecoder;
+
+	if (decoder->context != NULL) {
+		switch (decoder->format) {
+#ifdef ENABLE_INOUT_GZIP_DECOMPRESSION
+			case STREAM_GZIP:
+				inflateEnd(decoder->context);
+				free(decoder->context);
+				break;
+#endif
+
+#ifdef ENABLE_INOUT_ZSTD_DECOMPRESSION
+			case STREAM_ZSTD:
+				ZSTD_freeDStream(decoder->context);
+				break;
+#endif
+
+#ifdef ENABLE_INOUT_LZ4_DECOMPRESSION
+			case STREAM_LZ4:
+				LZ4F_freeDecompressionContext(decoder->context);
+				break;
+#endif
+
+			default:
+				break;
+		}
+
+		decoder->context = NULL;
+	}
+
+	free(decoder->readAhead);
+	decoder->readAhead = NULL;
+
+	decoder->format = STREAM_UNCOMPRESSED;
+}
+
+/**
+ * Move the compressed data not yet decoded to the start of the read-ahead
+ * buffer, and fill up the rest of it from the file.
+ *
+ * @return true on success (also at EOF), false on read error (errno set).
+ */
+static bool streamDecoderFill(inputCommonState state) {
+	struct input_common_stream_decoder_data *decoder = &state->streamDecoder;
+
+	size_t remaining = decoder->readAheadUsed - decoder->readAheadPosition;
+
+	memmove(decoder->readAhead, decoder->readAhead + decoder->readAheadPosition, remaining);
+
+	decoder->readAheadUsed     = remaining;
+	decoder->readAheadPosition = 0;
+
+	ssize_t result = readUntilDone(
+		state->fileDescriptor, decoder->readAhead + remaining, decoder->readAheadSize - remaining);
+	if (result < 0) {
+		return (false);
+	}
+
+	// readUntilDone() only returns less than requested at EOF.
+	if ((size_t) result < (decoder->readAheadSize - remaining)) {
+		decoder->inputEnd = true;
+	}
+
+	decoder->readAheadUsed += (size_t) result;
+
+	return (true);
+}
+
+/**
+ * Decode as much of the compressed data in the read-ahead buffer as fits into
+ * the given buffer. Files made of several concatenated compressed streams are
+ * decoded one after the other.
+ *
+ * @param state common input data structure.
+ * @param consumed set to the number of compressed bytes used up.
+ * @param buffer where to put the decoded data.
+ * @param bufferSize size of buffer, in bytes.
+ * @param produced set to the number of decoded bytes put into buffer.
+ *
+ * @return 0 on success, -1 on invalid compressed data.
+ */
+static int streamDecoderDecode(inputCommonState state, size_t *consumed, uint8_t *buffer, size_t bufferSize,
+	size_t *produced) {
+	struct input_common_stream_decoder_data *decoder = &state->streamDecoder;
+
+	uint8_t *input   = decoder->readAhead + decoder->readAheadPosition;
+	size_t inputSize = decoder->readAheadUsed - decoder->readAheadPosition;
+
+	*consumed = 0;
+	*produced = 0;
+
+	switch (decoder->format) {
+#ifdef ENABLE_INOUT_GZIP_DECOMPRESSION
+		case STREAM_GZIP: {
+			z_stream *gzip = decoder->context;
+
+			// zlib sizes are 32 bit, just do less per call.
+			gzip->next_in   = input;
+			gzip->avail_in  = (inputSize > UINT32_MAX) ? (UINT32_MAX) : ((uInt) inputSize);
+			gzip->next_out  = buffer;
+			gzip->avail_out = (bufferSize > UINT32_MAX) ? (UINT32_MAX) : ((uInt) bufferSize);
+
+			uInt availIn  = gzip->avail_in;
+			uInt availOut = gzip->avail_out;
+
+			int result = inflate(gzip, Z_NO_FLUSH);
+
+			*consumed = availIn - gzip->avail_in;
+			*produced = availOut - gzip->avail_out;
+
+			if (result == Z_STREAM_END) {
+				decoder->frameOpen = false;
+				inflateReset(gzip);
+			}
+			else if ((result == Z_OK) || (result == Z_BUF_ERROR)) {
+				decoder->frameOpen = decoder->frameOpen || (*consumed != 0);
+			}
+			else {
+				caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to decode gzip data: %s.",
+					(gzip->msg != NULL) ? (gzip->msg) : ("unknown error"));
+				return (-1);
+			}
+
+			break;
+		}
+#endif
+
+#ifdef ENABLE_INOUT_ZSTD_DECOMPRESSION
+		case STREAM_ZSTD: {
+			ZSTD_inBuffer in   = {.src = input, .size = inputSize, .pos = 0};
+			ZSTD_outBuffer out = {.dst = buffer, .size = bufferSize, .pos = 0};
+
+			// Returns 0 when a frame is completely decoded and flushed.
+			size_t result = ZSTD_decompressStream(decoder->context, &out, &in);
+			if (ZSTD_isError(result)) {
+				caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to decode zstd data: %s.",
+					ZSTD_getErrorName(result));
+				return (-1);
+			}
+
+			*consumed          = in.pos;
+			*produced          = out.pos;
+			decoder->frameOpen = (result != 0);
+			break;
+		}
+#endif
+
+#ifdef ENABLE_INOUT_LZ4_DECOMPRESSION
+		case STREAM_LZ4: {
+			size_t inSize  = inputSize;
+			size_t outSize = bufferSize;
+
+			// Returns 0 when a frame is completely decoded and flushed.
+			size_t result = LZ4F_decompress(decoder->context, buffer, &outSize, input, &inSize, NULL);
+			if (LZ4F_isError(result)) {
+				caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to decode lz4 data: %s.",
+					LZ4F_getErrorName(result));
+				return (-1);
+			}
+
+			*consumed          = inSize;
+			*produced          = outSize;
+			decoder->frameOpen = (result != 0);
+			break;
+		}
+#endif
+
+		default:
+			UNUSED_ARGUMENT(input);
+			UNUSED_ARGUMENT(inputSize);
+			UNUSED_ARGUMENT(buffer);
+			UNUSED_ARGUMENT(bufferSize);
+			return (-1);
+	}
+
+	return (0);
+}
+
+/**
+ * Compressed file counterpart of readUntilDone(): fill the given buffer with
+ * decoded data, reading compressed data from the file as needed.
+ *
+ * @return number of bytes put into buffer, less than bufferSize only at the end
+ * of the file (0 when nothing is left), -1 on read or decoding error (errno set).
+ */
+static ssize_t streamDecoderRead(inputCommonState state, uint8_t *buffer, size_t bufferSize) {
+	struct input_common_stream_decoder_data *decoder = &state->streamDecoder;
+
+	size_t decoded = 0;
+
+	while (decoded < bufferSize) {
+		if ((decoder->readAheadPosition == decoder->readAheadUsed) && !decoder->inputEnd) {
+			if (!streamDecoderFill(state)) {
+				return (-1);
+			}
+		}
+
+		if ((decoder->readAheadPosition == decoder->readAheadUsed) && decoder->inputEnd) {
+			if (decoder->frameOpen) {
+				caerModuleLog(state->parentModule, CAER_LOG_WARNING, "Compressed input file is truncated.");
+				decoder->frameOpen = false;
+			}
+
+			break;
+		}
+
+		size_t consumed = 0;
+		size_t produced = 0;
+
+		if (streamDecoderDecode(state, &consumed, buffer + decoded, bufferSize - decoded, &produced) < 0) {
+			errno = EIO;
+			return (-1);
+		}
+
+		decoder->readAheadPosition += consumed;
+		decoded += produced;
+
+		// Decoder needs more data than what is left in the read-ahead buffer.
+		if ((consumed == 0) && (produced == 0)) {
+			if (decoder->inputEnd) {
+				caerModuleLog(state->parentModule, CAER_LOG_WARNING, "Compressed input file is truncated.");
+				decoder->readAheadPosition = decoder->readAheadUsed;
+				decoder->frameOpen         = false;
+				break;
+			}
+
+			if (!streamDecoderFill(state)) {
+				return (-1);
+			}
+		}
+	}
+
+	return ((ssize_t) decoded);
+}
+
+#if !defined(OS_WINDOWS)
+/**
+ * Read N bytes starting at the given file offset, without moving the
+ * file position, so that it doesn't interfere with other readers.
+ *
+ * @return N if all bytes were read, a smaller value if EOF is reached, -1 on error.
+ */
+static ssize_t indexReadAt(int fd, uint8_t *buffer, size_t bytesToRead, size_t offset) {
+	size_t curRead = 0;
+
+	while (curRead < bytesToRead) {
+		ssize_t readResult = pread(fd, buffer + curRead, bytesToRead - curRead, (off_t)(offset + curRead));
+		if (readResult < 0) {
+			// Error. Sets errno.
+			return (-1);
+		}
+		else if (readResult == 0) {
+			// End-of-file.
+			break;
+		}
+
+		curRead += (size_t) readResult;
+	}
+
+	return ((ssize_t) curRead);
+}
+
+static inline void indexPutU16(uint8_t *buffer, uint16_t value) {
+	value = htole16(value);
+	memcpy(buffer, &value, sizeof(value));
+}
+
+static inline void indexPutU32(uint8_t *buffer, uint32_t value) {
+	value = htole32(value);
+	memcpy(buffer, &value, sizeof(value));
+}
+
+static inline void indexPutU64(uint8_t *buffer, uint64_t value) {
+	value = htole64(value);
+	memcpy(buffer, &value, sizeof(value));
+}
+
+static inline uint16_t indexGetU16(const uint8_t *buffer) {
+	uint16_t value;
+	memcpy(&value, buffer, sizeof(value));
+	return (le16toh(value));
+}
+
+static inline uint32_t indexGetU32(const uint8_t *buffer) {
+	uint32_t value;
+	memcpy(&value, buffer, sizeof(value));
+	return (le32toh(value));
+}
+
+static inline uint64_t indexGetU64(const uint8_t *buffer) {
+	uint64_t value;
+	memcpy(&value, buffer, sizeof(value));
+	return (le64toh(value));
+}
+
+static void indexEncodeHeader(inputCommonState state, const struct stat *fileStat, size_t entries, uint8_t *buffer) {
+	memcpy(buffer, INDEX_FILE_MAGIC, 8);
+	indexPutU32(buffer + 8, INDEX_FILE_VERSION);
+	indexPutU16(buffer + 12, U16T(state->header.sourceID));
+	indexPutU16(buffer + 14, 0); // Reserved.
+	indexPutU64(buffer + 16, U64T(fileStat->st_size));
+	indexPutU64(buffer + 24, U64T(fileStat->st_mtime));
+	indexPutU64(buffer + 32, atomic_load(&state->index.dataStart));
+	indexPutU64(buffer + 40, entries);
+}
+
+static void indexEncodeEntry(const struct input_index_entry *entry, uint8_t *buffer) {
+	indexPutU64(buffer, entry->offset);
+	indexPutU64(buffer + 8, U64T(entry->startTimestamp));
+	indexPutU64(buffer + 16, U64T(entry->endTimestamp));
+	indexPutU32(buffer + 24, U32T(entry->eventNumber));
+	indexPutU32(buffer + 28, U32T(entry->epoch));
+	indexPutU16(buffer + 32, U16T(entry->eventType));
+	indexPutU16(buffer + 34, U16T(entry->eventSource));
+}
+
+static void indexDecodeEntry(const uint8_t *buffer, struct input_index_entry *entry) {
+	entry->offset         = indexGetU64(buffer);
+	entry->startTimestamp = I64T(indexGetU64(buffer + 8));
+	entry->endTimestamp   = I64T(indexGetU64(buffer + 16));
+	entry->eventNumber    = I32T(indexGetU32(buffer + 24));
+	entry->epoch          = I32T(indexGetU32(buffer + 28));
+	entry->eventType      = I16T(indexGetU16(buffer + 32));
+	entry->eventSource    = I16T(indexGetU16(buffer + 34));
+}
+
+static bool indexAppend(inputCommonState state, const struct input_index_entry *entry) {
+	mtx_lock(&state->index.lock);
+
+	if (state->index.entriesSize == state->index.entriesCapacity) {
+		size_t newCapacity = (state->index.entriesCapacity == 0) ? (1024) : (state->index.entriesCapacity * 2);
+
+		struct input_index_entry *newEntries
+			= realloc(state->index.entries, newCapacity * sizeof(struct input_index_entry));
+		if (newEntries == NULL) {
+			mtx_unlock(&state->index.lock);
+			return (false);
+		}
+
+		state->index.entries         = newEntries;
+		state->index.entriesCapacity = newCapacity;
+	}
+
+	struct input_index_entry *newEntry = &state->index.entries[state->index.entriesSize];
+	*newEntry                          = *entry;
+
+	// Keep the running maximum of end timestamps inside an epoch, that one
+	// is monotonic even if packets of different types overlap in time.
+	newEntry->maxEndTimestamp = entry->endTimestamp;
+
+	if (state->index.entriesSize > 0) {
+		const struct input_index_entry *prevEntry = &state->index.entries[state->index.entriesSize - 1];
+
+		if ((prevEntry->epoch == entry->epoch) && (prevEntry->maxEndTimestamp > entry->endTimestamp)) {
+			newEntry->maxEndTimestamp = prevEntry->maxEndTimestamp;
+		}
+	}
+
+	state->index.entriesSize++;
+
+	mtx_unlock(&state->index.lock);
+
+	return (true);
+}
+
+static bool indexLoad(inputCommonState state) {
+	int indexFd = open(state->index.indexFilePath, O_RDONLY);
+	if (indexFd < 0) {
+		// No index saved yet.
+		return (false);
+	}
+
+	struct stat fileStat;
+	if (fstat(state->index.fileDescriptor, &fileStat) != 0) {
+		close(indexFd);
+		return (false);
+	}
+
+	// The header must match the input file exactly, else it changed since indexing.
+	uint8_t expectedHeader[INDEX_FILE_HEADER_SIZE];
+	uint8_t header[INDEX_FILE_HEADER_SIZE];
+
+	if (readUntilDone(indexFd, header, INDEX_FILE_HEADER_SIZE) != INDEX_FILE_HEADER_SIZE) {
+		close(indexFd);
+		caerModuleLog(state->parentModule, CAER_LOG_INFO, "Packet index file '%s' is invalid, rebuilding it.",
+			state->index.indexFilePath);
+		return (false);
+	}
+
+	size_t numEntries = (size_t) indexGetU64(header + 40);
+	indexEncodeHeader(state, &fileStat, numEntries, expectedHeader);
+
+	if (memcmp(header, expectedHeader, INDEX_FILE_HEADER_SIZE) != 0) {
+		close(indexFd);
+		caerModuleLog(state->parentModule, CAER_LOG_INFO, "Packet index file '%s' is outdated, rebuilding it.",
+			state->index.indexFilePath);
+		return (false);
+	}
+
+	uint8_t entriesBuffer[INDEX_FILE_ENTRY_SIZE * 256];
+	size_t entriesRead = 0;
+
+	while (entriesRead < numEntries) {
+		size_t chunkEntries = numEntries - entriesRead;
+		if (chunkEntries > 256) {
+			chunkEntries = 256;
+		}
+
+		size_t chunkSize = chunkEntries * INDEX_FILE_ENTRY_SIZE;
+
+		if (readUntilDone(indexFd, entriesBuffer, chunkSize) != (ssize_t) chunkSize) {
+			break;
+		}
+
+		for (size_t i = 0; i < chunkEntries; i++) {
+			struct input_index_entry entry;
+			indexDecodeEntry(entriesBuffer + (i * INDEX_FILE_ENTRY_SIZE), &entry);
+
+			if (!indexAppend(state, &entry)) {
+				break;
+			}
+		}
+
+		entriesRead += chunkEntries;
+	}
+
+	close(indexFd);
+
+	if (state->index.entriesSize != numEntries) {
+		// Truncated file or out of memory, start over.
+		mtx_lock(&state->index.lock);
+		state->index.entriesSize = 0;
+		mtx_unlock(&state->index.lock);
+
+		caerModuleLog(state->parentModule, CAER_LOG_INFO, "Failed to load packet index file '%s', rebuilding it.",
+			state->index.indexFilePath);
+		return (false);
+	}
+
+	return (true);
+}
+
+static void indexSave(inputCommonState state) {
+	struct stat fileStat;
+	if (fstat(state->index.fileDescriptor, &fileStat) != 0) {
+		return;
+	}
+
+	// Write to a temporary file first and then rename it, so that the index
+	// file is either complete or not there at all.
+	size_t tmpPathLength = strlen(state->index.indexFilePath) + 4;
+	char tmpPath[tmpPathLength + 1]; // +1 for NUL character.
+	snprintf(tmpPath, tmpPathLength + 1, "%s.tmp", state->index.indexFilePath);
+
+	int indexFd = open(tmpPath, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+	if (indexFd < 0) {
+		caerModuleLog(state->parentModule, CAER_LOG_NOTICE,
+			"Could not create packet index file '%s', index is only kept in memory. Error: %d.",
+			state->index.indexFilePath, errno);
+		return;
+	}
+
+	// Only the indexer thread adds entries, and it's the one saving, so no lock needed.
+	uint8_t header[INDEX_FILE_HEADER_SIZE];
+	indexEncodeHeader(state, &fileStat, state->index.entriesSize, header);
+
+	bool success = writeUntilDone(indexFd, header, INDEX_FILE_HEADER_SIZE);
+
+	uint8_t entriesBuffer[INDEX_FILE_ENTRY_SIZE * 256];
+	size_t entriesWritten = 0;
+
+	while (success && entriesWritten < state->index.entriesSize) {
+		size_t chunkEntries = state->index.entriesSize - entriesWritten;
+		if (chunkEntries > 256) {
+			chunkEntries = 256;
+		}
+
+		for (size_t i = 0; i < chunkEntries; i++) {
+			indexEncodeEntry(&state->index.entries[entriesWritten + i], entriesBuffer + (i * INDEX_FILE_ENTRY_SIZE));
+		}
+
+		success = writeUntilDone(indexFd, entriesBuffer, chunkEntries * INDEX_FILE_ENTRY_SIZE);
+
+		entriesWritten += chunkEntries;
+	}
+
+	close(indexFd);
+
+	if (!success || rename(tmpPath, state->index.indexFilePath) != 0) {
+		unlink(tmpPath);
+
+		caerModuleLog(state->parentModule, CAER_LOG_NOTICE,
+			"Could not write packet index file '%s', index is only kept in memory. Error: %d.",
+			state->index.indexFilePath, errno);
+		return;
+	}
+
+	caerModuleLog(state->parentModule, CAER_LOG_DEBUG, "Packet index written to '%s'.", state->index.indexFilePath);
+}
+
+/**
+ * Get first and last timestamp of an uncompressed packet, by reading
+ * just the two timestamps from the file.
+ */
+static bool indexPacketTimestamps(
+	inputCommonState state, caerEventPacketHeader header, size_t packetOffset, struct input_index_entry *entry) {
+	size_t eventSize     = (size_t) caerEventPacketHeaderGetEventSize(header);
+	size_t firstTSOffset = packetOffset + CAER_EVENT_PACKET_HEADER_SIZE
+						   + (size_t) caerEventPacketHeaderGetEventTSOffset(header);
+	size_t lastTSOffset = firstTSOffset + ((size_t)(entry->eventNumber - 1) * eventSize);
+
+	uint32_t firstTS, lastTS;
+
+	if ((indexReadAt(state->index.fileDescriptor, (uint8_t *) &firstTS, sizeof(firstTS), firstTSOffset)
+			!= (ssize_t) sizeof(firstTS))
+		|| (indexReadAt(state->index.fileDescriptor, (uint8_t *) &lastTS, sizeof(lastTS), lastTSOffset)
+			   != (ssize_t) sizeof(lastTS))) {
+		return (false);
+	}
+
+	// Same as caerGenericEventGetTimestamp64(), TS overflow is in the header.
+	uint64_t tsOverflow = U64T(caerEventPacketHeaderGetEventTSOverflow(header)) << TS_OVERFLOW_SHIFT;
+
+	entry->startTimestamp = I64T(tsOverflow | U64T(le32toh(firstTS)));
+	entry->endTimestamp   = I64T(tsOverflow | U64T(le32toh(lastTS)));
+
+	return (true);
+}
+
+/**
+ * Get first and last timestamp of a compressed or special event packet.
+ * Those have to be read fully: compressed data has to be decoded first,
+ * and special events are checked for timestamp resets.
+ */
+static bool indexPacketTimestampsFull(inputCommonState state, const uint8_t *headerBuffer, size_t packetOffset,
+	size_t packetDataSize, struct input_index_entry *entry, bool *tsReset) {
+	caerEventPacketHeader header = (caerEventPacketHeader) headerBuffer;
+	bool isCompressed            = (caerEventPacketHeaderGetEventType(header) & 0x8000);
+	size_t eventSize             = (size_t) caerEventPacketHeaderGetEventSize(header);
+
+	caerEventPacketHeader packet
+		= malloc(CAER_EVENT_PACKET_HEADER_SIZE + ((size_t) entry->eventNumber * eventSize));
+	if (packet == NULL) {
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to allocate memory for event packet to index.");
+		return (false);
+	}
+
+	memcpy(packet, headerBuffer, CAER_EVENT_PACKET_HEADER_SIZE);
+
+	if (indexReadAt(state->index.fileDescriptor, ((uint8_t *) packet) + CAER_EVENT_PACKET_HEADER_SIZE, packetDataSize,
+			packetOffset + CAER_EVENT_PACKET_HEADER_SIZE)
+		!= (ssize_t) packetDataSize) {
+		free(packet);
+		return (false);
+	}
+
+	// Restore in-memory layout and decompress, like the reader does.
+	if (isCompressed) {
+		packet->eventType     = htole16(le16toh(packet->eventType) & I16T(0x7FFF));
+		packet->eventCapacity = htole32(entry->eventNumber);
+
+		if (!decompressEventPacket(state, packet, CAER_EVENT_PACKET_HEADER_SIZE + packetDataSize)) {
+			free(packet);
+
+			caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to decompress event packet to index.");
+			return (false);
+		}
+	}
+
+	const void *firstEvent = caerGenericEventGetEvent(packet, 0);
+	entry->startTimestamp  = caerGenericEventGetTimestamp64(firstEvent, packet);
+
+	const void *lastEvent = caerGenericEventGetEvent(packet, entry->eventNumber - 1);
+	entry->endTimestamp   = caerGenericEventGetTimestamp64(lastEvent, packet);
+
+	if ((entry->eventType == SPECIAL_EVENT)
+		&& (caerSpecialEventPacketFindValidEventByType((caerSpecialEventPacket) packet, TIMESTAMP_RESET) != NULL)) {
+		*tsReset = true;
+	}
+
+	free(packet);
+
+	return (true);
+}
+
+/**
+ * Index all packets of the input file, or load the index saved from
+ * an earlier run. This works on its own file descriptor, independent of
+ * playback, and reads only packet headers and timestamps where possible.
+ */
+static int inputIndexerThread(void *stateArg) {
+	inputCommonState state = stateArg;
+
+	// Set thread name.
+	size_t threadNameLength = strlen(state->parentModule->moduleSubSystemString);
+	char threadName[threadNameLength + 1 + 9]; // +1 for NUL character.
+	strcpy(threadName, state->parentModule->moduleSubSystemString);
+	strcat(threadName, "[Indexer]");
+	portable_thread_set_name(threadName);
+
+	// Packets start right after the file header, wait for the reader to get there.
+	size_t offset;
+
+	while ((offset = atomic_load(&state->index.dataStart)) == 0) {
+		if (!atomic_load_explicit(&state->running, memory_order_relaxed)) {
+			return (thrd_success);
+		}
+
+		// Sleep until the reader signals it, or until woken up to stop.
+		caerQueueGetWait(state->index.dataStartSignal, INOUT_QUEUE_WAIT_TIME);
+	}
+
+	bool loaded    = indexLoad(state);
+	bool completed = loaded;
+
+	// Timestamp epoch: incremented after each packet containing a timestamp reset.
+	int32_t epoch = 0;
+	uint8_t headerBuffer[CAER_EVENT_PACKET_HEADER_SIZE];
+
+	while (!completed && atomic_load_explicit(&state->running, memory_order_relaxed)) {
+		ssize_t result = indexReadAt(state->index.fileDescriptor, headerBuffer, CAER_EVENT_PACKET_HEADER_SIZE, offset);
+		if (result < 0) {
+			caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Error while indexing file, error: %d.", errno);
+			break;
+		}
+		else if (result < CAER_EVENT_PACKET_HEADER_SIZE) {
+			// End of file. A truncated last packet can't be played back anyway.
+			completed = true;
+			break;
+		}
+
+		caerEventPacketHeader header = (caerEventPacketHeader) headerBuffer;
+
+		int16_t eventType     = caerEventPacketHeaderGetEventType(header);
+		bool isCompressed     = (eventType & 0x8000);
+		int16_t eventSource   = caerEventPacketHeaderGetEventSource(header);
+		int32_t eventCapacity = caerEventPacketHeaderGetEventCapacity(header);
+		int32_t eventNumber   = caerEventPacketHeaderGetEventNumber(header);
+		int32_t eventSize     = caerEventPacketHeaderGetEventSize(header);
+
+		// If packet is compressed, eventCapacity carries the size in bytes.
+		size_t packetOffset   = offset;
+		size_t packetDataSize = (isCompressed) ? (size_t)(eventCapacity) : (size_t)(eventNumber * eventSize);
+
+		offset += CAER_EVENT_PACKET_HEADER_SIZE + packetDataSize;
+
+		// The reader skips packets from other sources, and empty packets have no
+		// timestamps to seek to, so leave them out.
+		if ((eventSource != state->header.sourceID) || (eventNumber <= 0) || (eventSize <= 0)) {
+			continue;
+		}
+
+		struct input_index_entry entry;
+		entry.offset      = packetOffset;
+		entry.eventNumber = eventNumber;
+		entry.epoch       = epoch;
+		entry.eventType   = I16T(eventType & 0x7FFF);
+		entry.eventSource = eventSource;
+
+		bool tsReset = false;
+		bool success;
+
+		if (isCompressed || (entry.eventType == SPECIAL_EVENT)) {
+			success = indexPacketTimestampsFull(state, headerBuffer, packetOffset, packetDataSize, &entry, &tsReset);
+		}
+		else {
+			success = indexPacketTimestamps(state, header, packetOffset, &entry);
+		}
+
+		if (!success) {
+			caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+				"Failed to index packet at offset %zu, seeking is limited to the part before it.", packetOffset);
+			break;
+		}
+
+		if (!indexAppend(state, &entry)) {
+			caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+				"Failed to allocate memory for packet index, seeking is limited to the part indexed so far.");
+			break;
+		}
+
+		// Following packets belong to a new timeline.
+		if (tsReset) {
+			epoch++;
+		}
+	}
+
+	if (completed) {
+		if (!loaded) {
+			indexSave(state);
+		}
+
+		atomic_store(&state->index.ready, true);
+		sshsNodeUpdateReadOnlyAttribute(state->parentModule->moduleNode, "indexReady", SSHS_BOOL,
+			(union sshs_node_attr_value){.boolean = true});
+
+		caerModuleLog(state->parentModule, CAER_LOG_INFO, "Packet index ready with %zu packets, seeking fully enabled.",
+			state->index.entriesSize);
+	}
+
+	return (thrd_success);
+}
+#endif
+
+static void indexInit(inputCommonState state) {
+	state->index.fileDescriptor = -1;
+
+	mtx_init(&state->index.lock, mtx_plain);
+	mtx_init(&state->seek.lock, mtx_plain);
+
+	if (state->isNetworkStream) {
+		return;
+	}
+
+#if !defined(OS_WINDOWS)
+	// File offsets of packets are only known after decoding.
+	if (state->streamDecoder.format != STREAM_UNCOMPRESSED) {
+		caerModuleLog(state->parentModule, CAER_LOG_INFO, "Seeking is not supported for compressed files.");
+		return;
+	}
+
+	// Only AEDAT 3.1 files are indexed, older formats need conversion while reading.
+	if (state->header.majorVersion != 3 || state->header.minorVersion != 1) {
+		caerModuleLog(state->parentModule, CAER_LOG_INFO, "Seeking is only supported for AEDAT 3.1 files.");
+		return;
+	}
+
+	if (!sshsNodeAttributeExists(state->parentModule->moduleNode, "filePath", SSHS_STRING)) {
+		return;
+	}
+
+	char *filePath = sshsNodeGetString(state->parentModule->moduleNode, "filePath");
+
+	// Own file descriptor: the reader moves its one around, and closes it on EOF.
+	state->index.fileDescriptor = open(filePath, O_RDONLY);
+	if (state->index.fileDescriptor < 0) {
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+			"Could not open input file '%s' for indexing, seeking disabled. Error: %d.", filePath, errno);
+		free(filePath);
+		return;
+	}
+
+	size_t filePathLength      = strlen(filePath);
+	state->index.indexFilePath = malloc(filePathLength + strlen(INDEX_FILE_SUFFIX) + 1);
+	if (state->index.indexFilePath == NULL) {
+		free(filePath);
+		close(state->index.fileDescriptor);
+		state->index.fileDescriptor = -1;
+
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to allocate memory for index file path.");
+		return;
+	}
+
+	strcpy(state->index.indexFilePath, filePath);
+	strcat(state->index.indexFilePath, INDEX_FILE_SUFFIX);
+	free(filePath);
+
+	if (thrd_create(&state->index.indexerThread, &inputIndexerThread, state) != thrd_success) {
+		free(state->index.indexFilePath);
+		state->index.indexFilePath = NULL;
+		close(state->index.fileDescriptor);
+		state->index.fileDescriptor = -1;
+
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to start input indexer thread, seeking disabled.");
+		return;
+	}
+
+	state->index.indexerRunning = true;
+#else
+	caerModuleLog(state->parentModule, CAER_LOG_INFO, "Seeking not supported on this platform.");
+#endif
+}
+
+// Must be called after the input threads have been told to stop (running = false).
+static void indexExit(inputCommonState state) {
+	if (state->index.indexerRunning) {
+		if ((errno = thrd_join(state->index.indexerThread, NULL)) != thrd_success) {
+			// This should never happen!
+			caerModuleLog(
+				state->parentModule, CAER_LOG_CRITICAL, "Failed to join input indexer thread. Error: %d.", errno);
+		}
+
+		state->index.indexerRunning = false;
+	}
+
+	if (state->index.fileDescriptor >= 0) {
+		close(state->index.fileDescriptor);
+		state->index.fileDescriptor = -1;
+	}
+
+	free(state->index.indexFilePath);
+	state->index.indexFilePath = NULL;
+
+	free(state->index.entries);
+	state->index.entries = NULL;
+
+	mtx_destroy(&state->index.lock);
+	mtx_destroy(&state->seek.lock);
+}
+
+// Get the end of the epoch the entry at 'begin' belongs to. Index lock must be held.
+static size_t indexEpochEnd(inputCommonState state, size_t begin) {
+	int32_t epoch = state->index.entries[begin].epoch;
+	size_t end    = state->index.entriesSize;
+
+	while (begin < end) {
+		size_t middle = begin + ((end - begin) / 2);
+
+		if (state->index.entries[middle].epoch <= epoch) {
+			begin = middle + 1;
+		}
+		else {
+			end = middle;
+		}
+	}
+
+	return (begin);
+}
+
+// Get the first packet in [begin, end) holding events at or after timestamp.
+// Index lock must be held.
+static size_t indexFindTimestamp(inputCommonState state, size_t begin, size_t end, int64_t timestamp) {
+	while (begin < end) {
+		size_t middle = begin + ((end - begin) / 2);
+
+		if (state->index.entries[middle].maxEndTimestamp < timestamp) {
+			begin = middle + 1;
+		}
+		else {
+			end = middle;
+		}
+	}
+
+	return (begin);
+}
+
+/**
+ * Resolve a seek target via the packet index and pass it on to the
+ * reader and assembler threads.
+ *
+ * @param state common input data structure.
+ * @param timestamp timestamp to seek to (first matching one if it appears
+ * in multiple epochs, due to timestamp resets), or -1 to use fraction.
+ * @param fraction position in the total playback time to seek to [0, 1].
+ */
+static void inputSeek(inputCommonState state, int64_t timestamp, double fraction) {
+	// The loop replay store must hold the file exactly once, from start to end.
+	if (state->replay.enabled) {
+		caerModuleLog(state->parentModule, CAER_LOG_WARNING, "Cannot seek while loop replay is enabled.");
+		return;
+	}
+
+	mtx_lock(&state->index.lock);
+
+	size_t numEntries = state->index.entriesSize;
+	size_t target     = numEntries;
+
+	if (timestamp < 0) {
+		// Total playback time is only known once the whole file is indexed.
+		if (!atomic_load(&state->index.ready)) {
+			mtx_unlock(&state->index.lock);
+
+			caerModuleLog(state->parentModule, CAER_LOG_WARNING, "Cannot seek yet, file is still being indexed.");
+			return;
+		}
+
+		// Timestamps restart on resets, so add up each epoch's duration.
+		int64_t duration = 0;
+
+		for (size_t begin = 0, end; begin < numEntries; begin = end) {
+			end = indexEpochEnd(state, begin);
+			duration += state->index.entries[end - 1].maxEndTimestamp - state->index.entries[begin].startTimestamp;
+		}
+
+		int64_t remaining = I64T(fraction * (double) duration);
+
+		for (size_t begin = 0, end; begin < numEntries; begin = end) {
+			end = indexEpochEnd(state, begin);
+
+			int64_t epochDuration
+				= state->index.entries[end - 1].maxEndTimestamp - state->index.entries[begin].startTimestamp;
+
+			if (remaining <= epochDuration) {
+				timestamp = state->index.entries[begin].startTimestamp + remaining;
+				target    = indexFindTimestamp(state, begin, end, timestamp);
+				break;
+			}
+
+			remaining -= epochDuration;
+		}
+	}
+	else {
+		for (size_t begin = 0, end; begin < numEntries; begin = end) {
+			end = indexEpochEnd(state, begin);
+
+			if (state->index.entries[end - 1].maxEndTimestamp >= timestamp) {
+				target = indexFindTimestamp(state, begin, end, timestamp);
+				break;
+			}
+		}
+	}
+
+	if (target == numEntries) {
+		mtx_unlock(&state->index.lock);
+
+		if (atomic_load(&state->index.ready)) {
+			caerModuleLog(state->parentModule, CAER_LOG_WARNING,
+				"Cannot seek to timestamp %" PRIi64 ", it is not in the file.", timestamp);
+		}
+		else {
+			caerModuleLog(state->parentModule, CAER_LOG_WARNING,
+				"Cannot seek to timestamp %" PRIi64 ", it is not indexed yet.", timestamp);
+		}
+		return;
+	}
+
+	size_t offset = state->index.entries[target].offset;
+
+	mtx_unlock(&state->index.lock);
+
+	mtx_lock(&state->seek.lock);
+
+	state->seek.offset    = offset;
+	state->seek.timestamp = timestamp;
+
+	// Assembler first, so it's already dropping stale packets when the reader moves.
+	atomic_store(&state->seek.assemblerRequest, true);
+	atomic_store(&state->seek.readerRequest, true);
+
+	mtx_unlock(&state->seek.lock);
+
+	caerModuleLog(state->parentModule, CAER_LOG_INFO, "Seeking to timestamp %" PRIi64 " (file offset %zu).",
+		timestamp, offset);
+}
+
+// Reader thread: move to the requested packet and tell the assembler thread.
+static void inputReaderSeek(inputCommonState state) {
+	mtx_lock(&state->seek.lock);
+
+	size_t offset = state->seek.offset;
+	atomic_store(&state->seek.readerRequest, false);
+
+	mtx_unlock(&state->seek.lock);
+
+	// Drop any partially read packet, parsing restarts at a packet boundary.
+	free(state->packets.currPacket);
+	state->packets.currPacket = NULL;
+	free(state->packets.currPacketData);
+	state->packets.currPacketData = NULL;
+
+	state->packets.currPacketHeaderSize = 0;
+	state->packets.skipSize             = 0;
+
+	if (state->mmap.enabled) {
+#if !defined(OS_WINDOWS)
+		// Mappings must start at a page boundary, skip the bytes up to the packet.
+		size_t pageSize = (size_t) sysconf(_SC_PAGESIZE);
+
+		mmapInputClose(state);
+
+		state->mmap.nextOffset  = offset - (offset % pageSize);
+		state->packets.skipSize = offset - state->mmap.nextOffset;
+		state->dataBufferOffset = state->mmap.nextOffset;
+#endif
+	}
+	else {
+		if (lseek(state->fileDescriptor, (off_t) offset, SEEK_SET) == (off_t) -1) {
+			caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to seek in input file. Error: %d.", errno);
+		}
+
+		state->dataBufferOffset = offset;
+	}
+
+	// Packets still being decompressed must come before the marker. If one failed,
+	// parsing the next data will fail on it too, nothing to do here.
+	decompressPoolForward(state, 0);
+
+	// All packets after the marker come from the new position.
+	while (!caerQueuePutWait(state->transferRingPackets, SEEK_MARKER, INOUT_QUEUE_WAIT_TIME)) {
+		if (!atomic_load_explicit(&state->running, memory_order_relaxed)) {
+			return;
+		}
+	}
+}
+
+// Assembler thread: the reader moved, restart assembling on a new timeline.
+static bool inputAssemblerSeek(inputCommonState state) {
+	// Drop what was merged so far, it's from before the seek.
+	struct input_common_pending_packet *pending = NULL;
+	while ((pending = (struct input_common_pending_packet *) utarray_next(state->packetContainer.eventPackets, pending))
+		   != NULL) {
+		free(pending->memory);
+	}
+
+	utarray_clear(state->packetContainer.eventPackets);
+
+	state->packetContainer.sizeLimitHit       = false;
+	state->packetContainer.sizeLimitTimestamp = INT32_MAX;
+
+	// Playback continues somewhere else in time, pace from there.
+	atomic_store(&state->pacing.reset, true);
+
+	mtx_lock(&state->seek.lock);
+
+	state->seek.skipUntilTimestamp = state->seek.timestamp;
+
+	// If another seek came in meanwhile, keep dropping packets until its marker.
+	if (!atomic_load(&state->seek.readerRequest)) {
+		atomic_store(&state->seek.assemblerRequest, false);
+	}
+
+	mtx_unlock(&state->seek.lock);
+
+	// Timestamps jump, so tell downstream modules just like on a timestamp reset.
+	return (handleTSReset(state));
+}
+
+static bool parseNetworkHeader(inputCommonState state) {
+	// Network header is 20 bytes long. Use struct to interpret.
+	struct aedat3_network_header networkHeader = caerParseNetworkHeader(state->dataView.buffer);
+	state->dataView.bufferPosition += AEDAT3_NETWORK_HEADER_LENGTH;
+
+	// Check header values.
+	if (networkHeader.magicNumber != AEDAT3_NETWORK_MAGIC_NUMBER) {
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "AEDAT 3.X magic number not found. Invalid network stream.");
+		return (false);
+	}
+
+	state->header.isAEDAT3     = true;
+	state->header.majorVersion = 3;
+
+	if (state->isNetworkMessageBased) {
+		// For message based streams, use the sequence number. Missing messages
+		// were already taken care of while reassembling the event packets.
+		state->header.networkSequenceNumber = networkHeader.sequenceNumber;
+	}
+	else {
+		// For stream based transports, this is always zero.
+		if (networkHeader.sequenceNumber != 0) {
+			caerModuleLog(state->parentModule, CAER_LOG_ERROR, "SequenceNumber is not zero. Invalid network stream.");
+			return (false);
+		}
+	}
+
+	if (networkHeader.versionNumber != AEDAT3_NETWORK_VERSION) {
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Unsupported AEDAT version. Invalid network stream.");
+		return (false);
+	}
+
+	state->header.minorVersion = networkHeader.versionNumber;
+
+	// All formats are supported.
+	state->header.formatID = networkHeader.formatNumber;
+
+	// TODO: Network: get sourceInfo node info via config-server side-channel.
+	state->header.sourceID = networkHeader.sourceID;
+
+	sshsNodeCreateShort(state->sourceInfoNode, "polaritySizeX", 240, 1, INT16_MAX,
+		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Polarity events width.");
+	sshsNodeCreateShort(state->sourceInfoNode, "polaritySizeY", 180, 1, INT16_MAX,
+		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Polarity events height.");
+	sshsNodeCreateShort(state->sourceInfoNode, "frameSizeX", 240, 1, INT16_MAX,
+		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Frame events width.");
+	sshsNodeCreateShort(state->sourceInfoNode, "frameSizeY", 180, 1, INT16_MAX,
+		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Frame events height.");
+	sshsNodeCreateShort(state->sourceInfoNode, "dataSizeX", 240, 1, INT16_MAX,
+		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Data width.");
+	sshsNodeCreateShort(state->sourceInfoNode, "dataSizeY", 180, 1, INT16_MAX,
+		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Data height.");
+	sshsNodeCreateShort(state->sourceInfoNode, "visualizerSizeX", 240, 1, INT16_MAX,
+		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Visualization width.");
+	sshsNodeCreateShort(state->sourceInfoNode, "visualizerSizeY", 180, 1, INT16_MAX,
+		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Visualization height.");
+
+	// TODO: Network: add sourceString.
+
+	// We're done!
+	atomic_store(&state->header.isValidHeader, true);
+
+	return (true);
+}
+
+static char *getFileHeaderLine(inputCommonState state) {
+	struct input_common_data_view *buf = &state->dataView;
+
+	if ((buf->bufferPosition < buf->bufferUsedSize) && (buf->buffer[buf->bufferPosition] == '#')) {
+		size_t headerLinePos = 0;
+		char *headerLine     = malloc(MAX_HEADER_LINE_SIZE);
+		if (headerLine == NULL) {
+			// Failed to allocate memory.
+			return (NULL);
+		}
+
+		headerLine[headerLinePos++] = '#';
+		buf->bufferPosition++;
+
+		while (buf->buffer[buf->bufferPosition] != '\n') {
+			if ((headerLinePos >= (MAX_HEADER_LINE_SIZE - 2)) // -1 for terminating new-line, -1 for end NUL char.
+				|| ((buf->bufferPosition + 1) >= buf->bufferUsedSize)) {
+				// Overlong header line or end of data, refuse it.
+				free(headerLine);
+				return (NULL);
+			}
+
+			headerLine[headerLinePos++] = (char) buf->buffer[buf->bufferPosition];
+			buf->bufferPosition++;
+		}
+
+		// Found terminating new-line character.
+		headerLine[headerLinePos++] = '\n';
+		buf->bufferPosition++;
+
+		// Now let's just verify that the previous character was indeed a carriage-return.
+		if (headerLine[headerLinePos - 2] == '\r') {
+			// Valid, terminate it and return it.
+			headerLine[headerLinePos] = '\0';
+
+			return (headerLine);
+		}
+		else {
+			// Invalid header line. No Windows line-ending.
+			free(headerLine);
+			return (NULL);
+		}
+	}
+
+	// Invalid header line. Doesn't begin with #.
+	return (NULL);
+}
+
+static void parseSourceString(char *sourceString, inputCommonState state) {
+	// Create SourceInfo node.
+	int16_t dvsSizeX = 0, dvsSizeY = 0;
+	int16_t apsSizeX = 0, apsSizeY = 0;
+	int16_t dataSizeX = 0, dataSizeY = 0;
+	int16_t visualizerSizeX = 0, visualizerSizeY = 0;
+
+	// Determine sizes via known chip information.
+	if (caerStrEquals(sourceString, "DVS128")) {
+		dvsSizeX = dvsSizeY = 128;
+	}
+	else if (caerStrEquals(sourceString, "DAVIS240A") || caerStrEquals(sourceString, "DAVIS240B")
+			 || caerStrEquals(sourceString, "DAVIS240C")) {
+		dvsSizeX = apsSizeX = 240;
+		dvsSizeY = apsSizeY = 180;
+	}
+	else if (caerStrEquals(sourceString, "DAVIS128")) {
+		dvsSizeX = apsSizeX = dvsSizeY = apsSizeY = 128;
+	}
+	else if (caerStrEquals(sourceString, "DAVIS346A") || caerStrEquals(sourceString, "DAVIS346B")
+			 || caerStrEquals(sourceString, "DAVIS346Cbsi") || caerStrEquals(sourceString, "DAVIS346")
+			 || caerStrEquals(sourceString, "DAVIS346bsi")) {
+		dvsSizeX = apsSizeX = 346;
+		dvsSizeY = apsSizeY = 260;
+	}
+	else if (caerStrEquals(sourceString, "DAVIS640")) {
+		dvsSizeX = apsSizeX = 640;
+		dvsSizeY = apsSizeY = 480;
+	}
+	else if (caerStrEquals(sourceString, "DAVISHet640") || caerStrEquals(sourceString, "DAVIS640het")) {
+		dvsSizeX = 320;
+		dvsSizeY = 240;
+		apsSizeX = 640;
+		apsSizeY = 480;
+	}
+	else if (caerStrEquals(sourceString, "DAVIS208")) {
+		dvsSizeX = apsSizeX = 208;
+		dvsSizeY = apsSizeY = 192;
+	}
+	else if (caerStrEquals(sourceString, "DYNAPSE")) {
+		dataSizeX = DYNAPSE_X4BOARD_NEUX;
+		dataSizeY = DYNAPSE_X4BOARD_NEUY;
+	}
+	else if (caerStrEqualsUpTo(sourceString, "File,", 5)) {
+		sscanf(sourceString + 5,
+			"dvsSizeX=%" SCNi16 ",dvsSizeY=%" SCNi16 ",apsSizeX=%" SCNi16 ",apsSizeY=%" SCNi16 ","
+			"dataSizeX=%" SCNi16 ",dataSizeY=%" SCNi16 ",visualizerSizeX=%" SCNi16 ",visualizerSizeY=%" SCNi16 "\r\n",
+			&dvsSizeX, &dvsSizeY, &apsSizeX, &apsSizeY, &dataSizeX, &dataSizeY, &visualizerSizeX, &visualizerSizeY);
+	}
+	else if (caerStrEqualsUpTo(sourceString, "Network,", 8)) {
+		sscanf(sourceString + 8,
+			"dvsSizeX=%" SCNi16 ",dvsSizeY=%" SCNi16 ",apsSizeX=%" SCNi16 ",apsSizeY=%" SCNi16 ","
+			"dataSizeX=%" SCNi16 ",dataSizeY=%" SCNi16 ",visualizerSizeX=%" SCNi16 ",visualizerSizeY=%" SCNi16 "\r\n",
+			&dvsSizeX, &dvsSizeY, &apsSizeX, &apsSizeY, &dataSizeX, &dataSizeY, &visualizerSizeX, &visualizerSizeY);
+	}
+	else if (caerStrEqualsUpTo(sourceString, "Processor,", 10)) {
+		sscanf(sourceString + 10,
+			"dvsSizeX=%" SCNi16 ",dvsSizeY=%" SCNi16 ",apsSizeX=%" SCNi16 ",apsSizeY=%" SCNi16 ","
+			"dataSizeX=%" SCNi16 ",dataSizeY=%" SCNi16 ",visualizerSizeX=%" SCNi16 ",visualizerSizeY=%" SCNi16 "\r\n",
+			&dvsSizeX, &dvsSizeY, &apsSizeX, &apsSizeY, &dataSizeX, &dataSizeY, &visualizerSizeX, &visualizerSizeY);
+	}
+	else {
+		// Default fall-back of 640x480 (VGA).
+		caerModuleLog(state->parentModule, CAER_LOG_WARNING,
+			"Impossible to determine display sizes from Source information/string. Falling back to 640x480 (VGA).");
+		dvsSizeX = apsSizeX = 640;
+		dvsSizeY = apsSizeY = 480;
+	}
+
+	// Put size information inside sourceInfo node.
+	if (dvsSizeX != 0 && dvsSizeY != 0) {
+		sshsNodeCreateShort(state->sourceInfoNode, "polaritySizeX", dvsSizeX, 1, INT16_MAX,
+			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Polarity events width.");
+		sshsNodeCreateShort(state->sourceInfoNode, "polaritySizeY", dvsSizeY, 1, INT16_MAX,
+			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Polarity events height.");
+	}
+
+	if (apsSizeX != 0 && apsSizeY != 0) {
+		sshsNodeCreateShort(state->sourceInfoNode, "frameSizeX", apsSizeX, 1, INT16_MAX,
+			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Frame events width.");
+		sshsNodeCreateShort(state->sourceInfoNode, "frameSizeY", apsSizeY, 1, INT16_MAX,
+			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Frame events height.");
+	}
+
+	if (dataSizeX == 0 && dataSizeY == 0) {
+		// Try to auto-discover dataSize, if it was not previously set, based on the
+		// presence of DVS or APS sizes. If they don't exist either, this will be 0.
+		dataSizeX = (dvsSizeX > apsSizeX) ? (dvsSizeX) : (apsSizeX);
+		dataSizeY = (dvsSizeY > apsSizeY) ? (dvsSizeY) : (apsSizeY);
+	}
+
+	if (dataSizeX != 0 && dataSizeY != 0) {
+		sshsNodeCreateShort(state->sourceInfoNode, "dataSizeX", dataSizeX, 1, INT16_MAX,
+			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Data width.");
+		sshsNodeCreateShort(state->sourceInfoNode, "dataSizeY", dataSizeY, 1, INT16_MAX,
+			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Data height.");
+	}
+
+	if (visualizerSizeX != 0 && visualizerSizeY != 0) {
+		sshsNodeCreateShort(state->sourceInfoNode, "visualizerSizeX", visualizerSizeX, 1, INT16_MAX,
+			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Visualization width.");
+		sshsNodeCreateShort(state->sourceInfoNode, "visualizerSizeY", visualizerSizeY, 1, INT16_MAX,
+			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Visualization height.");
+	}
+
+	// Generate source string for output modules.
+	size_t sourceStringFileLength = (size_t) snprintf(NULL, 0,
+		"#Source %" PRIu16 ": File,"
+		"dvsSizeX=%" PRIi16 ",dvsSizeY=%" PRIi16 ",apsSizeX=%" PRIi16 ",apsSizeY=%" PRIi16 ","
+		"dataSizeX=%" PRIi16 ",dataSizeY=%" PRIi16 ",visualizerSizeX=%" PRIi16 ",visualizerSizeY=%" PRIi16 "\r\n"
+		"#-Source %" PRIi16 ": %s\r\n",
+		state->parentModule->moduleID, dvsSizeX, dvsSizeY, apsSizeX, apsSizeY, dataSizeX, dataSizeY, visualizerSizeX,
+		visualizerSizeY, state->header.sourceID, sourceString);
+
+	char sourceStringFile[sourceStringFileLength + 1];
+	snprintf(sourceStringFile, sourceStringFileLength + 1,
+		"#Source %" PRIu16 ": File,"
+		"dvsSizeX=%" PRIi16 ",dvsSizeY=%" PRIi16 ",apsSizeX=%" PRIi16 ",apsSizeY=%" PRIi16 ","
+		"dataSizeX=%" PRIi16 ",dataSizeY=%" PRIi16 ",visualizerSizeX=%" PRIi16 ",visualizerSizeY=%" PRIi16 "\r\n"
+		"#-Source %" PRIi16 ": %s\r\n",
+		state->parentModule->moduleID, dvsSizeX, dvsSizeY, apsSizeX, apsSizeY, dataSizeX, dataSizeY, visualizerSizeX,
+		visualizerSizeY, state->header.sourceID, sourceString);
+	sourceStringFile[sourceStringFileLength] = '\0';
+
+	sshsNodeCreateString(state->sourceInfoNode, "sourceString", sourceStringFile, 1, 2048,
+		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Device source information.");
 }
 
 static bool parseFileHeader(inputCommonState state) {
@@ -344,877 +1697,1799 @@ static bool parseFileHeader(inputCommonState state) {
 	bool sourceHeader  = false;
 	bool endHeader     = false;
 
-	while (!endHeader) {
-		char *headerLine = getFileHeaderLine(state);
-		if (headerLine == NULL) {
-			// Failed to parse header line; this is an invalid header for AEDAT 3.1!
-			// For AEDAT 2.0 and 3.0, since there is no END-HEADER, this might be
-			// the right way for headers to stop, so we consider this valid IFF we
-			// already got the version header for AEDAT 2.0, and for AEDAT 3.0 if we
-			// also got the required headers Format and Source at least.
-			if ((state->header.majorVersion == 2 && state->header.minorVersion == 0) && versionHeader) {
-				// Parsed AEDAT 2.0 header successfully (version).
-				atomic_store(&state->header.isValidHeader, true);
-				return (true);
+	while (!endHeader) {
+		char *headerLine = getFileHeaderLine(state);
+		if (headerLine == NULL) {
+			// Failed to parse header line; this is an invalid header for AEDAT 3.1!
+			// For AEDAT 2.0 and 3.0, since there is no END-HEADER, this might be
+			// the right way for headers to stop, so we consider this valid IFF we
+			// already got the version header for AEDAT 2.0, and for AEDAT 3.0 if we
+			// also got the required headers Format and Source at least.
+			if ((state->header.majorVersion == 2 && state->header.minorVersion == 0) && versionHeader) {
+				// Parsed AEDAT 2.0 header successfully (version).
+				atomic_store(&state->header.isValidHeader, true);
+				return (true);
+			}
+
+			if ((state->header.majorVersion == 3 && state->header.minorVersion == 0) && versionHeader && formatHeader
+				&& sourceHeader) {
+				// Parsed AEDAT 3.0 header successfully (version, format, source).
+				atomic_store(&state->header.isValidHeader, true);
+				return (true);
+			}
+
+			return (false);
+		}
+
+		if (!versionHeader) {
+			// First thing we expect is the version header. We don't support files not having it.
+			if (sscanf(headerLine, "#!AER-DAT%" SCNi16 ".%" SCNi8 "\r\n", &state->header.majorVersion,
+					&state->header.minorVersion)
+				== 2) {
+				versionHeader = true;
+
+				// Check valid versions.
+				switch (state->header.majorVersion) {
+					case 2:
+						// AEDAT 2.0 is supported. No revisions exist.
+						if (state->header.minorVersion != 0) {
+							goto noValidVersionHeader;
+						}
+						break;
+
+					case 3:
+						state->header.isAEDAT3 = true;
+
+						// AEDAT 3.0 and 3.1 are supported.
+						if (state->header.minorVersion != 0 && state->header.minorVersion != 1) {
+							goto noValidVersionHeader;
+						}
+						break;
+
+					default:
+						// Versions other than 2.0 and 3.X are not supported.
+						goto noValidVersionHeader;
+						break;
+				}
+
+				caerModuleLog(state->parentModule, CAER_LOG_DEBUG, "Found AEDAT%" PRIi16 ".%" PRIi8 " version header.",
+					state->header.majorVersion, state->header.minorVersion);
+			}
+			else {
+			noValidVersionHeader:
+				free(headerLine);
+
+				caerModuleLog(
+					state->parentModule, CAER_LOG_ERROR, "No compliant AEDAT version header found. Invalid file.");
+				return (false);
+			}
+		}
+		else if (state->header.isAEDAT3 && !formatHeader) {
+			// Then the format header. Only with AEDAT 3.X.
+			char formatString[1024 + 1];
+
+			if (sscanf(headerLine, "#Format: %1024s\r\n", formatString) == 1) {
+				formatHeader = true;
+
+				// Parse format string to format ID.
+				// We support either only RAW, or a mixture of the various compression modes.
+				if (caerStrEquals(formatString, "RAW")) {
+					state->header.formatID = 0x00;
+				}
+				else {
+					state->header.formatID = 0x00;
+
+					if (strstr(formatString, "SerializedTS") != NULL) {
+						state->header.formatID |= 0x01;
+					}
+
+					if (strstr(formatString, "PNGFrames") != NULL) {
+						state->header.formatID |= 0x02;
+					}
+
+					if (!state->header.formatID) {
+						// No valid format found.
+						free(headerLine);
+
+						caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+							"No compliant Format type found. Format '%s' is invalid.", formatString);
+
+						return (false);
+					}
+				}
+
+				caerModuleLog(state->parentModule, CAER_LOG_DEBUG,
+					"Found Format header with value '%s', Format ID %" PRIi8 ".", formatString, state->header.formatID);
+			}
+			else {
+				free(headerLine);
+
+				caerModuleLog(state->parentModule, CAER_LOG_ERROR, "No compliant Format header found. Invalid file.");
+				return (false);
+			}
+		}
+		else if (state->header.isAEDAT3 && !sourceHeader) {
+			// Then the source header. Only with AEDAT 3.X. We only support one active source.
+			char sourceString[1024 + 1];
+
+			if (sscanf(headerLine, "#Source %" SCNi16 ": %1024[^\r]s\n", &state->header.sourceID, sourceString) == 2) {
+				sourceHeader = true;
+
+				// Parse source string to get needed sourceInfo parameters.
+				parseSourceString(sourceString, state);
+
+				caerModuleLog(state->parentModule, CAER_LOG_DEBUG,
+					"Found Source header with value '%s', Source ID %" PRIi16 ".", sourceString,
+					state->header.sourceID);
+			}
+			else {
+				free(headerLine);
+
+				caerModuleLog(state->parentModule, CAER_LOG_ERROR, "No compliant Source header found. Invalid file.");
+				return (false);
+			}
+		}
+		else {
+			// Now we either have other header lines with AEDAT 2.0/AEDAT 3.X, or
+			// the END-HEADER with AEDAT 3.1. We check this before the other possible,
+			// because it terminates the AEDAT 3.1 header, so we stop in that case.
+			if (caerStrEquals(headerLine, "#!END-HEADER\r\n")) {
+				endHeader = true;
+
+				caerModuleLog(state->parentModule, CAER_LOG_DEBUG, "Found END-HEADER header.");
+			}
+			else {
+				// Then other headers, like Start-Time.
+				if (caerStrEqualsUpTo(headerLine, "#Start-Time: ", 13)) {
+					char startTimeString[1024 + 1];
+
+					if (sscanf(headerLine, "#Start-Time: %1024[^\r]s\n", startTimeString) == 1) {
+						caerModuleLog(
+							state->parentModule, CAER_LOG_INFO, "Recording was taken on %s.", startTimeString);
+					}
+				}
+				else if (caerStrEqualsUpTo(headerLine, "#-Source ", 9)) {
+					// Detect negative source strings (#-Source) and add them to sourceInfo.
+					// Previous sources are simply appended to the sourceString string in order.
+					char *currSourceString        = sshsNodeGetString(state->sourceInfoNode, "sourceString");
+					size_t currSourceStringLength = strlen(currSourceString);
+
+					size_t addSourceStringLength = strlen(headerLine);
+
+					char *newSourceString = realloc(currSourceString,
+						currSourceStringLength + addSourceStringLength + 1); // +1 for NUL termination.
+					if (newSourceString == NULL) {
+						// Memory reallocation failure, skip this negative source string.
+						free(currSourceString);
+					}
+					else {
+						// Concatenate negative source string and commit as new sourceString.
+						memcpy(newSourceString + currSourceStringLength, headerLine, addSourceStringLength);
+						newSourceString[currSourceStringLength + addSourceStringLength] = '\0';
+
+						sshsNodeUpdateReadOnlyAttribute(state->sourceInfoNode, "sourceString", SSHS_STRING,
+							(union sshs_node_attr_value){.string = newSourceString});
+
+						free(newSourceString);
+					}
+				}
+				else {
+					headerLine[strlen(headerLine) - 2] = '\0'; // Shorten string to avoid printing ending \r\n.
+					caerModuleLog(state->parentModule, CAER_LOG_DEBUG, "Header line: '%s'.", headerLine);
+				}
+			}
+		}
+
+		free(headerLine);
+	}
+
+	// Parsed AEDAT 3.1 header successfully.
+	atomic_store(&state->header.isValidHeader, true);
+	return (true);
+}
+
+static bool parseHeader(inputCommonState state) {
+	if (state->isNetworkStream) {
+		return (parseNetworkHeader(state));
+	}
+	else {
+		return (parseFileHeader(state));
+	}
+}
+
+static bool parseData(inputCommonState state) {
+	while (state->dataView.bufferPosition < state->dataView.bufferUsedSize) {
+		// The rest of the data is useless if we're about to seek elsewhere.
+		if (atomic_load_explicit(&state->seek.readerRequest, memory_order_relaxed)) {
+			break;
+		}
+
+		int pRes = -1;
+
+		// Try getting packet and packetData from buffer.
+		if (state->header.majorVersion == 2 && state->header.minorVersion == 0) {
+			pRes = aedat2GetPacket(state, 0);
+		}
+		else if (state->header.majorVersion == 3) {
+			pRes = aedat3GetPacket(state, (state->header.minorVersion == 0));
+		}
+		else {
+			// No parseable format found!
+			return (false);
+		}
+
+		// Check packet parser return value.
+		if (pRes < 0) {
+			// Error in parsing buffer to get packet.
+			return (false);
+		}
+		else if (pRes == 1) {
+			// Finished parsing this buffer with no new packet.
+			// Exit to get next buffer.
+			break;
+		}
+		else if (pRes == 2) {
+			// Skip requested, run again.
+			continue;
+		}
+
+		caerModuleLog(state->parentModule, CAER_LOG_DEBUG,
+			"New packet read - ID: %zu, Offset: %zu, Size: %zu, Events: %" PRIi32 ", Type: %" PRIi16
+			", StartTS: %" PRIi64 ", EndTS: %" PRIi64 ".",
+			state->packets.currPacketData->id, state->packets.currPacketData->offset,
+			state->packets.currPacketData->size, state->packets.currPacketData->eventNumber,
+			state->packets.currPacketData->eventType, state->packets.currPacketData->startTimestamp,
+			state->packets.currPacketData->endTimestamp);
+
+		// New packet information, add it to the global packet info list.
+		// This is done here to prevent ambiguity about the ownership of the involved memory block:
+		// it either is inside the global list with state->packets.currPacketData NULL, or it is not
+		// in the list, but in state->packets.currPacketData itself. So if, on exit, we clear both,
+		// we'll free all the memory and have no fear of a double-free happening.
+		packetData newPacketData = state->packets.currPacketData;
+
+		DL_APPEND(state->packets.packetsList, state->packets.currPacketData);
+		state->packets.currPacketData = NULL;
+
+		// With parallel decompression, packets go through the worker pool, which then
+		// forwards them to the input assembler thread in order. The pool owns them now.
+		if (state->decompress.workersNumber > 0) {
+			caerEventPacketHeader newPacket = state->packets.currPacket;
+			state->packets.currPacket       = NULL;
+
+			if (!decompressPoolSubmit(state, newPacket, newPacketData,
+					(state->header.majorVersion == 3 && state->header.minorVersion == 0))) {
+				return (false);
+			}
+
+			continue;
+		}
+
+		// Keep a copy for loop replay, before the assembler takes ownership.
+		replayCacheAdd(state, state->packets.currPacket);
+
+		// New packet from stream, send it off to the input assembler thread. Same memory
+		// related considerations as above for state->packets.currPacketData apply here too!
+		while (!caerQueuePutWait(state->transferRingPackets, state->packets.currPacket, INOUT_QUEUE_WAIT_TIME)) {
+			// We ensure all read packets are sent to the Assembler stage.
+			if (!atomic_load_explicit(&state->running, memory_order_relaxed)) {
+				// On normal termination, just return without errors. The Reader thread
+				// will then also exit without errors and clean up in Exit().
+				return (true);
+			}
+		}
+
+		state->packets.currPacket = NULL;
+	}
+
+	// All good, get next buffer.
+	return (true);
+}
+
+/**
+ * Parse the current buffer and try to extract the AEDAT 2.0
+ * data contained within, to form a compliant AEDAT 3.1 packet,
+ * and then update the packet meta-data list with it.
+ *
+ * @param state common input data structure.
+ * @param chipID chip identifier to decide sizes, ordering and
+ * features of the data stream for conversion to AEDAT 3.1.
+ *
+ * @return 0 on successful packet extraction.
+ * Positive numbers for special conditions:
+ * 1 if more data needed.
+ * Negative numbers on error conditions:
+ * -1 on memory allocation failure.
+ */
+static int aedat2GetPacket(inputCommonState state, int16_t chipID) {
+	UNUSED_ARGUMENT(chipID);
+
+	// TODO: AEDAT 2.0 not yet supported.
+	caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Reading AEDAT 2.0 data not yet supported.");
+	return (-1);
+}
+
+/**
+ * Parse the current buffer and try to extract the AEDAT 3.X
+ * packet contained within, as well as updating the packet
+ * meta-data list.
+ *
+ * @param state common input data structure.
+ * @param isAEDAT30 change the X/Y coordinate origin for Frames and Polarity
+ * events, as this changed from 3.0 (lower left) to 3.1 (upper left).
+ *
+ * @return 0 on successful packet extraction.
+ * Positive numbers for special conditions:
+ * 1 if more data needed.
+ * 2 if skip requested (call again).
+ * Negative numbers on error conditions:
+ * -1 on memory allocation failure.
+ * -2 on decompression failure.
+ */
+static int aedat3GetPacket(inputCommonState state, bool isAEDAT30) {
+	struct input_common_data_view *buf = &state->dataView;
+
+	// So now we're somewhere inside the buffer (usually at start), and want to
+	// read in a very long sequence of event packets.
+	// An event packet is made up of header + data, and the header contains the
+	// information needed to decode the data and its length, to know then where
+	// the next event packet boundary is. So we get the full header first, then
+	// the data, but careful, it can all be split across two (header+data) or
+	// more (data) buffers, so we need to reassemble!
+	size_t remainingData = buf->bufferUsedSize - buf->bufferPosition;
+
+	// First thing, handle skip packet requests. This can happen if packets
+	// from another source are mixed in, or we forbid some packet types.
+	// In that case, we just skip over all their bytes and try to get the next
+	// good packet (header).
+	if (state->packets.skipSize != 0) {
+		if (state->packets.skipSize >= remainingData) {
+			state->packets.skipSize -= remainingData;
+
+			// Go and get next buffer. bufferPosition is at end of buffer.
+			buf->bufferPosition += remainingData;
+			return (1);
+		}
+		else {
+			buf->bufferPosition += state->packets.skipSize;
+			remainingData -= state->packets.skipSize;
+			state->packets.skipSize = 0; // Don't skip anymore, continue as usual.
+		}
+	}
+
+	// Get 28 bytes common packet header.
+	if (state->packets.currPacketHeaderSize != CAER_EVENT_PACKET_HEADER_SIZE) {
+		if (remainingData < CAER_EVENT_PACKET_HEADER_SIZE) {
+			// Reaching end of buffer, the header is split across two buffers!
+			memcpy(state->packets.currPacketHeader, buf->buffer + buf->bufferPosition, remainingData);
+
+			state->packets.currPacketHeaderSize = remainingData;
+
+			// Go and get next buffer. bufferPosition is at end of buffer.
+			buf->bufferPosition += remainingData;
+			return (1);
+		}
+		else {
+			// Either a full header, or the second part of one.
+			size_t dataToRead = CAER_EVENT_PACKET_HEADER_SIZE - state->packets.currPacketHeaderSize;
+
+			memcpy(state->packets.currPacketHeader + state->packets.currPacketHeaderSize,
+				buf->buffer + buf->bufferPosition, dataToRead);
+
+			state->packets.currPacketHeaderSize += dataToRead;
+			buf->bufferPosition += dataToRead;
+			remainingData -= dataToRead;
+		}
+
+		// So now that we have a full header, let's look at it.
+		caerEventPacketHeader packet = (caerEventPacketHeader) state->packets.currPacketHeader;
+
+		int16_t eventType     = caerEventPacketHeaderGetEventType(packet);
+		bool isCompressed     = (eventType & 0x8000);
+		int16_t eventSource   = caerEventPacketHeaderGetEventSource(packet);
+		int32_t eventCapacity = caerEventPacketHeaderGetEventCapacity(packet);
+		int32_t eventNumber   = caerEventPacketHeaderGetEventNumber(packet);
+		int32_t eventValid    = caerEventPacketHeaderGetEventValid(packet);
+		int32_t eventSize     = caerEventPacketHeaderGetEventSize(packet);
+
+		// First we verify that the source ID remained unique (only one source per I/O module supported!).
+		if (state->header.sourceID != eventSource) {
+			caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+				"An input module can only handle packets from the same source! "
+				"A packet with source %" PRIi16
+				" was read, but this input module expects only packets from source %" PRIi16 ". "
+				"Discarding event packet.",
+				eventSource, state->header.sourceID);
+
+			// Skip packet. If packet is compressed, eventCapacity carries the size.
+			state->packets.skipSize = (isCompressed) ? (size_t)(eventCapacity) : (size_t)(eventNumber * eventSize);
+			state->packets.currPacketHeaderSize = 0; // Get new header after skipping.
+
+			// Run function again to skip data. bufferPosition is already up-to-date.
+			return (2);
+		}
+
+		// If packet is compressed, eventCapacity carries the size in bytes to read.
+		state->packets.currPacketDataSize
+			= (isCompressed) ? (size_t)(eventCapacity) : (size_t)(eventNumber * eventSize);
+
+		// Allocate space for the full packet, so we can reassemble it (and decompress it later).
+		state->packets.currPacket = malloc(CAER_EVENT_PACKET_HEADER_SIZE + (size_t)(eventNumber * eventSize));
+		if (state->packets.currPacket == NULL) {
+			caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to allocate memory for new event packet.");
+			return (-1);
+		}
+
+		// First we copy the header in.
+		memcpy(state->packets.currPacket, state->packets.currPacketHeader, CAER_EVENT_PACKET_HEADER_SIZE);
+
+		state->packets.currPacketDataOffset = CAER_EVENT_PACKET_HEADER_SIZE;
+
+		// Rewrite event source to reflect this module, not the original one.
+		caerEventPacketHeaderSetEventSource(state->packets.currPacket, I16T(state->parentModule->moduleID));
+
+		// If packet was compressed, restore original eventType and eventCapacity,
+		// for in-memory usage (no mark bit, eventCapacity == eventNumber).
+		if (isCompressed) {
+			state->packets.currPacket->eventType
+				= htole16(le16toh(state->packets.currPacket->eventType) & I16T(0x7FFF));
+			state->packets.currPacket->eventCapacity = htole32(eventNumber);
+		}
+
+		// Now we can also start keeping track of this packet's meta-data.
+		state->packets.currPacketData = calloc(1, sizeof(struct input_packet_data));
+		if (state->packets.currPacketData == NULL) {
+			free(state->packets.currPacket);
+			state->packets.currPacket = NULL;
+
+			caerModuleLog(
+				state->parentModule, CAER_LOG_ERROR, "Failed to allocate memory for new event packet meta-data.");
+			return (-1);
+		}
+
+		// Fill out meta-data fields with proper information gained from current event packet.
+		state->packets.currPacketData->id = state->packets.packetCount++;
+		state->packets.currPacketData->offset
+			= (state->isNetworkStream)
+				  ? (0)
+				  : (state->dataBufferOffset + buf->bufferPosition - CAER_EVENT_PACKET_HEADER_SIZE);
+		state->packets.currPacketData->size         = CAER_EVENT_PACKET_HEADER_SIZE + state->packets.currPacketDataSize;
+		state->packets.currPacketData->isCompressed = isCompressed;
+		state->packets.currPacketData->eventType    = caerEventPacketHeaderGetEventType(state->packets.currPacket);
+		state->packets.currPacketData->eventSize    = eventSize;
+		state->packets.currPacketData->eventNumber  = eventNumber;
+		state->packets.currPacketData->eventValid   = eventValid;
+		state->packets.currPacketData->startTimestamp = -1; // Invalid for now.
+		state->packets.currPacketData->endTimestamp   = -1; // Invalid for now.
+	}
+
+	// Now get the data from the buffer to the new event packet. We have to take care of
+	// data being split across multiple buffers, as above.
+	if (state->packets.currPacketDataSize > remainingData) {
+		// We need to copy more data than in this buffer.
+		memcpy(((uint8_t *) state->packets.currPacket) + state->packets.currPacketDataOffset,
+			buf->buffer + buf->bufferPosition, remainingData);
+
+		state->packets.currPacketDataOffset += remainingData;
+		state->packets.currPacketDataSize -= remainingData;
+
+		// Go and get next buffer. bufferPosition is at end of buffer.
+		buf->bufferPosition += remainingData;
+		return (1);
+	}
+	else {
+		// We copy the last bytes of data and we're done.
+		memcpy(((uint8_t *) state->packets.currPacket) + state->packets.currPacketDataOffset,
+			buf->buffer + buf->bufferPosition, state->packets.currPacketDataSize);
+
+		// This packet is fully copied and done, so reset variables for next iteration.
+		state->packets.currPacketHeaderSize = 0; // Get new header next iteration.
+		buf->bufferPosition += state->packets.currPacketDataSize;
+
+		// Compressed packets are finished by the decompression workers, if enabled.
+		if (state->packets.currPacketData->isCompressed && (state->decompress.workersNumber > 0)) {
+			return (0);
+		}
+
+		if (!finishPacket(state, state->packets.currPacket, state->packets.currPacketData, isAEDAT30)) {
+			// Failed to decompress packet. Error exit.
+			free(state->packets.currPacket);
+			state->packets.currPacket = NULL;
+			free(state->packets.currPacketData);
+			state->packets.currPacketData = NULL;
+
+			caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to decompress event packet.");
+			return (-2);
+		}
+
+		// New packet parsed!
+		return (0);
+	}
+}
+
+/**
+ * Decompress a fully read AEDAT 3.X packet, if needed, and fill in its
+ * timestamp meta-data. Called by the reader thread, or by a decompression
+ * worker thread, so it must only touch the given packet and meta-data.
+ *
+ * @param state common input data structure.
+ * @param packet fully read packet.
+ * @param packetInfoData meta-data of packet.
+ * @param isAEDAT30 file is in AEDAT 3.0 format, coordinates need conversion.
+ *
+ * @return true on success, false on decompression failure.
+ */
+static bool finishPacket(
+	inputCommonState state, caerEventPacketHeader packet, packetData packetInfoData, bool isAEDAT30) {
+	// Decompress packet.
+	if (packetInfoData->isCompressed && !decompressEventPacket(state, packet, packetInfoData->size)) {
+		return (false);
+	}
+
+	// Update timestamp information.
+	const void *firstEvent         = caerGenericEventGetEvent(packet, 0);
+	packetInfoData->startTimestamp = caerGenericEventGetTimestamp64(firstEvent, packet);
+
+	const void *lastEvent        = caerGenericEventGetEvent(packet, packetInfoData->eventNumber - 1);
+	packetInfoData->endTimestamp = caerGenericEventGetTimestamp64(lastEvent, packet);
+
+	// If the file was in AEDAT 3.0 format, we must change X/Y coordinate origin
+	// for Polarity and Frame events. We do this after parsing and decompression.
+	if (isAEDAT30) {
+		aedat30ChangeOrigin(state, packet);
+	}
+
+	return (true);
+}
+
+static void aedat30ChangeOrigin(inputCommonState state, caerEventPacketHeader packet) {
+	if (caerEventPacketHeaderGetEventType(packet) == POLARITY_EVENT) {
+		// We need to know the DVS resolution to invert the polarity Y address.
+		int16_t dvsSizeY = I16T(sshsNodeGetShort(state->sourceInfoNode, "dvsSizeY") - 1);
+
+		CAER_POLARITY_ITERATOR_ALL_START((caerPolarityEventPacket) packet)
+		uint16_t newYAddress = U16T(dvsSizeY - caerPolarityEventGetY(caerPolarityIteratorElement));
+		caerPolarityEventSetY(caerPolarityIteratorElement, newYAddress);
+	}
+}
+
+if (caerEventPacketHeaderGetEventType(packet) == FRAME_EVENT) {
+	// For frames, the resolution and size information is carried in each event.
+	CAER_FRAME_ITERATOR_ALL_START((caerFrameEventPacket) packet)
+	int32_t lengthX                               = caerFrameEventGetLengthX(caerFrameIteratorElement);
+	int32_t lengthY                               = caerFrameEventGetLengthY(caerFrameIteratorElement);
+	enum caer_frame_event_color_channels channels = caerFrameEventGetChannelNumber(caerFrameIteratorElement);
+
+	size_t rowSize = (size_t) lengthX * channels;
+
+	uint16_t *pixels = caerFrameEventGetPixelArrayUnsafe(caerFrameIteratorElement);
+
+	// Invert position of entire rows.
+	for (size_t y = 0; y < (size_t) lengthY; y++) {
+		size_t invY = (size_t) lengthY - 1 - y;
+
+		// Don't invert if no position change, this happens in the exact
+		// middle if lengthY is uneven.
+		if (y != invY) {
+			memcpy(&pixels[y * rowSize], &pixels[invY * rowSize], rowSize);
+		}
+	}
+}
+}
+}
+
+#ifdef ENABLE_INOUT_PNG_COMPRESSION
+
+static void caerLibPNGReadBuffer(png_structp png_ptr, png_bytep data, png_size_t length);
+static bool decompressFramePNG(inputCommonState state, caerEventPacketHeader packet, size_t packetSize);
+
+// Simple structure to store PNG image bytes.
+struct caer_libpng_buffer {
+	uint8_t *buffer;
+	size_t size;
+	size_t pos;
+};
+
+static void caerLibPNGReadBuffer(png_structp png_ptr, png_bytep data, png_size_t length) {
+	struct caer_libpng_buffer *p = (struct caer_libpng_buffer *) png_get_io_ptr(png_ptr);
+	size_t newPos                = p->pos + length;
+
+	// Detect attempts to read past buffer end.
+	if (newPos > p->size) {
+		png_error(png_ptr, "Read Buffer Error");
+	}
+
+	memcpy(data, p->buffer + p->pos, length);
+	p->pos += length;
+}
+
+static inline enum caer_frame_event_color_channels caerFrameEventColorFromLibPNG(int channels) {
+	switch (channels) {
+		case PNG_COLOR_TYPE_GRAY:
+			return (GRAYSCALE);
+			break;
+
+		case PNG_COLOR_TYPE_RGB:
+			return (RGB);
+			break;
+
+		case PNG_COLOR_TYPE_RGBA:
+		default:
+			return (RGBA);
+			break;
+	}
+}
+
+static inline bool caerFrameEventPNGDecompress(uint8_t *inBuffer, size_t inSize, uint16_t *outBuffer, int32_t xSize,
+	int32_t ySize, enum caer_frame_event_color_channels channels) {
+	png_structp png_ptr = NULL;
+	png_infop info_ptr  = NULL;
+
+	// Initialize the write struct.
+	png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+	if (png_ptr == NULL) {
+		return (false);
+	}
+
+	// Initialize the info struct.
+	info_ptr = png_create_info_struct(png_ptr);
+	if (info_ptr == NULL) {
+		png_destroy_read_struct(&png_ptr, NULL, NULL);
+		return (false);
+	}
+
+	// Set up error handling.
+	if (setjmp(png_jmpbuf(png_ptr))) {
+		png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
+		return (false);
+	}
+
+	// Handle endianness of 16-bit depth pixels correctly.
+	// PNG assumes big-endian, our Frame Event is always little-endian.
+	png_set_swap(png_ptr);
+
+	// Set read function to buffer one.
+	struct caer_libpng_buffer state = {.buffer = inBuffer, .size = inSize, .pos = 0};
+	png_set_read_fn(png_ptr, &state, &caerLibPNGReadBuffer);
+
+	// Read the whole PNG image.
+	png_read_png(png_ptr, info_ptr, PNG_TRANSFORM_IDENTITY, NULL);
+
+	// Extract header info.
+	png_uint_32 width = 0, height = 0;
+	int bitDepth = 0;
+	int color    = -1;
+	png_get_IHDR(png_ptr, info_ptr, &width, &height, &bitDepth, &color, NULL, NULL, NULL);
+
+	// Check header info against known values from our frame event header.
+	if ((I32T(width) != xSize) || (I32T(height) != ySize) || (bitDepth != 16)
+		|| (caerFrameEventColorFromLibPNG(color) != channels)) {
+		png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
+		return (false);
+	}
+
+	// Extract image data, row by row.
+	png_size_t row_bytes    = png_get_rowbytes(png_ptr, info_ptr);
+	png_bytepp row_pointers = png_get_rows(png_ptr, info_ptr);
+
+	for (size_t y = 0; y < (size_t) ySize; y++) {
+		memcpy(&outBuffer[y * row_bytes], row_pointers[y], row_bytes);
+	}
+
+	// Destroy main structs.
+	png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
+
+	return (true);
+}
+
+static bool decompressFramePNG(inputCommonState state, caerEventPacketHeader packet, size_t packetSize) {
+	// We want to avoid allocating new memory for each PNG decompression, and moving around things
+	// to much. So we first go through the compressed header+data blocks, and move them to their
+	// correct position for an in-memory frame packet (so at N*eventSize). Then we decompress the
+	// PNG block and directly copy the results into the space that it was occupying (plus extra for
+	// the uncompressed pixels).
+	// First we go once through the events to know where they are, and where they should go.
+	// Then we do memory move + PNG decompression, starting from the last event (back-side), so as
+	// to not overwrite memory we still need and haven't moved yet.
+	int32_t eventSize   = caerEventPacketHeaderGetEventSize(packet);
+	int32_t eventNumber = caerEventPacketHeaderGetEventNumber(packet);
+
+	struct {
+		size_t offsetDestination;
+		size_t offset;
+		size_t size;
+		bool isCompressed;
+	} eventMemory[eventNumber];
+
+	size_t currPacketOffset = CAER_EVENT_PACKET_HEADER_SIZE; // Start here, no change to header.
+	// '- sizeof(uint16_t)' to compensate for pixels[1] at end of struct for C++ compatibility.
+	size_t frameEventHeaderSize = (sizeof(struct caer_frame_event) - sizeof(uint16_t));
+
+	// Gather information on events.
+	for (int32_t i = 0; i < eventNumber; i++) {
+		// In-memory packet's events have to go where N*eventSize is.
+		eventMemory[i].offsetDestination = CAER_EVENT_PACKET_HEADER_SIZE + (size_t)(i * eventSize);
+		eventMemory[i].offset            = currPacketOffset;
+
+		caerFrameEvent frameEvent = (caerFrameEvent)(((uint8_t *) packet) + currPacketOffset);
+
+		// Bit 31 of info signals if event is PNG-compressed or not.
+		eventMemory[i].isCompressed = GET_NUMBITS32(frameEvent->info, 31, 0x01);
+
+		if (eventMemory[i].isCompressed) {
+			// Clear compression enabled bit.
+			CLEAR_NUMBITS32(frameEvent->info, 31, 0x01);
+
+			// Compressed block size is held in an integer right after the header.
+			int32_t pngSize = le32toh(*((int32_t *) (((uint8_t *) frameEvent) + frameEventHeaderSize)));
+
+			// PNG size is header plus integer plus compressed block size.
+			eventMemory[i].size = frameEventHeaderSize + sizeof(int32_t) + (size_t) pngSize;
+		}
+		else {
+			// Normal size is header plus uncompressed pixels.
+			eventMemory[i].size = frameEventHeaderSize + caerFrameEventGetPixelsSize(frameEvent);
+		}
+
+		// Update counter.
+		currPacketOffset += eventMemory[i].size;
+	}
+
+	// Check that we indeed parsed everything correctly.
+	if (currPacketOffset != packetSize) {
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to decompress frame event. "
+														   "Size after event parsing and packet size don't match.");
+		return (false);
+	}
+
+	// Now move memory and decompress in reverse order.
+	for (int32_t i = eventNumber; i >= 0; i--) {
+		// Move memory from compressed position to uncompressed, in-memory position.
+		memmove(((uint8_t *) packet) + eventMemory[i].offsetDestination, ((uint8_t *) packet) + eventMemory[i].offset,
+			eventMemory[i].size);
+
+		// If event is PNG-compressed, decompress it now.
+		if (eventMemory[i].isCompressed) {
+			uint8_t *pngBuffer
+				= ((uint8_t *) packet) + eventMemory[i].offsetDestination + frameEventHeaderSize + sizeof(int32_t);
+			size_t pngBufferSize = eventMemory[i].size - frameEventHeaderSize - sizeof(int32_t);
+
+			caerFrameEvent frameEvent = (caerFrameEvent)(((uint8_t *) packet) + eventMemory[i].offsetDestination);
+
+			if (!caerFrameEventPNGDecompress(pngBuffer, pngBufferSize, caerFrameEventGetPixelArrayUnsafe(frameEvent),
+					caerFrameEventGetLengthX(frameEvent), caerFrameEventGetLengthY(frameEvent),
+					caerFrameEventGetChannelNumber(frameEvent))) {
+				// Failed to decompress PNG.
+				caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to decompress frame event. "
+																   "PNG decompression failure.");
+				return (false);
 			}
+		}
+
+		// Uncompressed size will always be header + uncompressed pixels.
+		caerFrameEvent frameEvent = (caerFrameEvent)(((uint8_t *) packet) + eventMemory[i].offsetDestination);
+		size_t uncompressedSize   = frameEventHeaderSize + caerFrameEventGetPixelsSize(frameEvent);
+
+		// Initialize the rest of the memory of the event to zeros, to comply with spec
+		// that says non-pixels at the end, if they exist, are always zero.
+		memset(((uint8_t *) packet) + eventMemory[i].offsetDestination + uncompressedSize, 0,
+			(size_t) eventSize - uncompressedSize);
+	}
+
+	return (true);
+}
+
+#endif
+
+static bool decompressTimestampSerialize(inputCommonState state, caerEventPacketHeader packet, size_t packetSize) {
+	// Decompressed in place, the packet memory already has space for all events.
+	if (!caerTimestampSerializeDecompress(packet, packetSize)) {
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+			"Failed to decode serialized timestamp. Compressed data doesn't match packet header.");
+		return (false);
+	}
+
+	return (true);
+}
+
+static bool decompressEventPacket(inputCommonState state, caerEventPacketHeader packet, size_t packetSize) {
+	bool retVal = false;
+
+	// Data compression technique 1: serialized timestamps.
+	if ((state->header.formatID & 0x01) && caerEventPacketHeaderGetEventType(packet) == POLARITY_EVENT) {
+		retVal = decompressTimestampSerialize(state, packet, packetSize);
+	}
+
+#ifdef ENABLE_INOUT_PNG_COMPRESSION
+	// Data compression technique 2: frame PNG compression.
+	if ((state->header.formatID & 0x02) && caerEventPacketHeaderGetEventType(packet) == FRAME_EVENT) {
+		retVal = decompressFramePNG(state, packet, packetSize);
+	}
+#endif
+
+	return (retVal);
+}
+
+static int inputDecompressWorkerThread(void *workerArg) {
+	struct input_common_decompress_worker *worker = workerArg;
+	inputCommonState state                        = worker->state;
+
+	// Set thread name.
+	size_t threadNameLength = strlen(state->parentModule->moduleSubSystemString);
+	char threadName[threadNameLength + 1 + 12]; // +1 for NUL character.
+	strcpy(threadName, state->parentModule->moduleSubSystemString);
+	strcat(threadName, "[Decompress]");
+	portable_thread_set_name(threadName);
+
+	while (atomic_load_explicit(&state->running, memory_order_relaxed)) {
+		// Sleep until a job comes in.
+		struct input_common_decompress_job *job = caerQueueGetWait(worker->jobsRing, INOUT_QUEUE_WAIT_TIME);
+		if (job == NULL) {
+			continue;
+		}
+
+		bool success = finishPacket(state, job->packet, job->metaData, job->isAEDAT30);
+
+		// Release: the reader thread must see the finished packet with the status.
+		atomic_store_explicit(
+			&job->status, (success) ? (DECOMPRESS_JOB_DONE) : (DECOMPRESS_JOB_FAILED), memory_order_release);
+
+		// Wake up the reader thread, if it's waiting for this job. Never full,
+		// it fits all jobs in flight.
+		caerQueuePut(worker->doneRing, job);
+	}
 
-			if ((state->header.majorVersion == 3 && state->header.minorVersion == 0) && versionHeader && formatHeader
-				&& sourceHeader) {
-				// Parsed AEDAT 3.0 header successfully (version, format, source).
-				atomic_store(&state->header.isValidHeader, true);
-				return (true);
-			}
+	return (thrd_success);
+}
 
-			return (false);
+static bool decompressPoolInit(inputCommonState state, size_t workersNumber, size_t jobsSize) {
+	struct input_common_decompress_data *pool = &state->decompress;
+
+	pool->jobs = calloc(jobsSize, sizeof(struct input_common_decompress_job));
+	if (pool->jobs == NULL) {
+		return (false);
+	}
+
+	pool->jobsSize  = jobsSize;
+	pool->jobsHead  = 0;
+	pool->jobsCount = 0;
+
+	pool->workers = calloc(workersNumber, sizeof(struct input_common_decompress_worker));
+	if (pool->workers == NULL) {
+		free(pool->jobs);
+		pool->jobs = NULL;
+		return (false);
+	}
+
+	pool->nextWorker = 0;
+
+	// Each job queue can take all jobs in flight, so handing out a job never fails.
+	for (pool->workersNumber = 0; pool->workersNumber < workersNumber; pool->workersNumber++) {
+		struct input_common_decompress_worker *worker = &pool->workers[pool->workersNumber];
+
+		worker->state    = state;
+		worker->jobsRing = caerQueueInit(jobsSize);
+		if (worker->jobsRing == NULL) {
+			break;
 		}
 
-		if (!versionHeader) {
-			// First thing we expect is the version header. We don't support files not having it.
-			if (sscanf(headerLine, "#!AER-DAT%" SCNi16 ".%" SCNi8 "\r\n", &state->header.majorVersion,
-					&state->header.minorVersion)
-				== 2) {
-				versionHeader = true;
+		worker->doneRing = caerQueueInit(jobsSize);
+		if (worker->doneRing == NULL) {
+			caerQueueFree(worker->jobsRing);
+			break;
+		}
 
-				// Check valid versions.
-				switch (state->header.majorVersion) {
-					case 2:
-						// AEDAT 2.0 is supported. No revisions exist.
-						if (state->header.minorVersion != 0) {
-							goto noValidVersionHeader;
-						}
-						break;
+		if (thrd_create(&worker->thread, &inputDecompressWorkerThread, worker) != thrd_success) {
+			caerQueueFree(worker->jobsRing);
+			caerQueueFree(worker->doneRing);
+			break;
+		}
+	}
 
-					case 3:
-						state->header.isAEDAT3 = true;
+	if (pool->workersNumber != workersNumber) {
+		// Stop the workers started so far.
+		decompressPoolExit(state);
+		return (false);
+	}
 
-						// AEDAT 3.0 and 3.1 are supported.
-						if (state->header.minorVersion != 0 && state->header.minorVersion != 1) {
-							goto noValidVersionHeader;
-						}
-						break;
+	return (true);
+}
 
-					default:
-						// Versions other than 2.0 and 3.X are not supported.
-						goto noValidVersionHeader;
-						break;
-				}
+// Must be called after the input threads have been told to stop (running = false).
+static void decompressPoolExit(inputCommonState state) {
+	struct input_common_decompress_data *pool = &state->decompress;
 
-				caerModuleLog(state->parentModule, CAER_LOG_DEBUG, "Found AEDAT%" PRIi16 ".%" PRIi8 " version header.",
-					state->header.majorVersion, state->header.minorVersion);
-			}
-			else {
-			noValidVersionHeader:
-				free(headerLine);
+	// Workers waiting for jobs must notice they have to stop.
+	for (size_t i = 0; i < pool->workersNumber; i++) {
+		caerQueueWakeUp(pool->workers[i].jobsRing);
+	}
 
-				caerModuleLog(
-					state->parentModule, CAER_LOG_ERROR, "No compliant AEDAT version header found. Invalid file.");
-				return (false);
-			}
+	for (size_t i = 0; i < pool->workersNumber; i++) {
+		if ((errno = thrd_join(pool->workers[i].thread, NULL)) != thrd_success) {
+			// This should never happen!
+			caerModuleLog(state->parentModule, CAER_LOG_CRITICAL,
+				"Failed to join input decompression worker thread. Error: %d.", errno);
 		}
-		else if (state->header.isAEDAT3 && !formatHeader) {
-			// Then the format header. Only with AEDAT 3.X.
-			char formatString[1024 + 1];
 
-			if (sscanf(headerLine, "#Format: %1024s\r\n", formatString) == 1) {
-				formatHeader = true;
+		caerQueueFree(pool->workers[i].jobsRing);
+		caerQueueFree(pool->workers[i].doneRing);
+	}
 
-				// Parse format string to format ID.
-				// We support either only RAW, or a mixture of the various compression modes.
-				if (caerStrEquals(formatString, "RAW")) {
-					state->header.formatID = 0x00;
-				}
-				else {
-					state->header.formatID = 0x00;
+	// Free packets that were not forwarded anymore.
+	for (size_t i = 0; i < pool->jobsCount; i++) {
+		free(pool->jobs[(pool->jobsHead + i) % pool->jobsSize].packet);
+	}
 
-					if (strstr(formatString, "SerializedTS") != NULL) {
-						state->header.formatID |= 0x01;
-					}
+	free(pool->workers);
+	pool->workers       = NULL;
+	pool->workersNumber = 0;
 
-					if (strstr(formatString, "PNGFrames") != NULL) {
-						state->header.formatID |= 0x02;
-					}
+	free(pool->jobs);
+	pool->jobs      = NULL;
+	pool->jobsSize  = 0;
+	pool->jobsCount = 0;
+}
 
-					if (!state->header.formatID) {
-						// No valid format found.
-						free(headerLine);
+/**
+ * Forward finished packets to the input assembler thread, in stream order.
+ * Stops at the first unfinished packet, or waits for it if more than
+ * maxPending packets are still in the pool.
+ *
+ * @return 1 on success, 0 if the input is stopping, -1 on decompression failure.
+ */
+static int decompressPoolForward(inputCommonState state, size_t maxPending) {
+	struct input_common_decompress_data *pool = &state->decompress;
 
-						caerModuleLog(state->parentModule, CAER_LOG_ERROR,
-							"No compliant Format type found. Format '%s' is invalid.", formatString);
+	while (pool->jobsCount > 0) {
+		struct input_common_decompress_job *job = &pool->jobs[pool->jobsHead];
 
-						return (false);
-					}
+		if (job->worker != NULL) {
+			// Each worker finishes its jobs in the order they were handed out,
+			// and they are forwarded in that same order, so the next finished job
+			// of the head job's worker is the head job. Sleep until it's there,
+			// if too many packets are pending already.
+			bool mustWait = (pool->jobsCount > maxPending);
+
+			caerQueue doneRing = job->worker->doneRing;
+			void *doneJob = (mustWait) ? (caerQueueGetWait(doneRing, INOUT_QUEUE_WAIT_TIME)) : (caerQueueGet(doneRing));
+
+			if (doneJob == NULL) {
+				if (!mustWait) {
+					break;
 				}
 
-				caerModuleLog(state->parentModule, CAER_LOG_DEBUG,
-					"Found Format header with value '%s', Format ID %" PRIi8 ".", formatString, state->header.formatID);
-			}
-			else {
-				free(headerLine);
+				if (!atomic_load_explicit(&state->running, memory_order_relaxed)) {
+					return (0);
+				}
 
-				caerModuleLog(state->parentModule, CAER_LOG_ERROR, "No compliant Format header found. Invalid file.");
-				return (false);
+				continue;
 			}
+
+			job->worker = NULL;
 		}
-		else if (state->header.isAEDAT3 && !sourceHeader) {
-			// Then the source header. Only with AEDAT 3.X. We only support one active source.
-			char sourceString[1024 + 1];
 
-			if (sscanf(headerLine, "#Source %" SCNi16 ": %1024[^\r]s\n", &state->header.sourceID, sourceString) == 2) {
-				sourceHeader = true;
+		int_fast32_t status = atomic_load_explicit(&job->status, memory_order_acquire);
 
-				// Parse source string to get needed sourceInfo parameters.
-				parseSourceString(sourceString, state);
+		if (status == DECOMPRESS_JOB_FAILED) {
+			// Packet stays in the pool and is freed on exit.
+			caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to decompress event packet.");
+			return (-1);
+		}
 
-				caerModuleLog(state->parentModule, CAER_LOG_DEBUG,
-					"Found Source header with value '%s', Source ID %" PRIi16 ".", sourceString,
-					state->header.sourceID);
-			}
-			else {
-				free(headerLine);
+		replayCacheAdd(state, job->packet);
 
-				caerModuleLog(state->parentModule, CAER_LOG_ERROR, "No compliant Source header found. Invalid file.");
-				return (false);
+		while (!caerQueuePutWait(state->transferRingPackets, job->packet, INOUT_QUEUE_WAIT_TIME)) {
+			if (!atomic_load_explicit(&state->running, memory_order_relaxed)) {
+				return (0);
 			}
 		}
-		else {
-			// Now we either have other header lines with AEDAT 2.0/AEDAT 3.X, or
-			// the END-HEADER with AEDAT 3.1. We check this before the other possible,
-			// because it terminates the AEDAT 3.1 header, so we stop in that case.
-			if (caerStrEquals(headerLine, "#!END-HEADER\r\n")) {
-				endHeader = true;
 
-				caerModuleLog(state->parentModule, CAER_LOG_DEBUG, "Found END-HEADER header.");
-			}
-			else {
-				// Then other headers, like Start-Time.
-				if (caerStrEqualsUpTo(headerLine, "#Start-Time: ", 13)) {
-					char startTimeString[1024 + 1];
+		job->packet    = NULL;
+		pool->jobsHead = (pool->jobsHead + 1) % pool->jobsSize;
+		pool->jobsCount--;
+	}
 
-					if (sscanf(headerLine, "#Start-Time: %1024[^\r]s\n", startTimeString) == 1) {
-						caerModuleLog(
-							state->parentModule, CAER_LOG_INFO, "Recording was taken on %s.", startTimeString);
-					}
-				}
-				else if (caerStrEqualsUpTo(headerLine, "#-Source ", 9)) {
-					// Detect negative source strings (#-Source) and add them to sourceInfo.
-					// Previous sources are simply appended to the sourceString string in order.
-					char *currSourceString        = sshsNodeGetString(state->sourceInfoNode, "sourceString");
-					size_t currSourceStringLength = strlen(currSourceString);
+	return (1);
+}
 
-					size_t addSourceStringLength = strlen(headerLine);
+/**
+ * Add a parsed packet to the decompression pool. Compressed packets are
+ * handed to a worker, the others just wait for their turn, so that all
+ * packets reach the input assembler thread in the original order.
+ *
+ * @return true on success (also if stopping), false on decompression failure.
+ */
+static bool decompressPoolSubmit(
+	inputCommonState state, caerEventPacketHeader packet, packetData packetInfoData, bool isAEDAT30) {
+	struct input_common_decompress_data *pool = &state->decompress;
 
-					char *newSourceString = realloc(currSourceString,
-						currSourceStringLength + addSourceStringLength + 1); // +1 for NUL termination.
-					if (newSourceString == NULL) {
-						// Memory reallocation failure, skip this negative source string.
-						free(currSourceString);
-					}
-					else {
-						// Concatenate negative source string and commit as new sourceString.
-						memcpy(newSourceString + currSourceStringLength, headerLine, addSourceStringLength);
-						newSourceString[currSourceStringLength + addSourceStringLength] = '\0';
+	// Make room for the new job, if all are in use.
+	int result = decompressPoolForward(state, pool->jobsSize - 1);
+	if (result <= 0) {
+		free(packet);
+		return (result == 0);
+	}
 
-						sshsNodeUpdateReadOnlyAttribute(state->sourceInfoNode, "sourceString", SSHS_STRING,
-							(union sshs_node_attr_value){.string = newSourceString});
+	struct input_common_decompress_job *job = &pool->jobs[(pool->jobsHead + pool->jobsCount) % pool->jobsSize];
 
-						free(newSourceString);
-					}
-				}
-				else {
-					headerLine[strlen(headerLine) - 2] = '\0'; // Shorten string to avoid printing ending \r\n.
-					caerModuleLog(state->parentModule, CAER_LOG_DEBUG, "Header line: '%s'.", headerLine);
-				}
-			}
+	job->packet    = packet;
+	job->metaData  = packetInfoData;
+	job->isAEDAT30 = isAEDAT30;
+
+	pool->jobsCount++;
+
+	if (packetInfoData->isCompressed) {
+		atomic_store_explicit(&job->status, DECOMPRESS_JOB_PENDING, memory_order_relaxed);
+		job->worker = &pool->workers[pool->nextWorker];
+
+		if (!caerQueuePut(job->worker->jobsRing, job)) {
+			// This should never happen, job queues fit all jobs in flight.
+			caerModuleLog(state->parentModule, CAER_LOG_CRITICAL, "Failed to hand packet to decompression worker.");
+			atomic_store_explicit(&job->status, DECOMPRESS_JOB_FAILED, memory_order_relaxed);
+			job->worker = NULL;
 		}
 
-		free(headerLine);
+		pool->nextWorker = (pool->nextWorker + 1) % pool->workersNumber;
+	}
+	else {
+		// Already finished by the reader.
+		atomic_store_explicit(&job->status, DECOMPRESS_JOB_DONE, memory_order_relaxed);
+		job->worker = NULL;
 	}
 
-	// Parsed AEDAT 3.1 header successfully.
-	atomic_store(&state->header.isValidHeader, true);
-	return (true);
+	// Pass on what's already done, without waiting.
+	return (decompressPoolForward(state, pool->jobsSize) >= 0);
 }
 
-static bool parseHeader(inputCommonState state) {
-	if (state->isNetworkStream) {
-		return (parseNetworkHeader(state));
+static void replayCacheInit(inputCommonState state, size_t storeLimit) {
+	struct input_common_replay_data *replay = &state->replay;
+
+	replay->enabled        = true;
+	replay->collecting     = true;
+	replay->store          = NULL;
+	replay->storeSize      = 0;
+	replay->storeCapacity  = 0;
+	replay->storeLimit     = storeLimit;
+	replay->firstTimestamp = -1;
+	replay->lastTimestamp  = -1;
+}
+
+// Must be called after the reader thread has stopped.
+static void replayCacheExit(inputCommonState state) {
+	free(state->replay.store);
+	state->replay.store = NULL;
+}
+
+static void replayCacheDisable(inputCommonState state, const char *reason) {
+	struct input_common_replay_data *replay = &state->replay;
+
+	caerModuleLog(state->parentModule, CAER_LOG_WARNING, "Disabling loop replay, because %s.", reason);
+
+	free(replay->store);
+
+	replay->collecting    = false;
+	replay->store         = NULL;
+	replay->storeSize     = 0;
+	replay->storeCapacity = 0;
+}
+
+/**
+ * Store a copy of a fully decoded packet for loop replay, during the first
+ * pass through the file. Packets are kept back to back in one memory block,
+ * instead of as separate allocations.
+ *
+ * @param state common input data structure.
+ * @param packet decoded packet, about to be sent to the assembler thread.
+ */
+static void replayCacheAdd(inputCommonState state, caerEventPacketHeader packet) {
+	struct input_common_replay_data *replay = &state->replay;
+
+	if (!replay->collecting) {
+		return;
 	}
-	else {
-		return (parseFileHeader(state));
+
+	int32_t eventNumber = caerEventPacketHeaderGetEventNumber(packet);
+	if (eventNumber == 0) {
+		return;
 	}
-}
 
-static bool parseData(inputCommonState state) {
-	while (state->dataBuffer->bufferPosition < state->dataBuffer->bufferUsedSize) {
-		int pRes = -1;
+	// Timestamp resets would make the rebased timestamps go back in time.
+	if ((caerEventPacketHeaderGetEventType(packet) == SPECIAL_EVENT)
+		&& (caerSpecialEventPacketFindValidEventByType((caerSpecialEventPacket) packet, TIMESTAMP_RESET) != NULL)) {
+		replayCacheDisable(state, "the file contains timestamp resets");
+		return;
+	}
 
-		// Try getting packet and packetData from buffer.
-		if (state->header.majorVersion == 2 && state->header.minorVersion == 0) {
-			pRes = aedat2GetPacket(state, 0);
-		}
-		else if (state->header.majorVersion == 3) {
-			pRes = aedat3GetPacket(state, (state->header.minorVersion == 0));
-		}
-		else {
-			// No parseable format found!
-			return (false);
-		}
+	size_t packetSize
+		= CAER_EVENT_PACKET_HEADER_SIZE + (size_t)(eventNumber * caerEventPacketHeaderGetEventSize(packet));
+	size_t storedSize = (packetSize + 7) & ~((size_t) 7);
 
-		// Check packet parser return value.
-		if (pRes < 0) {
-			// Error in parsing buffer to get packet.
-			return (false);
-		}
-		else if (pRes == 1) {
-			// Finished parsing this buffer with no new packet.
-			// Exit to get next buffer.
-			break;
-		}
-		else if (pRes == 2) {
-			// Skip requested, run again.
-			continue;
-		}
+	if ((replay->storeSize + storedSize) > replay->storeLimit) {
+		replayCacheDisable(state, "the file doesn't fit into loopReplayMemory");
+		return;
+	}
 
-		caerModuleLog(state->parentModule, CAER_LOG_DEBUG,
-			"New packet read - ID: %zu, Offset: %zu, Size: %zu, Events: %" PRIi32 ", Type: %" PRIi16
-			", StartTS: %" PRIi64 ", EndTS: %" PRIi64 ".",
-			state->packets.currPacketData->id, state->packets.currPacketData->offset,
-			state->packets.currPacketData->size, state->packets.currPacketData->eventNumber,
-			state->packets.currPacketData->eventType, state->packets.currPacketData->startTimestamp,
-			state->packets.currPacketData->endTimestamp);
+	if ((replay->storeSize + storedSize) > replay->storeCapacity) {
+		// Grow by doubling, up to the limit.
+		size_t newCapacity = (replay->storeCapacity == 0) ? (1024 * 1024) : (replay->storeCapacity * 2);
 
-		// New packet information, add it to the global packet info list.
-		// This is done here to prevent ambiguity about the ownership of the involved memory block:
-		// it either is inside the global list with state->packets.currPacketData NULL, or it is not
-		// in the list, but in state->packets.currPacketData itself. So if, on exit, we clear both,
-		// we'll free all the memory and have no fear of a double-free happening.
-		DL_APPEND(state->packets.packetsList, state->packets.currPacketData);
-		state->packets.currPacketData = NULL;
+		if (newCapacity < (replay->storeSize + storedSize)) {
+			newCapacity = replay->storeSize + storedSize;
+		}
 
-		// New packet from stream, send it off to the input assembler thread. Same memory
-		// related considerations as above for state->packets.currPacketData apply here too!
-		while (!caerRingBufferPut(state->transferRingPackets, state->packets.currPacket)) {
-			// We ensure all read packets are sent to the Assembler stage.
-			if (!atomic_load_explicit(&state->running, memory_order_relaxed)) {
-				// On normal termination, just return without errors. The Reader thread
-				// will then also exit without errors and clean up in Exit().
-				return (true);
-			}
+		if (newCapacity > replay->storeLimit) {
+			newCapacity = replay->storeLimit;
+		}
 
-			// Delay by 10 µs if no change, to avoid a wasteful busy loop.
-			struct timespec retrySleep = {.tv_sec = 0, .tv_nsec = 10000};
-			thrd_sleep(&retrySleep, NULL);
+		uint8_t *newStore = realloc(replay->store, newCapacity);
+		if (newStore == NULL) {
+			replayCacheDisable(state, "of failed memory allocation");
+			return;
 		}
 
-		state->packets.currPacket = NULL;
+		replay->store         = newStore;
+		replay->storeCapacity = newCapacity;
 	}
 
-	// All good, get next buffer.
-	return (true);
+	memcpy(replay->store + replay->storeSize, packet, packetSize);
+	replay->storeSize += storedSize;
+
+	int64_t firstTimestamp = caerGenericEventGetTimestamp64(caerGenericEventGetEvent(packet, 0), packet);
+	int64_t lastTimestamp
+		= caerGenericEventGetTimestamp64(caerGenericEventGetEvent(packet, eventNumber - 1), packet);
+
+	if (replay->firstTimestamp == -1) {
+		replay->firstTimestamp = firstTimestamp;
+	}
+
+	if (lastTimestamp > replay->lastTimestamp) {
+		replay->lastTimestamp = lastTimestamp;
+	}
 }
 
 /**
- * Parse the current buffer and try to extract the AEDAT 2.0
- * data contained within, to form a compliant AEDAT 3.1 packet,
- * and then update the packet meta-data list with it.
+ * Send a copy of a stored packet to the assembler thread, with all timestamps
+ * moved forward by the given offset. A packet only has one timestamp overflow
+ * counter, so it is split where the new timestamps cross into the next one.
  *
  * @param state common input data structure.
- * @param chipID chip identifier to decide sizes, ordering and
- * features of the data stream for conversion to AEDAT 3.1.
+ * @param cached packet in the replay store.
+ * @param timeOffset time (in µs) to add to all timestamps.
  *
- * @return 0 on successful packet extraction.
- * Positive numbers for special conditions:
- * 1 if more data needed.
- * Negative numbers on error conditions:
- * -1 on memory allocation failure.
+ * @return true on success (also if stopping), false on memory allocation failure.
  */
-static int aedat2GetPacket(inputCommonState state, int16_t chipID) {
-	UNUSED_ARGUMENT(chipID);
+static bool replayCachePut(inputCommonState state, caerEventPacketHeader cached, int64_t timeOffset) {
+	int32_t eventNumber = caerEventPacketHeaderGetEventNumber(cached);
+	int32_t eventSize   = caerEventPacketHeaderGetEventSize(cached);
+	bool isFrame        = (caerEventPacketHeaderGetEventType(cached) == FRAME_EVENT);
 
-	// TODO: AEDAT 2.0 not yet supported.
-	caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Reading AEDAT 2.0 data not yet supported.");
-	return (-1);
+	int32_t start = 0;
+
+	while (start < eventNumber) {
+		int64_t startTimestamp
+			= caerGenericEventGetTimestamp64(caerGenericEventGetEvent(cached, start), cached) + timeOffset;
+		int32_t tsOverflow = I32T(startTimestamp >> 31);
+
+		// Events are in time order, find the first one belonging to the next overflow.
+		int32_t end = start + 1;
+
+		while ((end < eventNumber)
+			   && (((caerGenericEventGetTimestamp64(caerGenericEventGetEvent(cached, end), cached) + timeOffset) >> 31)
+					  == tsOverflow)) {
+			end++;
+		}
+
+		int32_t number = end - start;
+
+		caerEventPacketHeader packet = malloc(CAER_EVENT_PACKET_HEADER_SIZE + (size_t)(number * eventSize));
+		if (packet == NULL) {
+			caerModuleLog(state->parentModule, CAER_LOG_CRITICAL, "Failed to allocate memory for replayed packet.");
+			return (false);
+		}
+
+		memcpy(packet, cached, CAER_EVENT_PACKET_HEADER_SIZE);
+		memcpy(((uint8_t *) packet) + CAER_EVENT_PACKET_HEADER_SIZE, caerGenericEventGetEvent(cached, start),
+			(size_t)(number * eventSize));
+
+		caerEventPacketHeaderSetEventNumber(packet, number);
+		caerEventPacketHeaderSetEventCapacity(packet, number);
+		caerEventPacketHeaderSetEventValid(packet, (number == eventNumber)
+													   ? (caerEventPacketHeaderGetEventValid(cached))
+													   : (countValidEvents(cached, start, end)));
+		caerEventPacketHeaderSetEventTSOverflow(packet, tsOverflow);
+
+		for (int32_t i = 0; i < number; i++) {
+			const void *cachedEvent = caerGenericEventGetEvent(cached, start + i);
+			void *event             = caerGenericEventGetEvent(packet, i);
+
+			int64_t timestamp = caerGenericEventGetTimestamp64(cachedEvent, cached) + timeOffset;
+			caerGenericEventSetTimestamp(event, packet, I32T(timestamp & INT32_MAX));
+
+			// Frames carry more timestamps than the main one.
+			if (isFrame) {
+				caerFrameEventPacketConst cachedFrames = (caerFrameEventPacketConst) cached;
+
+				caerFrameEventSetTSStartOfFrame(event,
+					I32T((caerFrameEventGetTSStartOfFrame64(cachedEvent, cachedFrames) + timeOffset) & INT32_MAX));
+				caerFrameEventSetTSEndOfFrame(event,
+					I32T((caerFrameEventGetTSEndOfFrame64(cachedEvent, cachedFrames) + timeOffset) & INT32_MAX));
+				caerFrameEventSetTSStartOfExposure(event,
+					I32T((caerFrameEventGetTSStartOfExposure64(cachedEvent, cachedFrames) + timeOffset) & INT32_MAX));
+				caerFrameEventSetTSEndOfExposure(event,
+					I32T((caerFrameEventGetTSEndOfExposure64(cachedEvent, cachedFrames) + timeOffset) & INT32_MAX));
+			}
+		}
+
+		while (!caerQueuePutWait(state->transferRingPackets, packet, INOUT_QUEUE_WAIT_TIME)) {
+			if (!atomic_load_explicit(&state->running, memory_order_relaxed)) {
+				free(packet);
+				return (true);
+			}
+		}
+
+		start = end;
+	}
+
+	return (true);
 }
 
 /**
- * Parse the current buffer and try to extract the AEDAT 3.X
- * packet contained within, as well as updating the packet
- * meta-data list.
+ * Replay the stored packets over and over, until the module is stopped.
+ * Each loop continues in time right after the previous one ended, so that
+ * timestamps keep increasing and downstream modules never see a reset.
  *
  * @param state common input data structure.
- * @param isAEDAT30 change the X/Y coordinate origin for Frames and Polarity
- * events, as this changed from 3.0 (lower left) to 3.1 (upper left).
  *
- * @return 0 on successful packet extraction.
- * Positive numbers for special conditions:
- * 1 if more data needed.
- * 2 if skip requested (call again).
- * Negative numbers on error conditions:
- * -1 on memory allocation failure.
- * -2 on decompression failure.
+ * @return true on normal termination, false on memory allocation failure.
  */
-static int aedat3GetPacket(inputCommonState state, bool isAEDAT30) {
-	simpleBuffer buf = state->dataBuffer;
+static bool replayCacheLoop(inputCommonState state) {
+	struct input_common_replay_data *replay = &state->replay;
 
-	// So now we're somewhere inside the buffer (usually at start), and want to
-	// read in a very long sequence of event packets.
-	// An event packet is made up of header + data, and the header contains the
-	// information needed to decode the data and its length, to know then where
-	// the next event packet boundary is. So we get the full header first, then
-	// the data, but careful, it can all be split across two (header+data) or
-	// more (data) buffers, so we need to reassemble!
-	size_t remainingData = buf->bufferUsedSize - buf->bufferPosition;
+	int64_t loopDuration = replay->lastTimestamp - replay->firstTimestamp + 1;
+	int64_t timeOffset   = 0;
 
-	// First thing, handle skip packet requests. This can happen if packets
-	// from another source are mixed in, or we forbid some packet types.
-	// In that case, we just skip over all their bytes and try to get the next
-	// good packet (header).
-	if (state->packets.skipSize != 0) {
-		if (state->packets.skipSize >= remainingData) {
-			state->packets.skipSize -= remainingData;
+	caerModuleLog(state->parentModule, CAER_LOG_INFO,
+		"Replaying file from memory (%zu bytes), looping every %" PRIi64 " µs.", replay->storeSize, loopDuration);
 
-			// Go and get next buffer. bufferPosition is at end of buffer.
-			buf->bufferPosition += remainingData;
-			return (1);
-		}
-		else {
-			buf->bufferPosition += state->packets.skipSize;
-			remainingData -= state->packets.skipSize;
-			state->packets.skipSize = 0; // Don't skip anymore, continue as usual.
-		}
-	}
+	while (atomic_load_explicit(&state->running, memory_order_relaxed)) {
+		timeOffset += loopDuration;
 
-	// Get 28 bytes common packet header.
-	if (state->packets.currPacketHeaderSize != CAER_EVENT_PACKET_HEADER_SIZE) {
-		if (remainingData < CAER_EVENT_PACKET_HEADER_SIZE) {
-			// Reaching end of buffer, the header is split across two buffers!
-			memcpy(state->packets.currPacketHeader, buf->buffer + buf->bufferPosition, remainingData);
+		for (size_t offset = 0; offset < replay->storeSize;) {
+			if (!atomic_load_explicit(&state->running, memory_order_relaxed)) {
+				return (true);
+			}
 
-			state->packets.currPacketHeaderSize = remainingData;
+			caerEventPacketHeader cached = (caerEventPacketHeader)(replay->store + offset);
 
-			// Go and get next buffer. bufferPosition is at end of buffer.
-			buf->bufferPosition += remainingData;
-			return (1);
+			if (!replayCachePut(state, cached, timeOffset)) {
+				return (false);
+			}
+
+			size_t packetSize = CAER_EVENT_PACKET_HEADER_SIZE
+								+ (size_t)(caerEventPacketHeaderGetEventNumber(cached)
+										   * caerEventPacketHeaderGetEventSize(cached));
+			offset += (packetSize + 7) & ~((size_t) 7);
 		}
-		else {
-			// Either a full header, or the second part of one.
-			size_t dataToRead = CAER_EVENT_PACKET_HEADER_SIZE - state->packets.currPacketHeaderSize;
+	}
 
-			memcpy(state->packets.currPacketHeader + state->packets.currPacketHeaderSize,
-				buf->buffer + buf->bufferPosition, dataToRead);
+	return (true);
+}
 
-			state->packets.currPacketHeaderSize += dataToRead;
-			buf->bufferPosition += dataToRead;
-			remainingData -= dataToRead;
-		}
+static bool udpInputInit(inputCommonState state, size_t batchSize, size_t windowSize, int64_t reorderTimeout) {
+	struct input_common_udp_data *udp = &state->udp;
 
-		// So now that we have a full header, let's look at it.
-		caerEventPacketHeader packet = (caerEventPacketHeader) state->packets.currPacketHeader;
+	udp->batchSize      = batchSize;
+	udp->windowSize     = windowSize;
+	udp->reorderTimeout = reorderTimeout;
 
-		int16_t eventType     = caerEventPacketHeaderGetEventType(packet);
-		bool isCompressed     = (eventType & 0x8000);
-		int16_t eventSource   = caerEventPacketHeaderGetEventSource(packet);
-		int32_t eventCapacity = caerEventPacketHeaderGetEventCapacity(packet);
-		int32_t eventNumber   = caerEventPacketHeaderGetEventNumber(packet);
-		int32_t eventValid    = caerEventPacketHeaderGetEventValid(packet);
-		int32_t eventSize     = caerEventPacketHeaderGetEventSize(packet);
+	udp->nextSequenceNumber    = -1;
+	udp->highestSequenceNumber = -1;
+	udp->deliverEnd            = -1;
 
-		// First we verify that the source ID remained unique (only one source per I/O module supported!).
-		if (state->header.sourceID != eventSource) {
-			caerModuleLog(state->parentModule, CAER_LOG_ERROR,
-				"An input module can only handle packets from the same source! "
-				"A packet with source %" PRIi16
-				" was read, but this input module expects only packets from source %" PRIi16 ". "
-				"Discarding event packet.",
-				eventSource, state->header.sourceID);
+#if !defined(OS_WINDOWS)
+	udp->batch        = calloc(batchSize, sizeof(struct input_common_udp_message));
+	udp->batchHeaders = calloc(batchSize, sizeof(struct mmsghdr));
+	udp->batchIovecs  = calloc(batchSize, sizeof(struct iovec));
+	udp->window       = calloc(windowSize, sizeof(struct input_common_udp_message));
 
-			// Skip packet. If packet is compressed, eventCapacity carries the size.
-			state->packets.skipSize = (isCompressed) ? (size_t)(eventCapacity) : (size_t)(eventNumber * eventSize);
-			state->packets.currPacketHeaderSize = 0; // Get new header after skipping.
+	if ((udp->batch == NULL) || (udp->batchHeaders == NULL) || (udp->batchIovecs == NULL) || (udp->window == NULL)) {
+		udpInputExit(state);
+		return (false);
+	}
 
-			// Run function again to skip data. bufferPosition is already up-to-date.
-			return (2);
+	// Every batch entry and window slot always owns one datagram buffer.
+	for (size_t i = 0; i < batchSize; i++) {
+		udp->batch[i].sequenceNumber = -1;
+
+		udp->batch[i].buffer = malloc(UDP_MESSAGE_SIZE);
+		if (udp->batch[i].buffer == NULL) {
+			udpInputExit(state);
+			return (false);
 		}
+	}
 
-		// If packet is compressed, eventCapacity carries the size in bytes to read.
-		state->packets.currPacketDataSize
-			= (isCompressed) ? (size_t)(eventCapacity) : (size_t)(eventNumber * eventSize);
+	for (size_t i = 0; i < windowSize; i++) {
+		udp->window[i].sequenceNumber = -1;
 
-		// Allocate space for the full packet, so we can reassemble it (and decompress it later).
-		state->packets.currPacket = malloc(CAER_EVENT_PACKET_HEADER_SIZE + (size_t)(eventNumber * eventSize));
-		if (state->packets.currPacket == NULL) {
-			caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to allocate memory for new event packet.");
-			return (-1);
+		udp->window[i].buffer = malloc(UDP_MESSAGE_SIZE);
+		if (udp->window[i].buffer == NULL) {
+			udpInputExit(state);
+			return (false);
 		}
+	}
 
-		// First we copy the header in.
-		memcpy(state->packets.currPacket, state->packets.currPacketHeader, CAER_EVENT_PACKET_HEADER_SIZE);
-
-		state->packets.currPacketDataOffset = CAER_EVENT_PACKET_HEADER_SIZE;
+	return (true);
+#else
+	return (false);
+#endif
+}
 
-		// Rewrite event source to reflect this module, not the original one.
-		caerEventPacketHeaderSetEventSource(state->packets.currPacket, I16T(state->parentModule->moduleID));
+static void udpInputExit(inputCommonState state) {
+	struct input_common_udp_data *udp = &state->udp;
 
-		// If packet was compressed, restore original eventType and eventCapacity,
-		// for in-memory usage (no mark bit, eventCapacity == eventNumber).
-		if (isCompressed) {
-			state->packets.currPacket->eventType
-				= htole16(le16toh(state->packets.currPacket->eventType) & I16T(0x7FFF));
-			state->packets.currPacket->eventCapacity = htole32(eventNumber);
+	if (udp->batch != NULL) {
+		for (size_t i = 0; i < udp->batchSize; i++) {
+			free(udp->batch[i].buffer);
 		}
+	}
 
-		// Now we can also start keeping track of this packet's meta-data.
-		state->packets.currPacketData = calloc(1, sizeof(struct input_packet_data));
-		if (state->packets.currPacketData == NULL) {
-			free(state->packets.currPacket);
-			state->packets.currPacket = NULL;
-
-			caerModuleLog(
-				state->parentModule, CAER_LOG_ERROR, "Failed to allocate memory for new event packet meta-data.");
-			return (-1);
+	if (udp->window != NULL) {
+		for (size_t i = 0; i < udp->windowSize; i++) {
+			free(udp->window[i].buffer);
 		}
-
-		// Fill out meta-data fields with proper information gained from current event packet.
-		state->packets.currPacketData->id = state->packets.packetCount++;
-		state->packets.currPacketData->offset
-			= (state->isNetworkStream)
-				  ? (0)
-				  : (state->dataBufferOffset + buf->bufferPosition - CAER_EVENT_PACKET_HEADER_SIZE);
-		state->packets.currPacketData->size         = CAER_EVENT_PACKET_HEADER_SIZE + state->packets.currPacketDataSize;
-		state->packets.currPacketData->isCompressed = isCompressed;
-		state->packets.currPacketData->eventType    = caerEventPacketHeaderGetEventType(state->packets.currPacket);
-		state->packets.currPacketData->eventSize    = eventSize;
-		state->packets.currPacketData->eventNumber  = eventNumber;
-		state->packets.currPacketData->eventValid   = eventValid;
-		state->packets.currPacketData->startTimestamp = -1; // Invalid for now.
-		state->packets.currPacketData->endTimestamp   = -1; // Invalid for now.
 	}
 
-	// Now get the data from the buffer to the new event packet. We have to take care of
-	// data being split across multiple buffers, as above.
-	if (state->packets.currPacketDataSize > remainingData) {
-		// We need to copy more data than in this buffer.
-		memcpy(((uint8_t *) state->packets.currPacket) + state->packets.currPacketDataOffset,
-			buf->buffer + buf->bufferPosition, remainingData);
+	free(udp->batch);
+	free(udp->batchHeaders);
+	free(udp->batchIovecs);
+	free(udp->window);
 
-		state->packets.currPacketDataOffset += remainingData;
-		state->packets.currPacketDataSize -= remainingData;
+	udp->batch        = NULL;
+	udp->batchHeaders = NULL;
+	udp->batchIovecs  = NULL;
+	udp->window       = NULL;
+}
 
-		// Go and get next buffer. bufferPosition is at end of buffer.
-		buf->bufferPosition += remainingData;
-		return (1);
-	}
-	else {
-		// We copy the last bytes of data and we're done.
-		memcpy(((uint8_t *) state->packets.currPacket) + state->packets.currPacketDataOffset,
-			buf->buffer + buf->bufferPosition, state->packets.currPacketDataSize);
+/**
+ * Wait for datagrams to arrive on the socket, then receive as many as are
+ * available, up to a full batch, with one system call.
+ *
+ * @return number of received datagrams, 0 on timeout, -1 on error (errno set).
+ */
+static int udpInputReceive(inputCommonState state, int timeoutMs) {
+#if !defined(OS_WINDOWS)
+	struct input_common_udp_data *udp = &state->udp;
 
-		// This packet is fully copied and done, so reset variables for next iteration.
-		state->packets.currPacketHeaderSize = 0; // Get new header next iteration.
-		buf->bufferPosition += state->packets.currPacketDataSize;
+	struct pollfd pollSocket = {.fd = state->fileDescriptor, .events = POLLIN, .revents = 0};
 
-		// Decompress packet.
-		if (state->packets.currPacketData->isCompressed) {
-			if (!decompressEventPacket(state, state->packets.currPacket, state->packets.currPacketData->size)) {
-				// Failed to decompress packet. Error exit.
-				free(state->packets.currPacket);
-				state->packets.currPacket = NULL;
-				free(state->packets.currPacketData);
-				state->packets.currPacketData = NULL;
+	int pollResult = poll(&pollSocket, 1, timeoutMs);
+	if (pollResult <= 0) {
+		return (((pollResult < 0) && (errno != EINTR)) ? (-1) : (0));
+	}
 
-				caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to decompress event packet.");
-				return (-2);
-			}
-		}
+	// Buffers are swapped into the window after each receive, so always point to the current ones.
+	for (size_t i = 0; i < udp->batchSize; i++) {
+		udp->batchIovecs[i].iov_base = udp->batch[i].buffer;
+		udp->batchIovecs[i].iov_len  = UDP_MESSAGE_SIZE;
 
-		// Update timestamp information and insert packet into meta-data list.
-		const void *firstEvent = caerGenericEventGetEvent(state->packets.currPacket, 0);
-		state->packets.currPacketData->startTimestamp
-			= caerGenericEventGetTimestamp64(firstEvent, state->packets.currPacket);
+		memset(&udp->batchHeaders[i], 0, sizeof(struct mmsghdr));
+		udp->batchHeaders[i].msg_hdr.msg_iov    = &udp->batchIovecs[i];
+		udp->batchHeaders[i].msg_hdr.msg_iovlen = 1;
+	}
 
-		const void *lastEvent
-			= caerGenericEventGetEvent(state->packets.currPacket, state->packets.currPacketData->eventNumber - 1);
-		state->packets.currPacketData->endTimestamp
-			= caerGenericEventGetTimestamp64(lastEvent, state->packets.currPacket);
+#if defined(OS_LINUX)
+	int received
+		= recvmmsg(state->fileDescriptor, udp->batchHeaders, (unsigned int) udp->batchSize, MSG_DONTWAIT, NULL);
+#else
+	int received = 0;
 
-		// If the file was in AEDAT 3.0 format, we must change X/Y coordinate origin
-		// for Polarity and Frame events. We do this after parsing and decompression.
-		if (isAEDAT30) {
-			aedat30ChangeOrigin(state, state->packets.currPacket);
+	while ((size_t) received < udp->batchSize) {
+		ssize_t length = recvmsg(state->fileDescriptor, &udp->batchHeaders[received].msg_hdr, MSG_DONTWAIT);
+		if (length < 0) {
+			break;
 		}
 
-		// New packet parsed!
-		return (0);
+		udp->batchHeaders[received].msg_len = (unsigned int) length;
+		received++;
 	}
-}
 
-static void aedat30ChangeOrigin(inputCommonState state, caerEventPacketHeader packet) {
-	if (caerEventPacketHeaderGetEventType(packet) == POLARITY_EVENT) {
-		// We need to know the DVS resolution to invert the polarity Y address.
-		int16_t dvsSizeY = I16T(sshsNodeGetShort(state->sourceInfoNode, "dvsSizeY") - 1);
+	if (received == 0) {
+		received = -1; // errno set by recvmsg().
+	}
+#endif
 
-		CAER_POLARITY_ITERATOR_ALL_START((caerPolarityEventPacket) packet)
-		uint16_t newYAddress = U16T(dvsSizeY - caerPolarityEventGetY(caerPolarityIteratorElement));
-		caerPolarityEventSetY(caerPolarityIteratorElement, newYAddress);
+	if (received < 0) {
+		return (((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)) ? (0) : (-1));
 	}
-}
 
-if (caerEventPacketHeaderGetEventType(packet) == FRAME_EVENT) {
-	// For frames, the resolution and size information is carried in each event.
-	CAER_FRAME_ITERATOR_ALL_START((caerFrameEventPacket) packet)
-	int32_t lengthX                               = caerFrameEventGetLengthX(caerFrameIteratorElement);
-	int32_t lengthY                               = caerFrameEventGetLengthY(caerFrameIteratorElement);
-	enum caer_frame_event_color_channels channels = caerFrameEventGetChannelNumber(caerFrameIteratorElement);
+	// Truncated datagrams get length zero, so they're discarded.
+	for (size_t i = 0; i < (size_t) received; i++) {
+		udp->batch[i].dataLength
+			= (udp->batchHeaders[i].msg_hdr.msg_flags & MSG_TRUNC) ? (0) : (udp->batchHeaders[i].msg_len);
+	}
 
-	size_t rowSize = (size_t) lengthX * channels;
+	udp->batchReceived = (size_t) received;
+	udp->batchPosition = 0;
 
-	uint16_t *pixels = caerFrameEventGetPixelArrayUnsafe(caerFrameIteratorElement);
+	atomic_fetch_add_explicit(&udp->messagesReceived, U64T(received), memory_order_relaxed);
 
-	// Invert position of entire rows.
-	for (size_t y = 0; y < (size_t) lengthY; y++) {
-		size_t invY = (size_t) lengthY - 1 - y;
+	return (received);
+#else
+	UNUSED_ARGUMENT(state);
+	UNUSED_ARGUMENT(timeoutMs);
 
-		// Don't invert if no position change, this happens in the exact
-		// middle if lengthY is uneven.
-		if (y != invY) {
-			memcpy(&pixels[y * rowSize], &pixels[invY * rowSize], rowSize);
+	errno = ENOTSUP;
+	return (-1);
+#endif
+}
+
+// Put the received datagrams into the reorder window, until it is full of complete event packets.
+static void udpInputAddBatch(inputCommonState state) {
+	struct input_common_udp_data *udp = &state->udp;
+
+	while (udp->batchPosition < udp->batchReceived) {
+		if (!udpInputAddMessage(state, &udp->batch[udp->batchPosition])) {
+			// Retried once these event packets are delivered.
+			return;
 		}
+
+		udp->batchPosition++;
 	}
 }
-}
-}
 
-#ifdef ENABLE_INOUT_PNG_COMPRESSION
+/**
+ * Put a received datagram into its slot in the reorder window, based on its
+ * sequence number. The batch entry gets the slot's free buffer in exchange.
+ * Invalid, duplicate and late messages are discarded. If there is no space
+ * in the window, gives up on the event packet delivery is waiting for.
+ *
+ * @return true if the datagram was handled, false if there is no space in
+ *         the window until the complete event packets in it are delivered.
+ */
+static bool udpInputAddMessage(inputCommonState state, struct input_common_udp_message *message) {
+	struct input_common_udp_data *udp = &state->udp;
 
-static void caerLibPNGReadBuffer(png_structp png_ptr, png_bytep data, png_size_t length);
-static bool decompressFramePNG(inputCommonState state, caerEventPacketHeader packet, size_t packetSize);
+	// Received datagrams carry their full length in dataLength.
+	size_t length = message->dataLength;
 
-// Simple structure to store PNG image bytes.
-struct caer_libpng_buffer {
-	uint8_t *buffer;
-	size_t size;
-	size_t pos;
-};
+	if (length < AEDAT3_NETWORK_HEADER_LENGTH) {
+		atomic_fetch_add_explicit(&udp->messagesDiscarded, 1, memory_order_relaxed);
+		return (true);
+	}
 
-static void caerLibPNGReadBuffer(png_structp png_ptr, png_bytep data, png_size_t length) {
-	struct caer_libpng_buffer *p = (struct caer_libpng_buffer *) png_get_io_ptr(png_ptr);
-	size_t newPos                = p->pos + length;
+	struct aedat3_network_header networkHeader = caerParseNetworkHeader(message->buffer);
 
-	// Detect attempts to read past buffer end.
-	if (newPos > p->size) {
-		png_error(png_ptr, "Read Buffer Error");
+	if (networkHeader.magicNumber != AEDAT3_NETWORK_MAGIC_NUMBER) {
+		atomic_fetch_add_explicit(&udp->messagesDiscarded, 1, memory_order_relaxed);
+		return (true);
 	}
 
-	memcpy(data, p->buffer + p->pos, length);
-	p->pos += length;
-}
+	bool packetStart       = (U64T(networkHeader.sequenceNumber) & UDP_PACKET_START_BIT);
+	int64_t sequenceNumber = I64T(U64T(networkHeader.sequenceNumber) & ~UDP_PACKET_START_BIT);
 
-static inline enum caer_frame_event_color_channels caerFrameEventColorFromLibPNG(int channels) {
-	switch (channels) {
-		case PNG_COLOR_TYPE_GRAY:
-			return (GRAYSCALE);
-			break;
+	if (sequenceNumber < udp->nextSequenceNumber) {
+		// Duplicate or too late, delivery is already past it. Unless the sender started over.
+		if (++udp->oldMessages < udp->windowSize) {
+			atomic_fetch_add_explicit(&udp->messagesDiscarded, 1, memory_order_relaxed);
+			return (true);
+		}
 
-		case PNG_COLOR_TYPE_RGB:
-			return (RGB);
-			break;
+		caerModuleLog(state->parentModule, CAER_LOG_INFO,
+			"UDP sequence numbers went back from %" PRIi64 " to %" PRIi64 ", sender restarted.",
+			udp->nextSequenceNumber, sequenceNumber);
 
-		case PNG_COLOR_TYPE_RGBA:
-		default:
-			return (RGBA);
-			break;
+		udpInputResync(state);
 	}
-}
 
-static inline bool caerFrameEventPNGDecompress(uint8_t *inBuffer, size_t inSize, uint16_t *outBuffer, int32_t xSize,
-	int32_t ySize, enum caer_frame_event_color_channels channels) {
-	png_structp png_ptr = NULL;
-	png_infop info_ptr  = NULL;
+	udp->oldMessages = 0;
 
-	// Initialize the write struct.
-	png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
-	if (png_ptr == NULL) {
-		return (false);
-	}
+	if (udp->nextSequenceNumber < 0) {
+		// Start at the first event packet beginning. Messages of an earlier,
+		// or of this packet arriving before its start, are not recoverable.
+		if (!packetStart) {
+			atomic_fetch_add_explicit(&udp->messagesDiscarded, 1, memory_order_relaxed);
+			return (true);
+		}
 
-	// Initialize the info struct.
-	info_ptr = png_create_info_struct(png_ptr);
-	if (info_ptr == NULL) {
-		png_destroy_read_struct(&png_ptr, NULL, NULL);
-		return (false);
+		udp->nextSequenceNumber = sequenceNumber;
 	}
 
-	// Set up error handling.
-	if (setjmp(png_jmpbuf(png_ptr))) {
-		png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
-		return (false);
+	// No space left in the window: give up on the event packet delivery is
+	// waiting for. Complete ones are never given up on, they're delivered first.
+	while (sequenceNumber >= (udp->nextSequenceNumber + (int64_t) udp->windowSize)) {
+		if (udp->nextSequenceNumber > udp->highestSequenceNumber) {
+			// Nothing in the window, just jump ahead.
+			udpInputAdvance(state, sequenceNumber - (int64_t) udp->windowSize + 1);
+			break;
+		}
+
+		if (udpInputPacketComplete(state) > 0) {
+			return (false);
+		}
+
+		udpInputSkip(state);
 	}
 
-	// Handle endianness of 16-bit depth pixels correctly.
-	// PNG assumes big-endian, our Frame Event is always little-endian.
-	png_set_swap(png_ptr);
+	struct input_common_udp_message *slot = &udp->window[U64T(sequenceNumber) % udp->windowSize];
 
-	// Set read function to buffer one.
-	struct caer_libpng_buffer state = {.buffer = inBuffer, .size = inSize, .pos = 0};
-	png_set_read_fn(png_ptr, &state, &caerLibPNGReadBuffer);
+	if (slot->sequenceNumber == sequenceNumber) {
+		// Duplicate.
+		atomic_fetch_add_explicit(&udp->messagesDiscarded, 1, memory_order_relaxed);
+		return (true);
+	}
 
-	// Read the whole PNG image.
-	png_read_png(png_ptr, info_ptr, PNG_TRANSFORM_IDENTITY, NULL);
+	uint8_t *freeBuffer = slot->buffer;
 
-	// Extract header info.
-	png_uint_32 width = 0, height = 0;
-	int bitDepth = 0;
-	int color    = -1;
-	png_get_IHDR(png_ptr, info_ptr, &width, &height, &bitDepth, &color, NULL, NULL, NULL);
+	slot->sequenceNumber = sequenceNumber;
+	slot->packetStart    = packetStart;
+	slot->dataLength     = length - AEDAT3_NETWORK_HEADER_LENGTH;
+	slot->buffer         = message->buffer;
 
-	// Check header info against known values from our frame event header.
-	if ((I32T(width) != xSize) || (I32T(height) != ySize) || (bitDepth != 16)
-		|| (caerFrameEventColorFromLibPNG(color) != channels)) {
-		png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
-		return (false);
+	message->buffer = freeBuffer;
+
+	if (sequenceNumber > udp->highestSequenceNumber) {
+		udp->highestSequenceNumber = sequenceNumber;
 	}
 
-	// Extract image data, row by row.
-	png_size_t row_bytes    = png_get_rowbytes(png_ptr, info_ptr);
-	png_bytepp row_pointers = png_get_rows(png_ptr, info_ptr);
+	return (true);
+}
 
-	for (size_t y = 0; y < (size_t) ySize; y++) {
-		memcpy(&outBuffer[y * row_bytes], row_pointers[y], row_bytes);
-	}
+static void udpInputResync(inputCommonState state) {
+	struct input_common_udp_data *udp = &state->udp;
 
-	// Destroy main structs.
-	png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
+	for (size_t i = 0; i < udp->windowSize; i++) {
+		if (udp->window[i].sequenceNumber >= 0) {
+			udp->window[i].sequenceNumber = -1;
+			atomic_fetch_add_explicit(&udp->messagesDiscarded, 1, memory_order_relaxed);
+		}
+	}
 
-	return (true);
+	udp->nextSequenceNumber    = -1;
+	udp->highestSequenceNumber = -1;
+	udp->oldMessages           = 0;
+	udp->deliverEnd            = -1;
+	udp->deliverOffset         = 0;
+	udp->blocked               = false;
 }
 
-static bool decompressFramePNG(inputCommonState state, caerEventPacketHeader packet, size_t packetSize) {
-	// We want to avoid allocating new memory for each PNG decompression, and moving around things
-	// to much. So we first go through the compressed header+data blocks, and move them to their
-	// correct position for an in-memory frame packet (so at N*eventSize). Then we decompress the
-	// PNG block and directly copy the results into the space that it was occupying (plus extra for
-	// the uncompressed pixels).
-	// First we go once through the events to know where they are, and where they should go.
-	// Then we do memory move + PNG decompression, starting from the last event (back-side), so as
-	// to not overwrite memory we still need and haven't moved yet.
-	int32_t eventSize   = caerEventPacketHeaderGetEventSize(packet);
-	int32_t eventNumber = caerEventPacketHeaderGetEventNumber(packet);
+/**
+ * Move delivery forward to the given sequence number, giving up on all
+ * messages before it: missing ones are lost, received ones are discarded,
+ * together with the event packets they belong to.
+ */
+static void udpInputAdvance(inputCommonState state, int64_t targetSequenceNumber) {
+	struct input_common_udp_data *udp = &state->udp;
 
-	struct {
-		size_t offsetDestination;
-		size_t offset;
-		size_t size;
-		bool isCompressed;
-	} eventMemory[eventNumber];
+	// Messages after the highest received one can't be in the window.
+	int64_t endSequenceNumber = (targetSequenceNumber <= udp->highestSequenceNumber)
+									? (targetSequenceNumber)
+									: (udp->highestSequenceNumber + 1);
+	int64_t found = 0;
 
-	size_t currPacketOffset = CAER_EVENT_PACKET_HEADER_SIZE; // Start here, no change to header.
-	// '- sizeof(uint16_t)' to compensate for pixels[1] at end of struct for C++ compatibility.
-	size_t frameEventHeaderSize = (sizeof(struct caer_frame_event) - sizeof(uint16_t));
+	for (int64_t seq = udp->nextSequenceNumber; seq < endSequenceNumber; seq++) {
+		struct input_common_udp_message *slot = &udp->window[U64T(seq) % udp->windowSize];
 
-	// Gather information on events.
-	for (int32_t i = 0; i < eventNumber; i++) {
-		// In-memory packet's events have to go where N*eventSize is.
-		eventMemory[i].offsetDestination = CAER_EVENT_PACKET_HEADER_SIZE + (size_t)(i * eventSize);
-		eventMemory[i].offset            = currPacketOffset;
+		if (slot->sequenceNumber == seq) {
+			if (slot->packetStart) {
+				atomic_fetch_add_explicit(&udp->packetsDropped, 1, memory_order_relaxed);
+			}
 
-		caerFrameEvent frameEvent = (caerFrameEvent)(((uint8_t *) packet) + currPacketOffset);
+			slot->sequenceNumber = -1;
+			found++;
+		}
+	}
 
-		// Bit 31 of info signals if event is PNG-compressed or not.
-		eventMemory[i].isCompressed = GET_NUMBITS32(frameEvent->info, 31, 0x01);
+	atomic_fetch_add_explicit(&udp->messagesDiscarded, U64T(found), memory_order_relaxed);
+	atomic_fetch_add_explicit(
+		&udp->messagesLost, U64T(targetSequenceNumber - udp->nextSequenceNumber - found), memory_order_relaxed);
 
-		if (eventMemory[i].isCompressed) {
-			// Clear compression enabled bit.
-			CLEAR_NUMBITS32(frameEvent->info, 31, 0x01);
+	udp->nextSequenceNumber = targetSequenceNumber;
+	udp->deliverOffset      = 0;
+	udp->blocked            = false;
+}
 
-			// Compressed block size is held in an integer right after the header.
-			int32_t pngSize = le32toh(*((int32_t *) (((uint8_t *) frameEvent) + frameEventHeaderSize)));
+// Give up on the event packet delivery is waiting for, continue at the next one received.
+static void udpInputSkip(inputCommonState state) {
+	struct input_common_udp_data *udp = &state->udp;
 
-			// PNG size is header plus integer plus compressed block size.
-			eventMemory[i].size = frameEventHeaderSize + sizeof(int32_t) + (size_t) pngSize;
-		}
-		else {
-			// Normal size is header plus uncompressed pixels.
-			eventMemory[i].size = frameEventHeaderSize + caerFrameEventGetPixelsSize(frameEvent);
+	int64_t seq = udp->nextSequenceNumber + 1;
+
+	for (; seq <= udp->highestSequenceNumber; seq++) {
+		struct input_common_udp_message *slot = &udp->window[U64T(seq) % udp->windowSize];
+
+		if ((slot->sequenceNumber == seq) && slot->packetStart) {
+			break;
 		}
+	}
 
-		// Update counter.
-		currPacketOffset += eventMemory[i].size;
+	udpInputAdvance(state, seq);
+}
+
+/**
+ * Check if all messages of the event packet starting at the next sequence
+ * number to deliver have been received, and fit together.
+ *
+ * @return number of messages of the complete event packet, 0 if some are
+ *         still missing, -1 if the messages can never form a valid packet.
+ */
+static int64_t udpInputPacketComplete(inputCommonState state) {
+	struct input_common_udp_data *udp = &state->udp;
+
+	if ((udp->nextSequenceNumber < 0) || (udp->nextSequenceNumber > udp->highestSequenceNumber)) {
+		// Nothing received yet.
+		return (0);
 	}
 
-	// Check that we indeed parsed everything correctly.
-	if (currPacketOffset != packetSize) {
-		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to decompress frame event. "
-														   "Size after event parsing and packet size don't match.");
-		return (false);
+	struct input_common_udp_message *first = &udp->window[U64T(udp->nextSequenceNumber) % udp->windowSize];
+
+	if (first->sequenceNumber != udp->nextSequenceNumber) {
+		// Missing, may still arrive.
+		return (0);
 	}
 
-	// Now move memory and decompress in reverse order.
-	for (int32_t i = eventNumber; i >= 0; i--) {
-		// Move memory from compressed position to uncompressed, in-memory position.
-		memmove(((uint8_t *) packet) + eventMemory[i].offsetDestination, ((uint8_t *) packet) + eventMemory[i].offset,
-			eventMemory[i].size);
+	if (!first->packetStart || (first->dataLength < CAER_EVENT_PACKET_HEADER_SIZE)) {
+		// Event packet start was lost, or is broken.
+		return (-1);
+	}
 
-		// If event is PNG-compressed, decompress it now.
-		if (eventMemory[i].isCompressed) {
-			uint8_t *pngBuffer
-				= ((uint8_t *) packet) + eventMemory[i].offsetDestination + frameEventHeaderSize + sizeof(int32_t);
-			size_t pngBufferSize = eventMemory[i].size - frameEventHeaderSize - sizeof(int32_t);
+	// Sizes as in aedat3GetPacket(): compressed packets carry their size in eventCapacity.
+	caerEventPacketHeader packet = (caerEventPacketHeader)(first->buffer + AEDAT3_NETWORK_HEADER_LENGTH);
 
-			caerFrameEvent frameEvent = (caerFrameEvent)(((uint8_t *) packet) + eventMemory[i].offsetDestination);
+	size_t packetDataSize = (caerEventPacketHeaderGetEventType(packet) & 0x8000)
+								? ((size_t) caerEventPacketHeaderGetEventCapacity(packet))
+								: ((size_t)(caerEventPacketHeaderGetEventNumber(packet)
+											* caerEventPacketHeaderGetEventSize(packet)));
+	size_t packetSize = CAER_EVENT_PACKET_HEADER_SIZE + packetDataSize;
 
-			if (!caerFrameEventPNGDecompress(pngBuffer, pngBufferSize, caerFrameEventGetPixelArrayUnsafe(frameEvent),
-					caerFrameEventGetLengthX(frameEvent), caerFrameEventGetLengthY(frameEvent),
-					caerFrameEventGetChannelNumber(frameEvent))) {
-				// Failed to decompress PNG.
-				caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to decompress frame event. "
-																   "PNG decompression failure.");
-				return (false);
-			}
+	size_t messagesNumber = (packetSize + AEDAT3_MAX_UDP_SIZE - 1) / AEDAT3_MAX_UDP_SIZE;
+	if (messagesNumber > udp->windowSize) {
+		caerModuleLog(state->parentModule, CAER_LOG_WARNING,
+			"Event packet of %zu bytes doesn't fit the UDP reorder window, dropping it.", packetSize);
+		return (-1);
+	}
+
+	// All messages are full, except the last one.
+	for (size_t i = 0; i < messagesNumber; i++) {
+		int64_t seq                           = udp->nextSequenceNumber + (int64_t) i;
+		struct input_common_udp_message *slot = &udp->window[U64T(seq) % udp->windowSize];
+
+		if (slot->sequenceNumber != seq) {
+			return (0);
 		}
 
-		// Uncompressed size will always be header + uncompressed pixels.
-		caerFrameEvent frameEvent = (caerFrameEvent)(((uint8_t *) packet) + eventMemory[i].offsetDestination);
-		size_t uncompressedSize   = frameEventHeaderSize + caerFrameEventGetPixelsSize(frameEvent);
+		size_t expectedLength
+			= (i == (messagesNumber - 1)) ? (packetSize - (i * AEDAT3_MAX_UDP_SIZE)) : (AEDAT3_MAX_UDP_SIZE);
 
-		// Initialize the rest of the memory of the event to zeros, to comply with spec
-		// that says non-pixels at the end, if they exist, are always zero.
-		memset(((uint8_t *) packet) + eventMemory[i].offsetDestination + uncompressedSize, 0,
-			(size_t) eventSize - uncompressedSize);
+		if (((i != 0) && slot->packetStart) || (slot->dataLength != expectedLength)) {
+			return (-1);
+		}
 	}
 
-	return (true);
+	return ((int64_t) messagesNumber);
 }
 
-#endif
+/**
+ * Copy complete event packets, in sequence order, into the given buffer.
+ * Before the first packet, the network header is copied too, to be parsed
+ * like the one from stream-based inputs. Event packets can span buffers.
+ *
+ * @return number of bytes copied, 0 if there is nothing to deliver.
+ */
+static size_t udpInputDeliver(inputCommonState state, uint8_t *buffer, size_t bufferSize) {
+	struct input_common_udp_data *udp = &state->udp;
+	size_t copied                     = 0;
 
-static bool decompressTimestampSerialize(inputCommonState state, caerEventPacketHeader packet, size_t packetSize) {
-	// To decompress this, we have to allocate memory to hold the expanded events. There is
-	// no efficient way to avoid this; working backwards from the last compressed event might
-	// be an option, but you'd have to track where all the events are during a first forward
-	// pass, and keeping track of offset, ts, numEvents for each group would incur similar
-	// memory consumption, while considerably increasing complexity. So let's just do the
-	// simple thing.
-	int32_t eventSize     = caerEventPacketHeaderGetEventSize(packet);
-	int32_t eventNumber   = caerEventPacketHeaderGetEventNumber(packet);
-	int32_t eventTSOffset = caerEventPacketHeaderGetEventTSOffset(packet);
-
-	uint8_t *events = malloc((size_t)(eventNumber * eventSize));
-	if (events == NULL) {
-		// Memory allocation failure.
-		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to decode serialized timestamp. "
-														   "Memory allocation failure.");
-		return (false);
-	}
+	if (!udp->headerDelivered) {
+		if (udp->nextSequenceNumber < 0) {
+			return (0);
+		}
 
-	size_t currPacketOffset        = CAER_EVENT_PACKET_HEADER_SIZE; // Start here, no change to header.
-	size_t recoveredEventsPosition = 0;
-	size_t recoveredEventsNumber   = 0;
+		// Synchronization always happens on a start message, it's right there.
+		memcpy(buffer, udp->window[U64T(udp->nextSequenceNumber) % udp->windowSize].buffer,
+			AEDAT3_NETWORK_HEADER_LENGTH);
 
-	while (currPacketOffset < packetSize) {
-		void *firstEvent = ((uint8_t *) packet) + currPacketOffset;
-		int32_t currTS   = caerGenericEventGetTimestamp(firstEvent, packet);
+		udp->headerDelivered = true;
+		copied               = AEDAT3_NETWORK_HEADER_LENGTH;
+	}
 
-		if (currTS & I32T(0x80000000)) {
-			// Compressed run starts here! Must clear the compression bit from
-			// this first timestamp and restore the timestamp to the others.
-			// So first we clean the timestamp.
-			currTS &= I32T(0x7FFFFFFF);
+	while (copied < bufferSize) {
+		if (udp->nextSequenceNumber >= udp->deliverEnd) {
+			// Between event packets, see if the next one is ready.
+			int64_t messagesNumber = udpInputPacketComplete(state);
 
-			// Then we fix the first event timestamp and copy it over.
-			caerGenericEventSetTimestamp(firstEvent, packet, currTS);
-			memcpy(events + recoveredEventsPosition, firstEvent, (size_t) eventSize);
+			if (messagesNumber == 0) {
+				break;
+			}
 
-			currPacketOffset += (size_t) eventSize;
-			recoveredEventsPosition += (size_t) eventSize;
-			recoveredEventsNumber++;
+			if (messagesNumber < 0) {
+				udpInputSkip(state);
+				continue;
+			}
 
-			// Then we get the second event, and get its timestamp, which is
-			// actually the size of the following compressed run.
-			void *secondEvent = ((uint8_t *) packet) + currPacketOffset;
-			int32_t tsRun     = caerGenericEventGetTimestamp(secondEvent, packet);
+			udp->deliverEnd    = udp->nextSequenceNumber + messagesNumber;
+			udp->deliverOffset = 0;
+			udp->blocked       = false;
+		}
 
-			// And fix its own timestamp back to what it should be, and copy it.
-			caerGenericEventSetTimestamp(secondEvent, packet, currTS);
-			memcpy(events + recoveredEventsPosition, secondEvent, (size_t) eventSize);
+		struct input_common_udp_message *slot = &udp->window[U64T(udp->nextSequenceNumber) % udp->windowSize];
 
-			currPacketOffset += (size_t) eventSize;
-			recoveredEventsPosition += (size_t) eventSize;
-			recoveredEventsNumber++;
+		size_t copySize = slot->dataLength - udp->deliverOffset;
+		if (copySize > (bufferSize - copied)) {
+			copySize = bufferSize - copied;
+		}
 
-			// Now go through the compressed, data-only events, and restore their
-			// timestamp. We do this by copying the data and then adding the timestamp,
-			// which is always the last in an event.
-			while (tsRun > 0) {
-				void *thirdEvent = ((uint8_t *) packet) + currPacketOffset;
-				memcpy(events + recoveredEventsPosition, thirdEvent, (size_t) eventTSOffset);
+		memcpy(buffer + copied, slot->buffer + AEDAT3_NETWORK_HEADER_LENGTH + udp->deliverOffset, copySize);
 
-				currPacketOffset += (size_t) eventTSOffset;
-				recoveredEventsPosition += (size_t) eventTSOffset;
+		copied += copySize;
+		udp->deliverOffset += copySize;
 
-				int32_t *newTS = (int32_t *) (events + recoveredEventsPosition);
-				*newTS         = currTS;
+		if (udp->deliverOffset == slot->dataLength) {
+			slot->sequenceNumber = -1;
 
-				recoveredEventsPosition += sizeof(int32_t);
+			udp->nextSequenceNumber++;
+			udp->deliverOffset = 0;
 
-				recoveredEventsNumber++;
-				tsRun--;
+			if (udp->nextSequenceNumber == udp->deliverEnd) {
+				atomic_fetch_add_explicit(&udp->packetsReassembled, 1, memory_order_relaxed);
 			}
 		}
-		else {
-			// Normal event, nothing compressed.
-			// Just copy and advance.
-			memcpy(events + recoveredEventsPosition, firstEvent, (size_t) eventSize);
-
-			currPacketOffset += (size_t) eventSize;
-			recoveredEventsPosition += (size_t) eventSize;
-			recoveredEventsNumber++;
-		}
 	}
 
-	// Check we really recovered all events from compression.
-	if (currPacketOffset != packetSize) {
-		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to decode serialized timestamp. "
-														   "Length of compressed packet and read data don't match.");
-		return (false);
-	}
+	return (copied);
+}
 
-	if ((size_t)(eventNumber * eventSize) != recoveredEventsPosition) {
-		caerModuleLog(state->parentModule, CAER_LOG_ERROR,
-			"Failed to decode serialized timestamp. "
-			"Length of uncompressed packet and uncompressed data don't match.");
-		return (false);
-	}
+/**
+ * Fill the data buffer with the next reassembled event packets from UDP.
+ * Returns as soon as there is any data, so latency stays low. While waiting
+ * on missing messages, gives up on them after the reorder timeout.
+ *
+ * @return number of bytes in the data buffer, 0 if stopped, -1 on error (errno set).
+ */
+static ssize_t udpInputNextBuffer(inputCommonState state) {
+	struct input_common_udp_data *udp = &state->udp;
 
-	if ((size_t) eventNumber != recoveredEventsNumber) {
-		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to decode serialized timestamp. "
-														   "Number of expected and recovered events don't match.");
-		return (false);
-	}
+	while (atomic_load_explicit(&state->running, memory_order_relaxed)) {
+		size_t copied = udpInputDeliver(state, state->dataBuffer->buffer, state->dataBuffer->bufferSize);
+		if (copied > 0) {
+			return ((ssize_t) copied);
+		}
+
+		// Nothing to deliver, continue with the rest of the received datagrams.
+		if (udp->batchPosition < udp->batchReceived) {
+			udpInputAddBatch(state);
+			continue;
+		}
 
-	// Copy recovered event packet into original.
-	memcpy(((uint8_t *) packet) + CAER_EVENT_PACKET_HEADER_SIZE, events, recoveredEventsPosition);
+		int64_t waitTime = INOUT_QUEUE_WAIT_TIME;
 
-	free(events);
+		if ((udp->nextSequenceNumber >= 0) && (udp->nextSequenceNumber <= udp->highestSequenceNumber)) {
+			// Later messages are there, but delivery is waiting on missing ones.
+			struct timespec currentTime;
+			portable_clock_gettime_monotonic(&currentTime);
 
-	return (true);
-}
+			if (!udp->blocked) {
+				udp->blocked      = true;
+				udp->blockedSince = currentTime;
+			}
 
-static bool decompressEventPacket(inputCommonState state, caerEventPacketHeader packet, size_t packetSize) {
-	bool retVal = false;
+			int64_t blockedTime = I64T(currentTime.tv_sec - udp->blockedSince.tv_sec) * 1000000LL
+								  + I64T(currentTime.tv_nsec - udp->blockedSince.tv_nsec) / 1000;
 
-	// Data compression technique 1: serialized timestamps.
-	if ((state->header.formatID & 0x01) && caerEventPacketHeaderGetEventType(packet) == POLARITY_EVENT) {
-		retVal = decompressTimestampSerialize(state, packet, packetSize);
-	}
+			if (blockedTime >= udp->reorderTimeout) {
+				udpInputSkip(state);
+				continue;
+			}
 
-#ifdef ENABLE_INOUT_PNG_COMPRESSION
-	// Data compression technique 2: frame PNG compression.
-	if ((state->header.formatID & 0x02) && caerEventPacketHeaderGetEventType(packet) == FRAME_EVENT) {
-		retVal = decompressFramePNG(state, packet, packetSize);
+			waitTime = udp->reorderTimeout - blockedTime;
+		}
+
+		// Round up, poll() works in ms.
+		if (udpInputReceive(state, (int) ((waitTime + 999) / 1000)) < 0) {
+			return (-1);
+		}
 	}
-#endif
 
-	return (retVal);
+	return (0);
 }
 
 static int inputReaderThread(void *stateArg) {
@@ -1244,9 +3519,53 @@ static int inputReaderThread(void *stateArg) {
 			}
 		}
 
-		// Read data from disk or socket.
-		ssize_t result = readUntilDone(state->fileDescriptor, state->dataBuffer->buffer, state->dataBuffer->bufferSize);
+		// Move to a new position in the file, if requested.
+		if (atomic_load_explicit(&state->seek.readerRequest, memory_order_relaxed)) {
+			inputReaderSeek(state);
+		}
+
+		// Read data from disk or socket, or map the next part of the file.
+		ssize_t result;
+
+		if (state->mmap.enabled) {
+			result = mmapInputNextWindow(state);
+		}
+		else if (state->isNetworkMessageBased) {
+			result = udpInputNextBuffer(state);
+
+			// There is no end of stream with UDP, no data means we're stopping.
+			if (result == 0) {
+				break;
+			}
+
+			state->dataView.buffer         = state->dataBuffer->buffer;
+			state->dataView.bufferUsedSize = (result > 0) ? ((size_t) result) : (0);
+			state->dataView.bufferPosition = 0;
+		}
+		else if (state->streamDecoder.format != STREAM_UNCOMPRESSED) {
+			result = streamDecoderRead(state, state->dataBuffer->buffer, state->dataBuffer->bufferSize);
+
+			// Go and parse the full buffer, starting at position 0.
+			state->dataView.buffer         = state->dataBuffer->buffer;
+			state->dataView.bufferUsedSize = (result > 0) ? ((size_t) result) : (0);
+			state->dataView.bufferPosition = 0;
+		}
+		else {
+			result = readUntilDone(state->fileDescriptor, state->dataBuffer->buffer, state->dataBuffer->bufferSize);
+
+			// Go and parse the full buffer, starting at position 0.
+			state->dataView.buffer         = state->dataBuffer->buffer;
+			state->dataView.bufferUsedSize = (result > 0) ? ((size_t) result) : (0);
+			state->dataView.bufferPosition = 0;
+		}
+
 		if (result <= 0) {
+			// Packets still being decompressed come before the stop.
+			if (decompressPoolForward(state, 0) < 0) {
+				atomic_store(&state->inputReaderThreadState, ERROR_DATA); // Error in Data
+				break;
+			}
+
 			// Error or EOF with no data. Let's just stop at this point.
 			close(state->fileDescriptor);
 			state->fileDescriptor = -1;
@@ -1254,6 +3573,17 @@ static int inputReaderThread(void *stateArg) {
 			// Distinguish EOF from errors based upon errno value.
 			if (result == 0) {
 				caerModuleLog(state->parentModule, CAER_LOG_INFO, "Reached End of File.");
+
+				// Keep going from memory, if the whole file could be stored there.
+				if (state->replay.collecting && (state->replay.storeSize > 0)) {
+					state->replay.collecting = false;
+
+					if (!replayCacheLoop(state)) {
+						atomic_store(&state->inputReaderThreadState, ERROR_DATA); // Error in Data
+					}
+					break;
+				}
+
 				atomic_store(&state->inputReaderThreadState, EOF_REACHED); // EOF
 			}
 			else {
@@ -1262,15 +3592,21 @@ static int inputReaderThread(void *stateArg) {
 			}
 			break;
 		}
-		state->dataBuffer->bufferUsedSize = (size_t) result;
-
 		// Parse header and setup header info structure.
-		if (!atomic_load_explicit(&state->header.isValidHeader, memory_order_relaxed) && !parseHeader(state)) {
-			// Header invalid, exit.
-			caerModuleLog(state->parentModule, CAER_LOG_ERROR,
-				"Failed to parse header. Only AEDAT 2.X and 3.x compliant files are supported.");
-			atomic_store(&state->inputReaderThreadState, ERROR_HEADER); // Error in Header
-			break;
+		if (!atomic_load_explicit(&state->header.isValidHeader, memory_order_relaxed)) {
+			if (!parseHeader(state)) {
+				// Header invalid, exit.
+				caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+					"Failed to parse header. Only AEDAT 2.X and 3.x compliant files are supported.");
+				atomic_store(&state->inputReaderThreadState, ERROR_HEADER); // Error in Header
+				break;
+			}
+
+			// Packets start right after the header, the indexer begins there.
+			if (!state->isNetworkStream) {
+				atomic_store(&state->index.dataStart, state->dataBufferOffset + state->dataView.bufferPosition);
+				caerQueuePut(state->index.dataStartSignal, state);
+			}
 		}
 
 		// Parse event data now.
@@ -1281,15 +3617,15 @@ static int inputReaderThread(void *stateArg) {
 			break;
 		}
 
-		// Go and get a full buffer on next iteration again, starting at position 0.
-		state->dataBuffer->bufferPosition = 0;
-
 		// Update offset. Makes sense for files only.
 		if (!state->isNetworkStream) {
-			state->dataBufferOffset += state->dataBuffer->bufferUsedSize;
+			state->dataBufferOffset += state->dataView.bufferUsedSize;
 		}
 	}
 
+	// The assembler may be waiting for more packets, let it see why there are none.
+	caerQueueWakeUp(state->transferRingPackets);
+
 	return (thrd_success);
 }
 
@@ -1327,11 +3663,12 @@ static inline void updateSizeCommitCriteria(inputCommonState state, caerEventPac
  * @return true on successful packet merge, false on failure (memory allocation).
  */
 static bool addToPacketContainer(inputCommonState state, caerEventPacketHeader newPacket, packetData newPacketData) {
-	bool packetAlreadyExists      = false;
-	caerEventPacketHeader *packet = NULL;
-	while ((packet = (caerEventPacketHeader *) utarray_next(state->packetContainer.eventPackets, packet)) != NULL) {
-		int16_t packetEventType = caerEventPacketHeaderGetEventType(*packet);
-		int32_t packetEventSize = caerEventPacketHeaderGetEventSize(*packet);
+	bool packetAlreadyExists                    = false;
+	struct input_common_pending_packet *pending = NULL;
+	while ((pending = (struct input_common_pending_packet *) utarray_next(state->packetContainer.eventPackets, pending))
+		   != NULL) {
+		int16_t packetEventType = caerEventPacketHeaderGetEventType(pending->packet);
+		int32_t packetEventSize = caerEventPacketHeaderGetEventSize(pending->packet);
 
 		if (packetEventType == newPacketData->eventType && packetEventSize == newPacketData->eventSize) {
 			// Packet with this type and event size already present.
@@ -1342,10 +3679,11 @@ static bool addToPacketContainer(inputCommonState state, caerEventPacketHeader n
 
 	// Packet with same type and event size as newPacket found, do merge operation.
 	if (packetAlreadyExists) {
-		// Merge newPacket with '*packet'. Since packets from the same source,
+		// Merge newPacket with the pending packet. Since packets from the same source,
 		// and having the same time, are guaranteed to have monotonic timestamps,
-		// the merge operation becomes a simple append operation.
-		caerEventPacketHeader mergedPacket = caerEventPacketAppend(*packet, newPacket);
+		// the merge operation becomes a simple append operation. Appending reallocates,
+		// so any remainder of a previous split has to move back to the start first.
+		caerEventPacketHeader mergedPacket = caerEventPacketAppend(pendingPacketCompact(pending), newPacket);
 		if (mergedPacket == NULL) {
 			caerModuleLog(state->parentModule, CAER_LOG_ERROR,
 				"%s: Failed to allocate memory for packet merge operation.", __func__);
@@ -1355,12 +3693,14 @@ static bool addToPacketContainer(inputCommonState state, caerEventPacketHeader n
 		// Merged content with existing packet, data copied: free new one.
 		// Update references to old/new packets to point to merged one.
 		free(newPacket);
-		*packet   = mergedPacket;
-		newPacket = mergedPacket;
+		pending->memory = mergedPacket;
+		pending->packet = mergedPacket;
+		newPacket       = mergedPacket;
 	}
 	else {
 		// No previous packet of this type and event size found, use this one directly.
-		utarray_push_back(state->packetContainer.eventPackets, &newPacket);
+		struct input_common_pending_packet newPending = {.memory = newPacket, .packet = newPacket};
+		utarray_push_back(state->packetContainer.eventPackets, &newPending);
 
 		utarray_sort(state->packetContainer.eventPackets, &packetsFirstTypeThenSizeCmp);
 	}
@@ -1371,6 +3711,103 @@ static bool addToPacketContainer(inputCommonState state, caerEventPacketHeader n
 	return (true);
 }
 
+/**
+ * Move the events of a pending packet back to the start of its memory block,
+ * undoing the offset left by previous splits, so that the result is again a
+ * normal packet that can be reallocated, freed or sent on to other modules.
+ * The events before the current offset were already sent, so it is always
+ * safe to overwrite them.
+ *
+ * @param pending pending packet to compact.
+ *
+ * @return the compacted packet, same as pending->memory.
+ */
+static caerEventPacketHeader pendingPacketCompact(struct input_common_pending_packet *pending) {
+	if (pending->packet != pending->memory) {
+		int32_t eventSize   = caerEventPacketHeaderGetEventSize(pending->packet);
+		int32_t eventNumber = caerEventPacketHeaderGetEventNumber(pending->packet);
+
+		memmove(pending->memory, pending->packet, CAER_EVENT_PACKET_HEADER_SIZE + (size_t)(eventSize * eventNumber));
+
+		pending->packet = pending->memory;
+	}
+
+	return (pending->memory);
+}
+
+/**
+ * Search for the cutoff point in a packet, either reaching the size limit first,
+ * or then the time limit. Timestamps inside a packet are monotonic, so the first
+ * event past the wanted time can be found with a binary search instead of looking
+ * at every single event.
+ *
+ * @param state common input data structure.
+ * @param packet packet to search in.
+ *
+ * @return index of first event not to send now, or -1 if all of them can be sent.
+ */
+static int32_t findCutoffIndex(inputCommonState state, caerEventPacketHeader packet) {
+	int32_t eventNumber = caerEventPacketHeaderGetEventNumber(packet);
+
+	// The events up to the size limit can at most be sent.
+	int32_t upperBound     = eventNumber;
+	int64_t timestampLimit = state->packetContainer.newContainerTimestampEnd;
+
+	if (state->packetContainer.sizeLimitHit) {
+		if (state->packetContainer.newContainerSizeLimit < upperBound) {
+			upperBound = state->packetContainer.newContainerSizeLimit;
+		}
+
+		if (state->packetContainer.sizeLimitTimestamp < timestampLimit) {
+			timestampLimit = state->packetContainer.sizeLimitTimestamp;
+		}
+	}
+
+	// Find the first event with a timestamp bigger than the limit, in [0, upperBound).
+	int32_t low  = 0;
+	int32_t high = upperBound;
+
+	while (low < high) {
+		int32_t middle = low + ((high - low) / 2);
+
+		const void *event = caerGenericEventGetEvent(packet, middle);
+
+		if (caerGenericEventGetTimestamp64(event, packet) > timestampLimit) {
+			high = middle;
+		}
+		else {
+			low = middle + 1;
+		}
+	}
+
+	return ((low == eventNumber) ? (-1) : (low));
+}
+
+/**
+ * Count the valid events in the range [start, end) of a packet.
+ * The valid mark is always the lowest bit of the first byte of an event,
+ * so this just sums up those bits, without any branches in the loop.
+ *
+ * @param packet packet to count valid events in.
+ * @param start first event index to look at.
+ * @param end first event index not to look at anymore.
+ *
+ * @return number of valid events in range.
+ */
+static int32_t countValidEvents(caerEventPacketHeader packet, int32_t start, int32_t end) {
+	size_t eventSize    = (size_t) caerEventPacketHeaderGetEventSize(packet);
+	const uint8_t *mark = caerGenericEventGetEvent(packet, start);
+
+	int32_t validEvents = 0;
+
+	for (int32_t i = start; i < end; i++) {
+		validEvents += (mark[0] & 0x01);
+		mark += eventSize;
+	}
+
+	return (validEvents);
+}
+
 static caerEventPacketContainer generatePacketContainer(inputCommonState state, bool forceFlush) {
 	// Let's generate a packet container, use the size of the event packets array as upper bound.
 	int32_t packetContainerPosition = 0;
@@ -1383,10 +3820,12 @@ static caerEventPacketContainer generatePacketContainer(inputCommonState state,
 	// When we force a flush commit, we put everything currently there in the packet
 	// container and return it, with no slicing being done at all.
 	if (forceFlush) {
-		caerEventPacketHeader *currPacket = NULL;
-		while ((currPacket = (caerEventPacketHeader *) utarray_next(state->packetContainer.eventPackets, currPacket))
+		struct input_common_pending_packet *pending = NULL;
+		while ((pending
+				   = (struct input_common_pending_packet *) utarray_next(state->packetContainer.eventPackets, pending))
 			   != NULL) {
-			caerEventPacketContainerSetEventPacket(packetContainer, packetContainerPosition++, *currPacket);
+			caerEventPacketContainerSetEventPacket(
+				packetContainer, packetContainerPosition++, pendingPacketCompact(pending));
 		}
 
 		// Clean packets array, they are all being sent out now.
@@ -1394,106 +3833,92 @@ static caerEventPacketContainer generatePacketContainer(inputCommonState state,
 	}
 	else {
 		// Iterate over each event packet, and slice out the relevant part in time.
-		caerEventPacketHeader *currPacket = NULL;
-		while ((currPacket = (caerEventPacketHeader *) utarray_next(state->packetContainer.eventPackets, currPacket))
+		struct input_common_pending_packet *pending = NULL;
+		while ((pending
+				   = (struct input_common_pending_packet *) utarray_next(state->packetContainer.eventPackets, pending))
 			   != NULL) {
-			// Search for cutoff point, either reaching the size limit first, or then the time limit.
-			// Also count valid events encountered for later setting the right values in the packet.
-			int32_t cutoffIndex     = -1;
-			int32_t validEventsSeen = 0;
-
-			CAER_ITERATOR_ALL_START(*currPacket, const void *)
-			int64_t caerIteratorElementTimestamp = caerGenericEventGetTimestamp64(caerIteratorElement, *currPacket);
-
-			if ((state->packetContainer.sizeLimitHit
-					&& ((caerIteratorCounter >= state->packetContainer.newContainerSizeLimit)
-						   || (caerIteratorElementTimestamp > state->packetContainer.sizeLimitTimestamp)))
-				|| (caerIteratorElementTimestamp > state->packetContainer.newContainerTimestampEnd)) {
-				cutoffIndex = caerIteratorCounter;
-				break;
+			int32_t cutoffIndex = findCutoffIndex(state, pending->packet);
+
+			// If there is no cutoff point, we can just send on the whole packet with no changes.
+			if (cutoffIndex == -1) {
+				caerEventPacketContainerSetEventPacket(
+					packetContainer, packetContainerPosition++, pendingPacketCompact(pending));
+
+				// Erase slot from packets array.
+				utarray_erase(state->packetContainer.eventPackets,
+					(size_t) utarray_eltidx(state->packetContainer.eventPackets, pending), 1);
+				pending
+					= (struct input_common_pending_packet *) utarray_prev(state->packetContainer.eventPackets, pending);
+				continue;
 			}
 
-			if (caerGenericEventIsValid(caerIteratorElement)) {
-				validEventsSeen++;
+			// If there is one on the other hand, we can only send up to that event.
+			// Special case is if the cutoff point is zero, meaning there's nothing to send.
+			if (cutoffIndex == 0) {
+				continue;
 			}
-		}
 
-		// If there is no cutoff point, we can just send on the whole packet with no changes.
-		if (cutoffIndex == -1) {
-			caerEventPacketContainerSetEventPacket(packetContainer, packetContainerPosition++, *currPacket);
+			caerEventPacketHeader currPacket = pending->packet;
 
-			// Erase slot from packets array.
-			utarray_erase(state->packetContainer.eventPackets,
-				(size_t) utarray_eltidx(state->packetContainer.eventPackets, currPacket), 1);
-			currPacket = (caerEventPacketHeader *) utarray_prev(state->packetContainer.eventPackets, currPacket);
-			continue;
-		}
+			int32_t currPacketEventSize   = caerEventPacketHeaderGetEventSize(currPacket);
+			int32_t currPacketEventValid  = caerEventPacketHeaderGetEventValid(currPacket);
+			int32_t currPacketEventNumber = caerEventPacketHeaderGetEventNumber(currPacket);
 
-		// If there is one on the other hand, we can only send up to that event.
-		// Special case is if the cutoff point is zero, meaning there's nothing to send.
-		if (cutoffIndex == 0) {
-			continue;
-		}
+			// Count valid events in the part to send. When all or none are valid, there
+			// is nothing to count. Else count in the shorter part and derive the other.
+			int32_t validEventsSeen;
 
-		int32_t currPacketEventSize   = caerEventPacketHeaderGetEventSize(*currPacket);
-		int32_t currPacketEventValid  = caerEventPacketHeaderGetEventValid(*currPacket);
-		int32_t currPacketEventNumber = caerEventPacketHeaderGetEventNumber(*currPacket);
+			if (currPacketEventValid == currPacketEventNumber) {
+				validEventsSeen = cutoffIndex;
+			}
+			else if (currPacketEventValid == 0) {
+				validEventsSeen = 0;
+			}
+			else if (cutoffIndex <= (currPacketEventNumber / 2)) {
+				validEventsSeen = countValidEvents(currPacket, 0, cutoffIndex);
+			}
+			else {
+				validEventsSeen = currPacketEventValid
+								  - countValidEvents(currPacket, cutoffIndex, currPacketEventNumber);
+			}
 
-		// Allocate a new packet, with space for the remaining events that we don't send off
-		// (the ones after cutoff point).
-		int32_t nextPacketEventNumber = currPacketEventNumber - cutoffIndex;
-		caerEventPacketHeader nextPacket
-			= malloc(CAER_EVENT_PACKET_HEADER_SIZE + (size_t)(currPacketEventSize * nextPacketEventNumber));
-		if (nextPacket == NULL) {
-			caerModuleLog(state->parentModule, CAER_LOG_CRITICAL,
-				"Failed memory allocation for nextPacket. Discarding remaining data.");
-		}
-		else {
-			// Copy header and remaining events to new packet, set header sizes correctly.
-			memcpy(nextPacket, *currPacket, CAER_EVENT_PACKET_HEADER_SIZE);
-			memcpy(((uint8_t *) nextPacket) + CAER_EVENT_PACKET_HEADER_SIZE,
-				((uint8_t *) *currPacket) + CAER_EVENT_PACKET_HEADER_SIZE + (currPacketEventSize * cutoffIndex),
-				(size_t)(currPacketEventSize * nextPacketEventNumber));
+			// Copy out only the events up until the cutoff point into a new packet, which
+			// goes into the packet container for output. The remaining events stay in place.
+			size_t slicedPacketSize = CAER_EVENT_PACKET_HEADER_SIZE + (size_t)(currPacketEventSize * cutoffIndex);
+
+			caerEventPacketHeader slicedPacket = malloc(slicedPacketSize);
+			if (slicedPacket == NULL) {
+				caerModuleLog(state->parentModule, CAER_LOG_CRITICAL,
+					"Failed memory allocation for slicedPacket. Discarding current data.");
+			}
+			else {
+				memcpy(slicedPacket, currPacket, slicedPacketSize);
+
+				// Set header sizes for sliced packet correctly.
+				caerEventPacketHeaderSetEventValid(slicedPacket, validEventsSeen);
+				caerEventPacketHeaderSetEventNumber(slicedPacket, cutoffIndex);
+				caerEventPacketHeaderSetEventCapacity(slicedPacket, cutoffIndex);
+
+				caerEventPacketContainerSetEventPacket(packetContainer, packetContainerPosition++, slicedPacket);
+			}
+
+			// The remaining events become a packet of their own by writing a header
+			// right in front of them, over data that was just copied out (or discarded).
+			int32_t nextPacketEventNumber = currPacketEventNumber - cutoffIndex;
+			caerEventPacketHeader nextPacket
+				= (caerEventPacketHeader)(((uint8_t *) currPacket) + (currPacketEventSize * cutoffIndex));
+
+			memmove(nextPacket, currPacket, CAER_EVENT_PACKET_HEADER_SIZE);
 
 			caerEventPacketHeaderSetEventValid(nextPacket, currPacketEventValid - validEventsSeen);
 			caerEventPacketHeaderSetEventNumber(nextPacket, nextPacketEventNumber);
 			caerEventPacketHeaderSetEventCapacity(nextPacket, nextPacketEventNumber);
-		}
-
-		// Resize current packet to include only the events up until cutoff point.
-		caerEventPacketHeader currPacketResized
-			= realloc(*currPacket, CAER_EVENT_PACKET_HEADER_SIZE + (size_t)(currPacketEventSize * cutoffIndex));
-		if (currPacketResized == NULL) {
-			// This is unlikely to happen as we always shrink here!
-			caerModuleLog(state->parentModule, CAER_LOG_CRITICAL,
-				"Failed memory allocation for currPacketResized. Discarding current data.");
-			free(*currPacket);
-		}
-		else {
-			// Set header sizes for resized packet correctly.
-			caerEventPacketHeaderSetEventValid(currPacketResized, validEventsSeen);
-			caerEventPacketHeaderSetEventNumber(currPacketResized, cutoffIndex);
-			caerEventPacketHeaderSetEventCapacity(currPacketResized, cutoffIndex);
-
-			// Update references: the currPacket, after resizing, goes into the packet container for output.
-			caerEventPacketContainerSetEventPacket(packetContainer, packetContainerPosition++, currPacketResized);
-		}
 
-		// Update references: the nextPacket goes into the eventPackets array at the currPacket position,
-		// if it exists. Else we just delete that position.
-		if (nextPacket != NULL) {
-			*currPacket = nextPacket;
-		}
-		else {
-			// Erase slot from packets array.
-			utarray_erase(state->packetContainer.eventPackets,
-				(size_t) utarray_eltidx(state->packetContainer.eventPackets, currPacket), 1);
-			currPacket = (caerEventPacketHeader *) utarray_prev(state->packetContainer.eventPackets, currPacket);
+			pending->packet = nextPacket;
 		}
 	}
-}
 
-return (packetContainer);
+	return (packetContainer);
 }
 
 static void commitPacketContainer(inputCommonState state, bool forceFlush) {
@@ -1527,6 +3952,8 @@ redo:
 	// Also don't update if forceFlush is true, for the same reason of the next call
 	// having to again comb through the same time window for any of the size or time
 	// limits to hit again (on TS Overflow, on TS Reset everything just resets anyway).
+	int32_t pacingMode = I32T(atomic_load_explicit(&state->pacing.mode, memory_order_relaxed));
+
 	if (!sizeCommit && !forceFlush) {
 		state->packetContainer.newContainerTimestampEnd
 			+= I32T(atomic_load_explicit(&state->packetContainer.timeSlice, memory_order_relaxed));
@@ -1534,7 +3961,14 @@ redo:
 		// Only do time delay operation if time is actually changing. On size hits or
 		// full flushes, this would slow down everything incorrectly as it would be an
 		// extra delay operation inside the same time window.
-		doTimeDelay(state);
+		if (pacingMode == PACING_DELAY) {
+			doTimeDelay(state);
+		}
+	}
+
+	// Timestamp pacing looks at the events themselves, so it applies to any commit.
+	if (pacingMode == PACING_TIMESTAMPS) {
+		doTimestampPacing(state, packetContainer);
 	}
 
 	doPacketContainerCommit(state, packetContainer, atomic_load_explicit(&state->keepPackets, memory_order_relaxed));
@@ -1548,10 +3982,11 @@ redo:
 
 	if (!forceFlush) {
 		// Check if any of the remaining packets still would trigger an early size limit.
-		caerEventPacketHeader *currPacket = NULL;
-		while ((currPacket = (caerEventPacketHeader *) utarray_next(state->packetContainer.eventPackets, currPacket))
+		struct input_common_pending_packet *pending = NULL;
+		while ((pending
+				   = (struct input_common_pending_packet *) utarray_next(state->packetContainer.eventPackets, pending))
 			   != NULL) {
-			updateSizeCommitCriteria(state, *currPacket);
+			updateSizeCommitCriteria(state, pending->packet);
 		}
 
 		// Run the above again, to make sure we do exhaust all possible size and time commits
@@ -1600,19 +4035,134 @@ static void doTimeDelay(inputCommonState state) {
 	}
 }
 
+/**
+ * Delay the commit of a packet container until the time its events happened,
+ * relative to the start of the schedule and scaled by the playback speed factor.
+ * The schedule is kept against the monotonic clock, so delays don't accumulate:
+ * if a commit is late, the following ones catch up. A new schedule starts on the
+ * first container, on speed changes and on discontinuities (seek, pause, time
+ * going backwards like on timestamp resets).
+ *
+ * @param state common input data structure.
+ * @param packetContainer the packet container about to be committed.
+ */
+static void doTimestampPacing(inputCommonState state, caerEventPacketContainer packetContainer) {
+	int64_t timestamp = caerEventPacketContainerGetHighestEventTimestamp(packetContainer);
+	if (timestamp < 0) {
+		// No events, won't be committed anyway.
+		return;
+	}
+
+	int32_t speed = I32T(atomic_load_explicit(&state->pacing.speed, memory_order_relaxed));
+
+	struct timespec currentTime;
+	portable_clock_gettime_monotonic(&currentTime);
+
+	if (atomic_exchange(&state->pacing.reset, false) || !state->pacing.anchored || (speed != state->pacing.anchorSpeed)
+		|| (timestamp < state->pacing.anchorTimestamp)) {
+		state->pacing.anchored        = true;
+		state->pacing.anchorTime      = currentTime;
+		state->pacing.anchorTimestamp = timestamp;
+		state->pacing.anchorSpeed     = speed;
+
+		atomic_store(&state->pacing.lag, 0);
+		atomic_store(&state->pacing.maxLag, 0);
+
+		return;
+	}
+
+	// Time (in ns) since the schedule started, both wanted and actual.
+	int64_t dueNanoTime = ((timestamp - state->pacing.anchorTimestamp) * 1000000) / speed;
+	int64_t elapsedNanoTime
+		= ((int64_t)(currentTime.tv_sec - state->pacing.anchorTime.tv_sec) * 1000000000LL)
+		  + (int64_t)(currentTime.tv_nsec - state->pacing.anchorTime.tv_nsec);
+
+	if (dueNanoTime > elapsedNanoTime) {
+		// Early, sleep for the remaining time. Slow playback can mean long waits,
+		// so sleep in slices and stop waiting as soon as the schedule changes.
+		while (dueNanoTime > elapsedNanoTime) {
+			int64_t sleepNanoTime = dueNanoTime - elapsedNanoTime;
+			if (sleepNanoTime > (INOUT_QUEUE_WAIT_TIME * 1000LL)) {
+				sleepNanoTime = INOUT_QUEUE_WAIT_TIME * 1000LL;
+			}
+
+			// Configuration changes wake us up early, rounded up to not spin.
+			caerQueueGetWait(state->assemblerSignal, (uint32_t)((sleepNanoTime + 999) / 1000));
+
+			if (!atomic_load_explicit(&state->running, memory_order_relaxed)) {
+				return;
+			}
+
+			// Hold the container back while paused, the pause also resets the
+			// schedule, so it goes out right away afterwards.
+			if (atomic_load_explicit(&state->pause, memory_order_relaxed)) {
+				while (atomic_load_explicit(&state->pause, memory_order_relaxed)
+					   && atomic_load_explicit(&state->running, memory_order_relaxed)) {
+					caerQueueGetWait(state->assemblerSignal, INOUT_QUEUE_WAIT_TIME);
+				}
+
+				return;
+			}
+
+			// Seek, mode or speed change: commit now, the next container
+			// starts a new schedule.
+			if (atomic_load_explicit(&state->pacing.reset, memory_order_relaxed)
+				|| (I32T(atomic_load_explicit(&state->pacing.mode, memory_order_relaxed)) != PACING_TIMESTAMPS)
+				|| (I32T(atomic_load_explicit(&state->pacing.speed, memory_order_relaxed)) != speed)) {
+				return;
+			}
+
+			portable_clock_gettime_monotonic(&currentTime);
+
+			elapsedNanoTime = ((int64_t)(currentTime.tv_sec - state->pacing.anchorTime.tv_sec) * 1000000000LL)
+							  + (int64_t)(currentTime.tv_nsec - state->pacing.anchorTime.tv_nsec);
+		}
+
+		atomic_store_explicit(&state->pacing.lag, 0, memory_order_relaxed);
+	}
+	else {
+		// Late, commit right away and account for it.
+		int64_t lag = (elapsedNanoTime - dueNanoTime) / 1000;
+
+		atomic_store_explicit(&state->pacing.lag, lag, memory_order_relaxed);
+
+		if (lag > atomic_load_explicit(&state->pacing.maxLag, memory_order_relaxed)) {
+			atomic_store_explicit(&state->pacing.maxLag, lag, memory_order_relaxed);
+		}
+
+		if (lag > PACING_LATE_THRESHOLD) {
+			atomic_fetch_add_explicit(&state->pacing.lateContainers, 1, memory_order_relaxed);
+		}
+	}
+}
+
+static int32_t pacingModeParse(const char *mode) {
+	if (caerStrEquals(mode, "Timestamps")) {
+		return (PACING_TIMESTAMPS);
+	}
+	else if (caerStrEquals(mode, "Unlimited")) {
+		return (PACING_UNLIMITED);
+	}
+	else {
+		return (PACING_DELAY);
+	}
+}
+
 static void doPacketContainerCommit(inputCommonState state, caerEventPacketContainer packetContainer, bool force) {
 	// Could be that the packet container is empty of events. Don't commit empty containers.
 	if (caerEventPacketContainerGetEventsNumber(packetContainer) == 0) {
 		return;
 	}
 
-retry:
-	if (!caerRingBufferPut(state->transferRingPacketContainers, packetContainer)) {
-		if (force && atomic_load_explicit(&state->running, memory_order_relaxed)) {
-			// Retry forever if requested, at least while the module is running.
-			goto retry;
-		}
+	bool success = caerQueuePut(state->transferRingPacketContainers, packetContainer);
 
+	// Retry forever if requested, at least while the module is running.
+	// Sleep until the mainloop makes space by taking a packet container out.
+	while (!success && force && atomic_load_explicit(&state->running, memory_order_relaxed)) {
+		success = caerQueuePutWait(state->transferRingPacketContainers, packetContainer, INOUT_QUEUE_WAIT_TIME);
+	}
+
+	if (!success) {
 		caerEventPacketContainerFree(packetContainer);
 
 		caerModuleLog(
@@ -1698,21 +4248,17 @@ static int inputAssemblerThread(void *stateArg) {
 			"Failed to raise thread priority for Input Assembler thread. You may experience lags and delays.");
 	}
 
-	// Delay by 1 µs if no data, to avoid a wasteful busy loop.
-	struct timespec noDataSleep = {.tv_sec = 0, .tv_nsec = 1000};
-
 	while (atomic_load_explicit(&state->running, memory_order_relaxed)) {
 		// Support pause: don't get and send out new data while in pause mode.
 		if (atomic_load_explicit(&state->pause, memory_order_relaxed)) {
-			// Wait for 1 ms in pause mode, to avoid a wasteful busy loop.
-			struct timespec pauseSleep = {.tv_sec = 0, .tv_nsec = 1000000};
-			thrd_sleep(&pauseSleep, NULL);
+			// Sleep until the pause ends, the configuration listener signals it.
+			caerQueueGetWait(state->assemblerSignal, INOUT_QUEUE_WAIT_TIME);
 
 			continue;
 		}
 
-		// Get parsed packets from Reader thread.
-		caerEventPacketHeader currPacket = caerRingBufferGet(state->transferRingPackets);
+		// Get parsed packets from Reader thread, sleep until one is there.
+		caerEventPacketHeader currPacket = caerQueueGetWait(state->transferRingPackets, INOUT_QUEUE_WAIT_TIME);
 		if (currPacket == NULL) {
 			// Let's see why there are no more packets to read, maybe the reader failed.
 			// Also EOF could have been reached, in which case the reader would have committed its last
@@ -1722,9 +4268,22 @@ static int inputAssemblerThread(void *stateArg) {
 				break;
 			}
 
-			// Delay by 1 µs if no data, to avoid a wasteful busy loop.
-			thrd_sleep(&noDataSleep, NULL);
+			continue;
+		}
+
+		// Reader moved to a new position, packets from now on come from there.
+		if (currPacket == SEEK_MARKER) {
+			if (!inputAssemblerSeek(state)) {
+				// Critical error, exit.
+				break;
+			}
+
+			continue;
+		}
 
+		// Packets read before a seek are stale, drop them.
+		if (atomic_load_explicit(&state->seek.assemblerRequest, memory_order_relaxed)) {
+			free(currPacket);
 			continue;
 		}
 
@@ -1738,6 +4297,17 @@ static int inputAssemblerThread(void *stateArg) {
 		struct input_packet_data currPacketData;
 		getPacketInfo(currPacket, &currPacketData);
 
+		// After a seek, drop packets ending before the requested timestamp. The first
+		// packet reaching it ends this, later packets can't start earlier than it.
+		if (state->seek.skipUntilTimestamp >= 0) {
+			if (currPacketData.endTimestamp < state->seek.skipUntilTimestamp) {
+				free(currPacket);
+				continue;
+			}
+
+			state->seek.skipUntilTimestamp = -1;
+		}
+
 		// Check timestamp constraints as per AEDAT 3.X format: order-relevant timestamps
 		// of each packet (the first timestamp) must be smaller or equal than next packet's.
 		if (currPacketData.startTimestamp < state->packetContainer.lastPacketTimestamp) {
@@ -1842,10 +4412,10 @@ static int inputAssemblerThread(void *stateArg) {
 	// If we hit EOF/errors though, we want the consumers to be able to finish
 	// consuming the already produced data, so we wait for the ring-buffer to be empty.
 	if (atomic_load(&state->running)) {
-		while (atomic_load(&state->running) && atomic_load(&state->dataAvailableModule) != 0) {
-			// Delay by 1 ms if no change, to avoid a wasteful busy loop.
-			struct timespec waitSleep = {.tv_sec = 0, .tv_nsec = 1000000};
-			thrd_sleep(&waitSleep, NULL);
+		// Sleep until the mainloop took everything out.
+		while (atomic_load(&state->running)
+			   && !caerQueueWaitEmpty(state->transferRingPacketContainers, INOUT_QUEUE_WAIT_TIME)) {
+			;
 		}
 
 		// Ensure parent also shuts down, for example on read failures or EOF.
@@ -1855,7 +4425,7 @@ static int inputAssemblerThread(void *stateArg) {
 	return (thrd_success);
 }
 
-static const UT_icd ut_caerEventPacketHeader_icd = {sizeof(caerEventPacketHeader), NULL, NULL, NULL};
+static const UT_icd ut_inputPendingPacket_icd = {sizeof(struct input_common_pending_packet), NULL, NULL, NULL};
 
 bool caerInputCommonInit(caerModuleData moduleData, int readFd, bool isNetworkStream, bool isNetworkMessageBased) {
 	inputCommonState state = moduleData->moduleState;
@@ -1888,6 +4458,37 @@ bool caerInputCommonInit(caerModuleData moduleData, int readFd, bool isNetworkSt
 		"Size of read data buffer in bytes.");
 	sshsNodeCreateInt(moduleData->moduleNode, "ringBufferSize", 128, 8, 1024, SSHS_FLAGS_NORMAL,
 		"Size of EventPacketContainer and EventPacket queues, used for transfers between input threads and mainloop.");
+	sshsNodeCreateInt(moduleData->moduleNode, "decompressionWorkers", 2, 0, 32, SSHS_FLAGS_NORMAL,
+		"Number of threads decompressing packets in parallel, 0 to decompress them in the reader thread.");
+
+	if (!isNetworkStream) {
+		sshsNodeCreateBool(moduleData->moduleNode, "memoryMapped", true, SSHS_FLAGS_NORMAL,
+			"Read input files through a memory mapping, instead of copying them into the read buffer first.");
+		sshsNodeCreateBool(moduleData->moduleNode, "loopReplay", false, SSHS_FLAGS_NORMAL,
+			"Keep the decoded file in memory and replay it in a loop, with timestamps continuing across loops.");
+		sshsNodeCreateInt(moduleData->moduleNode, "loopReplayMemory", 1024, 1, 64 * 1024, SSHS_FLAGS_NORMAL,
+			"Maximum memory in MiB for keeping the file for loop replay. Bigger files are just played once.");
+		sshsNodeCreateInt(moduleData->moduleNode, "compressedReadAhead", 8, 1, 256, SSHS_FLAGS_NORMAL,
+			"Size in MiB of the read-ahead buffer for compressed (gzip, zstd, lz4) input files.");
+
+		sshsNodeCreateBool(moduleData->moduleNode, "indexReady", false, SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT,
+			"The whole file has been indexed, seeking to any position is possible.");
+		sshsNodeUpdateReadOnlyAttribute(
+			moduleData->moduleNode, "indexReady", SSHS_BOOL, (union sshs_node_attr_value){.boolean = false});
+		sshsNodeCreateLong(moduleData->moduleNode, "seekTimestamp", -1, -1, INT64_MAX, SSHS_FLAGS_NO_EXPORT,
+			"Jump to the first packet containing this timestamp (in µs). Resets to -1 once handled.");
+		sshsNodeCreateDouble(moduleData->moduleNode, "seekFraction", -1, -1, 1, SSHS_FLAGS_NO_EXPORT,
+			"Jump to this fraction [0, 1] of the total playback time. Resets to -1 once handled.");
+	}
+
+	if (isNetworkMessageBased) {
+		sshsNodeCreateInt(moduleData->moduleNode, "udpBatchSize", 64, 1, 1024, SSHS_FLAGS_NORMAL,
+			"Maximum number of UDP messages to receive with one system call.");
+		sshsNodeCreateInt(moduleData->moduleNode, "udpReorderWindow", 1024, 16, 64 * 1024, SSHS_FLAGS_NORMAL,
+			"Number of UDP messages kept for reordering and reassembly. Bigger event packets are dropped.");
+		sshsNodeCreateInt(moduleData->moduleNode, "udpReorderTimeout", 10000, 0, 1000 * 1000, SSHS_FLAGS_NORMAL,
+			"Time in µs to wait for missing UDP messages, before giving up on them and their event packet.");
+	}
 
 	sshsNodeCreateInt(moduleData->moduleNode, "PacketContainerMaxPacketSize", 0, 0, 10 * 1024 * 1024, SSHS_FLAGS_NORMAL,
 		"Maximum packet size in events, when any packet reaches this size, the EventPacketContainer is sent for "
@@ -1896,6 +4497,14 @@ bool caerInputCommonInit(caerModuleData moduleData, int readFd, bool isNetworkSt
 		"Time interval in µs, each sent EventPacketContainer will span this interval.");
 	sshsNodeCreateInt(moduleData->moduleNode, "PacketContainerDelay", 10000, 1, 120 * 1000 * 1000, SSHS_FLAGS_NORMAL,
 		"Time delay in µs between consecutive EventPacketContainers sent for processing.");
+	sshsNodeCreateString(moduleData->moduleNode, "PacketContainerPacing", "Delay", 5, 10, SSHS_FLAGS_NORMAL,
+		"How to pace sending EventPacketContainers for processing: with a fixed delay in between (Delay), "
+		"at the time their events happened, scaled by the speed factor (Timestamps), or as fast as possible "
+		"(Unlimited).");
+	sshsNodeCreateAttributeListOptions(
+		moduleData->moduleNode, "PacketContainerPacing", SSHS_STRING, PACING_MODES, false);
+	sshsNodeCreateDouble(moduleData->moduleNode, "PacketContainerSpeed", 1, 0.1, 100, SSHS_FLAGS_NORMAL,
+		"Playback speed factor for Timestamps pacing, 1 is real time.");
 
 	atomic_store(&state->validOnly, sshsNodeGetBool(moduleData->moduleNode, "validOnly"));
 	atomic_store(&state->keepPackets, sshsNodeGetBool(moduleData->moduleNode, "keepPackets"));
@@ -1907,56 +4516,137 @@ bool caerInputCommonInit(caerModuleData moduleData, int readFd, bool isNetworkSt
 	atomic_store(&state->packetContainer.timeSlice, sshsNodeGetInt(moduleData->moduleNode, "PacketContainerInterval"));
 	atomic_store(&state->packetContainer.timeDelay, sshsNodeGetInt(moduleData->moduleNode, "PacketContainerDelay"));
 
+	char *pacingMode = sshsNodeGetString(moduleData->moduleNode, "PacketContainerPacing");
+	atomic_store(&state->pacing.mode, pacingModeParse(pacingMode));
+	free(pacingMode);
+
+	atomic_store(&state->pacing.speed, I32T(sshsNodeGetDouble(moduleData->moduleNode, "PacketContainerSpeed") * 1000));
+	atomic_store(&state->pacing.reset, false);
+	state->pacing.anchored = false;
+	atomic_store(&state->pacing.lag, 0);
+	atomic_store(&state->pacing.maxLag, 0);
+	atomic_store(&state->pacing.lateContainers, 0);
+
 	// Initialize transfer ring-buffers. ringBufferSize only changes here at init time!
-	state->transferRingPackets = caerRingBufferInit((size_t) ringSize);
+	state->transferRingPackets = caerQueueInit((size_t) ringSize);
 	if (state->transferRingPackets == NULL) {
 		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to allocate packets transfer ring-buffer.");
 		return (false);
 	}
 
-	state->transferRingPacketContainers = caerRingBufferInit((size_t) ringSize);
+	state->transferRingPacketContainers = caerQueueInit((size_t) ringSize);
 	if (state->transferRingPacketContainers == NULL) {
 		caerModuleLog(
 			state->parentModule, CAER_LOG_ERROR, "Failed to allocate packet containers transfer ring-buffer.");
 		return (false);
 	}
 
+	// Wake-up signals, one pending signal is all that's needed.
+	state->assemblerSignal       = caerQueueInit(1);
+	state->index.dataStartSignal = caerQueueInit(1);
+	if ((state->assemblerSignal == NULL) || (state->index.dataStartSignal == NULL)) {
+		caerQueueFree(state->transferRingPackets);
+		caerQueueFree(state->transferRingPacketContainers);
+		caerQueueFree(state->assemblerSignal);
+		caerQueueFree(state->index.dataStartSignal);
+
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to allocate input thread signals.");
+		return (false);
+	}
+
+	// Compressed files are decoded while reading. Only changes at init time!
+	if (!isNetworkStream
+		&& !streamDecoderInit(
+			   state, (size_t) sshsNodeGetInt(moduleData->moduleNode, "compressedReadAhead") * 1024 * 1024)) {
+		caerQueueFree(state->transferRingPackets);
+		caerQueueFree(state->transferRingPacketContainers);
+		caerQueueFree(state->assemblerSignal);
+		caerQueueFree(state->index.dataStartSignal);
+
+		return (false);
+	}
+
+	// Files can be parsed directly from a memory mapping, if not compressed. Only changes at init time!
+	if (!isNetworkStream && (state->streamDecoder.format == STREAM_UNCOMPRESSED)
+		&& sshsNodeGetBool(moduleData->moduleNode, "memoryMapped")) {
+		mmapInputInit(state);
+	}
+
+	// Loop replay keeps the decoded file in memory. Only changes at init time!
+	if (!isNetworkStream && sshsNodeGetBool(moduleData->moduleNode, "loopReplay")) {
+		replayCacheInit(state, (size_t) sshsNodeGetInt(moduleData->moduleNode, "loopReplayMemory") * 1024 * 1024);
+	}
+
 	// Allocate data buffer. bufferSize is updated here.
 	if (!newInputBuffer(state)) {
-		caerRingBufferFree(state->transferRingPackets);
-		caerRingBufferFree(state->transferRingPacketContainers);
+		caerQueueFree(state->transferRingPackets);
+		caerQueueFree(state->transferRingPacketContainers);
+		caerQueueFree(state->assemblerSignal);
+		caerQueueFree(state->index.dataStartSignal);
+		streamDecoderExit(state);
 
 		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to allocate input data buffer.");
 		return (false);
 	}
 
+	// UDP reassembly buffers. Only change at init time!
+	if (isNetworkMessageBased
+		&& !udpInputInit(state, (size_t) sshsNodeGetInt(moduleData->moduleNode, "udpBatchSize"),
+			   (size_t) sshsNodeGetInt(moduleData->moduleNode, "udpReorderWindow"),
+			   sshsNodeGetInt(moduleData->moduleNode, "udpReorderTimeout"))) {
+		caerQueueFree(state->transferRingPackets);
+		caerQueueFree(state->transferRingPacketContainers);
+		caerQueueFree(state->assemblerSignal);
+		caerQueueFree(state->index.dataStartSignal);
+		free(state->dataBuffer);
+		streamDecoderExit(state);
+
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to allocate UDP reassembly buffers.");
+		return (false);
+	}
+
 	// Initialize array for packets -> packet container.
-	utarray_new(state->packetContainer.eventPackets, &ut_caerEventPacketHeader_icd);
+	utarray_new(state->packetContainer.eventPackets, &ut_inputPendingPacket_icd);
 
 	state->packetContainer.newContainerTimestampEnd = -1;
 	state->packetContainer.newContainerSizeLimit
 		= I32T(atomic_load_explicit(&state->packetContainer.sizeSlice, memory_order_relaxed));
 	state->packetContainer.sizeLimitTimestamp = INT32_MAX;
 
+	state->seek.skipUntilTimestamp = -1;
+
 	// Start input handling threads.
 	atomic_store(&state->running, true);
 
+	// Decompression workers first, the reader hands packets to them. Only changes at init time!
+	int decompressionWorkers = sshsNodeGetInt(moduleData->moduleNode, "decompressionWorkers");
+
+	if ((decompressionWorkers > 0) && !decompressPoolInit(state, (size_t) decompressionWorkers, (size_t) ringSize)) {
+		caerModuleLog(state->parentModule, CAER_LOG_WARNING,
+			"Failed to start decompression worker threads, decompressing in the reader thread instead.");
+	}
+
 	if (thrd_create(&state->inputAssemblerThread, &inputAssemblerThread, state) != thrd_success) {
-		caerRingBufferFree(state->transferRingPackets);
-		caerRingBufferFree(state->transferRingPacketContainers);
+		caerQueueFree(state->transferRingPackets);
+		caerQueueFree(state->transferRingPacketContainers);
+		caerQueueFree(state->assemblerSignal);
+		caerQueueFree(state->index.dataStartSignal);
 		free(state->dataBuffer);
+		udpInputExit(state);
+		streamDecoderExit(state);
+
+		// Stop decompression workers (started just above) and wait on them.
+		atomic_store(&state->running, false);
+		decompressPoolExit(state);
 
 		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to start input assembler thread.");
 		return (false);
 	}
 
 	if (thrd_create(&state->inputReaderThread, &inputReaderThread, state) != thrd_success) {
-		caerRingBufferFree(state->transferRingPackets);
-		caerRingBufferFree(state->transferRingPacketContainers);
-		free(state->dataBuffer);
-
 		// Stop assembler thread (started just above) and wait on it.
 		atomic_store(&state->running, false);
+		caerQueueWakeUp(state->transferRingPackets);
 
 		if ((errno = thrd_join(state->inputAssemblerThread, NULL)) != thrd_success) {
 			// This should never happen!
@@ -1964,6 +4654,17 @@ bool caerInputCommonInit(caerModuleData moduleData, int readFd, bool isNetworkSt
 				state->parentModule, CAER_LOG_CRITICAL, "Failed to join input assembler thread. Error: %d.", errno);
 		}
 
+		decompressPoolExit(state);
+
+		// Free the transfer queues only now, the assembler thread was using them.
+		caerQueueFree(state->transferRingPackets);
+		caerQueueFree(state->transferRingPacketContainers);
+		caerQueueFree(state->assemblerSignal);
+		caerQueueFree(state->index.dataStartSignal);
+		free(state->dataBuffer);
+		udpInputExit(state);
+		streamDecoderExit(state);
+
 		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to start input reader thread.");
 		return (false);
 	}
@@ -1971,12 +4672,9 @@ bool caerInputCommonInit(caerModuleData moduleData, int readFd, bool isNetworkSt
 	// Wait for header to be parsed. TODO: this can block indefinitely, better solution needed!
 	while (!atomic_load_explicit(&state->header.isValidHeader, memory_order_relaxed)) {
 		if (atomic_load_explicit(&state->inputReaderThreadState, memory_order_relaxed) != READER_OK) {
-			caerRingBufferFree(state->transferRingPackets);
-			caerRingBufferFree(state->transferRingPacketContainers);
-			free(state->dataBuffer);
-
 			// Stop assembler thread (started just above) and wait on it.
 			atomic_store(&state->running, false);
+			caerQueueWakeUp(state->transferRingPackets);
 
 			if ((errno = thrd_join(state->inputAssemblerThread, NULL)) != thrd_success) {
 				// This should never happen!
@@ -1990,11 +4688,85 @@ bool caerInputCommonInit(caerModuleData moduleData, int readFd, bool isNetworkSt
 					state->parentModule, CAER_LOG_CRITICAL, "Failed to join input reader thread. Error: %d.", errno);
 			}
 
+			decompressPoolExit(state);
+			mmapInputClose(state);
+			replayCacheExit(state);
+
+			caerQueueFree(state->transferRingPackets);
+			caerQueueFree(state->transferRingPacketContainers);
+			caerQueueFree(state->assemblerSignal);
+			caerQueueFree(state->index.dataStartSignal);
+			free(state->dataBuffer);
+			udpInputExit(state);
+			streamDecoderExit(state);
+
 			caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to start input reader thread.");
 			return (false);
 		}
 	}
 
+	// Start indexing files for seeking, in the background.
+	indexInit(state);
+
+	// Pacing statistics, read directly from the running counters.
+	sshsNode statNode = sshsGetRelativeNode(moduleData->moduleNode, "statistics/");
+
+	sshsNodeCreateLong(statNode, "pacingLag", 0, 0, INT64_MAX, SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT,
+		"How late the last EventPacketContainer was sent, compared to its timestamps, in µs.");
+	sshsNodeCreateAttributePollTime(statNode, "pacingLag", SSHS_LONG, 2);
+	sshsNodeAddAttributeReadModifier(statNode, "pacingLag", SSHS_LONG, state, &statisticsPassthrough);
+
+	sshsNodeCreateLong(statNode, "pacingMaxLag", 0, 0, INT64_MAX, SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT,
+		"Highest lag of EventPacketContainers compared to their timestamps, since pacing last started, in µs.");
+	sshsNodeCreateAttributePollTime(statNode, "pacingMaxLag", SSHS_LONG, 2);
+	sshsNodeAddAttributeReadModifier(statNode, "pacingMaxLag", SSHS_LONG, state, &statisticsPassthrough);
+
+	sshsNodeCreateLong(statNode, "pacingLateContainers", 0, 0, INT64_MAX, SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT,
+		"Number of EventPacketContainers sent more than 1 ms later than their timestamps.");
+	sshsNodeCreateAttributePollTime(statNode, "pacingLateContainers", SSHS_LONG, 2);
+	sshsNodeAddAttributeReadModifier(statNode, "pacingLateContainers", SSHS_LONG, state, &statisticsPassthrough);
+
+	sshsNodeCreateLong(statNode, "transferRingPacketsOccupancy", 0, 0, INT64_MAX,
+		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Number of event packets waiting to be assembled into containers.");
+	sshsNodeCreateAttributePollTime(statNode, "transferRingPacketsOccupancy", SSHS_LONG, 2);
+	sshsNodeAddAttributeReadModifier(
+		statNode, "transferRingPacketsOccupancy", SSHS_LONG, state, &statisticsPassthrough);
+
+	sshsNodeCreateLong(statNode, "transferRingPacketContainersOccupancy", 0, 0, INT64_MAX,
+		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Number of EventPacketContainers waiting for the mainloop.");
+	sshsNodeCreateAttributePollTime(statNode, "transferRingPacketContainersOccupancy", SSHS_LONG, 2);
+	sshsNodeAddAttributeReadModifier(
+		statNode, "transferRingPacketContainersOccupancy", SSHS_LONG, state, &statisticsPassthrough);
+
+	if (isNetworkMessageBased) {
+		sshsNodeCreateLong(statNode, "udpMessagesReceived", 0, 0, INT64_MAX,
+			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Number of UDP messages received.");
+		sshsNodeCreateAttributePollTime(statNode, "udpMessagesReceived", SSHS_LONG, 2);
+		sshsNodeAddAttributeReadModifier(statNode, "udpMessagesReceived", SSHS_LONG, state, &statisticsPassthrough);
+
+		sshsNodeCreateLong(statNode, "udpMessagesLost", 0, 0, INT64_MAX, SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT,
+			"Number of UDP messages that never arrived, from gaps in the sequence numbers.");
+		sshsNodeCreateAttributePollTime(statNode, "udpMessagesLost", SSHS_LONG, 2);
+		sshsNodeAddAttributeReadModifier(statNode, "udpMessagesLost", SSHS_LONG, state, &statisticsPassthrough);
+
+		sshsNodeCreateLong(statNode, "udpMessagesDiscarded", 0, 0, INT64_MAX,
+			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT,
+			"Number of UDP messages received but not used: invalid, duplicate, too late or part of a dropped "
+			"event packet.");
+		sshsNodeCreateAttributePollTime(statNode, "udpMessagesDiscarded", SSHS_LONG, 2);
+		sshsNodeAddAttributeReadModifier(statNode, "udpMessagesDiscarded", SSHS_LONG, state, &statisticsPassthrough);
+
+		sshsNodeCreateLong(statNode, "udpPacketsReassembled", 0, 0, INT64_MAX,
+			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Number of event packets reassembled from UDP messages.");
+		sshsNodeCreateAttributePollTime(statNode, "udpPacketsReassembled", SSHS_LONG, 2);
+		sshsNodeAddAttributeReadModifier(statNode, "udpPacketsReassembled", SSHS_LONG, state, &statisticsPassthrough);
+
+		sshsNodeCreateLong(statNode, "udpPacketsDropped", 0, 0, INT64_MAX, SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT,
+			"Number of event packets dropped, because some of their UDP messages were lost or too late.");
+		sshsNodeCreateAttributePollTime(statNode, "udpPacketsDropped", SSHS_LONG, 2);
+		sshsNodeAddAttributeReadModifier(statNode, "udpPacketsDropped", SSHS_LONG, state, &statisticsPassthrough);
+	}
+
 	// Add config listeners last, to avoid having them dangling if Init doesn't succeed.
 	sshsNodeAddAttributeListener(moduleData->moduleNode, moduleData, &caerInputCommonConfigListener);
 
@@ -2005,11 +4777,32 @@ void caerInputCommonExit(caerModuleData moduleData) {
 	// Remove listener, which can reference invalid memory in userData.
 	sshsNodeRemoveAttributeListener(moduleData->moduleNode, moduleData, &caerInputCommonConfigListener);
 
+	// Remove statistics read modifiers, they reference the state.
+	sshsNode statNode = sshsGetRelativeNode(moduleData->moduleNode, "statistics/");
+	sshsNodeRemoveAttributeReadModifier(statNode, "pacingLag", SSHS_LONG);
+	sshsNodeRemoveAttributeReadModifier(statNode, "pacingMaxLag", SSHS_LONG);
+	sshsNodeRemoveAttributeReadModifier(statNode, "pacingLateContainers", SSHS_LONG);
+	sshsNodeRemoveAttributeReadModifier(statNode, "transferRingPacketsOccupancy", SSHS_LONG);
+	sshsNodeRemoveAttributeReadModifier(statNode, "transferRingPacketContainersOccupancy", SSHS_LONG);
+
 	inputCommonState state = moduleData->moduleState;
 
+	if (state->isNetworkMessageBased) {
+		sshsNodeRemoveAttributeReadModifier(statNode, "udpMessagesReceived", SSHS_LONG);
+		sshsNodeRemoveAttributeReadModifier(statNode, "udpMessagesLost", SSHS_LONG);
+		sshsNodeRemoveAttributeReadModifier(statNode, "udpMessagesDiscarded", SSHS_LONG);
+		sshsNodeRemoveAttributeReadModifier(statNode, "udpPacketsReassembled", SSHS_LONG);
+		sshsNodeRemoveAttributeReadModifier(statNode, "udpPacketsDropped", SSHS_LONG);
+	}
+
 	// Stop input threads and wait on them.
 	atomic_store(&state->running, false);
 
+	caerQueueWakeUp(state->transferRingPackets);
+	caerQueueWakeUp(state->transferRingPacketContainers);
+	caerQueueWakeUp(state->assemblerSignal);
+	caerQueueWakeUp(state->index.dataStartSignal);
+
 	if ((errno = thrd_join(state->inputReaderThread, NULL)) != thrd_success) {
 		// This should never happen!
 		caerModuleLog(state->parentModule, CAER_LOG_CRITICAL, "Failed to join input reader thread. Error: %d.", errno);
@@ -2021,9 +4814,12 @@ void caerInputCommonExit(caerModuleData moduleData) {
 			state->parentModule, CAER_LOG_CRITICAL, "Failed to join input assembler thread. Error: %d.", errno);
 	}
 
+	indexExit(state);
+	decompressPoolExit(state);
+
 	// Now clean up the transfer ring-buffers and its contents.
 	caerEventPacketContainer packetContainer;
-	while ((packetContainer = caerRingBufferGet(state->transferRingPacketContainers)) != NULL) {
+	while ((packetContainer = caerQueueGet(state->transferRingPacketContainers)) != NULL) {
 		caerEventPacketContainerFree(packetContainer);
 
 		// If we're here, then nobody will (or even can) consume this data afterwards.
@@ -2031,7 +4827,7 @@ void caerInputCommonExit(caerModuleData moduleData) {
 		atomic_fetch_sub_explicit(&state->dataAvailableModule, 1, memory_order_relaxed);
 	}
 
-	caerRingBufferFree(state->transferRingPacketContainers);
+	caerQueueFree(state->transferRingPacketContainers);
 
 	// Check we indeed removed all data and counters match this expectation.
 	if (atomic_load(&state->dataAvailableModule) != 0) {
@@ -2042,17 +4838,23 @@ void caerInputCommonExit(caerModuleData moduleData) {
 	}
 
 	caerEventPacketHeader packet;
-	while ((packet = caerRingBufferGet(state->transferRingPackets)) != NULL) {
-		free(packet);
+	while ((packet = caerQueueGet(state->transferRingPackets)) != NULL) {
+		if (packet != SEEK_MARKER) {
+			free(packet);
+		}
 	}
 
-	caerRingBufferFree(state->transferRingPackets);
+	caerQueueFree(state->transferRingPackets);
+
+	// All threads using the signals have stopped.
+	caerQueueFree(state->assemblerSignal);
+	caerQueueFree(state->index.dataStartSignal);
 
 	// Free all waiting packets.
-	caerEventPacketHeader *packetPtr = NULL;
-	while (
-		(packetPtr = (caerEventPacketHeader *) utarray_next(state->packetContainer.eventPackets, packetPtr)) != NULL) {
-		free(*packetPtr);
+	struct input_common_pending_packet *pending = NULL;
+	while ((pending = (struct input_common_pending_packet *) utarray_next(state->packetContainer.eventPackets, pending))
+		   != NULL) {
+		free(pending->memory);
 	}
 
 	// Clear and free packet array used for packet container construction.
@@ -2065,6 +4867,10 @@ void caerInputCommonExit(caerModuleData moduleData) {
 
 	// Free allocated memory.
 	free(state->dataBuffer);
+	udpInputExit(state);
+	streamDecoderExit(state);
+	mmapInputClose(state);
+	replayCacheExit(state);
 
 	// Remove lingering packet parsing data.
 	packetData curr, curr_tmp;
@@ -2091,7 +4897,7 @@ void caerInputCommonRun(caerModuleData moduleData, caerEventPacketContainer in,
 
 	inputCommonState state = moduleData->moduleState;
 
-	*out = caerRingBufferGet(state->transferRingPacketContainers);
+	*out = caerQueueGet(state->transferRingPacketContainers);
 
 	if (*out != NULL) {
 		// No special memory order for decrease, because the acquire load to even start running
@@ -2111,8 +4917,6 @@ void caerInputCommonRun(caerModuleData moduleData, caerEventPacketContainer in,
 
 static void caerInputCommonConfigListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
 	const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue) {
-	UNUSED_ARGUMENT(node);
-
 	caerModuleData moduleData = userData;
 	inputCommonState state    = moduleData->moduleState;
 
@@ -2128,6 +4932,12 @@ static void caerInputCommonConfigListener(sshsNode node, void *userData, enum ss
 		else if (changeType == SSHS_BOOL && caerStrEquals(changeKey, "pause")) {
 			// Set pause flag to given value.
 			atomic_store(&state->pause, changeValue.boolean);
+
+			// Time in pause doesn't count for pacing.
+			atomic_store(&state->pacing.reset, true);
+
+			// If full, a wake-up is pending already.
+			caerQueuePut(state->assemblerSignal, state);
 		}
 		else if (changeType == SSHS_INT && caerStrEquals(changeKey, "bufferSize")) {
 			// Set buffer update flag.
@@ -2142,16 +4952,77 @@ static void caerInputCommonConfigListener(sshsNode node, void *userData, enum ss
 		else if (changeType == SSHS_INT && caerStrEquals(changeKey, "PacketContainerDelay")) {
 			atomic_store(&state->packetContainer.timeDelay, changeValue.iint);
 		}
+		else if (changeType == SSHS_STRING && caerStrEquals(changeKey, "PacketContainerPacing")) {
+			atomic_store(&state->pacing.mode, pacingModeParse(changeValue.string));
+			atomic_store(&state->pacing.reset, true);
+
+			caerQueuePut(state->assemblerSignal, state);
+		}
+		else if (changeType == SSHS_DOUBLE && caerStrEquals(changeKey, "PacketContainerSpeed")) {
+			atomic_store(&state->pacing.speed, I32T(changeValue.ddouble * 1000));
+
+			caerQueuePut(state->assemblerSignal, state);
+		}
+		else if (changeType == SSHS_LONG && caerStrEquals(changeKey, "seekTimestamp") && changeValue.ilong >= 0) {
+			inputSeek(state, changeValue.ilong, -1);
+
+			// Reset, so that seeking to the same position again is a change too.
+			sshsNodePutLong(node, "seekTimestamp", -1);
+		}
+		else if (changeType == SSHS_DOUBLE && caerStrEquals(changeKey, "seekFraction") && changeValue.ddouble >= 0) {
+			inputSeek(state, -1, changeValue.ddouble);
+
+			// Reset, so that seeking to the same position again is a change too.
+			sshsNodePutDouble(node, "seekFraction", -1);
+		}
+	}
+}
+
+static void statisticsPassthrough(
+	void *userData, const char *key, enum sshs_node_attr_value_type type, union sshs_node_attr_value *value) {
+	UNUSED_ARGUMENT(type); // We know all statistics are always LONG.
+
+	inputCommonState state = userData;
+
+	if (caerStrEquals(key, "pacingLag")) {
+		value->ilong = I64T(atomic_load_explicit(&state->pacing.lag, memory_order_relaxed));
+	}
+	else if (caerStrEquals(key, "pacingMaxLag")) {
+		value->ilong = I64T(atomic_load_explicit(&state->pacing.maxLag, memory_order_relaxed));
+	}
+	else if (caerStrEquals(key, "pacingLateContainers")) {
+		value->ilong = I64T(atomic_load_explicit(&state->pacing.lateContainers, memory_order_relaxed));
+	}
+	else if (caerStrEquals(key, "transferRingPacketsOccupancy")) {
+		value->ilong = I64T(caerQueueOccupancy(state->transferRingPackets));
+	}
+	else if (caerStrEquals(key, "transferRingPacketContainersOccupancy")) {
+		value->ilong = I64T(caerQueueOccupancy(state->transferRingPacketContainers));
+	}
+	else if (caerStrEquals(key, "udpMessagesReceived")) {
+		value->ilong = I64T(atomic_load_explicit(&state->udp.messagesReceived, memory_order_relaxed));
+	}
+	else if (caerStrEquals(key, "udpMessagesLost")) {
+		value->ilong = I64T(atomic_load_explicit(&state->udp.messagesLost, memory_order_relaxed));
+	}
+	else if (caerStrEquals(key, "udpMessagesDiscarded")) {
+		value->ilong = I64T(atomic_load_explicit(&state->udp.messagesDiscarded, memory_order_relaxed));
+	}
+	else if (caerStrEquals(key, "udpPacketsReassembled")) {
+		value->ilong = I64T(atomic_load_explicit(&state->udp.packetsReassembled, memory_order_relaxed));
+	}
+	else if (caerStrEquals(key, "udpPacketsDropped")) {
+		value->ilong = I64T(atomic_load_explicit(&state->udp.packetsDropped, memory_order_relaxed));
 	}
 }
 
 static int packetsFirstTypeThenSizeCmp(const void *a, const void *b) {
-	const caerEventPacketHeader *aa = a;
-	const caerEventPacketHeader *bb = b;
+	const struct input_common_pending_packet *aa = a;
+	const struct input_common_pending_packet *bb = b;
 
 	// Sort first by type ID.
-	int16_t eventTypeA = caerEventPacketHeaderGetEventType(*aa);
-	int16_t eventTypeB = caerEventPacketHeaderGetEventType(*bb);
+	int16_t eventTypeA = caerEventPacketHeaderGetEventType(aa->packet);
+	int16_t eventTypeB = caerEventPacketHeaderGetEventType(bb->packet);
 
 	if (eventTypeA < eventTypeB) {
 		return (-1);
@@ -2161,8 +5032,8 @@ static int packetsFirstTypeThenSizeCmp(const void *a, const void *b) {
 	}
 	else {
 		// If equal, further sort by event size.
-		int32_t eventSizeA = caerEventPacketHeaderGetEventSize(*aa);
-		int32_t eventSizeB = caerEventPacketHeaderGetEventSize(*bb);
+		int32_t eventSizeA = caerEventPacketHeaderGetEventSize(aa->packet);
+		int32_t eventSizeB = caerEventPacketHeaderGetEventSize(bb->packet);
 
 		if (eventSizeA < eventSizeB) {
 			return (-1);
@@ -1,9 +1,9 @@
 #ifndef INPUT_COMMON_H_
 #define INPUT_COMMON_H_
 
-#include <libcaer/ringbuffer.h>
 #include "caer-sdk/buffers.h"
 #include "caer-sdk/module.h"
+#include "caer-sdk/queue.h"
 #include "../inout_common.h"
 #include "ext/uthash/utarray.h"
 #include <unistd.h>
@@ -56,6 +56,247 @@ struct input_packet_data {
 
 typedef struct input_packet_data *packetData;
 
+struct input_index_entry {
+	/// File offset of the packet (header), in bytes.
+	uint64_t offset;
+	/// First (lowest) timestamp.
+	int64_t startTimestamp;
+	/// Last (highest) timestamp.
+	int64_t endTimestamp;
+	/// Highest last timestamp of all packets up to this one in the same
+	/// epoch. Unlike the others it never decreases, so it can be searched.
+	int64_t maxEndTimestamp;
+	/// Contained number of events.
+	int32_t eventNumber;
+	/// Timestamp epoch: number of timestamp resets before this packet.
+	int32_t epoch;
+	/// Contained event type.
+	int16_t eventType;
+	/// Event source ID.
+	int16_t eventSource;
+};
+
+struct input_common_index_data {
+	/// Index of the packets in the file, in file order.
+	struct input_index_entry *entries;
+	/// Number of indexed packets.
+	size_t entriesSize;
+	/// Allocated space for entries.
+	size_t entriesCapacity;
+	/// Protects entries, as they are added by the indexer thread.
+	mtx_t lock;
+	/// The whole file has been indexed.
+	atomic_bool ready;
+	/// Offset of the first packet in the file (right after the header).
+	/// Set by the reader thread once the header is parsed, zero until then.
+	atomic_size_t dataStart;
+	/// Signalled by the reader thread right after dataStart is set.
+	caerQueue dataStartSignal;
+	/// Background thread loading or building the index.
+	thrd_t indexerThread;
+	/// Indexer thread was started and must be joined.
+	bool indexerRunning;
+	/// Own file descriptor, the reader closes its one on EOF.
+	int fileDescriptor;
+	/// Path of the sidecar file the index is persisted to.
+	char *indexFilePath;
+};
+
+struct input_common_seek_data {
+	/// Protects the seek target and the request flags.
+	mtx_t lock;
+	/// Reader thread must move to the seek target.
+	atomic_bool readerRequest;
+	/// Assembler thread must drop packets until the seek marker arrives.
+	atomic_bool assemblerRequest;
+	/// File offset of the first packet to read after seeking.
+	size_t offset;
+	/// Timestamp to resume playback at, earlier packets are dropped.
+	int64_t timestamp;
+	/// Assembler: drop packets ending before this timestamp (-1 = off).
+	int64_t skipUntilTimestamp;
+};
+
+enum input_decompress_job_status {
+	DECOMPRESS_JOB_PENDING = 0,
+	DECOMPRESS_JOB_DONE    = 1,
+	DECOMPRESS_JOB_FAILED  = -1,
+};
+
+struct input_common_decompress_job {
+	/// Packet read from the input, owned by the job until forwarded.
+	caerEventPacketHeader packet;
+	/// Meta-data of the packet, timestamps are filled in after decompression.
+	packetData metaData;
+	/// File is in AEDAT 3.0 format, coordinates need conversion.
+	bool isAEDAT30;
+	/// Job status, see enum input_decompress_job_status.
+	atomic_int_fast32_t status;
+	/// Worker the job was handed to, NULL once its completion was collected
+	/// or if the reader finished the packet itself.
+	struct input_common_decompress_worker *worker;
+};
+
+struct input_common_decompress_worker {
+	/// Reference to common input state.
+	struct input_common_state *state;
+	/// Jobs to be done by this worker.
+	caerQueue jobsRing;
+	/// Jobs finished by this worker, in the order they were handed out,
+	/// so the reader thread can wait for completion without polling.
+	caerQueue doneRing;
+	/// Worker thread.
+	thrd_t thread;
+};
+
+struct input_common_decompress_data {
+	/// Number of decompression worker threads. Zero means packets are
+	/// decompressed directly by the reader thread.
+	size_t workersNumber;
+	/// Decompression worker threads and their job queues.
+	struct input_common_decompress_worker *workers;
+	/// Next worker to hand a job to (round-robin).
+	size_t nextWorker;
+	/// Jobs in stream order, so packets can be forwarded in the order they were
+	/// read. Circular buffer, only used by the reader thread.
+	struct input_common_decompress_job *jobs;
+	/// Maximum number of jobs in flight.
+	size_t jobsSize;
+	/// Oldest job, next to be forwarded.
+	size_t jobsHead;
+	/// Number of jobs in flight.
+	size_t jobsCount;
+};
+
+struct input_common_replay_data {
+	/// Loop replay from memory requested (files only, set at init).
+	bool enabled;
+	/// Packets are still being stored, during the first pass through the file.
+	bool collecting;
+	/// Decoded packets (header + events), one after the other, 8 byte aligned.
+	uint8_t *store;
+	/// Used size of the store, in bytes.
+	size_t storeSize;
+	/// Allocated size of the store, in bytes.
+	size_t storeCapacity;
+	/// Maximum size of the store, in bytes.
+	size_t storeLimit;
+	/// Lowest event timestamp in the store (first packet's first event).
+	int64_t firstTimestamp;
+	/// Highest event timestamp in the store.
+	int64_t lastTimestamp;
+};
+
+struct input_common_udp_message {
+	/// Sequence number, without the start-of-packet bit. -1 if there is no message.
+	int64_t sequenceNumber;
+	/// First message of an event packet.
+	bool packetStart;
+	/// Size of the event packet data in this message (after the network header), in bytes.
+	size_t dataLength;
+	/// Datagram memory: network header followed by event packet data.
+	uint8_t *buffer;
+};
+
+struct input_common_udp_data {
+	/// Receive buffers for one batch of datagrams, 'dataLength' is the datagram size.
+	/// A received buffer is swapped with the free one of the window slot it
+	/// belongs to, so nothing is copied.
+	struct input_common_udp_message *batch;
+	/// Receive call descriptors, one per batch buffer.
+	struct mmsghdr *batchHeaders;
+	/// Receive call scatter/gather descriptors, one per batch buffer.
+	struct iovec *batchIovecs;
+	/// Maximum number of datagrams to receive with one system call.
+	size_t batchSize;
+	/// Number of datagrams received into the batch buffers.
+	size_t batchReceived;
+	/// Received datagrams up to this one were put into the window.
+	size_t batchPosition;
+	/// Reorder window, ring of messages indexed by sequence number modulo windowSize.
+	struct input_common_udp_message *window;
+	/// Number of messages in the reorder window. Bigger event packets can't be reassembled.
+	size_t windowSize;
+	/// How long to wait for missing messages before giving up on them, in µs.
+	int64_t reorderTimeout;
+	/// Next sequence number to deliver. -1 until the first start-of-packet message arrives.
+	int64_t nextSequenceNumber;
+	/// Highest sequence number received.
+	int64_t highestSequenceNumber;
+	/// Consecutive messages older than the next one to deliver. Stragglers are
+	/// isolated, a whole window of them means the sender started over.
+	size_t oldMessages;
+	/// Delivery is waiting on missing messages, since 'blockedSince'.
+	bool blocked;
+	/// Monotonic clock time delivery started waiting on missing messages.
+	struct timespec blockedSince;
+	/// Messages up to (excluding) this sequence number make up the complete event
+	/// packet currently being delivered.
+	int64_t deliverEnd;
+	/// Bytes of the message 'nextSequenceNumber' already delivered.
+	size_t deliverOffset;
+	/// The network header was delivered, before the first event packet.
+	bool headerDelivered;
+	/// Number of received messages.
+	atomic_uint_fast64_t messagesReceived;
+	/// Number of messages that never arrived (sequence number gaps).
+	atomic_uint_fast64_t messagesLost;
+	/// Number of received messages that couldn't be used.
+	atomic_uint_fast64_t messagesDiscarded;
+	/// Number of event packets reassembled and delivered.
+	atomic_uint_fast64_t packetsReassembled;
+	/// Number of event packets given up on, because messages were missing.
+	atomic_uint_fast64_t packetsDropped;
+};
+
+struct input_common_data_view {
+	/// Data to parse, either dataBuffer content or the mapped file window.
+	const uint8_t *buffer;
+	/// Current position inside data.
+	size_t bufferPosition;
+	/// Size of data, in bytes.
+	size_t bufferUsedSize;
+};
+
+struct input_common_mmap_data {
+	/// Read the file through a memory mapping, instead of into dataBuffer.
+	bool enabled;
+	/// Total file size, in bytes.
+	size_t fileSize;
+	/// File offset of the next window to map.
+	size_t nextOffset;
+	/// Currently mapped file window, NULL if none.
+	void *window;
+	/// Size of currently mapped file window, in bytes.
+	size_t windowSize;
+};
+
+enum input_stream_compression {
+	STREAM_UNCOMPRESSED = 0,
+	STREAM_GZIP         = 1,
+	STREAM_ZSTD         = 2,
+	STREAM_LZ4          = 3,
+};
+
+struct input_common_stream_decoder_data {
+	/// Compression of the whole input file, detected at init (files only).
+	enum input_stream_compression format;
+	/// Decoder context (z_stream, ZSTD_DStream or LZ4F_dctx), NULL if uncompressed.
+	void *context;
+	/// Compressed data read from the file, waiting to be decoded.
+	uint8_t *readAhead;
+	/// Size of the read-ahead buffer, in bytes.
+	size_t readAheadSize;
+	/// Compressed data in the read-ahead buffer, in bytes.
+	size_t readAheadUsed;
+	/// Compressed data already decoded, index into readAhead.
+	size_t readAheadPosition;
+	/// The end of the file has been read.
+	bool inputEnd;
+	/// Decoder stopped in the middle of a compressed frame.
+	bool frameOpen;
+};
+
 struct input_common_packet_data {
 	/// Current packet header, to support headers being split across buffers.
 	uint8_t currPacketHeader[CAER_EVENT_PACKET_HEADER_SIZE];
@@ -77,8 +318,20 @@ struct input_common_packet_data {
 	size_t packetCount;
 };
 
+/// A merged packet waiting to be sliced into packet containers. Events that
+/// remain after a time-slice split are not copied: they stay where they are
+/// and get a new header written right in front of them, so 'packet' can point
+/// into the middle of the allocation 'memory'.
+struct input_common_pending_packet {
+	/// Allocated memory block, what free() and realloc() must be called on.
+	caerEventPacketHeader memory;
+	/// Valid packet (header + events still to send), inside 'memory'.
+	caerEventPacketHeader packet;
+};
+
 struct input_common_packet_container_data {
 	/// Current events, merged into packets, sorted by type.
+	/// Elements are of type 'struct input_common_pending_packet'.
 	UT_array *eventPackets;
 	/// The first main timestamp (the one relevant for packet ordering in streams)
 	/// of the last event packet that was handled.
@@ -108,6 +361,39 @@ struct input_common_packet_container_data {
 	struct timespec lastCommitTime;
 };
 
+enum input_pacing_mode {
+	/// Fixed delay between consecutive time slices ('timeDelay').
+	PACING_DELAY = 0,
+	/// Commit packet containers at the time their events happened, scaled by a speed factor.
+	PACING_TIMESTAMPS = 1,
+	/// No pacing, commit packet containers as fast as possible.
+	PACING_UNLIMITED = 2,
+};
+
+struct input_common_pacing_data {
+	/// Pacing mode, see enum input_pacing_mode.
+	atomic_int_fast32_t mode;
+	/// Playback speed factor for timestamp pacing, in thousandths (1000 = real time).
+	atomic_int_fast32_t speed;
+	/// Request to start a new schedule at the next packet container, after
+	/// discontinuities in playback like seeking or pausing.
+	atomic_bool reset;
+	/// A schedule is active, anchored at the values below.
+	bool anchored;
+	/// Monotonic clock time the schedule started at.
+	struct timespec anchorTime;
+	/// Event timestamp (in µs) corresponding to 'anchorTime'.
+	int64_t anchorTimestamp;
+	/// Speed factor the schedule was computed for.
+	int32_t anchorSpeed;
+	/// How late (in µs) the last packet container was committed, compared to its schedule.
+	atomic_int_fast64_t lag;
+	/// Highest lag (in µs) seen with the current schedule.
+	atomic_int_fast64_t maxLag;
+	/// Number of packet containers committed more than PACING_LATE_THRESHOLD late.
+	atomic_uint_fast64_t lateContainers;
+};
+
 struct input_common_state {
 	/// Control flag for input handling threads.
 	atomic_bool running;
@@ -139,11 +425,15 @@ struct input_common_state {
 	atomic_bool pause;
 	/// Transfer packets coming from the input reading thread to the assembly
 	/// thread. Normal EventPackets are used here.
-	caerRingBuffer transferRingPackets;
+	caerQueue transferRingPackets;
 	/// Transfer packet containers coming from the input assembly thread to
 	/// the mainloop. We use EventPacketContainers, as that is the standard
 	/// data structure returned from an input module.
-	caerRingBuffer transferRingPacketContainers;
+	caerQueue transferRingPacketContainers;
+	/// Wakes up the assembly thread when pause or pacing settings change, so
+	/// it can sleep in between instead of polling. Filled by the configuration
+	/// listener, which SSHS never calls concurrently for the same node.
+	caerQueue assemblerSignal;
 	/// Track how many packet containers are in the ring-buffer, ready for
 	/// consumption by the user. The Mainloop's 'dataAvailable' variable already
 	/// does this at a global level, but we also need to keep track at a local
@@ -162,6 +452,24 @@ struct input_common_state {
 	simpleBuffer dataBuffer;
 	/// Offset for current data buffer.
 	size_t dataBufferOffset;
+	/// Data currently being parsed.
+	struct input_common_data_view dataView;
+	/// Memory-mapped file input.
+	struct input_common_mmap_data mmap;
+	/// Decoding of compressed files while reading.
+	struct input_common_stream_decoder_data streamDecoder;
+	/// Packet index for seeking (files only).
+	struct input_common_index_data index;
+	/// Seek requests (files only).
+	struct input_common_seek_data seek;
+	/// Parallel decompression of packets.
+	struct input_common_decompress_data decompress;
+	/// In-memory loop replay (files only).
+	struct input_common_replay_data replay;
+	/// Playback pacing of packet container commits.
+	struct input_common_pacing_data pacing;
+	/// UDP reception and event packet reassembly (message-based network streams only).
+	struct input_common_udp_data udp;
 	/// Flag to signal update to buffer configuration asynchronously.
 	atomic_bool bufferUpdate;
 	/// Reference to parent module's original data.
@@ -0,0 +1,187 @@
+#include "caer-sdk/mainloop.h"
+#include "input_common.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+static bool caerInputNetUDPInit(caerModuleData moduleData);
+static bool setSocketReceiveBuffer(caerModuleData moduleData, int sockFd);
+static bool joinMulticastGroup(caerModuleData moduleData, int sockFd, struct in_addr *bindAddress);
+
+static const struct caer_module_functions InputNetUDPFunctions = {.moduleInit = &caerInputNetUDPInit,
+	.moduleRun                                                                = &caerInputCommonRun,
+	.moduleConfig                                                             = NULL,
+	.moduleExit                                                               = &caerInputCommonExit};
+
+static const struct caer_event_stream_out InputNetUDPOutputs[] = {{.type = -1}};
+
+static const struct caer_module_info InputNetUDPInfo = {
+	.version           = 1,
+	.name              = "NetUDPInput",
+	.description       = "Receive AEDAT 3 data via UDP messages.",
+	.type              = CAER_MODULE_INPUT,
+	.memSize           = sizeof(struct input_common_state),
+	.functions         = &InputNetUDPFunctions,
+	.inputStreams      = NULL,
+	.inputStreamsSize  = 0,
+	.outputStreams     = InputNetUDPOutputs,
+	.outputStreamsSize = CAER_EVENT_STREAM_OUT_SIZE(InputNetUDPOutputs),
+};
+
+caerModuleInfo caerModuleGetInfo(void) {
+	return (&InputNetUDPInfo);
+}
+
+static bool caerInputNetUDPInit(caerModuleData moduleData) {
+	// First, always create all needed setting nodes, set their default values
+	// and add their listeners.
+	sshsNodeCreateString(moduleData->moduleNode, "ipAddress", "127.0.0.1", 7, 15, SSHS_FLAGS_NORMAL,
+		"IPv4 address to listen on (0.0.0.0 for all interfaces). Ignored when joining a multicast group, the socket is "
+		"then bound to the group address, use multicastInterface to select the interface.");
+	sshsNodeCreateInt(
+		moduleData->moduleNode, "portNumber", 6666, 1, UINT16_MAX, SSHS_FLAGS_NORMAL, "Port number to listen on.");
+	sshsNodeCreateString(moduleData->moduleNode, "multicastGroup", "", 0, 15, SSHS_FLAGS_NORMAL,
+		"IPv4 multicast group to join, empty to not join any.");
+	sshsNodeCreateString(moduleData->moduleNode, "multicastInterface", "0.0.0.0", 7, 15, SSHS_FLAGS_NORMAL,
+		"IPv4 address of the interface to join the multicast group on (0.0.0.0 lets the system choose).");
+	sshsNodeCreateInt(moduleData->moduleNode, "socketBufferSize", 16 * 1024 * 1024, 64 * 1024, 512 * 1024 * 1024,
+		SSHS_FLAGS_NORMAL, "Size of the socket receive buffer in bytes, to absorb bursts of UDP messages.");
+
+	// Open a UDP socket to receive data packets on.
+	int sockFd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (sockFd < 0) {
+		caerModuleLog(moduleData, CAER_LOG_CRITICAL, "Could not create UDP socket. Error: %d.", errno);
+		return (false);
+	}
+
+	struct sockaddr_in udpServer;
+	memset(&udpServer, 0, sizeof(struct sockaddr_in));
+
+	udpServer.sin_family = AF_INET;
+	udpServer.sin_port   = htons(U16T(sshsNodeGetInt(moduleData->moduleNode, "portNumber")));
+
+	char *ipAddress = sshsNodeGetString(moduleData->moduleNode, "ipAddress");
+	if (inet_pton(AF_INET, ipAddress, &udpServer.sin_addr) == 0) {
+		close(sockFd);
+
+		caerModuleLog(moduleData, CAER_LOG_CRITICAL, "No valid IP address found. '%s' is invalid!", ipAddress);
+
+		free(ipAddress);
+		return (false);
+	}
+	free(ipAddress);
+
+	// Big buffers avoid the kernel dropping messages while the reader is busy.
+	setSocketReceiveBuffer(moduleData, sockFd);
+
+	// When joining a multicast group, bind to the group address instead, so that
+	// only datagrams sent to that group are received. Binding to a unicast
+	// address would filter out all multicast traffic.
+	if (!joinMulticastGroup(moduleData, sockFd, &udpServer.sin_addr)) {
+		close(sockFd);
+		return (false);
+	}
+
+	if (bind(sockFd, (struct sockaddr *) &udpServer, sizeof(struct sockaddr_in)) != 0) {
+		close(sockFd);
+
+		caerModuleLog(moduleData, CAER_LOG_CRITICAL, "Could not bind UDP socket to %s:%" PRIu16 ". Error: %d.",
+			inet_ntop(AF_INET, &udpServer.sin_addr, (char[INET_ADDRSTRLEN]){0x00}, INET_ADDRSTRLEN),
+			ntohs(udpServer.sin_port), errno);
+		return (false);
+	}
+
+	caerModuleLog(moduleData, CAER_LOG_INFO, "UDP socket listening on %s:%" PRIu16 ", waiting for data.",
+		inet_ntop(AF_INET, &udpServer.sin_addr, (char[INET_ADDRSTRLEN]){0x00}, INET_ADDRSTRLEN),
+		ntohs(udpServer.sin_port));
+
+	if (!caerInputCommonInit(moduleData, sockFd, true, true)) {
+		close(sockFd);
+		return (false);
+	}
+
+	return (true);
+}
+
+static bool setSocketReceiveBuffer(caerModuleData moduleData, int sockFd) {
+	int bufferSize = sshsNodeGetInt(moduleData->moduleNode, "socketBufferSize");
+
+#if defined(SO_RCVBUFFORCE)
+	// Privileged processes can go past the system-wide maximum (net.core.rmem_max).
+	if (setsockopt(sockFd, SOL_SOCKET, SO_RCVBUFFORCE, &bufferSize, sizeof(bufferSize)) == 0) {
+		return (true);
+	}
+#endif
+
+	if (setsockopt(sockFd, SOL_SOCKET, SO_RCVBUF, &bufferSize, sizeof(bufferSize)) != 0) {
+		caerModuleLog(moduleData, CAER_LOG_WARNING, "Could not set UDP socket receive buffer size. Error: %d.", errno);
+		return (false);
+	}
+
+	// The system silently limits the size, check what we actually got.
+	// Linux reports double the size, to account for its own overhead.
+	int actualBufferSize          = 0;
+	socklen_t actualBufferSizeLen = sizeof(actualBufferSize);
+
+	if ((getsockopt(sockFd, SOL_SOCKET, SO_RCVBUF, &actualBufferSize, &actualBufferSizeLen) == 0)
+		&& (actualBufferSize < bufferSize)) {
+		caerModuleLog(moduleData, CAER_LOG_WARNING,
+			"UDP socket receive buffer limited to %d bytes instead of %d, messages may be lost in bursts. "
+			"Raise the system limit (net.core.rmem_max on Linux) to allow bigger buffers.",
+			actualBufferSize, bufferSize);
+	}
+
+	return (true);
+}
+
+static bool joinMulticastGroup(caerModuleData moduleData, int sockFd, struct in_addr *bindAddress) {
+	char *multicastGroup = sshsNodeGetString(moduleData->moduleNode, "multicastGroup");
+
+	if (multicastGroup[0] == '\0') {
+		// Unicast, nothing to do.
+		free(multicastGroup);
+		return (true);
+	}
+
+	struct ip_mreq membership;
+	memset(&membership, 0, sizeof(struct ip_mreq));
+
+	if (inet_pton(AF_INET, multicastGroup, &membership.imr_multiaddr) == 0
+		|| !IN_MULTICAST(ntohl(membership.imr_multiaddr.s_addr))) {
+		caerModuleLog(
+			moduleData, CAER_LOG_CRITICAL, "No valid multicast group found. '%s' is invalid!", multicastGroup);
+
+		free(multicastGroup);
+		return (false);
+	}
+	free(multicastGroup);
+
+	char *multicastInterface = sshsNodeGetString(moduleData->moduleNode, "multicastInterface");
+	if (inet_pton(AF_INET, multicastInterface, &membership.imr_interface) == 0) {
+		caerModuleLog(moduleData, CAER_LOG_CRITICAL, "No valid multicast interface address found. '%s' is invalid!",
+			multicastInterface);
+
+		free(multicastInterface);
+		return (false);
+	}
+	free(multicastInterface);
+
+	// Several receivers on the same machine can listen to the same group.
+	int reuseAddress = 1;
+	if (setsockopt(sockFd, SOL_SOCKET, SO_REUSEADDR, &reuseAddress, sizeof(reuseAddress)) != 0) {
+		caerModuleLog(moduleData, CAER_LOG_WARNING, "Could not set address reuse on UDP socket. Error: %d.", errno);
+	}
+
+	if (setsockopt(sockFd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(struct ip_mreq)) != 0) {
+		caerModuleLog(moduleData, CAER_LOG_CRITICAL, "Could not join multicast group %s. Error: %d.",
+			inet_ntop(AF_INET, &membership.imr_multiaddr, (char[INET_ADDRSTRLEN]){0x00}, INET_ADDRSTRLEN), errno);
+		return (false);
+	}
+
+	caerModuleLog(moduleData, CAER_LOG_INFO, "Joined multicast group %s.",
+		inet_ntop(AF_INET, &membership.imr_multiaddr, (char[INET_ADDRSTRLEN]){0x00}, INET_ADDRSTRLEN));
+
+	*bindAddress = membership.imr_multiaddr;
+
+	return (true);
+}
@@ -4,6 +4,11 @@
 #include <libcaer/network.h>
 #include "caer-sdk/utils.h"
 
+// Upper bound on how long the input/output threads sleep on their transfer
+// queues (in µs). They are woken up as soon as there is data or space, this
+// is only so they periodically check whether they have to stop.
+#define INOUT_QUEUE_WAIT_TIME 100000
+
 static inline void caerGenericEventSetTimestamp(
 	void *eventPtr, caerEventPacketHeaderConst headerPtr, int32_t timestamp) {
 	*((int32_t *) (((uint8_t *) eventPtr) + U64T(caerEventPacketHeaderGetEventTSOffset(headerPtr))))
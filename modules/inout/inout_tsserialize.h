@@ -0,0 +1,317 @@
+#ifndef INPUT_OUTPUT_TSSERIALIZE_H_
+#define INPUT_OUTPUT_TSSERIALIZE_H_
+
+#include "inout_common.h"
+#include <libcaer/events/common.h>
+#include <string.h>
+
+// Define INOUT_TSSERIALIZE_NO_SIMD to always use the scalar code.
+#if !defined(INOUT_TSSERIALIZE_NO_SIMD)
+#if defined(__SSE2__)
+#define INOUT_TSSERIALIZE_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#define INOUT_TSSERIALIZE_NEON 1
+#include <arm_neon.h>
+#endif
+#endif
+
+/**
+ * Serialized timestamps, AEDAT 3 data compression technique 1 (format ID bit 0).
+ *
+ * Runs of three or more consecutive events with the same timestamp are stored
+ * as: first event with the timestamp's highest bit set, second event with the
+ * number of following events as timestamp, then only the data part (all bytes
+ * before the timestamp) of each following event. Requires the timestamp to be
+ * the last field of the event, which is the case for polarity events.
+ *
+ * Both directions work in place on the packet memory, without any allocation.
+ * Polarity events (8 bytes, timestamp at offset 4) use SSE2/NEON if available.
+ */
+
+static inline bool caerTimestampSerializeFastPath(size_t eventSize, size_t tsOffset) {
+#if defined(INOUT_TSSERIALIZE_SSE2) || defined(INOUT_TSSERIALIZE_NEON)
+	return ((eventSize == 8) && (tsOffset == 4));
+#else
+	UNUSED_ARGUMENT(eventSize);
+	UNUSED_ARGUMENT(tsOffset);
+
+	return (false);
+#endif
+}
+
+/**
+ * Count how many consecutive events, starting with the first, share its timestamp.
+ * Timestamps are compared in their stored (little-endian) form.
+ */
+static inline size_t caerTimestampSerializeRunLength(
+	const uint8_t *events, size_t eventsNumber, size_t eventSize, size_t tsOffset) {
+	uint32_t runTS;
+	memcpy(&runTS, events + tsOffset, sizeof(runTS));
+
+	size_t i = 1;
+
+	if (caerTimestampSerializeFastPath(eventSize, tsOffset)) {
+		// Compare four timestamps at once, then find the exact end below.
+#if defined(INOUT_TSSERIALIZE_SSE2)
+		__m128i runTSVector = _mm_set1_epi32((int32_t) runTS);
+
+		for (; (i + 4) <= eventsNumber; i += 4) {
+			__m128i low  = _mm_loadu_si128((const __m128i *) (events + (i * 8)));
+			__m128i high = _mm_loadu_si128((const __m128i *) (events + (i * 8) + 16));
+
+			// Timestamps are the odd 32-bit lanes.
+			int equalMask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(low, runTSVector)))
+							| (_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(high, runTSVector))) << 4);
+
+			if ((equalMask & 0xAA) != 0xAA) {
+				break;
+			}
+		}
+#elif defined(INOUT_TSSERIALIZE_NEON)
+		uint32x4_t runTSVector = vdupq_n_u32(runTS);
+
+		for (; (i + 4) <= eventsNumber; i += 4) {
+			// De-interleave: val[0] are the data words, val[1] the timestamps.
+			uint32x4x2_t fourEvents = vld2q_u32((const uint32_t *) (events + (i * 8)));
+			uint32x4_t equal        = vceqq_u32(fourEvents.val[1], runTSVector);
+			uint32x2_t equalHalves  = vand_u32(vget_low_u32(equal), vget_high_u32(equal));
+
+			if ((vget_lane_u32(equalHalves, 0) & vget_lane_u32(equalHalves, 1)) == 0) {
+				break;
+			}
+		}
+#endif
+	}
+
+	for (; i < eventsNumber; i++) {
+		uint32_t currTS;
+		memcpy(&currTS, events + (i * eventSize) + tsOffset, sizeof(currTS));
+
+		if (currTS != runTS) {
+			break;
+		}
+	}
+
+	return (i);
+}
+
+/**
+ * Move the data part of eventsNumber events together, dropping their timestamps.
+ * dst must not be after src, they can overlap.
+ */
+static inline void caerTimestampSerializeCompactRun(
+	uint8_t *dst, const uint8_t *src, size_t eventsNumber, size_t eventSize, size_t tsOffset) {
+	size_t i = 0;
+
+	if (caerTimestampSerializeFastPath(eventSize, tsOffset)) {
+		// Load four events before storing their data, so overlapping is fine.
+#if defined(INOUT_TSSERIALIZE_SSE2)
+		for (; (i + 4) <= eventsNumber; i += 4) {
+			__m128i low  = _mm_loadu_si128((const __m128i *) (src + (i * 8)));
+			__m128i high = _mm_loadu_si128((const __m128i *) (src + (i * 8) + 16));
+
+			// Gather the even 32-bit lanes (data) into the lower half, then join.
+			low  = _mm_shuffle_epi32(low, _MM_SHUFFLE(3, 1, 2, 0));
+			high = _mm_shuffle_epi32(high, _MM_SHUFFLE(3, 1, 2, 0));
+
+			_mm_storeu_si128((__m128i *) (dst + (i * 4)), _mm_unpacklo_epi64(low, high));
+		}
+#elif defined(INOUT_TSSERIALIZE_NEON)
+		for (; (i + 4) <= eventsNumber; i += 4) {
+			uint32x4x2_t fourEvents = vld2q_u32((const uint32_t *) (src + (i * 8)));
+
+			vst1q_u32((uint32_t *) (dst + (i * 4)), fourEvents.val[0]);
+		}
+#endif
+	}
+
+	for (; i < eventsNumber; i++) {
+		memmove(dst + (i * tsOffset), src + (i * eventSize), tsOffset);
+	}
+}
+
+/**
+ * Restore eventsNumber full events from their data parts, adding the timestamp.
+ * dst must not be after src, and may only overlap it as far as the expanded
+ * events never overtake the data parts still to be read (see decompression).
+ */
+static inline void caerTimestampSerializeExpandRun(
+	uint8_t *dst, const uint8_t *src, size_t eventsNumber, size_t eventSize, size_t tsOffset, uint32_t runTS) {
+	size_t i = 0;
+
+	if (caerTimestampSerializeFastPath(eventSize, tsOffset)) {
+		// Load four data parts before storing the events, so overlapping is fine.
+#if defined(INOUT_TSSERIALIZE_SSE2)
+		__m128i runTSVector = _mm_set1_epi32((int32_t) runTS);
+
+		for (; (i + 4) <= eventsNumber; i += 4) {
+			__m128i data = _mm_loadu_si128((const __m128i *) (src + (i * 4)));
+
+			_mm_storeu_si128((__m128i *) (dst + (i * 8)), _mm_unpacklo_epi32(data, runTSVector));
+			_mm_storeu_si128((__m128i *) (dst + (i * 8) + 16), _mm_unpackhi_epi32(data, runTSVector));
+		}
+#elif defined(INOUT_TSSERIALIZE_NEON)
+		uint32x4_t runTSVector = vdupq_n_u32(runTS);
+
+		for (; (i + 4) <= eventsNumber; i += 4) {
+			uint32x4x2_t fourEvents = {{vld1q_u32((const uint32_t *) (src + (i * 4))), runTSVector}};
+
+			vst2q_u32((uint32_t *) (dst + (i * 8)), fourEvents);
+		}
+#endif
+	}
+
+	for (; i < eventsNumber; i++) {
+		memmove(dst + (i * eventSize), src + (i * tsOffset), tsOffset);
+		memcpy(dst + (i * eventSize) + tsOffset, &runTS, sizeof(runTS));
+	}
+}
+
+/**
+ * Compress an event packet in place with serialized timestamps.
+ *
+ * @param packet uncompressed event packet, timestamp must be the last event field.
+ *
+ * @return the event packet size (header + data) after compression.
+ *         Equal or smaller than the uncompressed packet size.
+ */
+static inline size_t caerTimestampSerializeCompress(caerEventPacketHeader packet) {
+	size_t eventSize   = (size_t) caerEventPacketHeaderGetEventSize(packet);
+	size_t tsOffset    = (size_t) caerEventPacketHeaderGetEventTSOffset(packet);
+	size_t eventNumber = (size_t) caerEventPacketHeaderGetEventNumber(packet);
+
+	uint8_t *events = ((uint8_t *) packet) + CAER_EVENT_PACKET_HEADER_SIZE; // No change to header.
+
+	// The write position never gets ahead of the read position, it
+	// only falls behind as runs are compressed.
+	size_t writeOffset = 0;
+
+	for (size_t i = 0; i < eventNumber;) {
+		uint8_t *event = events + (i * eventSize);
+		size_t run     = caerTimestampSerializeRunLength(event, eventNumber - i, eventSize, tsOffset);
+
+		// Compression makes sense starting with three events.
+		if (run >= 3) {
+			int32_t runTS = caerGenericEventGetTimestamp(event, packet);
+
+			// First event stays complete, with the TS highest bit set.
+			// Second one stores how many further events there are.
+			memmove(events + writeOffset, event, eventSize * 2);
+			caerGenericEventSetTimestamp(events + writeOffset, packet, runTS | I32T(0x80000000));
+			caerGenericEventSetTimestamp(events + writeOffset + eventSize, packet, I32T(run - 2));
+			writeOffset += eventSize * 2;
+
+			// Then only the data of the remaining events, without timestamps.
+			caerTimestampSerializeCompactRun(
+				events + writeOffset, event + (eventSize * 2), run - 2, eventSize, tsOffset);
+			writeOffset += tsOffset * (run - 2);
+		}
+		else {
+			// Just copy data unchanged if no compression is possible.
+			if (writeOffset != (i * eventSize)) {
+				memmove(events + writeOffset, event, eventSize * run);
+			}
+			writeOffset += eventSize * run;
+		}
+
+		i += run;
+	}
+
+	return (CAER_EVENT_PACKET_HEADER_SIZE + writeOffset);
+}
+
+/**
+ * Decompress an event packet with serialized timestamps in place.
+ * The packet memory must be big enough to hold all uncompressed events,
+ * and the header must already be restored (eventNumber, no compression bit).
+ *
+ * @param packet compressed event packet.
+ * @param packetSize size (header + data) of the compressed event packet.
+ *
+ * @return true on success, false if the compressed data is invalid.
+ */
+static inline bool caerTimestampSerializeDecompress(caerEventPacketHeader packet, size_t packetSize) {
+	size_t eventSize   = (size_t) caerEventPacketHeaderGetEventSize(packet);
+	size_t tsOffset    = (size_t) caerEventPacketHeaderGetEventTSOffset(packet);
+	size_t eventNumber = (size_t) caerEventPacketHeaderGetEventNumber(packet);
+
+	if ((packetSize < CAER_EVENT_PACKET_HEADER_SIZE) || (eventSize == 0) || ((tsOffset + 4) != eventSize)) {
+		return (false);
+	}
+
+	uint8_t *events         = ((uint8_t *) packet) + CAER_EVENT_PACKET_HEADER_SIZE; // No change to header.
+	size_t compressedSize   = packetSize - CAER_EVENT_PACKET_HEADER_SIZE;
+	size_t uncompressedSize = eventNumber * eventSize;
+
+	if (compressedSize > uncompressedSize) {
+		return (false);
+	}
+
+	// Move the compressed data to the end, then expand it from the start. Each
+	// step writes at most as much as it reads, plus what compression saved on
+	// that step, so writing never overtakes reading for valid data.
+	size_t readOffset = uncompressedSize - compressedSize;
+	memmove(events + readOffset, events, compressedSize);
+
+	size_t writeOffset     = 0;
+	size_t recoveredEvents = 0;
+
+	while (readOffset < uncompressedSize) {
+		size_t remainingData = uncompressedSize - readOffset;
+		uint8_t *event       = events + readOffset;
+
+		if ((remainingData < eventSize) || (recoveredEvents >= eventNumber)) {
+			return (false);
+		}
+
+		int32_t currTS = caerGenericEventGetTimestamp(event, packet);
+
+		if (currTS & I32T(0x80000000)) {
+			// Compressed run starts here! Second event carries the size of the run.
+			if ((remainingData < (eventSize * 2)) || ((eventNumber - recoveredEvents) < 2)) {
+				return (false);
+			}
+
+			currTS &= I32T(0x7FFFFFFF);
+
+			int32_t tsRun = caerGenericEventGetTimestamp(event + eventSize, packet);
+
+			if ((tsRun < 1) || ((size_t) tsRun > (eventNumber - recoveredEvents - 2))
+				|| (((size_t) tsRun * tsOffset) > (remainingData - (eventSize * 2)))) {
+				return (false);
+			}
+
+			// First and second event are complete, restore their timestamps.
+			memmove(events + writeOffset, event, eventSize * 2);
+			caerGenericEventSetTimestamp(events + writeOffset, packet, currTS);
+			caerGenericEventSetTimestamp(events + writeOffset + eventSize, packet, currTS);
+
+			writeOffset += eventSize * 2;
+			readOffset += eventSize * 2;
+
+			// Then the data-only events, adding the timestamp back.
+			caerTimestampSerializeExpandRun(events + writeOffset, events + readOffset, (size_t) tsRun, eventSize,
+				tsOffset, htole32(U32T(currTS)));
+
+			writeOffset += eventSize * (size_t) tsRun;
+			readOffset += tsOffset * (size_t) tsRun;
+			recoveredEvents += 2 + (size_t) tsRun;
+		}
+		else {
+			// Normal event, nothing compressed.
+			if (writeOffset != readOffset) {
+				memmove(events + writeOffset, event, eventSize);
+			}
+
+			writeOffset += eventSize;
+			readOffset += eventSize;
+			recoveredEvents++;
+		}
+	}
+
+	// Check we really recovered all events from compression.
+	return ((recoveredEvents == eventNumber) && (writeOffset == uncompressedSize));
+}
+
+#endif /* INPUT_OUTPUT_TSSERIALIZE_H_ */
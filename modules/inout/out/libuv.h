@@ -118,6 +118,7 @@ static inline bool simpleBufferFileRead(uv_loop_t *loop, uv_file file, int64_t f
 struct libuvWriteBufStruct {
 	uv_buf_t buf;
 	void *freeBuf;
+	void (*freeFunc)(void *buffer); // Used to free freeBuf, if NULL free() is used.
 };
 
 typedef struct libuvWriteBufStruct *libuvWriteBuf;
@@ -145,6 +146,15 @@ static inline libuvWriteMultiBuf libuvWriteBufAlloc(size_t number) {
 	return (writeBufs);
 }
 
+static inline void libuvWriteBufFreeData(libuvWriteBuf writeBuf) {
+	if (writeBuf->freeFunc != NULL) {
+		(*writeBuf->freeFunc)(writeBuf->freeBuf);
+	}
+	else {
+		free(writeBuf->freeBuf);
+	}
+}
+
 static inline void libuvWriteBufFree(libuvWriteMultiBuf buffers) {
 	if (buffers == NULL) {
 		return;
@@ -155,7 +165,7 @@ static inline void libuvWriteBufFree(libuvWriteMultiBuf buffers) {
 	// within one thread's event loop, no locking is needed.
 	if (buffers->refCount == 1) {
 		for (size_t i = 0; i < buffers->buffersSize; i++) {
-			free(buffers->buffers[i].freeBuf);
+			libuvWriteBufFreeData(&buffers->buffers[i]);
 		}
 
 		free(buffers->data);
@@ -177,6 +187,8 @@ static inline void libuvWriteBufInternalInit(
 	else {
 		writeBuf->freeBuf = bufferToFree;
 	}
+
+	writeBuf->freeFunc = NULL;
 }
 
 static inline void libuvWriteBufInit(libuvWriteBuf writeBuf, size_t size) {
@@ -208,6 +220,18 @@ static inline void libuvWriteBufInitWithAnyBuffer(libuvWriteBuf writeBuf, void *
 	libuvWriteBufInternalInit(writeBuf, buffer, bufferSize, NULL);
 }
 
+// Buffer is not owned, but released through the given function once written.
+static inline void libuvWriteBufInitWithReleasedBuffer(
+	libuvWriteBuf writeBuf, void *buffer, size_t bufferSize, void (*releaseFunc)(void *buffer)) {
+	if (buffer == NULL || bufferSize == 0) {
+		return;
+	}
+
+	libuvWriteBufInternalInit(writeBuf, buffer, bufferSize, NULL);
+
+	writeBuf->freeFunc = releaseFunc;
+}
+
 static inline void libuvWriteFree(uv_write_t *writeRequest, int status) {
 	libuvWriteMultiBuf buffers = writeRequest->data;
 
@@ -1,10 +1,11 @@
 /*
  * Here we handle all outputs in a common way, taking in event packets
  * as input and writing a byte buffer to a stream as output.
- * The main-loop part is responsible for gathering the event packets,
- * copying them and their events (valid or not depending on configuration),
+ * The main-loop part is responsible for gathering the event packets, taking
+ * a reference on them (no copy, the packets are immutable from then on),
  * and putting them on a transfer ring-buffer. A second thread, called the
- * output handler, gets the packet groups from there, orders them according
+ * compressor, gets the packet groups from there, filters out invalid events
+ * if so configured, copying only what must change, orders them according
  * to the AEDAT 3.X format specification, and breaks them up into chunks as
  * directed to write them to a file descriptor efficiently (buffered I/O).
  * The AEDAT 3.X format specification specifically states that there is no
@@ -67,9 +68,11 @@
  */
 
 #include "output_common.h"
+#include "../inout_tsserialize.h"
 #include "caer-sdk/buffers.h"
 #include "caer-sdk/cross/portable_io.h"
 #include "caer-sdk/cross/portable_threads.h"
+#include "caer-sdk/cross/portable_time.h"
 #include "caer-sdk/mainloop.h"
 #include "ext/net_rw.h"
 
@@ -90,18 +93,21 @@ static void caerOutputCommonConfigListener(sshsNode node, void *userData, enum s
  * ============================================================================
  * MAIN THREAD
  * ============================================================================
- * Handle Run and Reset operations on main thread. Data packets are copied into
- * the transferRing for processing by the compressor thread.
+ * Handle Run and Reset operations on main thread. Data packets are referenced
+ * into the transferRing for processing by the compressor thread.
  * ============================================================================
  */
-static void copyPacketsToTransferRing(outputCommonState state, caerEventPacketContainer packetsContainer);
+static void retainPacketsToTransferRing(outputCommonState state, caerEventPacketContainer packetsContainer);
+static void releaseEventPacket(void *packet);
+static void statisticsPassthrough(
+	void *userData, const char *key, enum sshs_node_attr_value_type type, union sshs_node_attr_value *value);
 
 void caerOutputCommonRun(caerModuleData moduleData, caerEventPacketContainer in, caerEventPacketContainer *out) {
 	UNUSED_ARGUMENT(out);
 
 	outputCommonState state = moduleData->moduleState;
 
-	copyPacketsToTransferRing(state, in);
+	retainPacketsToTransferRing(state, in);
 }
 
 void caerOutputCommonReset(caerModuleData moduleData, int16_t resetCallSourceID) {
@@ -137,7 +143,7 @@ void caerOutputCommonReset(caerModuleData moduleData, int16_t resetCallSourceID)
 		// Assign special packet to packet container.
 		caerEventPacketContainerSetEventPacket(tsResetContainer, SPECIAL_EVENT, (caerEventPacketHeader) tsResetPacket);
 
-		while (!caerRingBufferPut(state->compressorRing, tsResetContainer)) {
+		while (!caerQueuePutWait(state->compressorRing, tsResetContainer, INOUT_QUEUE_WAIT_TIME)) {
 			; // Ensure this goes into the first ring-buffer.
 		}
 
@@ -147,12 +153,14 @@ void caerOutputCommonReset(caerModuleData moduleData, int16_t resetCallSourceID)
 }
 
 /**
- * Copy event packets to the ring buffer for transfer to the output handler thread.
+ * Reference event packets into the ring buffer for transfer to the compressor thread.
+ * The packets are shared with the mainloop and all other outputs on the same
+ * stream, so they must not be modified before the compressor thread copies them.
  *
  * @param state output module state.
  * @param packetsContainer a container with all the event packets to send out.
  */
-static void copyPacketsToTransferRing(outputCommonState state, caerEventPacketContainer packetsContainer) {
+static void retainPacketsToTransferRing(outputCommonState state, caerEventPacketContainer packetsContainer) {
 	caerEventPacketHeaderConst packets[caerEventPacketContainerGetEventPacketsNumber(packetsContainer)];
 	size_t packetsSize = 0;
 
@@ -218,12 +226,11 @@ static void copyPacketsToTransferRing(outputCommonState state, caerEventPacketCo
 		return;
 	}
 
-	// Handle the valid only flag here, that way we don't have to do another copy and
-	// process it in the output handling thread. We get the value once here, so we do
-	// the same for all packets from the same mainloop run, avoiding mid-way changes.
+	// The valid only flag is applied in the compressor thread, this is only used to
+	// skip packets that would end up empty anyway.
 	bool validOnly = atomic_load_explicit(&state->validOnly, memory_order_relaxed);
 
-	// Now copy each event packet and send the array out. Track how many packets there are.
+	// Now reference each event packet and send the array out. Track how many packets there are.
 	size_t idx               = 0;
 	int64_t highestTimestamp = 0;
 
@@ -260,28 +267,23 @@ static void copyPacketsToTransferRing(outputCommonState state, caerEventPacketCo
 			}
 		}
 
-		if (validOnly) {
-			caerEventPacketContainerSetEventPacket(
-				eventPackets, (int32_t) idx, caerEventPacketCopyOnlyValidEvents(packets[i]));
-		}
-		else {
-			caerEventPacketContainerSetEventPacket(
-				eventPackets, (int32_t) idx, caerEventPacketCopyOnlyEvents(packets[i]));
-		}
+		// Packet is kept alive past this mainloop run by its reference.
+		caerEventPacketHeader packetRef = (caerEventPacketHeader) caerMainloopPacketRetain(packets[i]);
 
-		if (caerEventPacketContainerGetEventPacket(eventPackets, (int32_t) idx) == NULL) {
-			// Failed to copy packet. Signal but try to continue anyway.
-			caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to copy event packet to output.");
+		if (packetRef == NULL) {
+			// Failed to reference packet. Signal but try to continue anyway.
+			caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to reference event packet for output.");
 		}
 		else {
+			caerEventPacketContainerSetEventPacket(eventPackets, (int32_t) idx, packetRef);
 			idx++;
 		}
 	}
 
-	// We might have failed to copy all packets (unlikely), or skipped all of them
+	// We might have failed to reference all packets (unlikely), or skipped all of them
 	// due to timestamp check failures.
 	if (idx == 0) {
-		caerEventPacketContainerFree(eventPackets);
+		free(eventPackets);
 
 		return;
 	}
@@ -291,27 +293,28 @@ static void copyPacketsToTransferRing(outputCommonState state, caerEventPacketCo
 	state->lastTimestamp = highestTimestamp;
 
 	// Reset packet container size so we only consider the packets we managed
-	// to successfully copy.
+	// to successfully reference.
 	caerEventPacketContainerSetEventPacketsNumber(eventPackets, (int32_t) idx);
 
-retry:
-	if (!caerRingBufferPut(state->compressorRing, eventPackets)) {
-		if (atomic_load_explicit(&state->keepPackets, memory_order_relaxed)) {
-			// Delay by 500 µs if no change, to avoid a wasteful busy loop.
-			struct timespec retrySleep = {.tv_sec = 0, .tv_nsec = 500000};
-			thrd_sleep(&retrySleep, NULL);
+	bool success = caerQueuePut(state->compressorRing, eventPackets);
 
-			// Retry forever if requested.
-			goto retry;
-		}
+	// Retry forever if requested. Sleep until the compressor thread makes space.
+	while (!success && atomic_load_explicit(&state->keepPackets, memory_order_relaxed)) {
+		success = caerQueuePutWait(state->compressorRing, eventPackets, INOUT_QUEUE_WAIT_TIME);
+	}
 
-		caerEventPacketContainerFree(eventPackets);
+	if (!success) {
+		caerMainloopPacketContainerRelease(eventPackets);
 
 		caerModuleLog(
 			state->parentModule, CAER_LOG_NOTICE, "Failed to put packet's array copy on transfer ring-buffer: full.");
 	}
 }
 
+static void releaseEventPacket(void *packet) {
+	caerMainloopPacketRelease(packet);
+}
+
 /**
  * ============================================================================
  * COMPRESSOR THREAD
@@ -323,8 +326,16 @@ retry:
 static int compressorThread(void *stateArg);
 
 static void orderAndSendEventPackets(outputCommonState state, caerEventPacketContainer currPacketContainer);
+static caerEventPacketHeader prepareEventPacket(outputCommonState state, caerEventPacketHeader packet, bool validOnly);
+static bool packetNeedsCompression(outputCommonState state, caerEventPacketHeaderConst packet);
 static int packetsFirstTimestampThenTypeCmp(const void *a, const void *b);
 static void sendEventPacket(outputCommonState state, caerEventPacketHeader packet);
+static void forwardEventPacket(outputCommonState state, caerEventPacketHeader packet, size_t packetSize);
+static int outputCompressWorkerThread(void *workerArg);
+static bool compressPoolInit(outputCommonState state, size_t workersNumber, size_t jobsSize);
+static void compressPoolExit(outputCommonState state);
+static void compressPoolForward(outputCommonState state, size_t maxPending);
+static void compressPoolSubmit(outputCommonState state, caerEventPacketHeader packet, size_t packetSize);
 static size_t compressEventPacket(outputCommonState state, caerEventPacketHeader packet, size_t packetSize);
 static size_t compressTimestampSerialize(outputCommonState state, caerEventPacketHeader packet);
 
@@ -343,17 +354,13 @@ static int compressorThread(void *stateArg) {
 	strcat(threadName, "[Compressor]");
 	portable_thread_set_name(threadName);
 
-	// If no data is available on the transfer ring-buffer, sleep for 1 ms.
-	// to avoid wasting resources in a busy loop.
-	struct timespec noDataSleep = {.tv_sec = 0, .tv_nsec = 1000000};
-
 	while (atomic_load_explicit(&state->running, memory_order_relaxed)) {
 		// Get the newest event packet container from the transfer ring-buffer.
-		caerEventPacketContainer currPacketContainer = caerRingBufferGet(state->compressorRing);
+		// If there is none, this sleeps until the next one arrives.
+		caerEventPacketContainer currPacketContainer
+			= caerQueueGetWait(state->compressorRing, INOUT_QUEUE_WAIT_TIME);
 		if (currPacketContainer == NULL) {
-			// There is none, so we can't work on and commit this.
-			// We just sleep here a little and then try again, as we need the data!
-			thrd_sleep(&noDataSleep, NULL);
+			// There is none, so we can't work on and commit this. Try again, as we need the data!
 			continue;
 		}
 
@@ -366,17 +373,35 @@ static int compressorThread(void *stateArg) {
 
 	// Handle shutdown, write out all content remaining in the transfer ring-buffer.
 	caerEventPacketContainer packetContainer;
-	while ((packetContainer = caerRingBufferGet(state->compressorRing)) != NULL) {
+	while ((packetContainer = caerQueueGet(state->compressorRing)) != NULL) {
 		orderAndSendEventPackets(state, packetContainer);
 	}
 
+	// Wait for all packets still being compressed and send them out too.
+	compressPoolForward(state, 0);
+
 	return (thrd_success);
 }
 
 static void orderAndSendEventPackets(outputCommonState state, caerEventPacketContainer currPacketContainer) {
-	// Sort container by first timestamp (required) and by type ID (convenience).
-	size_t currPacketContainerSize = (size_t) caerEventPacketContainerGetEventPacketsNumber(currPacketContainer);
+	// Handle the valid only flag here. We get the value once per container, so we do
+	// the same for all packets from the same mainloop run, avoiding mid-way changes.
+	bool validOnly = atomic_load_explicit(&state->validOnly, memory_order_relaxed);
+
+	// Prepare packets for output first, as filtering can change their first timestamp.
+	// Packets that end up empty are dropped from the container.
+	size_t currPacketContainerSize = 0;
+
+	for (int32_t i = 0; i < caerEventPacketContainerGetEventPacketsNumber(currPacketContainer); i++) {
+		caerEventPacketHeader packet
+			= prepareEventPacket(state, caerEventPacketContainerGetEventPacket(currPacketContainer, i), validOnly);
+
+		if (packet != NULL) {
+			currPacketContainer->eventPackets[currPacketContainerSize++] = packet;
+		}
+	}
 
+	// Sort container by first timestamp (required) and by type ID (convenience).
 	qsort(currPacketContainer->eventPackets, currPacketContainerSize, sizeof(caerEventPacketHeader),
 		&packetsFirstTimestampThenTypeCmp);
 
@@ -390,6 +415,60 @@ static void orderAndSendEventPackets(outputCommonState state, caerEventPacketCon
 	free(currPacketContainer);
 }
 
+/**
+ * Make an event packet ready for output. Packets are shared with the mainloop and
+ * other outputs, so they are sent out as-is whenever possible, without any copy.
+ * A private copy is only made if the packet has to change: to drop invalid events,
+ * to trim its capacity (must equal number in any output stream), or to compress it
+ * in-place. The reference on the shared packet is then released.
+ *
+ * @param state common output state.
+ * @param packet the referenced event packet.
+ * @param validOnly only keep valid events.
+ *
+ * @return the event packet to send out, or NULL if nothing is left to send.
+ */
+static caerEventPacketHeader prepareEventPacket(outputCommonState state, caerEventPacketHeader packet, bool validOnly) {
+	int32_t eventNumber = caerEventPacketHeaderGetEventNumber(packet);
+	int32_t eventValid  = caerEventPacketHeaderGetEventValid(packet);
+
+	if ((eventNumber == 0) || (validOnly && (eventValid == 0))) {
+		caerMainloopPacketRelease(packet);
+		return (NULL);
+	}
+
+	if ((caerEventPacketHeaderGetEventCapacity(packet) == eventNumber) && (!validOnly || (eventValid == eventNumber))
+		&& !packetNeedsCompression(state, packet)) {
+		// Zero-copy, send shared packet out directly.
+		return (packet);
+	}
+
+	caerEventPacketHeader packetCopy
+		= (validOnly) ? (caerEventPacketCopyOnlyValidEvents(packet)) : (caerEventPacketCopyOnlyEvents(packet));
+
+	caerMainloopPacketRelease(packet);
+
+	if (packetCopy == NULL) {
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to copy event packet to output.");
+	}
+
+	return (packetCopy);
+}
+
+static bool packetNeedsCompression(outputCommonState state, caerEventPacketHeaderConst packet) {
+	if ((state->formatID & 0x01) && caerEventPacketHeaderGetEventType(packet) == POLARITY_EVENT) {
+		return (true);
+	}
+
+#ifdef ENABLE_INOUT_PNG_COMPRESSION
+	if ((state->formatID & 0x02) && caerEventPacketHeaderGetEventType(packet) == FRAME_EVENT) {
+		return (true);
+	}
+#endif
+
+	return (false);
+}
+
 static int packetsFirstTimestampThenTypeCmp(const void *a, const void *b) {
 	const caerEventPacketHeader *aa = a;
 	const caerEventPacketHeader *bb = b;
@@ -427,43 +506,267 @@ static void sendEventPacket(outputCommonState state, caerEventPacketHeader packe
 																 * caerEventPacketHeaderGetEventSize(packet));
 
 	// Statistics support.
-	state->statistics.packetsNumber++;
-	state->statistics.packetsTotalSize += packetSize;
-	state->statistics.packetsHeaderSize += CAER_EVENT_PACKET_HEADER_SIZE;
-	state->statistics.packetsDataSize
-		+= (size_t)(caerEventPacketHeaderGetEventNumber(packet) * caerEventPacketHeaderGetEventSize(packet));
+	atomic_fetch_add_explicit(&state->statistics.packetsNumber, 1, memory_order_relaxed);
+	atomic_fetch_add_explicit(&state->statistics.packetsTotalSize, packetSize, memory_order_relaxed);
+	atomic_fetch_add_explicit(
+		&state->statistics.packetsHeaderSize, CAER_EVENT_PACKET_HEADER_SIZE, memory_order_relaxed);
+	atomic_fetch_add_explicit(&state->statistics.packetsDataSize,
+		(size_t)(caerEventPacketHeaderGetEventNumber(packet) * caerEventPacketHeaderGetEventSize(packet)),
+		memory_order_relaxed);
+
+	// With parallel compression, packets go through the worker pool, which then
+	// sends them out in the same order they were submitted in.
+	if (state->compress.workersNumber > 0) {
+		compressPoolSubmit(state, packet, packetSize);
+		return;
+	}
 
 	if (state->formatID != 0) {
 		packetSize = compressEventPacket(state, packet, packetSize);
 	}
 
+	forwardEventPacket(state, packet, packetSize);
+}
+
+static void forwardEventPacket(outputCommonState state, caerEventPacketHeader packet, size_t packetSize) {
 	// Statistics support (after compression).
-	state->statistics.dataWritten += packetSize;
+	atomic_fetch_add_explicit(&state->statistics.dataWritten, packetSize, memory_order_relaxed);
 
 	// Send compressed packet out to output handling thread.
 	// Already format it as a libuv buffer.
 	libuvWriteBuf packetBuffer = malloc(sizeof(*packetBuffer));
 	if (packetBuffer == NULL) {
-		free(packet);
+		caerMainloopPacketRelease(packet);
 
 		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to allocate memory for libuv packet buffer.");
 		return;
 	}
 
-	libuvWriteBufInitWithAnyBuffer(packetBuffer, packet, packetSize);
+	// The packet may still be shared, so it's released instead of freed once written.
+	libuvWriteBufInitWithReleasedBuffer(packetBuffer, packet, packetSize, &releaseEventPacket);
 
 	// Put packet buffer onto output ring-buffer. Retry until successful.
-	while (!caerRingBufferPut(state->outputRing, packetBuffer)) {
+	while (!caerQueuePutWait(state->outputRing, packetBuffer, INOUT_QUEUE_WAIT_TIME)) {
 		// If the output thread failed, we'd forever block here, if it can't accept
 		// any more data. So we detect that condition and discard remaining packets.
 		if (atomic_load_explicit(&state->outputThreadFailure, memory_order_relaxed)) {
 			break;
 		}
+	}
+}
+
+static int outputCompressWorkerThread(void *workerArg) {
+	struct output_common_compress_worker *worker = workerArg;
+	outputCommonState state                      = worker->state;
+
+	// Set thread name.
+	size_t threadNameLength = strlen(state->parentModule->moduleSubSystemString);
+	char threadName[threadNameLength + 1 + 10]; // +1 for NUL character.
+	strcpy(threadName, state->parentModule->moduleSubSystemString);
+	strcat(threadName, "[Compress]");
+	portable_thread_set_name(threadName);
+
+	while (atomic_load_explicit(&state->compress.running, memory_order_relaxed)) {
+		// Sleep until a job comes in.
+		struct output_common_compress_job *job = caerQueueGetWait(worker->jobsRing, INOUT_QUEUE_WAIT_TIME);
+		if (job == NULL) {
+			continue;
+		}
+
+		job->packetSize = compressEventPacket(state, job->packet, job->packetSize);
+
+		// Hand the compressed packet back and wake up the compressor thread, if
+		// it's waiting for this job. Never full, it fits all jobs in flight.
+		caerQueuePut(worker->doneRing, job);
+	}
+
+	return (thrd_success);
+}
+
+static bool compressPoolInit(outputCommonState state, size_t workersNumber, size_t jobsSize) {
+	struct output_common_compress_data *pool = &state->compress;
+
+	pool->jobs = calloc(jobsSize, sizeof(struct output_common_compress_job));
+	if (pool->jobs == NULL) {
+		return (false);
+	}
+
+	pool->jobsSize  = jobsSize;
+	pool->jobsHead  = 0;
+	pool->jobsCount = 0;
+
+	pool->workers = calloc(workersNumber, sizeof(struct output_common_compress_worker));
+	if (pool->workers == NULL) {
+		free(pool->jobs);
+		pool->jobs = NULL;
+		return (false);
+	}
+
+	pool->nextWorker = 0;
+
+	atomic_store(&pool->running, true);
+
+	// Each job queue can take all jobs in flight, so handing out a job never fails.
+	for (pool->workersNumber = 0; pool->workersNumber < workersNumber; pool->workersNumber++) {
+		struct output_common_compress_worker *worker = &pool->workers[pool->workersNumber];
+
+		worker->state    = state;
+		worker->jobsRing = caerQueueInit(jobsSize);
+		if (worker->jobsRing == NULL) {
+			break;
+		}
+
+		worker->doneRing = caerQueueInit(jobsSize);
+		if (worker->doneRing == NULL) {
+			caerQueueFree(worker->jobsRing);
+			break;
+		}
+
+		if (thrd_create(&worker->thread, &outputCompressWorkerThread, worker) != thrd_success) {
+			caerQueueFree(worker->jobsRing);
+			caerQueueFree(worker->doneRing);
+			break;
+		}
+	}
+
+	if (pool->workersNumber != workersNumber) {
+		// Stop the workers started so far.
+		compressPoolExit(state);
+		return (false);
+	}
+
+	return (true);
+}
+
+// Must be called after the compressor thread has been stopped.
+static void compressPoolExit(outputCommonState state) {
+	struct output_common_compress_data *pool = &state->compress;
+
+	atomic_store(&pool->running, false);
+
+	// Workers waiting for jobs must notice they have to stop.
+	for (size_t i = 0; i < pool->workersNumber; i++) {
+		caerQueueWakeUp(pool->workers[i].jobsRing);
+	}
+
+	for (size_t i = 0; i < pool->workersNumber; i++) {
+		if ((errno = thrd_join(pool->workers[i].thread, NULL)) != thrd_success) {
+			// This should never happen!
+			caerModuleLog(state->parentModule, CAER_LOG_CRITICAL,
+				"Failed to join output compression worker thread. Error: %d.", errno);
+		}
+
+		caerQueueFree(pool->workers[i].jobsRing);
+		caerQueueFree(pool->workers[i].doneRing);
+	}
+
+	// Release packets that were not sent out anymore.
+	for (size_t i = 0; i < pool->jobsCount; i++) {
+		caerMainloopPacketRelease(pool->jobs[(pool->jobsHead + i) % pool->jobsSize].packet);
+	}
+
+	free(pool->workers);
+	pool->workers       = NULL;
+	pool->workersNumber = 0;
+
+	free(pool->jobs);
+	pool->jobs      = NULL;
+	pool->jobsSize  = 0;
+	pool->jobsCount = 0;
+}
+
+/**
+ * Send compressed packets to the output thread, in the order they were
+ * submitted in, which is the required timestamp/type order.
+ * Stops at the first unfinished packet, or waits for it if more than
+ * maxPending packets are still in the pool.
+ *
+ * @param state common output state.
+ * @param maxPending maximum number of unfinished packets to leave in the pool.
+ */
+static void compressPoolForward(outputCommonState state, size_t maxPending) {
+	struct output_common_compress_data *pool = &state->compress;
+
+	while (pool->jobsCount > 0) {
+		struct output_common_compress_job *job = &pool->jobs[pool->jobsHead];
+
+		if (job->worker != NULL) {
+			// Each worker finishes its jobs in the order they were handed out,
+			// and they are sent out in that same order, so the next finished job
+			// of the head job's worker is the head job. Sleep until it's there,
+			// if too many packets are pending already.
+			bool mustWait = (pool->jobsCount > maxPending);
+
+			caerQueue doneRing = job->worker->doneRing;
+			void *doneJob = (mustWait) ? (caerQueueGetWait(doneRing, INOUT_QUEUE_WAIT_TIME)) : (caerQueueGet(doneRing));
+
+			if (doneJob == NULL) {
+				if (!mustWait) {
+					break;
+				}
+
+				// Workers outlive the compressor thread, but don't wait
+				// forever if they were stopped anyway.
+				if (!atomic_load_explicit(&pool->running, memory_order_relaxed)) {
+					return;
+				}
+
+				continue;
+			}
+
+			job->worker = NULL;
+		}
 
-		// Delay by 500 µs if no change, to avoid a wasteful busy loop.
-		struct timespec retrySleep = {.tv_sec = 0, .tv_nsec = 500000};
-		thrd_sleep(&retrySleep, NULL);
+		forwardEventPacket(state, job->packet, job->packetSize);
+
+		job->packet    = NULL;
+		pool->jobsHead = (pool->jobsHead + 1) % pool->jobsSize;
+		pool->jobsCount--;
+	}
+}
+
+/**
+ * Add a packet to the compression pool. Packets to compress are handed
+ * to a worker, the others just wait for their turn, so that all packets
+ * reach the output thread in the order they were submitted in.
+ *
+ * @param state common output state.
+ * @param packet the event packet to send out.
+ * @param packetSize the current event packet size (header + data).
+ */
+static void compressPoolSubmit(outputCommonState state, caerEventPacketHeader packet, size_t packetSize) {
+	struct output_common_compress_data *pool = &state->compress;
+
+	// Make room for the new job, if all are in use.
+	compressPoolForward(state, pool->jobsSize - 1);
+
+	struct output_common_compress_job *job = &pool->jobs[(pool->jobsHead + pool->jobsCount) % pool->jobsSize];
+
+	job->packet     = packet;
+	job->packetSize = packetSize;
+
+	pool->jobsCount++;
+
+	if (packetNeedsCompression(state, packet)) {
+		job->worker = &pool->workers[pool->nextWorker];
+
+		if (!caerQueuePut(job->worker->jobsRing, job)) {
+			// This should never happen, job queues fit all jobs in flight.
+			// Compress it right here then.
+			caerModuleLog(state->parentModule, CAER_LOG_CRITICAL, "Failed to hand packet to compression worker.");
+			job->packetSize = compressEventPacket(state, job->packet, job->packetSize);
+			job->worker     = NULL;
+		}
+
+		pool->nextWorker = (pool->nextWorker + 1) % pool->workersNumber;
+	}
+	else {
+		// Nothing to compress.
+		job->worker = NULL;
 	}
+
+	// Pass on what's already done, without waiting.
+	compressPoolForward(state, pool->jobsSize);
 }
 
 /**
@@ -540,73 +843,8 @@ static size_t compressEventPacket(outputCommonState state, caerEventPacketHeader
 static size_t compressTimestampSerialize(outputCommonState state, caerEventPacketHeader packet) {
 	UNUSED_ARGUMENT(state);
 
-	size_t currPacketOffset = CAER_EVENT_PACKET_HEADER_SIZE; // Start here, no change to header.
-	int32_t eventSize       = caerEventPacketHeaderGetEventSize(packet);
-	int32_t eventTSOffset   = caerEventPacketHeaderGetEventTSOffset(packet);
-
-	int32_t lastTS = -1;
-	int32_t currTS = -1;
-	size_t tsRun   = 0;
-	bool doMemMove = false; // Initially don't move memory, until we actually shrink the size.
-
-	for (int32_t caerIteratorCounter = 0; caerIteratorCounter <= caerEventPacketHeaderGetEventNumber(packet);
-		 caerIteratorCounter++) {
-		// Iterate until one element past the end, to flush the last run. In that particular case,
-		// we don't get a new element or TS, as we'd be past the end of the array.
-		if (caerIteratorCounter < caerEventPacketHeaderGetEventNumber(packet)) {
-			const void *caerIteratorElement = caerGenericEventGetEvent(packet, caerIteratorCounter);
-
-			currTS = caerGenericEventGetTimestamp(caerIteratorElement, packet);
-			if (currTS == lastTS) {
-				// Increase size of run of same TS events currently being seen.
-				tsRun++;
-				continue;
-			}
-		}
-
-		// TS are different, at this point look if the last run was long enough
-		// and if it makes sense to compress. It does starting with 3 events.
-		if (tsRun >= 3) {
-			// First event to remains there, we set its TS highest bit.
-			const uint8_t *firstEvent = caerGenericEventGetEvent(packet, caerIteratorCounter - (int32_t) tsRun--);
-			caerGenericEventSetTimestamp(
-				(void *) firstEvent, packet, caerGenericEventGetTimestamp(firstEvent, packet) | I32T(0x80000000));
-
-			// Now use second event's timestamp for storing how many further events.
-			const uint8_t *secondEvent = caerGenericEventGetEvent(packet, caerIteratorCounter - (int32_t) tsRun--);
-			caerGenericEventSetTimestamp((void *) secondEvent, packet, I32T(tsRun)); // Is at least 1.
-
-			// Finally move modified memory where it needs to go.
-			if (doMemMove) {
-				memmove(((uint8_t *) packet) + currPacketOffset, firstEvent, (size_t) eventSize * 2);
-			}
-			else {
-				doMemMove = true; // After first shrink always move memory.
-			}
-			currPacketOffset += (size_t) eventSize * 2;
-
-			// Now go through remaining events and move their data close together.
-			while (tsRun > 0) {
-				const uint8_t *thirdEvent = caerGenericEventGetEvent(packet, caerIteratorCounter - (int32_t) tsRun--);
-				memmove(((uint8_t *) packet) + currPacketOffset, thirdEvent, (size_t) eventTSOffset);
-				currPacketOffset += (size_t) eventTSOffset;
-			}
-		}
-		else {
-			// Just copy data unchanged if no compression is possible.
-			if (doMemMove) {
-				const uint8_t *startEvent = caerGenericEventGetEvent(packet, caerIteratorCounter - (int32_t) tsRun);
-				memmove(((uint8_t *) packet) + currPacketOffset, startEvent, (size_t) eventSize * tsRun);
-			}
-			currPacketOffset += (size_t) eventSize * tsRun;
-		}
-
-		// Reset values for next iteration.
-		lastTS = currTS;
-		tsRun  = 1;
-	}
-
-	return (currPacketOffset);
+	// Compressed in place, see inout_tsserialize.h.
+	return (caerTimestampSerializeCompress(packet));
 }
 
 #ifdef ENABLE_INOUT_PNG_COMPRESSION
@@ -809,6 +1047,7 @@ static void libuvAsyncShutdown(uv_async_t *handle);
 static void libuvClientShutdown(uv_shutdown_t *clientShutdown, int status);
 static void libuvWriteStatusCheck(uv_handle_t *handle, int status);
 static void writePacket(outputCommonState state, libuvWriteBuf packetBuffer);
+static void writeFileBatch(outputCommonState state, libuvWriteBuf firstBuffer, bool waitForMore);
 static void initializeNetworkHeader(outputCommonState state);
 static bool writeNetworkHeader(outputCommonNetIO streams, libuvWriteBuf buf, bool startOfUDPPacket);
 static void writeFileHeader(outputCommonState state);
@@ -816,7 +1055,7 @@ static void writeFileHeader(outputCommonState state);
 static inline _Noreturn void errorExit(outputCommonState state, libuvWriteBuf packetBuffer) {
 	// Free currently held memory.
 	if (packetBuffer != NULL) {
-		free(packetBuffer->freeBuf);
+		libuvWriteBufFreeData(packetBuffer);
 		free(packetBuffer);
 	}
 
@@ -872,8 +1111,8 @@ static int outputThread(void *stateArg) {
 	// in caerOutputCommonExit() we expect the ring-buffer to always be empty!
 	if (!headerSent) {
 		libuvWriteBuf packetBuffer;
-		while ((packetBuffer = caerRingBufferGet(state->outputRing)) != NULL) {
-			free(packetBuffer->freeBuf);
+		while ((packetBuffer = caerQueueGet(state->outputRing)) != NULL) {
+			libuvWriteBufFreeData(packetBuffer);
 			free(packetBuffer);
 		}
 
@@ -894,43 +1133,94 @@ static int outputThread(void *stateArg) {
 		}
 	}
 	else {
-		// If no data is available on the transfer ring-buffer, sleep for 1 ms.
-		// to avoid wasting resources in a busy loop.
-		struct timespec noDataSleep = {.tv_sec = 0, .tv_nsec = 1000000};
-
 		while (atomic_load_explicit(&state->running, memory_order_relaxed)) {
-			libuvWriteBuf packetBuffer = caerRingBufferGet(state->outputRing);
+			// If no data is available on the transfer ring-buffer, sleep until there is.
+			libuvWriteBuf packetBuffer = caerQueueGetWait(state->outputRing, INOUT_QUEUE_WAIT_TIME);
 			if (packetBuffer == NULL) {
-				// There is none, so we can't work on and commit this.
-				// We just sleep here a little and then try again, as we need the data!
-				thrd_sleep(&noDataSleep, NULL);
+				// There is none, so we can't work on and commit this. Try again, as we need the data!
 				continue;
 			}
 
-			// Write buffer to file descriptor.
-			if (!writeUntilDone(state->fileIO, (uint8_t *) packetBuffer->buf.base, packetBuffer->buf.len)) {
-				errorExit(state, packetBuffer);
-			}
-
-			free(packetBuffer->freeBuf);
-			free(packetBuffer);
+			// Write buffer to file descriptor, together with the ones following it.
+			writeFileBatch(state, packetBuffer, true);
 		}
 
-		// Write all remaining buffers to file.
+		// Write all remaining buffers to file, without waiting for more.
 		libuvWriteBuf packetBuffer;
-		while ((packetBuffer = caerRingBufferGet(state->outputRing)) != NULL) {
-			if (!writeUntilDone(state->fileIO, (uint8_t *) packetBuffer->buf.base, packetBuffer->buf.len)) {
-				errorExit(state, packetBuffer);
-			}
-
-			free(packetBuffer->freeBuf);
-			free(packetBuffer);
+		while ((packetBuffer = caerQueueGet(state->outputRing)) != NULL) {
+			writeFileBatch(state, packetBuffer, false);
 		}
 	}
 
 	return (thrd_success);
 }
 
+/**
+ * Write a buffer to the output file, coalesced with as many of the buffers that
+ * follow it as are available, up to the configured batch size, using a single
+ * writev() call. Optionally wait up to the configured delay for more buffers,
+ * if the batch isn't full yet, trading a little latency for fewer system calls.
+ *
+ * @param state common output state.
+ * @param firstBuffer the first buffer to write.
+ * @param waitForMore wait for more buffers to fill the batch.
+ */
+static void writeFileBatch(outputCommonState state, libuvWriteBuf firstBuffer, bool waitForMore) {
+	libuvWriteBuf buffers[MAX_OUTPUT_WRITE_BATCH];
+	struct iovec iov[MAX_OUTPUT_WRITE_BATCH];
+	int buffersSize   = 0;
+	size_t batchBytes = 0;
+
+	size_t batchSize    = atomic_load_explicit(&state->writeBatchSize, memory_order_relaxed);
+	uint32_t batchDelay = U32T(atomic_load_explicit(&state->writeBatchDelay, memory_order_relaxed));
+
+	struct timespec batchStart;
+	portable_clock_gettime_monotonic(&batchStart);
+
+	libuvWriteBuf packetBuffer = firstBuffer;
+
+	while (packetBuffer != NULL) {
+		buffers[buffersSize]      = packetBuffer;
+		iov[buffersSize].iov_base = packetBuffer->buf.base;
+		iov[buffersSize].iov_len  = packetBuffer->buf.len;
+		buffersSize++;
+		batchBytes += packetBuffer->buf.len;
+
+		if ((buffersSize == MAX_OUTPUT_WRITE_BATCH) || (batchBytes >= batchSize)) {
+			break;
+		}
+
+		packetBuffer = caerQueueGet(state->outputRing);
+
+		if ((packetBuffer == NULL) && waitForMore && (batchDelay > 0)) {
+			struct timespec currentTime;
+			portable_clock_gettime_monotonic(&currentTime);
+
+			int64_t elapsedUs = I64T(currentTime.tv_sec - batchStart.tv_sec) * 1000000LL
+								+ I64T(currentTime.tv_nsec - batchStart.tv_nsec) / 1000;
+
+			if (elapsedUs < batchDelay) {
+				packetBuffer = caerQueueGetWait(state->outputRing, U32T(batchDelay - elapsedUs));
+			}
+		}
+	}
+
+	ssize_t syscalls = writevUntilDone(state->fileIO, iov, buffersSize);
+
+	for (int i = 0; i < buffersSize; i++) {
+		libuvWriteBufFreeData(buffers[i]);
+		free(buffers[i]);
+	}
+
+	if (syscalls < 0) {
+		errorExit(state, NULL);
+	}
+
+	// Statistics support.
+	atomic_fetch_add_explicit(&state->statistics.writeSyscalls, (uint64_t) syscalls, memory_order_relaxed);
+	atomic_fetch_add_explicit(&state->statistics.writeSyscallsBytes, batchBytes, memory_order_relaxed);
+}
+
 static void libuvRingBufferGet(uv_idle_t *handle) {
 	outputCommonState state = handle->data;
 
@@ -938,16 +1228,18 @@ static void libuvRingBufferGet(uv_idle_t *handle) {
 	// but never more than 10 at a time.
 	size_t count = 0;
 	libuvWriteBuf packetBuffer;
-	while (count < MAX_OUTPUT_RINGBUFFER_GET && (packetBuffer = caerRingBufferGet(state->outputRing)) != NULL) {
+	while (count < MAX_OUTPUT_RINGBUFFER_GET && (packetBuffer = caerQueueGet(state->outputRing)) != NULL) {
 		writePacket(state, packetBuffer);
 		count++;
 	}
 
-	// If nothing, avoid busy loop within libuv event loop by sleeping a little.
+	// If nothing, avoid busy loop within libuv event loop by sleeping until data
+	// arrives, but for 1 ms at most, so that the event loop itself keeps running.
 	if (count == 0) {
-		// Sleep for 1 ms.
-		struct timespec noDataSleep = {.tv_sec = 0, .tv_nsec = 1000000};
-		thrd_sleep(&noDataSleep, NULL);
+		packetBuffer = caerQueueGetWait(state->outputRing, 1000);
+		if (packetBuffer != NULL) {
+			writePacket(state, packetBuffer);
+		}
 	}
 }
 
@@ -965,7 +1257,7 @@ static void libuvAsyncShutdown(uv_async_t *handle) {
 
 	// Then we empty the ring-buffer and write out all data.
 	libuvWriteBuf packetBuffer;
-	while ((packetBuffer = caerRingBufferGet(state->outputRing)) != NULL) {
+	while ((packetBuffer = caerQueueGet(state->outputRing)) != NULL) {
 		writePacket(state, packetBuffer);
 	}
 
@@ -1040,7 +1332,7 @@ static void libuvWriteStatusCheck(uv_handle_t *handle, int status) {
 static void writePacket(outputCommonState state, libuvWriteBuf packetBuffer) {
 	// If no active clients exist, don't write anything.
 	if (state->networkIO->activeClients == 0) {
-		free(packetBuffer->freeBuf);
+		libuvWriteBufFreeData(packetBuffer);
 		free(packetBuffer);
 
 		return;
@@ -1113,7 +1405,7 @@ static void writePacket(outputCommonState state, libuvWriteBuf packetBuffer) {
 
 	// Free all packet memory.
 	freePacketBufferUDP : {
-		free(packetBuffer->freeBuf);
+		libuvWriteBufFreeData(packetBuffer);
 		free(packetBuffer);
 	}
 	}
@@ -1124,7 +1416,7 @@ static void writePacket(outputCommonState state, libuvWriteBuf packetBuffer) {
 		if (buffers == NULL) {
 			caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to allocate memory for network buffers.");
 
-			free(packetBuffer->freeBuf);
+			libuvWriteBufFreeData(packetBuffer);
 			free(packetBuffer);
 			return;
 		}
@@ -1401,25 +1693,53 @@ bool caerOutputCommonInit(caerModuleData moduleData, int fileDescriptor, outputC
 		"Ensure all packets are kept (stall output if transfer-buffer full).");
 	sshsNodeCreateInt(moduleData->moduleNode, "ringBufferSize", 512, 8, 4096, SSHS_FLAGS_NORMAL,
 		"Size of EventPacketContainer and EventPacket queues, used for transfers between mainloop and output threads.");
+	if (!state->isNetworkStream) {
+		sshsNodeCreateInt(moduleData->moduleNode, "writeBatchSize", 1024, 1, 65536, SSHS_FLAGS_NORMAL,
+			"Maximum amount of data, in KiB, to coalesce into one file write call.");
+		sshsNodeCreateInt(moduleData->moduleNode, "writeBatchDelay", 1000, 0, 1000000, SSHS_FLAGS_NORMAL,
+			"Maximum time, in µs, to wait for more data to coalesce into one file write call.");
+	}
+	sshsNodeCreateBool(moduleData->moduleNode, "compressTimestamps", false, SSHS_FLAGS_NORMAL,
+		"Serialize repeated timestamps of polarity events (SerializedTS format).");
+#ifdef ENABLE_INOUT_PNG_COMPRESSION
+	sshsNodeCreateBool(moduleData->moduleNode, "compressFramesPNG", false, SSHS_FLAGS_NORMAL,
+		"Compress frame events as PNG images (PNGFrames format).");
+#endif
+	sshsNodeCreateInt(moduleData->moduleNode, "compressionWorkers", 2, 0, 32, SSHS_FLAGS_NORMAL,
+		"Number of threads compressing packets in parallel, 0 to compress them in the compressor thread.");
 
 	atomic_store(&state->validOnly, sshsNodeGetBool(moduleData->moduleNode, "validOnly"));
 	atomic_store(&state->keepPackets, sshsNodeGetBool(moduleData->moduleNode, "keepPackets"));
+	if (!state->isNetworkStream) {
+		atomic_store(&state->writeBatchSize, U32T(sshsNodeGetInt(moduleData->moduleNode, "writeBatchSize")) * 1024);
+		atomic_store(&state->writeBatchDelay, U32T(sshsNodeGetInt(moduleData->moduleNode, "writeBatchDelay")));
+	}
 	int ringSize = sshsNodeGetInt(moduleData->moduleNode, "ringBufferSize");
 
-	// Format configuration (compression modes).
+	// Format configuration (compression modes). Only changes here at init time!
 	state->formatID = 0x00; // RAW format by default.
 
+	if (sshsNodeGetBool(moduleData->moduleNode, "compressTimestamps")) {
+		state->formatID |= 0x01;
+	}
+
+#ifdef ENABLE_INOUT_PNG_COMPRESSION
+	if (sshsNodeGetBool(moduleData->moduleNode, "compressFramesPNG")) {
+		state->formatID |= 0x02;
+	}
+#endif
+
 	// Initialize compressor ring-buffer. ringBufferSize only changes here at init time!
-	state->compressorRing = caerRingBufferInit((size_t) ringSize);
+	state->compressorRing = caerQueueInit((size_t) ringSize);
 	if (state->compressorRing == NULL) {
 		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to allocate compressor ring-buffer.");
 		return (false);
 	}
 
 	// Initialize output ring-buffer. ringBufferSize only changes here at init time!
-	state->outputRing = caerRingBufferInit((size_t) ringSize);
+	state->outputRing = caerQueueInit((size_t) ringSize);
 	if (state->outputRing == NULL) {
-		caerRingBufferFree(state->compressorRing);
+		caerQueueFree(state->compressorRing);
 
 		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to allocate output ring-buffer.");
 		return (false);
@@ -1431,34 +1751,45 @@ bool caerOutputCommonInit(caerModuleData moduleData, int fileDescriptor, outputC
 		state->networkIO->shutdown.data = state;
 		int retVal = uv_async_init(&state->networkIO->loop, &state->networkIO->shutdown, &libuvAsyncShutdown);
 		UV_RET_CHECK(retVal, state->parentModule->moduleSubSystemString, "uv_async_init",
-					 caerRingBufferFree(state->compressorRing);
-					 caerRingBufferFree(state->outputRing); return (false));
+					 caerQueueFree(state->compressorRing);
+					 caerQueueFree(state->outputRing); return (false));
 
 		// Use idle handles to check for new data on every loop run.
 		state->networkIO->ringBufferGet.data = state;
 		retVal                               = uv_idle_init(&state->networkIO->loop, &state->networkIO->ringBufferGet);
 		UV_RET_CHECK(retVal, state->parentModule->moduleSubSystemString, "uv_idle_init",
 					 uv_close((uv_handle_t *) &state->networkIO->shutdown, NULL);
-					 caerRingBufferFree(state->compressorRing); caerRingBufferFree(state->outputRing); return (false));
+					 caerQueueFree(state->compressorRing); caerQueueFree(state->outputRing); return (false));
 
 		retVal = uv_idle_start(&state->networkIO->ringBufferGet, &libuvRingBufferGet);
 		UV_RET_CHECK(retVal, state->parentModule->moduleSubSystemString, "uv_idle_start",
 					 uv_close((uv_handle_t *) &state->networkIO->ringBufferGet, NULL);
 					 uv_close((uv_handle_t *) &state->networkIO->shutdown, NULL);
-					 caerRingBufferFree(state->compressorRing); caerRingBufferFree(state->outputRing); return (false));
+					 caerQueueFree(state->compressorRing); caerQueueFree(state->outputRing); return (false));
+	}
+
+	// Compression workers are only useful if there is something to compress.
+	int compressionWorkers = sshsNodeGetInt(moduleData->moduleNode, "compressionWorkers");
+
+	if ((state->formatID != 0) && (compressionWorkers > 0)
+		&& !compressPoolInit(state, (size_t) compressionWorkers, (size_t) ringSize)) {
+		caerModuleLog(state->parentModule, CAER_LOG_WARNING,
+			"Failed to start compression worker threads, compressing in the compressor thread instead.");
 	}
 
 	// Start output handling thread.
 	atomic_store(&state->running, true);
 
 	if (thrd_create(&state->compressorThread, &compressorThread, state) != thrd_success) {
+		compressPoolExit(state);
+
 		if (state->isNetworkStream) {
 			uv_idle_stop(&state->networkIO->ringBufferGet);
 			uv_close((uv_handle_t *) &state->networkIO->ringBufferGet, NULL);
 			uv_close((uv_handle_t *) &state->networkIO->shutdown, NULL);
 		}
-		caerRingBufferFree(state->compressorRing);
-		caerRingBufferFree(state->outputRing);
+		caerQueueFree(state->compressorRing);
+		caerQueueFree(state->outputRing);
 
 		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to start compressor thread.");
 		return (false);
@@ -1467,6 +1798,7 @@ bool caerOutputCommonInit(caerModuleData moduleData, int fileDescriptor, outputC
 	if (thrd_create(&state->outputThread, &outputThread, state) != thrd_success) {
 		// Stop compressor thread (started just above) and wait on it.
 		atomic_store(&state->running, false);
+		caerQueueWakeUp(state->compressorRing);
 
 		if ((errno = thrd_join(state->compressorThread, NULL)) != thrd_success) {
 			// This should never happen!
@@ -1474,32 +1806,168 @@ bool caerOutputCommonInit(caerModuleData moduleData, int fileDescriptor, outputC
 				state->parentModule, CAER_LOG_CRITICAL, "Failed to join compressor thread. Error: %d.", errno);
 		}
 
+		compressPoolExit(state);
+
 		if (state->isNetworkStream) {
 			uv_idle_stop(&state->networkIO->ringBufferGet);
 			uv_close((uv_handle_t *) &state->networkIO->ringBufferGet, NULL);
 			uv_close((uv_handle_t *) &state->networkIO->shutdown, NULL);
 		}
-		caerRingBufferFree(state->compressorRing);
-		caerRingBufferFree(state->outputRing);
+		caerQueueFree(state->compressorRing);
+		caerQueueFree(state->outputRing);
 
 		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to start output thread.");
 		return (false);
 	}
 
+	// Output statistics, read directly from the running counters.
+	sshsNode statNode = sshsGetRelativeNode(moduleData->moduleNode, "statistics/");
+
+	sshsNodeCreateLong(statNode, "packetsNumber", 0, 0, INT64_MAX, SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT,
+		"Number of event packets written.");
+	sshsNodeCreateAttributePollTime(statNode, "packetsNumber", SSHS_LONG, 2);
+	sshsNodeAddAttributeReadModifier(statNode, "packetsNumber", SSHS_LONG, state, &statisticsPassthrough);
+
+	sshsNodeCreateLong(statNode, "packetsTotalSize", 0, 0, INT64_MAX, SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT,
+		"Total uncompressed size of event packets written, in bytes.");
+	sshsNodeCreateAttributePollTime(statNode, "packetsTotalSize", SSHS_LONG, 2);
+	sshsNodeAddAttributeReadModifier(statNode, "packetsTotalSize", SSHS_LONG, state, &statisticsPassthrough);
+
+	sshsNodeCreateLong(statNode, "packetsHeaderSize", 0, 0, INT64_MAX, SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT,
+		"Uncompressed size of event packet headers written, in bytes.");
+	sshsNodeCreateAttributePollTime(statNode, "packetsHeaderSize", SSHS_LONG, 2);
+	sshsNodeAddAttributeReadModifier(statNode, "packetsHeaderSize", SSHS_LONG, state, &statisticsPassthrough);
+
+	sshsNodeCreateLong(statNode, "packetsDataSize", 0, 0, INT64_MAX, SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT,
+		"Uncompressed size of event packet data written, in bytes.");
+	sshsNodeCreateAttributePollTime(statNode, "packetsDataSize", SSHS_LONG, 2);
+	sshsNodeAddAttributeReadModifier(statNode, "packetsDataSize", SSHS_LONG, state, &statisticsPassthrough);
+
+	sshsNodeCreateLong(statNode, "dataWritten", 0, 0, INT64_MAX, SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT,
+		"Bytes actually written to output (after compression).");
+	sshsNodeCreateAttributePollTime(statNode, "dataWritten", SSHS_LONG, 2);
+	sshsNodeAddAttributeReadModifier(statNode, "dataWritten", SSHS_LONG, state, &statisticsPassthrough);
+
+	sshsNodeCreateLong(statNode, "compressorRingOccupancy", 0, 0, INT64_MAX, SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT,
+		"Number of EventPacketContainers waiting to be ordered and compressed.");
+	sshsNodeCreateAttributePollTime(statNode, "compressorRingOccupancy", SSHS_LONG, 2);
+	sshsNodeAddAttributeReadModifier(statNode, "compressorRingOccupancy", SSHS_LONG, state, &statisticsPassthrough);
+
+	sshsNodeCreateLong(statNode, "outputRingOccupancy", 0, 0, INT64_MAX, SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT,
+		"Number of event packets waiting to be written out.");
+	sshsNodeCreateAttributePollTime(statNode, "outputRingOccupancy", SSHS_LONG, 2);
+	sshsNodeAddAttributeReadModifier(statNode, "outputRingOccupancy", SSHS_LONG, state, &statisticsPassthrough);
+
+	if (!state->isNetworkStream) {
+		portable_clock_gettime_monotonic(&state->statistics.rateLastTime);
+
+		sshsNodeCreateLong(statNode, "writeSyscalls", 0, 0, INT64_MAX, SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT,
+			"Number of write system calls done to the output file.");
+		sshsNodeCreateAttributePollTime(statNode, "writeSyscalls", SSHS_LONG, 2);
+		sshsNodeAddAttributeReadModifier(statNode, "writeSyscalls", SSHS_LONG, state, &statisticsPassthrough);
+
+		sshsNodeCreateLong(statNode, "writeSyscallsPerSecond", 0, 0, INT64_MAX,
+			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Write system calls per second, since the last read.");
+		sshsNodeCreateAttributePollTime(statNode, "writeSyscallsPerSecond", SSHS_LONG, 2);
+		sshsNodeAddAttributeReadModifier(
+			statNode, "writeSyscallsPerSecond", SSHS_LONG, state, &statisticsPassthrough);
+
+		sshsNodeCreateLong(statNode, "writeBytesPerSyscall", 0, 0, INT64_MAX,
+			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Average bytes written per write system call.");
+		sshsNodeCreateAttributePollTime(statNode, "writeBytesPerSyscall", SSHS_LONG, 2);
+		sshsNodeAddAttributeReadModifier(statNode, "writeBytesPerSyscall", SSHS_LONG, state, &statisticsPassthrough);
+	}
+
 	// Add config listeners last, to avoid having them dangling if Init doesn't succeed.
 	sshsNodeAddAttributeListener(moduleData->moduleNode, moduleData, &caerOutputCommonConfigListener);
 
 	return (true);
 }
 
+static void statisticsPassthrough(
+	void *userData, const char *key, enum sshs_node_attr_value_type type, union sshs_node_attr_value *value) {
+	UNUSED_ARGUMENT(type); // We know all statistics are always LONG.
+
+	outputCommonState state = userData;
+
+	if (caerStrEquals(key, "packetsNumber")) {
+		value->ilong = I64T(atomic_load_explicit(&state->statistics.packetsNumber, memory_order_relaxed));
+	}
+	else if (caerStrEquals(key, "packetsTotalSize")) {
+		value->ilong = I64T(atomic_load_explicit(&state->statistics.packetsTotalSize, memory_order_relaxed));
+	}
+	else if (caerStrEquals(key, "packetsHeaderSize")) {
+		value->ilong = I64T(atomic_load_explicit(&state->statistics.packetsHeaderSize, memory_order_relaxed));
+	}
+	else if (caerStrEquals(key, "packetsDataSize")) {
+		value->ilong = I64T(atomic_load_explicit(&state->statistics.packetsDataSize, memory_order_relaxed));
+	}
+	else if (caerStrEquals(key, "dataWritten")) {
+		value->ilong = I64T(atomic_load_explicit(&state->statistics.dataWritten, memory_order_relaxed));
+	}
+	else if (caerStrEquals(key, "compressorRingOccupancy")) {
+		value->ilong = I64T(caerQueueOccupancy(state->compressorRing));
+	}
+	else if (caerStrEquals(key, "outputRingOccupancy")) {
+		value->ilong = I64T(caerQueueOccupancy(state->outputRing));
+	}
+	else if (caerStrEquals(key, "writeSyscalls")) {
+		value->ilong = I64T(atomic_load_explicit(&state->statistics.writeSyscalls, memory_order_relaxed));
+	}
+	else if (caerStrEquals(key, "writeSyscallsPerSecond")) {
+		uint64_t writeSyscalls = atomic_load_explicit(&state->statistics.writeSyscalls, memory_order_relaxed);
+
+		struct timespec currentTime;
+		portable_clock_gettime_monotonic(&currentTime);
+
+		int64_t elapsedUs = I64T(currentTime.tv_sec - state->statistics.rateLastTime.tv_sec) * 1000000LL
+							+ I64T(currentTime.tv_nsec - state->statistics.rateLastTime.tv_nsec) / 1000;
+
+		uint64_t newWriteSyscalls = writeSyscalls - state->statistics.rateLastWriteSyscalls;
+
+		value->ilong = (elapsedUs > 0) ? (I64T(newWriteSyscalls * 1000000 / U64T(elapsedUs))) : (0);
+
+		state->statistics.rateLastWriteSyscalls = writeSyscalls;
+		state->statistics.rateLastTime          = currentTime;
+	}
+	else if (caerStrEquals(key, "writeBytesPerSyscall")) {
+		uint64_t writeSyscalls = atomic_load_explicit(&state->statistics.writeSyscalls, memory_order_relaxed);
+
+		value->ilong = (writeSyscalls > 0)
+						   ? (I64T(atomic_load_explicit(&state->statistics.writeSyscallsBytes, memory_order_relaxed)
+								   / writeSyscalls))
+						   : (0);
+	}
+}
+
 void caerOutputCommonExit(caerModuleData moduleData) {
 	// Remove listener, which can reference invalid memory in userData.
 	sshsNodeRemoveAttributeListener(moduleData->moduleNode, moduleData, &caerOutputCommonConfigListener);
 
+	// Remove statistics read modifiers, they reference the state. Only our
+	// own, the mainloop publishes its per-module statistics here too.
+	sshsNode statNode = sshsGetRelativeNode(moduleData->moduleNode, "statistics/");
+	sshsNodeRemoveAttributeReadModifier(statNode, "packetsNumber", SSHS_LONG);
+	sshsNodeRemoveAttributeReadModifier(statNode, "packetsTotalSize", SSHS_LONG);
+	sshsNodeRemoveAttributeReadModifier(statNode, "packetsHeaderSize", SSHS_LONG);
+	sshsNodeRemoveAttributeReadModifier(statNode, "packetsDataSize", SSHS_LONG);
+	sshsNodeRemoveAttributeReadModifier(statNode, "dataWritten", SSHS_LONG);
+	sshsNodeRemoveAttributeReadModifier(statNode, "compressorRingOccupancy", SSHS_LONG);
+	sshsNodeRemoveAttributeReadModifier(statNode, "outputRingOccupancy", SSHS_LONG);
+
 	outputCommonState state = moduleData->moduleState;
 
+	if (!state->isNetworkStream) {
+		sshsNodeRemoveAttributeReadModifier(statNode, "writeSyscalls", SSHS_LONG);
+		sshsNodeRemoveAttributeReadModifier(statNode, "writeSyscallsPerSecond", SSHS_LONG);
+		sshsNodeRemoveAttributeReadModifier(statNode, "writeBytesPerSyscall", SSHS_LONG);
+	}
+
 	// Stop output thread and wait on it.
 	atomic_store(&state->running, false);
+
+	caerQueueWakeUp(state->compressorRing);
+	caerQueueWakeUp(state->outputRing);
 	if (state->isNetworkStream) {
 		uv_async_send(&state->networkIO->shutdown);
 	}
@@ -1509,6 +1977,9 @@ void caerOutputCommonExit(caerModuleData moduleData) {
 		caerModuleLog(state->parentModule, CAER_LOG_CRITICAL, "Failed to join compressor thread. Error: %d.", errno);
 	}
 
+	// Compressor thread has waited on all compression jobs, stop workers.
+	compressPoolExit(state);
+
 	if ((errno = thrd_join(state->outputThread, NULL)) != thrd_success) {
 		// This should never happen!
 		caerModuleLog(state->parentModule, CAER_LOG_CRITICAL, "Failed to join output thread. Error: %d.", errno);
@@ -1517,25 +1988,26 @@ void caerOutputCommonExit(caerModuleData moduleData) {
 	// Now clean up the ring-buffers: they should be empty, so sanity check!
 	caerEventPacketContainer packetContainer;
 
-	while ((packetContainer = caerRingBufferGet(state->compressorRing)) != NULL) {
-		caerEventPacketContainerFree(packetContainer);
+	while ((packetContainer = caerQueueGet(state->compressorRing)) != NULL) {
+		caerMainloopPacketContainerRelease(packetContainer);
 
 		// This should never happen!
 		caerModuleLog(state->parentModule, CAER_LOG_CRITICAL, "Compressor ring-buffer was not empty!");
 	}
 
-	caerRingBufferFree(state->compressorRing);
+	caerQueueFree(state->compressorRing);
 
 	libuvWriteBuf packetBuffer;
 
-	while ((packetBuffer = caerRingBufferGet(state->outputRing)) != NULL) {
+	while ((packetBuffer = caerQueueGet(state->outputRing)) != NULL) {
+		libuvWriteBufFreeData(packetBuffer);
 		free(packetBuffer);
 
 		// This should never happen!
 		caerModuleLog(state->parentModule, CAER_LOG_CRITICAL, "Output ring-buffer was not empty!");
 	}
 
-	caerRingBufferFree(state->outputRing);
+	caerQueueFree(state->outputRing);
 
 	// Cleanup IO resources.
 	if (state->isNetworkStream) {
@@ -1571,9 +2043,10 @@ void caerOutputCommonExit(caerModuleData moduleData) {
 		" bytes header + %" PRIu64 " bytes data). "
 		"Actually written to output were %" PRIu64 " bytes (after compression), resulting in a saving of %" PRIu64
 		" bytes.",
-		state->statistics.packetsNumber, state->statistics.packetsTotalSize, state->statistics.packetsHeaderSize,
-		state->statistics.packetsDataSize, state->statistics.dataWritten,
-		(state->statistics.packetsTotalSize - state->statistics.dataWritten));
+		atomic_load(&state->statistics.packetsNumber), atomic_load(&state->statistics.packetsTotalSize),
+		atomic_load(&state->statistics.packetsHeaderSize), atomic_load(&state->statistics.packetsDataSize),
+		atomic_load(&state->statistics.dataWritten),
+		(atomic_load(&state->statistics.packetsTotalSize) - atomic_load(&state->statistics.dataWritten)));
 }
 
 static void caerOutputCommonConfigListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
@@ -1592,5 +2065,13 @@ static void caerOutputCommonConfigListener(sshsNode node, void *userData, enum s
 			// Set keep packets flag to given value.
 			atomic_store(&state->keepPackets, changeValue.boolean);
 		}
+		else if (changeType == SSHS_INT && caerStrEquals(changeKey, "writeBatchSize")) {
+			// Set file write batch size to given value (KiB).
+			atomic_store(&state->writeBatchSize, U32T(changeValue.iint) * 1024);
+		}
+		else if (changeType == SSHS_INT && caerStrEquals(changeKey, "writeBatchDelay")) {
+			// Set file write batch delay to given value.
+			atomic_store(&state->writeBatchDelay, U32T(changeValue.iint));
+		}
 	}
 }
@@ -1,8 +1,8 @@
 #ifndef OUTPUT_COMMON_H_
 #define OUTPUT_COMMON_H_
 
-#include <libcaer/ringbuffer.h>
 #include "caer-sdk/module.h"
+#include "caer-sdk/queue.h"
 #include "../inout_common.h"
 #include "libuv.h"
 
@@ -12,6 +12,7 @@
 
 #define MAX_OUTPUT_RINGBUFFER_GET 10
 #define MAX_OUTPUT_QUEUED_SIZE (1 * 1024 * 1024) // 1MB outstanding writes
+#define MAX_OUTPUT_WRITE_BATCH 256                // Buffers per batch at most, writev() takes IOV_MAX each
 
 struct output_common_netio {
 	/// Keep the full network header around, so we can easily update and write it.
@@ -31,12 +32,62 @@ struct output_common_netio {
 
 typedef struct output_common_netio *outputCommonNetIO;
 
+// Atomic, as they are also read from the configuration side (SSHS read modifiers).
 struct output_common_statistics {
-	uint64_t packetsNumber;
-	uint64_t packetsTotalSize;
-	uint64_t packetsHeaderSize;
-	uint64_t packetsDataSize;
-	uint64_t dataWritten;
+	atomic_uint_fast64_t packetsNumber;
+	atomic_uint_fast64_t packetsTotalSize;
+	atomic_uint_fast64_t packetsHeaderSize;
+	atomic_uint_fast64_t packetsDataSize;
+	atomic_uint_fast64_t dataWritten;
+	atomic_uint_fast64_t writeSyscalls;
+	atomic_uint_fast64_t writeSyscallsBytes;
+	/// Last values seen by the syscalls per second statistic, only used there.
+	uint64_t rateLastWriteSyscalls;
+	struct timespec rateLastTime;
+};
+
+struct output_common_compress_job {
+	/// Packet to send out, owned by the job until forwarded.
+	caerEventPacketHeader packet;
+	/// Size of the packet (header + data), updated by compression.
+	size_t packetSize;
+	/// Worker the job was handed to, NULL once its completion was collected
+	/// or if there was nothing to compress.
+	struct output_common_compress_worker *worker;
+};
+
+struct output_common_compress_worker {
+	/// Reference to common output state.
+	struct output_common_state *state;
+	/// Jobs to be done by this worker.
+	caerQueue jobsRing;
+	/// Jobs finished by this worker, in the order they were handed out,
+	/// so the compressor thread can wait for completion without polling.
+	caerQueue doneRing;
+	/// Worker thread.
+	thrd_t thread;
+};
+
+struct output_common_compress_data {
+	/// Control flag for compression worker threads. They outlive the
+	/// compressor thread, as that one waits on them at shutdown.
+	atomic_bool running;
+	/// Number of compression worker threads. Zero means packets are
+	/// compressed directly by the compressor thread.
+	size_t workersNumber;
+	/// Compression worker threads and their job queues.
+	struct output_common_compress_worker *workers;
+	/// Next worker to hand a job to (round-robin).
+	size_t nextWorker;
+	/// Jobs in output order, so packets can be sent out in the order they were
+	/// sorted into. Circular buffer, only used by the compressor thread.
+	struct output_common_compress_job *jobs;
+	/// Maximum number of jobs in flight.
+	size_t jobsSize;
+	/// Oldest job, next to be sent out.
+	size_t jobsHead;
+	/// Number of jobs in flight.
+	size_t jobsCount;
 };
 
 struct output_common_state {
@@ -67,16 +118,22 @@ struct output_common_state {
 	/// This results in no loss of data, but may slow down processing considerably.
 	/// It may also block it altogether, if the output goes away for any reason.
 	atomic_bool keepPackets;
+	/// File output: coalesce buffers into one write until this many bytes are reached.
+	atomic_uint_fast32_t writeBatchSize;
+	/// File output: wait at most this long (in µs) for more buffers to coalesce.
+	atomic_uint_fast32_t writeBatchDelay;
 	/// Transfer packets coming from a mainloop run to the compression handling thread.
 	/// We use EventPacketContainers as data structure for convenience, they do exactly
 	/// keep track of the data we do want to transfer and are part of libcaer.
-	caerRingBuffer compressorRing;
+	caerQueue compressorRing;
 	/// Transfer buffers to output handling thread.
-	caerRingBuffer outputRing;
+	caerQueue outputRing;
 	/// Track last packet container's highest event timestamp that was sent out.
 	int64_t lastTimestamp;
 	/// Support different formats, providing data compression.
 	int8_t formatID;
+	/// Parallel compression of packets.
+	struct output_common_compress_data compress;
 	/// Output module statistics collection.
 	struct output_common_statistics statistics;
 	/// Reference to parent module's original data.
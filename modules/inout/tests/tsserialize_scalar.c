@@ -0,0 +1,12 @@
+// Scalar build of the serialized-timestamp codec, to compare the SIMD code against.
+#define INOUT_TSSERIALIZE_NO_SIMD 1
+
+#include "tsserialize_test.h"
+
+size_t tsSerializeCompressScalar(caerEventPacketHeader packet) {
+	return (caerTimestampSerializeCompress(packet));
+}
+
+bool tsSerializeDecompressScalar(caerEventPacketHeader packet, size_t packetSize) {
+	return (caerTimestampSerializeDecompress(packet, packetSize));
+}
@@ -0,0 +1,558 @@
+#include "tsserialize_test.h"
+#include "caer-sdk/cross/c11threads_posix.h"
+#include "caer-sdk/cross/portable_time.h"
+
+#include <libcaer/events/polarity.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define POOL_SIZE 4
+#define POOL_THREADS 4
+#define RANDOM_PACKETS 2000
+#define RANDOM_MAX_EVENTS 4096
+#define THROUGHPUT_EVENTS 8192
+#define THROUGHPUT_ITERATIONS 2000
+
+static size_t testsFailed = 0;
+
+static uint32_t rngState = 0x12345678;
+
+// Xorshift, deterministic so failures can be reproduced.
+static uint32_t rng(void) {
+	rngState ^= rngState << 13;
+	rngState ^= rngState >> 17;
+	rngState ^= rngState << 5;
+
+	return (rngState);
+}
+
+static void testFail(const char *testName, const char *what) {
+	fprintf(stderr, "FAILED %s: %s\n", testName, what);
+	testsFailed++;
+}
+
+static size_t packetSize(caerEventPacketHeaderConst packet) {
+	return (CAER_EVENT_PACKET_HEADER_SIZE
+			+ ((size_t) caerEventPacketHeaderGetEventNumber(packet)
+				  * (size_t) caerEventPacketHeaderGetEventSize(packet)));
+}
+
+static caerEventPacketHeader packetCopy(caerEventPacketHeaderConst packet) {
+	caerEventPacketHeader copy = malloc(packetSize(packet));
+	if (copy == NULL) {
+		fprintf(stderr, "Out of memory.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	memcpy(copy, packet, packetSize(packet));
+
+	return (copy);
+}
+
+/**
+ * Build a polarity packet from a list of run lengths: all events in a run
+ * share one timestamp, consecutive runs have different ones.
+ */
+static caerEventPacketHeader makePolarityPacket(const size_t *runs, size_t runsNumber) {
+	size_t eventsNumber = 0;
+	for (size_t i = 0; i < runsNumber; i++) {
+		eventsNumber += runs[i];
+	}
+
+	// Allocation needs a capacity of at least one.
+	caerPolarityEventPacket polarity
+		= caerPolarityEventPacketAllocate((eventsNumber == 0) ? (1) : (I32T(eventsNumber)), 1, 0);
+	if (polarity == NULL) {
+		fprintf(stderr, "Out of memory.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	int32_t timestamp = I32T(rng() % 1000);
+	size_t eventIndex = 0;
+
+	for (size_t i = 0; i < runsNumber; i++) {
+		timestamp += I32T(1 + (rng() % 100));
+
+		for (size_t j = 0; j < runs[i]; j++) {
+			caerPolarityEvent event = caerPolarityEventPacketGetEvent(polarity, I32T(eventIndex++));
+
+			// Random data, valid bit always set.
+			event->data = htole32(rng() | 0x01);
+			caerPolarityEventSetTimestamp(event, timestamp);
+		}
+	}
+
+	caerEventPacketHeader packet = &polarity->packetHeader;
+
+	caerEventPacketHeaderSetEventNumber(packet, I32T(eventsNumber));
+	caerEventPacketHeaderSetEventValid(packet, I32T(eventsNumber));
+
+	return (packet);
+}
+
+/**
+ * Straightforward encoder, written from the format description only,
+ * to check the optimized one against.
+ */
+static size_t referenceCompress(caerEventPacketHeaderConst packet, uint8_t *out) {
+	size_t eventSize    = (size_t) caerEventPacketHeaderGetEventSize(packet);
+	size_t tsOffset     = (size_t) caerEventPacketHeaderGetEventTSOffset(packet);
+	size_t eventsNumber = (size_t) caerEventPacketHeaderGetEventNumber(packet);
+
+	const uint8_t *events = ((const uint8_t *) packet) + CAER_EVENT_PACKET_HEADER_SIZE;
+	size_t outSize        = 0;
+
+	for (size_t i = 0; i < eventsNumber;) {
+		const uint8_t *event = events + (i * eventSize);
+
+		size_t run = 1;
+		while (((i + run) < eventsNumber) && (memcmp(event + tsOffset, event + (run * eventSize) + tsOffset, 4) == 0)) {
+			run++;
+		}
+
+		if (run >= 3) {
+			uint32_t runTS = le32toh(*((const uint32_t *) (event + tsOffset)));
+
+			uint32_t firstTS  = htole32(runTS | 0x80000000U);
+			uint32_t secondTS = htole32(U32T(run - 2));
+
+			memcpy(out + outSize, event, tsOffset);
+			memcpy(out + outSize + tsOffset, &firstTS, 4);
+			memcpy(out + outSize + eventSize, event + eventSize, tsOffset);
+			memcpy(out + outSize + eventSize + tsOffset, &secondTS, 4);
+			outSize += eventSize * 2;
+
+			for (size_t j = 2; j < run; j++) {
+				memcpy(out + outSize, event + (j * eventSize), tsOffset);
+				outSize += tsOffset;
+			}
+		}
+		else {
+			memcpy(out + outSize, event, eventSize * run);
+			outSize += eventSize * run;
+		}
+
+		i += run;
+	}
+
+	return (CAER_EVENT_PACKET_HEADER_SIZE + outSize);
+}
+
+/**
+ * Decode a compressed packet into a buffer from a pool, like the input
+ * decompression workers do, instead of into the original memory.
+ * Buffers are reused and filled with garbage first.
+ */
+struct decode_pool {
+	uint8_t *buffers[POOL_SIZE];
+	size_t bufferSize;
+	size_t next;
+};
+
+static void decodePoolInit(struct decode_pool *pool, size_t maxEvents) {
+	pool->bufferSize = CAER_EVENT_PACKET_HEADER_SIZE + (maxEvents * sizeof(struct caer_polarity_event));
+	pool->next       = 0;
+
+	for (size_t i = 0; i < POOL_SIZE; i++) {
+		pool->buffers[i] = malloc(pool->bufferSize);
+		if (pool->buffers[i] == NULL) {
+			fprintf(stderr, "Out of memory.\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+}
+
+static void decodePoolExit(struct decode_pool *pool) {
+	for (size_t i = 0; i < POOL_SIZE; i++) {
+		free(pool->buffers[i]);
+	}
+}
+
+static bool decodePooled(struct decode_pool *pool, caerEventPacketHeaderConst compressed, size_t compressedSize,
+	caerEventPacketHeaderConst original) {
+	uint8_t *buffer = pool->buffers[pool->next];
+	pool->next      = (pool->next + 1) % POOL_SIZE;
+
+	memset(buffer, 0xA5, pool->bufferSize);
+	memcpy(buffer, compressed, compressedSize);
+
+	caerEventPacketHeader packet = (caerEventPacketHeader) buffer;
+
+	return (caerTimestampSerializeDecompress(packet, compressedSize)
+			&& (memcmp(packet, original, packetSize(original)) == 0));
+}
+
+/**
+ * Compress with the SIMD and scalar codec and check both against the
+ * reference encoder, then decode in place (SIMD and scalar) and into a
+ * pooled buffer, checking that the original packet comes back each time.
+ */
+static void roundTrip(const char *testName, caerEventPacketHeaderConst packet, struct decode_pool *pool) {
+	size_t size = packetSize(packet);
+
+	caerEventPacketHeader simd   = packetCopy(packet);
+	caerEventPacketHeader scalar = packetCopy(packet);
+	uint8_t *reference           = malloc(size);
+	if (reference == NULL) {
+		fprintf(stderr, "Out of memory.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	size_t simdSize      = caerTimestampSerializeCompress(simd);
+	size_t scalarSize    = tsSerializeCompressScalar(scalar);
+	size_t referenceSize = referenceCompress(packet, reference);
+
+	if ((simdSize != referenceSize) || (scalarSize != referenceSize)) {
+		testFail(testName, "compressed size differs from reference");
+	}
+	else if (memcmp(((uint8_t *) simd) + CAER_EVENT_PACKET_HEADER_SIZE, reference,
+				 referenceSize - CAER_EVENT_PACKET_HEADER_SIZE)
+			 != 0) {
+		testFail(testName, "SIMD compressed data differs from reference");
+	}
+	else if (memcmp(simd, scalar, scalarSize) != 0) {
+		testFail(testName, "SIMD and scalar compressed data differ");
+	}
+	else {
+		if (!decodePooled(pool, simd, simdSize, packet)) {
+			testFail(testName, "pooled decoding failed");
+		}
+
+		if (!caerTimestampSerializeDecompress(simd, simdSize) || (memcmp(simd, packet, size) != 0)) {
+			testFail(testName, "SIMD in-place decoding failed");
+		}
+
+		if (!tsSerializeDecompressScalar(scalar, scalarSize) || (memcmp(scalar, packet, size) != 0)) {
+			testFail(testName, "scalar in-place decoding failed");
+		}
+	}
+
+	free(simd);
+	free(scalar);
+	free(reference);
+}
+
+static void testRunLengths(struct decode_pool *pool) {
+	static const struct {
+		const char *name;
+		size_t runs[16];
+		size_t runsNumber;
+	} cases[] = {
+		{"empty packet", {0}, 0},
+		{"single event", {1}, 1},
+		{"two equal", {2}, 1},
+		{"three equal", {3}, 1},
+		{"four equal", {4}, 1},
+		{"five equal", {5}, 1},
+		{"six equal", {6}, 1},
+		{"seven equal", {7}, 1},
+		{"eight equal", {8}, 1},
+		{"nine equal", {9}, 1},
+		{"ten equal", {10}, 1},
+		{"all different", {1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1}, 12},
+		{"pairs only", {2, 2, 2, 2, 2, 2}, 6},
+		{"run at start", {7, 1, 1, 2}, 4},
+		{"run at end", {1, 2, 1, 7}, 4},
+		{"runs back to back", {3, 4, 5, 6, 7, 8, 9, 10}, 8},
+		{"short between long", {11, 1, 13, 2, 17}, 5},
+		{"alternating 2 and 3", {2, 3, 2, 3, 2, 3, 2, 3}, 8},
+		{"long run", {1000}, 1},
+		{"long run, odd tail", {1023, 1}, 2},
+	};
+
+	for (size_t i = 0; i < (sizeof(cases) / sizeof(cases[0])); i++) {
+		caerEventPacketHeader packet = makePolarityPacket(cases[i].runs, cases[i].runsNumber);
+
+		roundTrip(cases[i].name, packet, pool);
+
+		free(packet);
+	}
+
+	// Every run length up to 4 SIMD blocks, at every alignment.
+	for (size_t lead = 0; lead < 4; lead++) {
+		for (size_t run = 1; run <= 19; run++) {
+			size_t runs[3] = {lead, run, 1};
+
+			caerEventPacketHeader packet
+				= (lead == 0) ? (makePolarityPacket(runs + 1, 2)) : (makePolarityPacket(runs, 3));
+
+			roundTrip("run length/alignment sweep", packet, pool);
+
+			free(packet);
+		}
+	}
+}
+
+static caerEventPacketHeader makeRandomPacket(size_t maxEvents, size_t meanRun) {
+	size_t *runs = calloc(maxEvents, sizeof(size_t));
+	if (runs == NULL) {
+		fprintf(stderr, "Out of memory.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	size_t runsNumber   = 0;
+	size_t eventsNumber = 1 + (rng() % maxEvents);
+
+	while (eventsNumber > 0) {
+		size_t run = 1 + (rng() % (2 * meanRun));
+		if (run > eventsNumber) {
+			run = eventsNumber;
+		}
+
+		runs[runsNumber++] = run;
+		eventsNumber -= run;
+	}
+
+	caerEventPacketHeader packet = makePolarityPacket(runs, runsNumber);
+
+	free(runs);
+
+	return (packet);
+}
+
+static void testRandom(struct decode_pool *pool) {
+	for (size_t i = 0; i < RANDOM_PACKETS; i++) {
+		caerEventPacketHeader packet = makeRandomPacket(RANDOM_MAX_EVENTS, 1 + (i % 16));
+
+		roundTrip("random packet", packet, pool);
+
+		free(packet);
+	}
+}
+
+static void testCorrupted(void) {
+	size_t runs[]                = {1, 5, 2, 9};
+	caerEventPacketHeader packet = makePolarityPacket(runs, 4);
+	size_t size                  = packetSize(packet);
+
+	caerEventPacketHeader compressed = packetCopy(packet);
+	size_t compressedSize            = caerTimestampSerializeCompress(compressed);
+
+	// Compressed data: E1, run(E2, E3 + count 3, 3 data), E7, E8, run(E9, E10 + count 7, 7 data).
+	size_t lastRunStart = CAER_EVENT_PACKET_HEADER_SIZE + 8 + 8 + 8 + (3 * 4) + 8 + 8;
+	size_t lastRunCount = lastRunStart + 8 + 4;
+
+	caerEventPacketHeader broken = malloc(size);
+	if (broken == NULL) {
+		fprintf(stderr, "Out of memory.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	// Truncated data.
+	memcpy(broken, compressed, compressedSize);
+	if (caerTimestampSerializeDecompress(broken, compressedSize - 4)) {
+		testFail("corrupted data", "truncated data accepted");
+	}
+
+	// Run count bigger than the packet.
+	memcpy(broken, compressed, compressedSize);
+	uint32_t hugeRun = htole32(1000);
+	memcpy(((uint8_t *) broken) + lastRunCount, &hugeRun, 4);
+	if (caerTimestampSerializeDecompress(broken, compressedSize)) {
+		testFail("corrupted data", "oversized run accepted");
+	}
+
+	// Run count of zero.
+	memcpy(broken, compressed, compressedSize);
+	uint32_t zeroRun = 0;
+	memcpy(((uint8_t *) broken) + lastRunCount, &zeroRun, 4);
+	if (caerTimestampSerializeDecompress(broken, compressedSize)) {
+		testFail("corrupted data", "empty run accepted");
+	}
+
+	// Run marker on the last event, no count following.
+	memcpy(broken, compressed, compressedSize);
+	if (caerTimestampSerializeDecompress(broken, lastRunStart + 8)) {
+		testFail("corrupted data", "dangling run marker accepted");
+	}
+
+	// More data than events.
+	memcpy(broken, packet, size);
+	caerEventPacketHeaderSetEventNumber(broken, caerEventPacketHeaderGetEventNumber(broken) - 1);
+	if (caerTimestampSerializeDecompress(broken, size)) {
+		testFail("corrupted data", "oversized data accepted");
+	}
+
+	free(broken);
+	free(compressed);
+	free(packet);
+}
+
+struct pool_worker {
+	thrd_t thread;
+	caerEventPacketHeader *originals;
+	caerEventPacketHeader *compressed;
+	size_t *compressedSizes;
+	size_t packetsNumber;
+	atomic_size_t *nextPacket;
+	size_t failures;
+};
+
+static int poolWorkerThread(void *workerArg) {
+	struct pool_worker *worker = workerArg;
+
+	struct decode_pool pool;
+	decodePoolInit(&pool, RANDOM_MAX_EVENTS);
+
+	size_t i;
+	while ((i = atomic_fetch_add(worker->nextPacket, 1)) < worker->packetsNumber) {
+		if (!decodePooled(&pool, worker->compressed[i], worker->compressedSizes[i], worker->originals[i])) {
+			worker->failures++;
+		}
+	}
+
+	decodePoolExit(&pool);
+
+	return (thrd_success);
+}
+
+// Several threads decoding into their own pooled buffers at once, like the input decompression workers.
+static void testPoolThreads(void) {
+	size_t packetsNumber = RANDOM_PACKETS / 4;
+
+	caerEventPacketHeader *originals  = calloc(packetsNumber, sizeof(caerEventPacketHeader));
+	caerEventPacketHeader *compressed = calloc(packetsNumber, sizeof(caerEventPacketHeader));
+	size_t *compressedSizes           = calloc(packetsNumber, sizeof(size_t));
+	if ((originals == NULL) || (compressed == NULL) || (compressedSizes == NULL)) {
+		fprintf(stderr, "Out of memory.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	for (size_t i = 0; i < packetsNumber; i++) {
+		originals[i]       = makeRandomPacket(RANDOM_MAX_EVENTS, 1 + (i % 8));
+		compressed[i]      = packetCopy(originals[i]);
+		compressedSizes[i] = caerTimestampSerializeCompress(compressed[i]);
+	}
+
+	atomic_size_t nextPacket;
+	atomic_store(&nextPacket, 0);
+
+	struct pool_worker workers[POOL_THREADS];
+
+	for (size_t i = 0; i < POOL_THREADS; i++) {
+		workers[i].originals       = originals;
+		workers[i].compressed      = compressed;
+		workers[i].compressedSizes = compressedSizes;
+		workers[i].packetsNumber   = packetsNumber;
+		workers[i].nextPacket      = &nextPacket;
+		workers[i].failures        = 0;
+
+		if (thrd_create(&workers[i].thread, &poolWorkerThread, &workers[i]) != thrd_success) {
+			fprintf(stderr, "Failed to start decoding thread.\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	for (size_t i = 0; i < POOL_THREADS; i++) {
+		thrd_join(workers[i].thread, NULL);
+
+		if (workers[i].failures != 0) {
+			testFail("threaded pooled decoding", "decoded packet differs from original");
+		}
+	}
+
+	for (size_t i = 0; i < packetsNumber; i++) {
+		free(originals[i]);
+		free(compressed[i]);
+	}
+
+	free(originals);
+	free(compressed);
+	free(compressedSizes);
+}
+
+static double elapsedSeconds(const struct timespec *start) {
+	struct timespec end;
+	portable_clock_gettime_monotonic(&end);
+
+	return ((double) (end.tv_sec - start->tv_sec) + ((double) (end.tv_nsec - start->tv_nsec) / 1.0E9));
+}
+
+/**
+ * Throughput on polarity data like a busy DAVIS produces: many events share
+ * a timestamp, runs are a few events long on average. Only reported, not
+ * checked, as it depends on the machine.
+ */
+static void testThroughput(void) {
+	caerEventPacketHeader packet = makeRandomPacket(THROUGHPUT_EVENTS, 4);
+	size_t size                  = packetSize(packet);
+	double events = (double) caerEventPacketHeaderGetEventNumber(packet) * THROUGHPUT_ITERATIONS / 1.0E6;
+
+	caerEventPacketHeader work = malloc(size);
+	if (work == NULL) {
+		fprintf(stderr, "Out of memory.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	struct {
+		const char *name;
+		size_t (*compress)(caerEventPacketHeader packet);
+		bool (*decompress)(caerEventPacketHeader packet, size_t packetSize);
+	} codecs[] = {
+		{"default", &caerTimestampSerializeCompress, &caerTimestampSerializeDecompress},
+		{"scalar", &tsSerializeCompressScalar, &tsSerializeDecompressScalar},
+	};
+
+	for (size_t c = 0; c < (sizeof(codecs) / sizeof(codecs[0])); c++) {
+		double compressTime   = 0;
+		double decompressTime = 0;
+		size_t compressedSize = 0;
+
+		for (size_t i = 0; i < THROUGHPUT_ITERATIONS; i++) {
+			memcpy(work, packet, size);
+
+			struct timespec start;
+			portable_clock_gettime_monotonic(&start);
+
+			compressedSize = (*codecs[c].compress)(work);
+
+			compressTime += elapsedSeconds(&start);
+			portable_clock_gettime_monotonic(&start);
+
+			bool success = (*codecs[c].decompress)(work, compressedSize);
+
+			decompressTime += elapsedSeconds(&start);
+
+			if (!success) {
+				testFail("throughput", "decoding failed");
+				break;
+			}
+		}
+
+		printf("%s codec: %.1f M events/s compress, %.1f M events/s decompress, size %.1f%%.\n", codecs[c].name,
+			events / compressTime, events / decompressTime, 100.0 * (double) compressedSize / (double) size);
+	}
+
+	free(work);
+	free(packet);
+}
+
+int main(void) {
+#if defined(INOUT_TSSERIALIZE_SSE2)
+	printf("Testing SSE2 against scalar serialized-timestamp codec.\n");
+#elif defined(INOUT_TSSERIALIZE_NEON)
+	printf("Testing NEON against scalar serialized-timestamp codec.\n");
+#else
+	printf("No SIMD available, testing scalar serialized-timestamp codec only.\n");
+#endif
+
+	struct decode_pool pool;
+	decodePoolInit(&pool, RANDOM_MAX_EVENTS);
+
+	testRunLengths(&pool);
+	testRandom(&pool);
+	testCorrupted();
+	testPoolThreads();
+	testThroughput();
+
+	decodePoolExit(&pool);
+
+	if (testsFailed != 0) {
+		fprintf(stderr, "%zu checks failed.\n", testsFailed);
+		return (EXIT_FAILURE);
+	}
+
+	printf("All checks passed.\n");
+	return (EXIT_SUCCESS);
+}
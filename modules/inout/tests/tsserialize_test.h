@@ -0,0 +1,10 @@
+#ifndef INPUT_OUTPUT_TESTS_TSSERIALIZE_TEST_H_
+#define INPUT_OUTPUT_TESTS_TSSERIALIZE_TEST_H_
+
+#include "modules/inout/inout_tsserialize.h"
+
+// Implemented in tsserialize_scalar.c, built without SIMD.
+size_t tsSerializeCompressScalar(caerEventPacketHeader packet);
+bool tsSerializeDecompressScalar(caerEventPacketHeader packet, size_t packetSize);
+
+#endif /* INPUT_OUTPUT_TESTS_TSSERIALIZE_TEST_H_ */
@@ -0,0 +1,754 @@
+#include "caer-sdk/cross/portable_time.h"
+#include "caer-sdk/mainloop.h"
+#include "ext/uthash/utarray.h"
+
+#include <libcaer/events/common.h>
+#include <libcaer/events/packetContainer.h>
+#include <libcaer/events/special.h>
+#include <stdatomic.h>
+
+/// A packet copy waiting to be merged, events before 'position' have already been sent on.
+struct merge_buffered_packet {
+	caerEventPacketHeader packet;
+	int32_t position;
+	/// When the packet entered the merge buffer, to measure buffering delay.
+	struct timespec arrival;
+};
+
+/// All buffered packets of one type, coming from one source.
+struct merge_stream {
+	int16_t sourceID;
+	int16_t typeID;
+	int32_t eventSize;
+	/// Event size differs from the other sources of this type, so the events can't be merged.
+	bool ignored;
+	UT_array *packets;
+};
+
+struct merge_source {
+	int16_t sourceID;
+	/// Highest event timestamp seen from this source. -1 if no data arrived yet.
+	int64_t watermark;
+	/// Last time data arrived from this source.
+	struct timespec lastArrival;
+	/// Timestamp reset seen from this source during the current run.
+	bool timestampReset;
+};
+
+struct merge_state {
+	/// Maximum event time (in µs) a source may lag behind the leading one before it isn't waited for anymore.
+	int64_t maxSkew;
+	/// Maximum wall-clock time (in µs) to wait for a source that doesn't send any data.
+	int64_t maxLatency;
+	struct merge_source *sources;
+	size_t sourcesSize;
+	UT_array *streams;
+	/// Streams of the type currently being merged, one per source at most.
+	struct merge_stream **mergeStreams;
+	/// Everything up to this timestamp has been sent on. Later arriving older events are late.
+	int64_t emittedWatermark;
+	size_t bufferedEvents;
+	atomic_uint_fast64_t statEventsMerged;
+	atomic_uint_fast64_t statEventsLate;
+	atomic_uint_fast64_t statEventsDropped;
+	atomic_uint_fast64_t statEventsBuffered;
+	atomic_uint_fast64_t statDelaySum;
+	atomic_uint_fast64_t statDelayCount;
+	atomic_uint_fast64_t statDelayMax;
+};
+
+typedef struct merge_state *MergeState;
+
+static void caerMergeConfigInit(sshsNode moduleNode);
+static bool caerMergeInit(caerModuleData moduleData);
+static void caerMergeRun(caerModuleData moduleData, caerEventPacketContainer in, caerEventPacketContainer *out);
+static void caerMergeConfig(caerModuleData moduleData);
+static void caerMergeExit(caerModuleData moduleData);
+
+static void statisticsPassthrough(
+	void *userData, const char *key, enum sshs_node_attr_value_type type, union sshs_node_attr_value *value);
+static void mergeSourceInfoInit(caerModuleData moduleData, int16_t *inputs, size_t inputsSize);
+static struct merge_source *mergeSourceGet(MergeState state, int16_t sourceID);
+static struct merge_stream *mergeStreamGet(
+	caerModuleData moduleData, int16_t sourceID, int16_t typeID, int32_t eventSize);
+static void mergeBufferPacket(
+	caerModuleData moduleData, caerEventPacketHeaderConst packet, const struct timespec *currentTime);
+static int64_t mergeWatermark(MergeState state, const struct timespec *currentTime);
+static caerEventPacketContainer mergeEmit(
+	caerModuleData moduleData, int64_t watermark, const struct timespec *currentTime);
+static caerEventPacketHeader mergeEmitType(
+	caerModuleData moduleData, int16_t typeID, int64_t watermark, const struct timespec *currentTime);
+static void mergeClear(MergeState state, bool countDropped);
+
+static const struct caer_module_functions MergeFunctions = {.moduleConfigInit = &caerMergeConfigInit,
+	.moduleInit                                                               = &caerMergeInit,
+	.moduleRun                                                                = &caerMergeRun,
+	.moduleConfig                                                             = &caerMergeConfig,
+	.moduleExit                                                               = &caerMergeExit,
+	.moduleReset                                                              = NULL};
+
+static const struct caer_event_stream_in MergeInputs[] = {{.type = -1, .number = -1, .readOnly = true}};
+// The merged packets are new packets, one per type, with this module as source.
+static const struct caer_event_stream_out MergeOutputs[] = {{.type = -1}};
+
+static const struct caer_module_info MergeInfo = {
+	.version           = 1,
+	.name              = "Merge",
+	.description       = "Merges the events of multiple sources into one stream, in timestamp order.",
+	.type              = CAER_MODULE_PROCESSOR,
+	.memSize           = sizeof(struct merge_state),
+	.functions         = &MergeFunctions,
+	.inputStreams      = MergeInputs,
+	.inputStreamsSize  = CAER_EVENT_STREAM_IN_SIZE(MergeInputs),
+	.outputStreams     = MergeOutputs,
+	.outputStreamsSize = CAER_EVENT_STREAM_OUT_SIZE(MergeOutputs),
+};
+
+static const UT_icd ut_merge_stream_icd = {sizeof(struct merge_stream), NULL, NULL, NULL};
+static const UT_icd ut_merge_packet_icd = {sizeof(struct merge_buffered_packet), NULL, NULL, NULL};
+
+caerModuleInfo caerModuleGetInfo(void) {
+	return (&MergeInfo);
+}
+
+static void caerMergeConfigInit(sshsNode moduleNode) {
+	sshsNodeCreateInt(moduleNode, "maxSkew", 10000, 0, 10000000, SSHS_FLAGS_NORMAL,
+		"Maximum time (in µs) a source's events may lag behind the other sources before it is not waited for "
+		"anymore; its older events are then dropped as late.");
+	sshsNodeCreateInt(moduleNode, "maxLatency", 100000, 0, 10000000, SSHS_FLAGS_NORMAL,
+		"Maximum time (in µs) to wait for a source that doesn't send any data, before merging without it.");
+
+	sshsNodeCreateLong(moduleNode, "eventsMerged", 0, 0, INT64_MAX, SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT,
+		"Number of events sent on in merged packets.");
+	sshsNodeCreateAttributePollTime(moduleNode, "eventsMerged", SSHS_LONG, 2);
+	sshsNodeCreateLong(moduleNode, "eventsLate", 0, 0, INT64_MAX, SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT,
+		"Number of events dropped because they arrived after newer events had already been sent on.");
+	sshsNodeCreateAttributePollTime(moduleNode, "eventsLate", SSHS_LONG, 2);
+	sshsNodeCreateLong(moduleNode, "eventsDropped", 0, 0, INT64_MAX, SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT,
+		"Number of events dropped because they could not be merged (timestamp reset, incompatible event size).");
+	sshsNodeCreateAttributePollTime(moduleNode, "eventsDropped", SSHS_LONG, 2);
+	sshsNodeCreateLong(moduleNode, "eventsBuffered", 0, 0, INT64_MAX, SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT,
+		"Number of events currently waiting to be merged.");
+	sshsNodeCreateAttributePollTime(moduleNode, "eventsBuffered", SSHS_LONG, 2);
+	sshsNodeCreateLong(moduleNode, "bufferingDelayAverage", 0, 0, INT64_MAX,
+		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT,
+		"Average time (in µs) events spent waiting to be merged, since the last read.");
+	sshsNodeCreateAttributePollTime(moduleNode, "bufferingDelayAverage", SSHS_LONG, 2);
+	sshsNodeCreateLong(moduleNode, "bufferingDelayMax", 0, 0, INT64_MAX, SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT,
+		"Maximum time (in µs) events spent waiting to be merged, since the last read.");
+	sshsNodeCreateAttributePollTime(moduleNode, "bufferingDelayMax", SSHS_LONG, 2);
+}
+
+static void statisticsPassthrough(
+	void *userData, const char *key, enum sshs_node_attr_value_type type, union sshs_node_attr_value *value) {
+	UNUSED_ARGUMENT(type); // We know all statistics are always LONG.
+
+	MergeState state = userData;
+
+	uint64_t statisticValue = 0;
+
+	if (caerStrEquals(key, "eventsMerged")) {
+		statisticValue = atomic_load_explicit(&state->statEventsMerged, memory_order_relaxed);
+	}
+	else if (caerStrEquals(key, "eventsLate")) {
+		statisticValue = atomic_load_explicit(&state->statEventsLate, memory_order_relaxed);
+	}
+	else if (caerStrEquals(key, "eventsDropped")) {
+		statisticValue = atomic_load_explicit(&state->statEventsDropped, memory_order_relaxed);
+	}
+	else if (caerStrEquals(key, "eventsBuffered")) {
+		statisticValue = atomic_load_explicit(&state->statEventsBuffered, memory_order_relaxed);
+	}
+	else if (caerStrEquals(key, "bufferingDelayAverage")) {
+		uint64_t delayCount = atomic_exchange_explicit(&state->statDelayCount, 0, memory_order_relaxed);
+		uint64_t delaySum   = atomic_exchange_explicit(&state->statDelaySum, 0, memory_order_relaxed);
+
+		if (delayCount != 0) {
+			statisticValue = delaySum / delayCount;
+		}
+	}
+	else if (caerStrEquals(key, "bufferingDelayMax")) {
+		statisticValue = atomic_exchange_explicit(&state->statDelayMax, 0, memory_order_relaxed);
+	}
+
+	value->ilong = I64T(statisticValue);
+}
+
+static bool caerMergeInit(caerModuleData moduleData) {
+	MergeState state = moduleData->moduleState;
+
+	int16_t *inputs   = NULL;
+	size_t inputsSize = caerMainloopModuleGetInputDeps(moduleData->moduleID, &inputs);
+	if (inputsSize == 0) {
+		caerModuleLog(moduleData, CAER_LOG_ERROR, "No input sources to merge.");
+		return (false);
+	}
+
+	// Wait for all inputs to be ready, their sourceInfo is merged below.
+	for (size_t i = 0; i < inputsSize; i++) {
+		if (caerMainloopGetSourceInfo(inputs[i]) == NULL) {
+			free(inputs);
+			return (false);
+		}
+	}
+
+	state->sources = calloc(inputsSize, sizeof(struct merge_source));
+	if (state->sources == NULL) {
+		free(inputs);
+		caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to allocate memory for sources.");
+		return (false);
+	}
+
+	state->mergeStreams = calloc(inputsSize, sizeof(struct merge_stream *));
+	if (state->mergeStreams == NULL) {
+		free(state->sources);
+		free(inputs);
+		caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to allocate memory for merge streams.");
+		return (false);
+	}
+
+	// Sources that never send anything are waited for up to 'maxLatency' from now.
+	struct timespec currentTime;
+	portable_clock_gettime_monotonic(&currentTime);
+
+	for (size_t i = 0; i < inputsSize; i++) {
+		state->sources[i].sourceID    = inputs[i];
+		state->sources[i].watermark   = -1;
+		state->sources[i].lastArrival = currentTime;
+	}
+
+	state->sourcesSize      = inputsSize;
+	state->emittedWatermark = -1;
+
+	utarray_new(state->streams, &ut_merge_stream_icd);
+
+	mergeSourceInfoInit(moduleData, inputs, inputsSize);
+
+	free(inputs);
+
+	caerMergeConfig(moduleData);
+
+	// Add read passthrough modifiers, they need access to moduleState.
+	sshsNodeAddAttributeReadModifier(moduleData->moduleNode, "eventsMerged", SSHS_LONG, state, &statisticsPassthrough);
+	sshsNodeAddAttributeReadModifier(moduleData->moduleNode, "eventsLate", SSHS_LONG, state, &statisticsPassthrough);
+	sshsNodeAddAttributeReadModifier(moduleData->moduleNode, "eventsDropped", SSHS_LONG, state, &statisticsPassthrough);
+	sshsNodeAddAttributeReadModifier(
+		moduleData->moduleNode, "eventsBuffered", SSHS_LONG, state, &statisticsPassthrough);
+	sshsNodeAddAttributeReadModifier(
+		moduleData->moduleNode, "bufferingDelayAverage", SSHS_LONG, state, &statisticsPassthrough);
+	sshsNodeAddAttributeReadModifier(
+		moduleData->moduleNode, "bufferingDelayMax", SSHS_LONG, state, &statisticsPassthrough);
+
+	// Add config listeners last, to avoid having them dangling if Init doesn't succeed.
+	sshsNodeAddAttributeChangeSetListener(
+		moduleData->moduleNode, moduleData, &caerModuleConfigDefaultChangeSetListener);
+
+	return (true);
+}
+
+/**
+ * The merged stream covers all its sources, so its sizes are the largest
+ * ones found in the sources' sourceInfo nodes.
+ *
+ * @param moduleData module data.
+ * @param inputs IDs of the source modules.
+ * @param inputsSize number of source modules.
+ */
+static void mergeSourceInfoInit(caerModuleData moduleData, int16_t *inputs, size_t inputsSize) {
+	static const char *sizeKeys[] = {
+		"dataSizeX", "dataSizeY", "polaritySizeX", "polaritySizeY", "frameSizeX", "frameSizeY"};
+
+	sshsNode sourceInfoNode = sshsGetRelativeNode(moduleData->moduleNode, "sourceInfo/");
+
+	for (size_t k = 0; k < (sizeof(sizeKeys) / sizeof(sizeKeys[0])); k++) {
+		int16_t size = 0;
+
+		for (size_t i = 0; i < inputsSize; i++) {
+			sshsNode sourceInfo = caerMainloopGetSourceInfo(inputs[i]);
+
+			if (sshsNodeAttributeExists(sourceInfo, sizeKeys[k], SSHS_SHORT)) {
+				int16_t sourceSize = sshsNodeGetShort(sourceInfo, sizeKeys[k]);
+
+				if (sourceSize > size) {
+					size = sourceSize;
+				}
+			}
+		}
+
+		if (size > 0) {
+			sshsNodeCreateShort(sourceInfoNode, sizeKeys[k], size, 1, INT16_MAX,
+				SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Output size, largest of all merged sources.");
+		}
+	}
+}
+
+static void caerMergeRun(caerModuleData moduleData, caerEventPacketContainer in, caerEventPacketContainer *out) {
+	MergeState state = moduleData->moduleState;
+
+	struct timespec currentTime;
+	portable_clock_gettime_monotonic(&currentTime);
+
+	// A timestamp reset from any source starts a new timeline: send on everything
+	// buffered from the old one, without waiting, and then start over. The new
+	// data is merged on the next run, as there can be only one packet per type.
+	bool timestampReset = false;
+
+	for (int32_t i = 0; i < caerEventPacketContainerGetEventPacketsNumber(in); i++) {
+		caerEventPacketHeaderConst packet = caerEventPacketContainerGetEventPacketConst(in, i);
+
+		if ((packet != NULL) && (caerEventPacketHeaderGetEventType(packet) == SPECIAL_EVENT)
+			&& (caerSpecialEventPacketFindValidEventByTypeConst((caerSpecialEventPacketConst) packet, TIMESTAMP_RESET)
+				   != NULL)) {
+			struct merge_source *source = mergeSourceGet(state, caerEventPacketHeaderGetEventSource(packet));
+			if (source != NULL) {
+				source->timestampReset = true;
+				timestampReset         = true;
+			}
+		}
+	}
+
+	if (timestampReset) {
+		*out = mergeEmit(moduleData, INT64_MAX, &currentTime);
+
+		mergeClear(state, true);
+
+		for (size_t i = 0; i < state->sourcesSize; i++) {
+			state->sources[i].watermark   = -1;
+			state->sources[i].lastArrival = currentTime;
+		}
+
+		state->emittedWatermark = -1;
+
+		caerModuleLog(moduleData, CAER_LOG_INFO, "Timestamp reset, restarting merge.");
+	}
+
+	for (int32_t i = 0; i < caerEventPacketContainerGetEventPacketsNumber(in); i++) {
+		caerEventPacketHeaderConst packet = caerEventPacketContainerGetEventPacketConst(in, i);
+
+		if (packet == NULL) {
+			continue;
+		}
+
+		// Packets from sources that didn't reset yet still belong to the old
+		// timeline, and would hold up the new one if buffered.
+		if (timestampReset) {
+			struct merge_source *source = mergeSourceGet(state, caerEventPacketHeaderGetEventSource(packet));
+			if ((source != NULL) && !source->timestampReset) {
+				atomic_fetch_add_explicit(&state->statEventsDropped,
+					U64T(caerEventPacketHeaderGetEventValid(packet)), memory_order_relaxed);
+				continue;
+			}
+		}
+
+		mergeBufferPacket(moduleData, packet, &currentTime);
+	}
+
+	for (size_t i = 0; i < state->sourcesSize; i++) {
+		state->sources[i].timestampReset = false;
+	}
+
+	if (!timestampReset) {
+		int64_t watermark = mergeWatermark(state, &currentTime);
+
+		*out = mergeEmit(moduleData, watermark, &currentTime);
+
+		state->emittedWatermark = watermark;
+	}
+
+	atomic_store_explicit(&state->statEventsBuffered, state->bufferedEvents, memory_order_relaxed);
+}
+
+/**
+ * Copy the valid events of an input packet into the merge buffer and update
+ * the source's watermark. Events older than what was already sent on are late
+ * and get dropped, so that the merged output stays in timestamp order.
+ *
+ * @param moduleData module data.
+ * @param packet input packet, not modified.
+ * @param currentTime current monotonic time.
+ */
+static void mergeBufferPacket(
+	caerModuleData moduleData, caerEventPacketHeaderConst packet, const struct timespec *currentTime) {
+	MergeState state = moduleData->moduleState;
+
+	int16_t sourceID            = caerEventPacketHeaderGetEventSource(packet);
+	struct merge_source *source = mergeSourceGet(state, sourceID);
+	if (source == NULL) {
+		caerModuleLog(moduleData, CAER_LOG_WARNING, "Dropping packet from unknown source %" PRIi16 ".", sourceID);
+		return;
+	}
+
+	if (caerEventPacketHeaderGetEventValid(packet) == 0) {
+		return;
+	}
+
+	source->lastArrival = *currentTime;
+
+	caerEventPacketHeader copy = caerEventPacketCopyOnlyValidEvents(packet);
+	if (copy == NULL) {
+		caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to copy packet into merge buffer.");
+		return;
+	}
+
+	int32_t eventNumber = caerEventPacketHeaderGetEventNumber(copy);
+
+	int64_t lastTimestamp = caerGenericEventGetTimestamp64(caerGenericEventGetEvent(copy, eventNumber - 1), copy);
+	if (lastTimestamp > source->watermark) {
+		source->watermark = lastTimestamp;
+	}
+
+	struct merge_stream *stream = mergeStreamGet(
+		moduleData, sourceID, caerEventPacketHeaderGetEventType(copy), caerEventPacketHeaderGetEventSize(copy));
+	if ((stream == NULL) || stream->ignored) {
+		atomic_fetch_add_explicit(&state->statEventsDropped, U64T(eventNumber), memory_order_relaxed);
+		free(copy);
+		return;
+	}
+
+	// Events are ordered by time, so late ones are all at the start.
+	int32_t position = 0;
+
+	while ((position < eventNumber)
+		   && (caerGenericEventGetTimestamp64(caerGenericEventGetEvent(copy, position), copy)
+				  < state->emittedWatermark)) {
+		position++;
+	}
+
+	if (position != 0) {
+		atomic_fetch_add_explicit(&state->statEventsLate, U64T(position), memory_order_relaxed);
+	}
+
+	if (position == eventNumber) {
+		free(copy);
+		return;
+	}
+
+	struct merge_buffered_packet buffered = {.packet = copy, .position = position, .arrival = *currentTime};
+	utarray_push_back(stream->packets, &buffered);
+
+	state->bufferedEvents += (size_t)(eventNumber - position);
+}
+
+static struct merge_source *mergeSourceGet(MergeState state, int16_t sourceID) {
+	for (size_t i = 0; i < state->sourcesSize; i++) {
+		if (state->sources[i].sourceID == sourceID) {
+			return (&state->sources[i]);
+		}
+	}
+
+	return (NULL);
+}
+
+static struct merge_stream *mergeStreamGet(
+	caerModuleData moduleData, int16_t sourceID, int16_t typeID, int32_t eventSize) {
+	MergeState state = moduleData->moduleState;
+
+	bool ignored = false;
+
+	struct merge_stream *stream = NULL;
+	while ((stream = (struct merge_stream *) utarray_next(state->streams, stream)) != NULL) {
+		if (stream->typeID != typeID) {
+			continue;
+		}
+
+		if (stream->sourceID == sourceID) {
+			return (stream);
+		}
+
+		if (!stream->ignored && (stream->eventSize != eventSize)) {
+			ignored = true;
+		}
+	}
+
+	if (ignored) {
+		caerModuleLog(moduleData, CAER_LOG_ERROR,
+			"Source %" PRIi16 " has a different event size for type %" PRIi16
+			" than the other sources, its events of that type will be dropped.",
+			sourceID, typeID);
+	}
+
+	struct merge_stream newStream
+		= {.sourceID = sourceID, .typeID = typeID, .eventSize = eventSize, .ignored = ignored, .packets = NULL};
+	utarray_new(newStream.packets, &ut_merge_packet_icd);
+
+	utarray_push_back(state->streams, &newStream);
+
+	return ((struct merge_stream *) utarray_back(state->streams));
+}
+
+/**
+ * Get the timestamp up to which events can be sent on. That is the lowest
+ * timestamp all sources have reached, leaving out sources that lag too far
+ * behind in event time ('maxSkew') or that didn't send any data for too long
+ * ('maxLatency'), so that one slow source can't hold up the whole stream.
+ *
+ * @param state merge state.
+ * @param currentTime current monotonic time.
+ *
+ * @return the new watermark, never lower than the previous one.
+ */
+static int64_t mergeWatermark(MergeState state, const struct timespec *currentTime) {
+	int64_t maxWatermark = -1;
+
+	for (size_t i = 0; i < state->sourcesSize; i++) {
+		if (state->sources[i].watermark > maxWatermark) {
+			maxWatermark = state->sources[i].watermark;
+		}
+	}
+
+	int64_t watermark = INT64_MAX;
+
+	for (size_t i = 0; i < state->sourcesSize; i++) {
+		const struct merge_source *source = &state->sources[i];
+
+		int64_t idleTime = I64T(currentTime->tv_sec - source->lastArrival.tv_sec) * 1000000LL
+						   + I64T(currentTime->tv_nsec - source->lastArrival.tv_nsec) / 1000;
+
+		if (idleTime > state->maxLatency) {
+			continue;
+		}
+
+		// Sources that didn't send anything yet can only time out.
+		if ((source->watermark != -1) && ((maxWatermark - source->watermark) > state->maxSkew)) {
+			continue;
+		}
+
+		if (source->watermark < watermark) {
+			watermark = source->watermark;
+		}
+	}
+
+	// Not waiting on anyone, everything can go.
+	if (watermark == INT64_MAX) {
+		watermark = maxWatermark;
+	}
+
+	if (watermark < state->emittedWatermark) {
+		watermark = state->emittedWatermark;
+	}
+
+	return (watermark);
+}
+
+static caerEventPacketContainer mergeEmit(
+	caerModuleData moduleData, int64_t watermark, const struct timespec *currentTime) {
+	MergeState state = moduleData->moduleState;
+
+	caerEventPacketContainer merged = NULL;
+	int32_t mergedPackets           = 0;
+
+	for (size_t i = 0; i < utarray_len(state->streams); i++) {
+		int16_t typeID = ((struct merge_stream *) utarray_eltptr(state->streams, i))->typeID;
+
+		// Each type only once, from its first stream.
+		bool seen = false;
+
+		for (size_t j = 0; j < i; j++) {
+			if (((struct merge_stream *) utarray_eltptr(state->streams, j))->typeID == typeID) {
+				seen = true;
+				break;
+			}
+		}
+
+		if (seen) {
+			continue;
+		}
+
+		caerEventPacketHeader packet = mergeEmitType(moduleData, typeID, watermark, currentTime);
+		if (packet == NULL) {
+			continue;
+		}
+
+		if (merged == NULL) {
+			merged = caerEventPacketContainerAllocate(I32T(utarray_len(state->streams)));
+			if (merged == NULL) {
+				caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to allocate memory for merged packet container.");
+				free(packet);
+				return (NULL);
+			}
+		}
+
+		caerEventPacketContainerSetEventPacket(merged, mergedPackets++, packet);
+	}
+
+	return (merged);
+}
+
+/**
+ * k-way merge of all streams of one type, by event timestamp, up to the
+ * watermark. A packet has only one timestamp overflow counter, so events
+ * belonging to the next one wait for the next run.
+ *
+ * @param moduleData module data.
+ * @param typeID event type to merge.
+ * @param watermark timestamp up to which (included) events are sent on.
+ * @param currentTime current monotonic time.
+ *
+ * @return a new merged packet, or NULL if there is nothing to send on.
+ */
+static caerEventPacketHeader mergeEmitType(
+	caerModuleData moduleData, int16_t typeID, int64_t watermark, const struct timespec *currentTime) {
+	MergeState state = moduleData->moduleState;
+
+	size_t streamsSize   = 0;
+	int32_t mergedNumber = 0;
+	int64_t minTimestamp = INT64_MAX;
+
+	struct merge_stream *stream = NULL;
+	while ((stream = (struct merge_stream *) utarray_next(state->streams, stream)) != NULL) {
+		if ((stream->typeID != typeID) || stream->ignored || (utarray_len(stream->packets) == 0)) {
+			continue;
+		}
+
+		state->mergeStreams[streamsSize++] = stream;
+
+		// Upper bound on events to merge, to size the packet.
+		struct merge_buffered_packet *buffered = NULL;
+		while ((buffered = (struct merge_buffered_packet *) utarray_next(stream->packets, buffered)) != NULL) {
+			int32_t eventNumber = caerEventPacketHeaderGetEventNumber(buffered->packet);
+
+			for (int32_t i = buffered->position; i < eventNumber; i++) {
+				int64_t timestamp
+					= caerGenericEventGetTimestamp64(caerGenericEventGetEvent(buffered->packet, i), buffered->packet);
+				if (timestamp > watermark) {
+					break;
+				}
+
+				if (timestamp < minTimestamp) {
+					minTimestamp = timestamp;
+				}
+
+				mergedNumber++;
+			}
+		}
+	}
+
+	if (mergedNumber == 0) {
+		return (NULL);
+	}
+
+	int32_t eventSize  = state->mergeStreams[0]->eventSize;
+	int32_t tsOverflow = I32T(minTimestamp >> 31);
+
+	caerEventPacketHeader packet = malloc(CAER_EVENT_PACKET_HEADER_SIZE + (size_t)(mergedNumber * eventSize));
+	if (packet == NULL) {
+		caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to allocate memory for merged packet.");
+		return (NULL);
+	}
+
+	// Header fields are the same for all sources of a type, but source and sizes.
+	memcpy(packet, ((struct merge_buffered_packet *) utarray_front(state->mergeStreams[0]->packets))->packet,
+		CAER_EVENT_PACKET_HEADER_SIZE);
+
+	// Source ID must be this module!
+	caerEventPacketHeaderSetEventSource(packet, moduleData->moduleID);
+	caerEventPacketHeaderSetEventTSOverflow(packet, tsOverflow);
+
+	int32_t number = 0;
+
+	while (number < mergedNumber) {
+		struct merge_stream *minStream = NULL;
+		int64_t minStreamTimestamp     = INT64_MAX;
+
+		// Few sources, a linear search for the smallest head is cheapest.
+		for (size_t i = 0; i < streamsSize; i++) {
+			if (utarray_len(state->mergeStreams[i]->packets) == 0) {
+				continue;
+			}
+
+			struct merge_buffered_packet *head
+				= (struct merge_buffered_packet *) utarray_front(state->mergeStreams[i]->packets);
+
+			int64_t timestamp
+				= caerGenericEventGetTimestamp64(caerGenericEventGetEvent(head->packet, head->position), head->packet);
+
+			if ((timestamp <= watermark) && ((timestamp >> 31) == tsOverflow) && (timestamp < minStreamTimestamp)) {
+				minStream          = state->mergeStreams[i];
+				minStreamTimestamp = timestamp;
+			}
+		}
+
+		if (minStream == NULL) {
+			break;
+		}
+
+		struct merge_buffered_packet *head = (struct merge_buffered_packet *) utarray_front(minStream->packets);
+
+		memcpy(caerGenericEventGetEvent(packet, number), caerGenericEventGetEvent(head->packet, head->position),
+			(size_t) eventSize);
+		number++;
+
+		uint64_t delay = U64T(I64T(currentTime->tv_sec - head->arrival.tv_sec) * 1000000LL
+							  + I64T(currentTime->tv_nsec - head->arrival.tv_nsec) / 1000);
+
+		atomic_fetch_add_explicit(&state->statDelaySum, delay, memory_order_relaxed);
+		atomic_fetch_add_explicit(&state->statDelayCount, 1, memory_order_relaxed);
+
+		if (delay > atomic_load_explicit(&state->statDelayMax, memory_order_relaxed)) {
+			atomic_store_explicit(&state->statDelayMax, delay, memory_order_relaxed);
+		}
+
+		head->position++;
+
+		if (head->position == caerEventPacketHeaderGetEventNumber(head->packet)) {
+			free(head->packet);
+			utarray_erase(minStream->packets, 0, 1);
+		}
+	}
+
+	caerEventPacketHeaderSetEventNumber(packet, number);
+	caerEventPacketHeaderSetEventCapacity(packet, mergedNumber);
+	caerEventPacketHeaderSetEventValid(packet, number);
+
+	state->bufferedEvents -= (size_t) number;
+
+	atomic_fetch_add_explicit(&state->statEventsMerged, U64T(number), memory_order_relaxed);
+
+	return (packet);
+}
+
+static void mergeClear(MergeState state, bool countDropped) {
+	struct merge_stream *stream = NULL;
+	while ((stream = (struct merge_stream *) utarray_next(state->streams, stream)) != NULL) {
+		struct merge_buffered_packet *buffered = NULL;
+		while ((buffered = (struct merge_buffered_packet *) utarray_next(stream->packets, buffered)) != NULL) {
+			free(buffered->packet);
+		}
+
+		utarray_free(stream->packets);
+	}
+
+	utarray_clear(state->streams);
+
+	if (countDropped) {
+		atomic_fetch_add_explicit(&state->statEventsDropped, state->bufferedEvents, memory_order_relaxed);
+	}
+
+	state->bufferedEvents = 0;
+}
+
+static void caerMergeConfig(caerModuleData moduleData) {
+	MergeState state = moduleData->moduleState;
+
+	state->maxSkew    = sshsNodeGetInt(moduleData->moduleNode, "maxSkew");
+	state->maxLatency = sshsNodeGetInt(moduleData->moduleNode, "maxLatency");
+}
+
+static void caerMergeExit(caerModuleData moduleData) {
+	MergeState state = moduleData->moduleState;
+
+	// Remove listener, which can reference invalid memory in userData.
+	sshsNodeRemoveAttributeChangeSetListener(
+		moduleData->moduleNode, moduleData, &caerModuleConfigDefaultChangeSetListener);
+
+	sshsNodeRemoveAllAttributeReadModifiers(moduleData->moduleNode);
+
+	mergeClear(state, false);
+	utarray_free(state->streams);
+
+	free(state->mergeStreams);
+	free(state->sources);
+
+	sshsNode sourceInfoNode = sshsGetRelativeNode(moduleData->moduleNode, "sourceInfo/");
+	sshsNodeClearSubTree(sourceInfoNode, true);
+}
@@ -237,7 +237,7 @@ static void caerVisualizerExit(caerModuleData moduleData) {
 	// Now clean up the ring-buffer and its contents.
 	caerEventPacketContainer container;
 	while ((container = (caerEventPacketContainer) caerRingBufferGet(state->dataTransfer)) != nullptr) {
-		caerEventPacketContainerFree(container);
+		caerMainloopPacketContainerRelease(container);
 	}
 
 	caerRingBufferFree(state->dataTransfer);
@@ -285,14 +285,21 @@ static void caerVisualizerRun(caerModuleData moduleData, caerEventPacketContaine
 		return;
 	}
 
-	caerEventPacketContainer containerCopy = caerEventPacketContainerCopyAllEvents(in);
-	if (containerCopy == nullptr) {
-		caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to copy event packet container for rendering.");
+	// Renderers only read the data, so reference the packets instead of copying them.
+	caerEventPacketContainer containerRef
+		= caerEventPacketContainerAllocate(caerEventPacketContainerGetEventPacketsNumber(in));
+	if (containerRef == nullptr) {
+		caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to allocate event packet container for rendering.");
 		return;
 	}
 
+	for (int32_t i = 0; i < caerEventPacketContainerGetEventPacketsNumber(in); i++) {
+		caerEventPacketContainerSetEventPacket(containerRef, i,
+			(caerEventPacketHeader) caerMainloopPacketRetain(caerEventPacketContainerGetEventPacketConst(in, i)));
+	}
+
 	// Will always succeed because of full check above.
-	caerRingBufferPut(state->dataTransfer, containerCopy);
+	caerRingBufferPut(state->dataTransfer, containerRef);
 }
 
 static void caerVisualizerReset(caerModuleData moduleData, int16_t resetCallSourceID) {
@@ -720,7 +727,7 @@ repeat:
 		caerEventPacketContainer container2 = (caerEventPacketContainer) caerRingBufferGet(state->dataTransfer);
 
 		if (container2 != nullptr) {
-			caerEventPacketContainerFree(container);
+			caerMainloopPacketContainerRelease(container);
 			container = container2;
 			goto repeat;
 		}
@@ -735,8 +742,8 @@ repeat:
 			drewSomething = (*state->renderer->renderer)((caerVisualizerPublicState) state, container);
 		}
 
-		// Free packet container copy.
-		caerEventPacketContainerFree(container);
+		// Release packet container references.
+		caerMainloopPacketContainerRelease(container);
 	}
 
 	// Render content to display.
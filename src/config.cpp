@@ -1,12 +1,21 @@
 #include "config.h"
 #include "caer-sdk/cross/portable_io.h"
+#include "caer-sdk/cross/portable_threads.h"
 #include <fcntl.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <ctime>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include <boost/filesystem.hpp>
@@ -15,6 +24,23 @@
 namespace po = boost::program_options;
 
 static boost::filesystem::path configFile;
+static boost::filesystem::path configSnapshotFile;
+
+static struct {
+	std::thread thread;
+	std::mutex lock;
+	std::condition_variable cond;
+	bool running;
+	bool requested;
+	std::chrono::steady_clock::time_point requestTime;
+	std::mutex writeLock;
+	uint64_t writtenChangeCount;
+} glConfigWriteBack;
+
+static bool caerConfigLoadSnapshot(void);
+static void caerConfigWriteBackIfChanged(void);
+static bool caerConfigWriteSnapshot(const boost::filesystem::path &snapshotFile);
+static bool caerConfigSnapshotUnchanged(const boost::filesystem::path &newSnapshotFile);
 
 [[noreturn]] static inline void printHelpAndExit(po::options_description &desc) {
 	std::cout << std::endl << desc << std::endl;
@@ -86,16 +112,21 @@ void caerConfigInit(int argc, char *argv[]) {
 		}
 	}
 
+	// The binary snapshot lives next to the XML file.
+	configSnapshotFile = boost::filesystem::path(configFile.string() + CAER_CONFIG_SNAPSHOT_EXTENSION);
+
 	// Let's try to open the file for reading, or create it.
 	int configFileFd = open(configFile.string().c_str(), O_RDONLY | O_CREAT, S_IWUSR | S_IRUSR | S_IRGRP);
 
 	if (configFileFd >= 0) {
 		// File opened for reading (or created) successfully.
+		// Prefer the binary snapshot if it is at least as recent as the XML
+		// file, else the XML was edited by hand and takes precedence.
 		// Load XML configuration from file if not empty.
 		struct stat configFileStat;
 		fstat(configFileFd, &configFileStat);
 
-		if (configFileStat.st_size > 0) {
+		if (!caerConfigLoadSnapshot() && (configFileStat.st_size > 0)) {
 			sshsNodeImportSubTreeFromXML(sshsGetNode(sshsGetGlobal(), "/"), configFileFd, true);
 		}
 
@@ -111,6 +142,9 @@ void caerConfigInit(int argc, char *argv[]) {
 		printHelpAndExit(cliDescription);
 	}
 
+	// What was just loaded is on disk already. Overrides are not.
+	glConfigWriteBack.writtenChangeCount = sshsGetChangeCount(sshsGetGlobal());
+
 	// Override with command-line arguments if requested.
 	if (cliVarMap.count("override")) {
 		std::vector<std::string> configOverrides = cliVarMap["override"].as<std::vector<std::string>>();
@@ -153,7 +187,152 @@ void caerConfigInit(int argc, char *argv[]) {
 	}
 }
 
+static bool caerConfigLoadSnapshot(void) {
+	boost::system::error_code ec;
+
+	if (!boost::filesystem::is_regular_file(configSnapshotFile, ec)) {
+		return (false);
+	}
+
+	const std::time_t snapshotTime = boost::filesystem::last_write_time(configSnapshotFile, ec);
+	if (ec) {
+		return (false);
+	}
+
+	const std::time_t xmlTime = boost::filesystem::last_write_time(configFile, ec);
+	if (ec || (xmlTime > snapshotTime)) {
+		return (false);
+	}
+
+	int snapshotFd = open(configSnapshotFile.string().c_str(), O_RDONLY);
+	if (snapshotFd < 0) {
+		return (false);
+	}
+
+	bool result = sshsNodeImportSubTreeFromBinary(sshsGetNode(sshsGetGlobal(), "/"), snapshotFd, true);
+
+	close(snapshotFd);
+
+	if (!result) {
+		std::cout << "Configuration snapshot " << configSnapshotFile << " is invalid, falling back to XML." << std::endl;
+	}
+
+	return (result);
+}
+
+void caerConfigWriteBackStart(void) {
+	std::lock_guard<std::mutex> lock(glConfigWriteBack.lock);
+
+	if (glConfigWriteBack.running) {
+		return;
+	}
+
+	glConfigWriteBack.running   = true;
+	glConfigWriteBack.requested = false;
+
+	glConfigWriteBack.thread = std::thread([]() {
+		portable_thread_set_name("ConfigWriteBack");
+
+		std::unique_lock<std::mutex> lock(glConfigWriteBack.lock);
+
+		while (true) {
+			glConfigWriteBack.cond.wait(
+				lock, []() { return (!glConfigWriteBack.running || glConfigWriteBack.requested); });
+
+			// Debounce: wait until no new request came in for a while, so a
+			// burst of changes (mainloop start, GUI sliders) is written once.
+			while (glConfigWriteBack.running) {
+				const auto deadline
+					= glConfigWriteBack.requestTime + std::chrono::milliseconds(CAER_CONFIG_WRITEBACK_DELAY_MS);
+
+				if (std::chrono::steady_clock::now() >= deadline) {
+					break;
+				}
+
+				glConfigWriteBack.cond.wait_until(lock, deadline);
+			}
+
+			// On stop, the final write is done by caerConfigWriteBackStop().
+			if (!glConfigWriteBack.running) {
+				break;
+			}
+
+			glConfigWriteBack.requested = false;
+
+			lock.unlock();
+			caerConfigWriteBackIfChanged();
+			lock.lock();
+		}
+	});
+}
+
+void caerConfigWriteBackStop(void) {
+	{
+		std::lock_guard<std::mutex> lock(glConfigWriteBack.lock);
+
+		if (!glConfigWriteBack.running) {
+			return;
+		}
+
+		glConfigWriteBack.running = false;
+	}
+
+	glConfigWriteBack.cond.notify_all();
+	glConfigWriteBack.thread.join();
+
+	// Final write of anything still pending.
+	caerConfigWriteBackIfChanged();
+}
+
 void caerConfigWriteBack(void) {
+	{
+		std::lock_guard<std::mutex> lock(glConfigWriteBack.lock);
+
+		if (glConfigWriteBack.running) {
+			glConfigWriteBack.requested   = true;
+			glConfigWriteBack.requestTime = std::chrono::steady_clock::now();
+
+			glConfigWriteBack.cond.notify_all();
+			return;
+		}
+	}
+
+	// No background thread, write right away.
+	caerConfigWriteBackIfChanged();
+}
+
+static void caerConfigWriteBackIfChanged(void) {
+	std::lock_guard<std::mutex> lock(glConfigWriteBack.writeLock);
+
+	// Get the count before writing, so that changes done while we write
+	// are picked up by the next write-back.
+	const uint64_t changeCount = sshsGetChangeCount(sshsGetGlobal());
+
+	if (changeCount == glConfigWriteBack.writtenChangeCount) {
+		caerLog(CAER_LOG_DEBUG, "Config", "Configuration unchanged, skipping write-back.");
+		return;
+	}
+
+	// Generate the binary snapshot first: it's cheap, and if it is identical
+	// to the one on disk (and the XML file wasn't edited since), the content
+	// didn't really change, for example after attributes loaded from file
+	// were re-created by their modules, and nothing has to be written.
+	const boost::filesystem::path tmpSnapshotFile(configSnapshotFile.string() + ".tmp");
+
+	if (!caerConfigWriteSnapshot(tmpSnapshotFile)) {
+		return;
+	}
+
+	if (caerConfigSnapshotUnchanged(tmpSnapshotFile)) {
+		boost::system::error_code ec;
+		boost::filesystem::remove(tmpSnapshotFile, ec);
+
+		glConfigWriteBack.writtenChangeCount = changeCount;
+
+		caerLog(CAER_LOG_DEBUG, "Config", "Configuration content unchanged, skipping write-back.");
+		return;
+	}
+
 	// configFile can only be correctly initialized, absolute and canonical
 	// by the point this function may ever be called, so we use it directly.
 	int configFileFd = open(configFile.string().c_str(), O_WRONLY | O_TRUNC);
@@ -169,5 +348,77 @@ void caerConfigWriteBack(void) {
 	else {
 		caerLog(CAER_LOG_EMERGENCY, "Config", "Could not write to the configuration file '%s'. Error: %d.",
 			configFile.string().c_str(), errno);
+
+		boost::system::error_code ec;
+		boost::filesystem::remove(tmpSnapshotFile, ec);
+		return;
 	}
+
+	// Rename the snapshot over the old one, so that a crash never leaves a
+	// half-written snapshot behind. Its time is updated so that it is at
+	// least as recent as the XML file just written, and preferred on load.
+	boost::system::error_code ec;
+
+	boost::filesystem::rename(tmpSnapshotFile, configSnapshotFile, ec);
+	if (!ec) {
+		boost::filesystem::last_write_time(configSnapshotFile, std::time(nullptr), ec);
+	}
+
+	if (ec) {
+		caerLog(CAER_LOG_ERROR, "Config", "Could not update the configuration snapshot '%s'. Error: '%s'.",
+			configSnapshotFile.string().c_str(), ec.message().c_str());
+
+		boost::filesystem::remove(tmpSnapshotFile, ec);
+		return;
+	}
+
+	caerLog(
+		CAER_LOG_DEBUG, "Config", "Configuration snapshot '%s' written to disk.", configSnapshotFile.string().c_str());
+
+	glConfigWriteBack.writtenChangeCount = changeCount;
+}
+
+static bool caerConfigWriteSnapshot(const boost::filesystem::path &snapshotFile) {
+	int snapshotFd = open(snapshotFile.string().c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IWUSR | S_IRUSR | S_IRGRP);
+
+	if (snapshotFd < 0) {
+		caerLog(CAER_LOG_ERROR, "Config", "Could not write to the configuration snapshot '%s'. Error: %d.",
+			snapshotFile.string().c_str(), errno);
+		return (false);
+	}
+
+	bool result = sshsNodeExportSubTreeToBinary(sshsGetNode(sshsGetGlobal(), "/"), snapshotFd);
+
+	portable_fsync(snapshotFd);
+	close(snapshotFd);
+
+	if (!result) {
+		boost::system::error_code ec;
+		boost::filesystem::remove(snapshotFile, ec);
+	}
+
+	return (result);
+}
+
+// True if the existing snapshot has the same content as newSnapshotFile,
+// and the XML file is not more recent than it.
+static bool caerConfigSnapshotUnchanged(const boost::filesystem::path &newSnapshotFile) {
+	boost::system::error_code ec;
+
+	const std::time_t snapshotTime = boost::filesystem::last_write_time(configSnapshotFile, ec);
+	if (ec) {
+		return (false);
+	}
+
+	const std::time_t xmlTime = boost::filesystem::last_write_time(configFile, ec);
+	if (ec || (xmlTime > snapshotTime)) {
+		return (false);
+	}
+
+	std::ifstream oldSnapshot(configSnapshotFile.string(), std::ios::binary);
+	std::ifstream newSnapshot(newSnapshotFile.string(), std::ios::binary);
+
+	return (oldSnapshot && newSnapshot
+			&& std::equal(std::istreambuf_iterator<char>(oldSnapshot), std::istreambuf_iterator<char>(),
+				   std::istreambuf_iterator<char>(newSnapshot), std::istreambuf_iterator<char>()));
 }
@@ -8,11 +8,21 @@ extern "C" {
 #endif
 
 #define CAER_CONFIG_FILE_NAME "caer-config.xml"
+#define CAER_CONFIG_SNAPSHOT_EXTENSION ".bin"
+#define CAER_CONFIG_WRITEBACK_DELAY_MS 2000
 
 // Create configuration storage, initialize it with content from the
-// configuration file, and apply eventual CLI overrides.
+// configuration file (or its more recent binary snapshot), and apply
+// eventual CLI overrides.
 void caerConfigInit(int argc, char *argv[]);
+
+// Request writing the configuration back to the XML file and binary
+// snapshot. With the write-back thread running, requests are debounced
+// and written in the background; nothing is written if the configuration
+// didn't change since the last write.
 void caerConfigWriteBack(void);
+void caerConfigWriteBackStart(void);
+void caerConfigWriteBackStop(void);
 
 #ifdef __cplusplus
 }
@@ -5,6 +5,11 @@
 
 #include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <istream>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <new>
@@ -25,60 +30,143 @@ namespace logger = libcaer::log;
 namespace asio   = boost::asio;
 namespace asioIP = boost::asio::ip;
 using asioTCP    = boost::asio::ip::tcp;
+using asioStream = boost::asio::generic::stream_protocol;
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+using asioLocal = boost::asio::local::stream_protocol;
+#endif
 
 #define CONFIG_SERVER_NAME "Config Server"
 
 class ConfigServerConnection;
+class ConfigServerSubscription;
 
 static void caerConfigServerHandleRequest(std::shared_ptr<ConfigServerConnection> client, uint8_t action, uint8_t type,
 	const uint8_t *extra, size_t extraLength, const uint8_t *node, size_t nodeLength, const uint8_t *key,
 	size_t keyLength, const uint8_t *value, size_t valueLength);
-
+static void caerConfigAppendResponse(
+	std::vector<uint8_t> &responses, uint8_t action, uint8_t type, const uint8_t *msg, size_t msgLength);
+static void caerConfigServerRegisterSubscription(std::shared_ptr<ConfigServerSubscription> subscription);
+static std::string caerConfigServerRenderMetrics(void);
+
+// TCP and Unix domain socket connections are both handled through generic
+// stream sockets. All handlers of a connection run on its strand, so they
+// never run concurrently, while different connections use all io threads.
+// Requests are pipelined: the next one is read as soon as the current one
+// has been handled, without waiting for its response to be written out.
+// Responses are still sent in request order.
 class ConfigServerConnection : public std::enable_shared_from_this<ConfigServerConnection> {
 private:
-	asioTCP::socket socket;
+	asioStream::socket socket;
+	asio::io_service &ioService;
+	// Shared with subscriptions, which can post to it after the connection is gone.
+	std::shared_ptr<asio::io_service::strand> strand;
+	const std::string clientName;
 	uint8_t data[CAER_CONFIG_SERVER_BUFFER_SIZE];
+	// Responses and pushed notifications share the socket, so all writes go
+	// through this queue.
+	std::deque<std::shared_ptr<std::vector<uint8_t>>> writeQueue;
+	bool readPaused;
+	std::vector<std::shared_ptr<ConfigServerSubscription>> subscriptions;
 
 public:
-	ConfigServerConnection(asioTCP::socket s) : socket(std::move(s)) {
-		logger::log(logger::logLevel::INFO, CONFIG_SERVER_NAME, "New connection from client %s:%d.",
-			socket.remote_endpoint().address().to_string().c_str(), socket.remote_endpoint().port());
+	ConfigServerConnection(asioStream::socket s, asio::io_service &ioSvc, const std::string &name)
+		: socket(std::move(s)), ioService(ioSvc), strand(std::make_shared<asio::io_service::strand>(ioSvc)),
+		  clientName(name), readPaused(false) {
+		logger::log(logger::logLevel::INFO, CONFIG_SERVER_NAME, "New connection from client %s.", clientName.c_str());
 	}
 
-	~ConfigServerConnection() {
-		logger::log(logger::logLevel::INFO, CONFIG_SERVER_NAME, "Closing connection from client %s:%d.",
-			socket.remote_endpoint().address().to_string().c_str(), socket.remote_endpoint().port());
-	}
+	~ConfigServerConnection();
 
 	void start() {
-		readHeader();
+		auto self(shared_from_this());
+
+		strand->dispatch([this, self]() { readHeader(); });
 	}
 
 	uint8_t *getData() {
 		return (data);
 	}
 
+	asio::io_service &getIOService() {
+		return (ioService);
+	}
+
+	std::shared_ptr<asio::io_service::strand> getStrand() {
+		return (strand);
+	}
+
+	// Write a series of responses prepared in a separate buffer, which
+	// is kept alive until the write completes.
+	void writeResponses(std::shared_ptr<std::vector<uint8_t>> responses) {
+		queueWrite(responses);
+	}
+
 	void writeResponse(size_t dataLength) {
+		queueWrite(std::make_shared<std::vector<uint8_t>>(data, data + dataLength));
+	}
+
+	// Write unrequested messages (subscription notifications).
+	void writePush(std::shared_ptr<std::vector<uint8_t>> messages) {
+		queueWrite(messages);
+	}
+
+	bool addSubscription(std::shared_ptr<ConfigServerSubscription> subscription);
+	bool removeSubscription(const std::string &nodePath, const std::string &key);
+
+private:
+	void queueWrite(std::shared_ptr<std::vector<uint8_t>> buffer) {
+		writeQueue.push_back(buffer);
+
+		// Only one write can be in progress, the others follow it.
+		if (writeQueue.size() == 1) {
+			writeNext();
+		}
+	}
+
+	void writeNext() {
 		auto self(shared_from_this());
 
-		asio::async_write(socket, asio::buffer(data, dataLength),
-			[this, self](const boost::system::error_code &error, std::size_t /*length*/) {
+		asio::async_write(socket, asio::buffer(*writeQueue.front()),
+			strand->wrap([this, self](const boost::system::error_code &error, std::size_t /*length*/) {
 				if (error) {
 					handleError(error, "Failed to write response");
+					writeQueue.clear();
+
+					// Also stop reading, so the connection goes away.
+					boost::system::error_code ignored;
+					socket.close(ignored);
+					return;
 				}
-				else {
-					// Restart.
+
+				writeQueue.pop_front();
+
+				// The client caught up with reading responses, resume.
+				if (readPaused && (writeQueue.size() < CAER_CONFIG_SERVER_MAX_QUEUED_WRITES)) {
+					readPaused = false;
 					readHeader();
 				}
-			});
+
+				if (!writeQueue.empty()) {
+					writeNext();
+				}
+			}));
+	}
+
+	void readNext() {
+		// Don't let a client that doesn't read its responses fill our memory.
+		if (writeQueue.size() >= CAER_CONFIG_SERVER_MAX_QUEUED_WRITES) {
+			readPaused = true;
+			return;
+		}
+
+		readHeader();
 	}
 
-private:
 	void readHeader() {
 		auto self(shared_from_this());
 
 		asio::async_read(socket, asio::buffer(data, CAER_CONFIG_SERVER_HEADER_SIZE),
-			[this, self](const boost::system::error_code &error, std::size_t /*length*/) {
+			strand->wrap([this, self](const boost::system::error_code &error, std::size_t /*length*/) {
 				if (error) {
 					handleError(error, "Failed to read header");
 				}
@@ -98,22 +186,20 @@ private:
 					// Close connection by falling out of scope.
 					if (readLength > (CAER_CONFIG_SERVER_BUFFER_SIZE - CAER_CONFIG_SERVER_HEADER_SIZE)) {
 						logger::log(logger::logLevel::INFO, CONFIG_SERVER_NAME,
-							"Client %s:%d: read length error (%d bytes requested).",
-							socket.remote_endpoint().address().to_string().c_str(), socket.remote_endpoint().port(),
-							readLength);
+							"Client %s: read length error (%d bytes requested).", clientName.c_str(), readLength);
 						return;
 					}
 
 					readData(readLength);
 				}
-			});
+			}));
 	}
 
 	void readData(size_t dataLength) {
 		auto self(shared_from_this());
 
 		asio::async_read(socket, asio::buffer(data + CAER_CONFIG_SERVER_HEADER_SIZE, dataLength),
-			[this, self](const boost::system::error_code &error, std::size_t /*length*/) {
+			strand->wrap([this, self](const boost::system::error_code &error, std::size_t /*length*/) {
 				if (error) {
 					handleError(error, "Failed to read data");
 				}
@@ -141,41 +227,578 @@ private:
 
 					caerConfigServerHandleRequest(
 						self, action, type, extra, extraLength, node, nodeLength, key, keyLength, value, valueLength);
+
+					// Pipelining: the response is queued, go on with the next request.
+					readNext();
 				}
-			});
+			}));
 	}
 
 	void handleError(const boost::system::error_code &error, const char *message) {
 		if (error == asio::error::eof) {
 			// Handle EOF separately.
-			logger::log(logger::logLevel::INFO, CONFIG_SERVER_NAME, "Client %s:%d: connection closed.",
-				socket.remote_endpoint().address().to_string().c_str(), socket.remote_endpoint().port());
+			logger::log(
+				logger::logLevel::INFO, CONFIG_SERVER_NAME, "Client %s: connection closed.", clientName.c_str());
+		}
+		else if (error != asio::error::operation_aborted) {
+			logger::log(logger::logLevel::ERROR, CONFIG_SERVER_NAME, "Client %s: %s. Error: %s (%d).",
+				clientName.c_str(), message, error.message().c_str(), error.value());
+		}
+	}
+};
+
+// Push attribute changes of a node (or a single attribute) to a client.
+// Changes are collected from SSHS listeners, coalesced to the latest value
+// per attribute, and sent at most once per minimum interval. Attributes with
+// a '<key>PollTime' companion are computed on read and never notify, so the
+// server polls those itself and only pushes them when they change.
+class ConfigServerSubscription : public std::enable_shared_from_this<ConfigServerSubscription> {
+private:
+	struct polledAttribute {
+		std::string key;
+		enum sshs_node_attr_value_type type;
+		std::chrono::seconds interval;
+		std::chrono::steady_clock::time_point lastPoll;
+		std::string lastValue;
+	};
+
+	std::weak_ptr<ConfigServerConnection> client;
+	sshsNode node;
+	const std::string nodePath;
+	const std::string key;
+	const std::chrono::milliseconds minInterval;
+	std::shared_ptr<asio::io_service::strand> strand;
+	asio::steady_timer flushTimer;
+	asio::steady_timer pollTimer;
+	// stopLock is held while stopping, polling and re-attaching, so that the
+	// node is never accessed after stop() returns. lock protects the pending
+	// changes and flags and is also taken by the listener, with the node locked.
+	std::mutex stopLock;
+	std::mutex lock;
+	std::map<std::pair<std::string, enum sshs_node_attr_value_type>, std::string> pending;
+	bool flushScheduled;
+	bool reattachScheduled;
+	bool stopped;
+	std::chrono::steady_clock::time_point lastFlush;
+	std::vector<polledAttribute> polled;
+
+public:
+	ConfigServerSubscription(std::shared_ptr<ConfigServerConnection> _client, sshsNode _node, const std::string &_key,
+		std::chrono::milliseconds _minInterval)
+		: client(_client),
+		  node(_node),
+		  nodePath(sshsNodeGetPath(_node)),
+		  key(_key),
+		  minInterval(_minInterval),
+		  strand(_client->getStrand()),
+		  flushTimer(_client->getIOService()),
+		  pollTimer(_client->getIOService()),
+		  flushScheduled(false),
+		  reattachScheduled(false),
+		  stopped(false) {
+	}
+
+	const std::string &getNodePath() const noexcept {
+		return (nodePath);
+	}
+
+	const std::string &getKey() const noexcept {
+		return (key);
+	}
+
+	// Call on the connection's strand.
+	void start() {
+		sshsNodeAddAttributeListener(node, this, &ConfigServerSubscription::attributeListener);
+
+		// Push the current values first, so the client has a baseline.
+		size_t numKeys;
+		const char **attrKeys = sshsNodeGetAttributeKeys(node, &numKeys);
+
+		for (size_t i = 0; i < numKeys; i++) {
+			if (!key.empty() && (key != attrKeys[i])) {
+				continue;
+			}
+
+			size_t numTypes;
+			enum sshs_node_attr_value_type *attrTypes = sshsNodeGetAttributeTypes(node, attrKeys[i], &numTypes);
+
+			for (size_t j = 0; j < numTypes; j++) {
+				const std::string value = getValueString(attrKeys[i], attrTypes[j]);
+
+				changed(attrKeys[i], attrTypes[j], value);
+
+				const std::string pollTimeKey = std::string(attrKeys[i]) + "PollTime";
+
+				if (sshsNodeAttributeExists(node, pollTimeKey.c_str(), SSHS_INT)) {
+					polled.push_back(polledAttribute{attrKeys[i], attrTypes[j],
+						std::chrono::seconds(sshsNodeGetInt(node, pollTimeKey.c_str())),
+						std::chrono::steady_clock::now(), value});
+				}
+			}
+
+			free(attrTypes);
+		}
+
+		free(attrKeys);
+
+		if (!polled.empty()) {
+			schedulePoll();
+		}
+	}
+
+	bool isStopped() {
+		std::lock_guard<std::mutex> guard(lock);
+
+		return (stopped);
+	}
+
+	// Can be called from any thread. Once stopped, the node is never accessed again.
+	// Returns false if the subscription was already stopped.
+	bool stop() {
+		std::lock_guard<std::mutex> stopGuard(stopLock);
+
+		{
+			std::lock_guard<std::mutex> guard(lock);
+
+			if (stopped) {
+				return (false);
+			}
+
+			stopped = true;
+		}
+
+		// Listeners are called with the node locked, so once this returns
+		// no listener call can still be using this subscription.
+		sshsNodeRemoveAttributeListener(node, this, &ConfigServerSubscription::attributeListener);
+
+		// Timers are not thread-safe, cancel them on the strand.
+		auto self(shared_from_this());
+		strand->post([self]() {
+			self->flushTimer.cancel();
+			self->pollTimer.cancel();
+		});
+
+		return (true);
+	}
+
+	// Stop because the node is going away, and tell the client so.
+	// Can be called from any thread, before the node is removed.
+	void end() {
+		if (!stop()) {
+			return;
+		}
+
+		auto self(shared_from_this());
+		strand->post([self]() {
+			auto connection = self->client.lock();
+			if (!connection) {
+				return;
+			}
+
+			std::string msg;
+			msg.append(self->nodePath);
+			msg.push_back('\0');
+			msg.append(self->key);
+			msg.push_back('\0');
+
+			auto messages = std::make_shared<std::vector<uint8_t>>();
+			caerConfigAppendResponse(
+				*messages, CAER_CONFIG_PUSH_END, SSHS_STRING, (const uint8_t *) msg.data(), msg.length());
+
+			connection->writePush(messages);
+		});
+	}
+
+	static void attributeListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
+		const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue) {
+		UNUSED_ARGUMENT(node);
+
+		ConfigServerSubscription *subscription = static_cast<ConfigServerSubscription *>(userData);
+
+		if (event == SSHS_ATTRIBUTE_REMOVED) {
+			// sshsNodeClearSubTree() removes all attributes and then silently
+			// drops all listeners, like when a module restarts. The listener
+			// can't be added back from here, so do it once the node is unlocked.
+			subscription->scheduleReattach();
+			return;
+		}
+
+		if (!subscription->key.empty() && subscription->key != changeKey) {
+			return;
+		}
+
+		char *valueStr = sshsHelperValueToStringConverter(changeType, changeValue);
+		if (valueStr == nullptr) {
+			return;
+		}
+
+		subscription->changed(changeKey, changeType, valueStr);
+
+		free(valueStr);
+	}
+
+private:
+	std::string getValueString(const char *attrKey, enum sshs_node_attr_value_type type) {
+		union sshs_node_attr_value value = sshsNodeGetAttribute(node, attrKey, type);
+
+		char *valueStr = sshsHelperValueToStringConverter(type, value);
+
+		if (type == SSHS_STRING) {
+			free(value.string);
+		}
+
+		if (valueStr == nullptr) {
+			return (std::string());
+		}
+
+		std::string result(valueStr);
+		free(valueStr);
+
+		return (result);
+	}
+
+	// Called from any thread, the rest happens on the connection's strand.
+	void changed(const std::string &changeKey, enum sshs_node_attr_value_type type, const std::string &value) {
+		std::lock_guard<std::mutex> guard(lock);
+
+		if (stopped) {
+			return;
+		}
+
+		pending[std::make_pair(changeKey, type)] = value;
+
+		if (!flushScheduled) {
+			flushScheduled = true;
+
+			auto self(shared_from_this());
+			strand->post([self]() { self->scheduleFlush(); });
+		}
+	}
+
+	// Called from any thread, with the node locked.
+	void scheduleReattach() {
+		std::lock_guard<std::mutex> guard(lock);
+
+		if (stopped || reattachScheduled) {
+			return;
+		}
+
+		reattachScheduled = true;
+
+		auto self(shared_from_this());
+		strand->post([self]() { self->reattach(); });
+	}
+
+	void reattach() {
+		std::lock_guard<std::mutex> stopGuard(stopLock);
+
+		{
+			std::lock_guard<std::mutex> guard(lock);
+
+			reattachScheduled = false;
+
+			if (stopped) {
+				return;
+			}
+		}
+
+		// Waits for any clearing of the node to finish. Does nothing if the
+		// listener is still there, new attributes notify it as added.
+		sshsNodeAddAttributeListener(node, this, &ConfigServerSubscription::attributeListener);
+	}
+
+	void scheduleFlush() {
+		auto self(shared_from_this());
+
+		flushTimer.expires_at(std::max(std::chrono::steady_clock::now(), lastFlush + minInterval));
+		flushTimer.async_wait(strand->wrap([self](const boost::system::error_code &error) {
+			if (!error) {
+				self->flush();
+			}
+		}));
+	}
+
+	void flush() {
+		std::map<std::pair<std::string, enum sshs_node_attr_value_type>, std::string> changes;
+
+		{
+			std::lock_guard<std::mutex> guard(lock);
+
+			if (stopped) {
+				return;
+			}
+
+			changes.swap(pending);
+			flushScheduled = false;
+		}
+
+		lastFlush = std::chrono::steady_clock::now();
+
+		auto connection = client.lock();
+		if (!connection || changes.empty()) {
+			return;
+		}
+
+		// Records of 'node', 'key', 'type', 'value', as many per message as fit.
+		auto messages = std::make_shared<std::vector<uint8_t>>();
+		std::string msg;
+
+		for (const auto &change : changes) {
+			std::string record;
+			auto appendPart = [&record](const std::string &part) {
+				record.append(part);
+				record.push_back('\0');
+			};
+
+			appendPart(nodePath);
+			appendPart(change.first.first);
+			appendPart(sshsHelperTypeToStringConverter(change.first.second));
+			appendPart(change.second);
+
+			if ((msg.length() + record.length()) > (CAER_CONFIG_SERVER_BUFFER_SIZE - 4)) {
+				if (!msg.empty()) {
+					caerConfigAppendResponse(
+						*messages, CAER_CONFIG_PUSH, SSHS_STRING, (const uint8_t *) msg.data(), msg.length());
+					msg.clear();
+				}
+
+				if (record.length() > (CAER_CONFIG_SERVER_BUFFER_SIZE - 4)) {
+					// Too large to ever be sent, drop it.
+					continue;
+				}
+			}
+
+			msg.append(record);
+		}
+
+		if (!msg.empty()) {
+			caerConfigAppendResponse(
+				*messages, CAER_CONFIG_PUSH, SSHS_STRING, (const uint8_t *) msg.data(), msg.length());
+		}
+
+		connection->writePush(messages);
+	}
+
+	void schedulePoll() {
+		auto self(shared_from_this());
+
+		// PollTime is in seconds, so checking once per second is enough.
+		pollTimer.expires_from_now(std::chrono::seconds(1));
+		pollTimer.async_wait(strand->wrap([self](const boost::system::error_code &error) {
+			if (!error) {
+				self->poll();
+			}
+		}));
+	}
+
+	void poll() {
+		std::lock_guard<std::mutex> stopGuard(stopLock);
+
+		{
+			std::lock_guard<std::mutex> guard(lock);
+
+			if (stopped) {
+				return;
+			}
+		}
+
+		const auto now = std::chrono::steady_clock::now();
+
+		for (auto &attr : polled) {
+			if ((now - attr.lastPoll) < attr.interval) {
+				continue;
+			}
+
+			attr.lastPoll = now;
+
+			// Attributes could be removed concurrently by modules.
+			if (!sshsNodeAttributeExists(node, attr.key.c_str(), attr.type)) {
+				continue;
+			}
+
+			std::string value = getValueString(attr.key.c_str(), attr.type);
+
+			if (value != attr.lastValue) {
+				attr.lastValue = value;
+
+				changed(attr.key, attr.type, value);
+			}
+		}
+
+		schedulePoll();
+	}
+};
+
+ConfigServerConnection::~ConfigServerConnection() {
+	for (const auto &subscription : subscriptions) {
+		subscription->stop();
+	}
+
+	logger::log(logger::logLevel::INFO, CONFIG_SERVER_NAME, "Closing connection from client %s.", clientName.c_str());
+}
+
+bool ConfigServerConnection::addSubscription(std::shared_ptr<ConfigServerSubscription> subscription) {
+	// Forget subscriptions that ended because their node was removed.
+	subscriptions.erase(std::remove_if(subscriptions.begin(), subscriptions.end(),
+							[](const std::shared_ptr<ConfigServerSubscription> &sub) { return (sub->isStopped()); }),
+		subscriptions.end());
+
+	for (const auto &sub : subscriptions) {
+		if ((sub->getNodePath() == subscription->getNodePath()) && (sub->getKey() == subscription->getKey())) {
+			return (false);
+		}
+	}
+
+	subscriptions.push_back(subscription);
+	caerConfigServerRegisterSubscription(subscription);
+
+	subscription->start();
+
+	return (true);
+}
+
+bool ConfigServerConnection::removeSubscription(const std::string &nodePath, const std::string &key) {
+	for (auto iter = subscriptions.begin(); iter != subscriptions.end(); iter++) {
+		if (((*iter)->getNodePath() == nodePath) && ((*iter)->getKey() == key)) {
+			(*iter)->stop();
+			subscriptions.erase(iter);
+			return (true);
+		}
+	}
+
+	return (false);
+}
+
+// Minimal HTTP handling for metrics scraping: a single GET request per
+// connection, answered with all current statistics, then closed.
+class MetricsConnection : public std::enable_shared_from_this<MetricsConnection> {
+private:
+	asioTCP::socket socket;
+	asio::streambuf request;
+	std::string response;
+
+public:
+	MetricsConnection(asioTCP::socket s) : socket(std::move(s)), request(CAER_CONFIG_SERVER_BUFFER_SIZE) {
+	}
+
+	void start() {
+		auto self(shared_from_this());
+
+		asio::async_read_until(
+			socket, request, "\r\n\r\n", [this, self](const boost::system::error_code &error, std::size_t /*length*/) {
+				if (error) {
+					logger::log(logger::logLevel::DEBUG, CONFIG_SERVER_NAME,
+						"Metrics: failed to read request. Error: %s (%d).", error.message().c_str(), error.value());
+					return;
+				}
+
+				handleRequest();
+			});
+	}
+
+private:
+	void handleRequest() {
+		std::istream requestStream(&request);
+
+		std::string method;
+		std::string target;
+		requestStream >> method >> target;
+
+		// Ignore query parameters.
+		target = target.substr(0, target.find('?'));
+
+		if (method != "GET") {
+			sendResponse("405 Method Not Allowed", "Only GET is supported.\n");
+		}
+		else if ((target != "/metrics") && (target != "/")) {
+			sendResponse("404 Not Found", "Metrics are available at /metrics.\n");
 		}
 		else {
-			logger::log(logger::logLevel::ERROR, CONFIG_SERVER_NAME, "Client %s:%d: %s. Error: %s (%d).",
-				socket.remote_endpoint().address().to_string().c_str(), socket.remote_endpoint().port(), message,
-				error.message().c_str(), error.value());
+			sendResponse("200 OK", caerConfigServerRenderMetrics());
 		}
 	}
+
+	void sendResponse(const char *status, const std::string &body) {
+		auto self(shared_from_this());
+
+		response = boost::str(boost::format("HTTP/1.1 %s\r\n"
+											"Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+											"Content-Length: %d\r\n"
+											"Connection: close\r\n\r\n")
+							  % status % body.length());
+		response.append(body);
+
+		asio::async_write(socket, asio::buffer(response),
+			[this, self](const boost::system::error_code &error, std::size_t /*length*/) {
+				if (error) {
+					logger::log(logger::logLevel::DEBUG, CONFIG_SERVER_NAME,
+						"Metrics: failed to write response. Error: %s (%d).", error.message().c_str(), error.value());
+				}
+
+				boost::system::error_code ignored;
+				socket.shutdown(asioTCP::socket::shutdown_both, ignored);
+			});
+	}
 };
 
 class ConfigServer {
 private:
 	asio::io_service ioService;
 	asioTCP::acceptor acceptor;
-	asioTCP::socket socket;
-	std::thread ioThread;
+	asioStream::socket socket;
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+	std::unique_ptr<asioLocal::acceptor> localAcceptor;
+	asioStream::socket localSocket;
+	std::string localPath;
+#endif
+	std::unique_ptr<asioTCP::acceptor> metricsAcceptor;
+	asioTCP::socket metricsSocket;
+	std::vector<std::thread> ioThreads;
 
 public:
-	ConfigServer(const asioIP::address &listenAddress, unsigned short listenPort)
-		: acceptor(ioService, asioTCP::endpoint(listenAddress, listenPort)), socket(ioService) {
+	ConfigServer(const asioIP::address &listenAddress, unsigned short listenPort, const std::string &unixSocketPath,
+		unsigned short metricsPort, size_t numIOThreads)
+		: acceptor(ioService, asioTCP::endpoint(listenAddress, listenPort)),
+		  socket(ioService),
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+		  localSocket(ioService),
+#endif
+		  metricsSocket(ioService) {
 		acceptStart();
 
-		threadStart();
+		if (metricsPort != 0) {
+			metricsAcceptor
+				= std::make_unique<asioTCP::acceptor>(ioService, asioTCP::endpoint(listenAddress, metricsPort));
+
+			metricsAcceptStart();
+		}
+
+		if (!unixSocketPath.empty()) {
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+			// Remove a stale socket file left over by a previous run.
+			unlink(unixSocketPath.c_str());
+
+			localAcceptor = std::make_unique<asioLocal::acceptor>(ioService, asioLocal::endpoint(unixSocketPath));
+			localPath     = unixSocketPath;
+
+			localAcceptStart();
+#else
+			logger::log(logger::logLevel::WARNING, CONFIG_SERVER_NAME,
+				"Unix domain sockets are not supported on this platform, ignoring '%s'.", unixSocketPath.c_str());
+#endif
+		}
+
+		threadStart(numIOThreads);
 	}
 
 	void stop() {
 		threadStop();
+
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+		if (localAcceptor) {
+			unlink(localPath.c_str());
+		}
+#endif
 	}
 
 private:
@@ -186,37 +809,120 @@ private:
 					"Failed to accept new connection. Error: %s (%d).", error.message().c_str(), error.value());
 			}
 			else {
-				std::make_shared<ConfigServerConnection>(std::move(socket))->start();
+				std::string clientName = tcpClientName();
+
+				std::make_shared<ConfigServerConnection>(std::move(socket), ioService, clientName)->start();
 			}
 
 			acceptStart();
 		});
 	}
 
-	void threadStart() {
-		ioThread = std::thread([this]() {
-			// Set thread name.
-			portable_thread_set_name("ConfigServer");
+	void metricsAcceptStart() {
+		metricsAcceptor->async_accept(metricsSocket, [this](const boost::system::error_code &error) {
+			if (error) {
+				logger::log(logger::logLevel::ERROR, CONFIG_SERVER_NAME,
+					"Failed to accept new metrics connection. Error: %s (%d).", error.message().c_str(),
+					error.value());
+			}
+			else {
+				std::make_shared<MetricsConnection>(std::move(metricsSocket))->start();
+			}
 
-			// Run IO service.
-			while (!ioService.stopped()) {
-				ioService.run();
+			metricsAcceptStart();
+		});
+	}
+
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+	void localAcceptStart() {
+		localAcceptor->async_accept(localSocket, [this](const boost::system::error_code &error) {
+			if (error) {
+				logger::log(logger::logLevel::ERROR, CONFIG_SERVER_NAME,
+					"Failed to accept new local connection. Error: %s (%d).", error.message().c_str(), error.value());
 			}
+			else {
+				std::make_shared<ConfigServerConnection>(std::move(localSocket), ioService, "local:" + localPath)
+					->start();
+			}
+
+			localAcceptStart();
 		});
 	}
+#endif
+
+	// The generic socket only gives back a raw endpoint, convert it back
+	// to a TCP one for a readable address.
+	std::string tcpClientName() {
+		boost::system::error_code error;
+		asioStream::endpoint remote = socket.remote_endpoint(error);
+
+		asioTCP::endpoint tcpRemote;
+
+		if (error || (remote.size() > tcpRemote.capacity())) {
+			return ("unknown");
+		}
+
+		memcpy(tcpRemote.data(), remote.data(), remote.size());
+		tcpRemote.resize(remote.size());
+
+		return (boost::str(boost::format("%s:%d") % tcpRemote.address().to_string() % tcpRemote.port()));
+	}
+
+	void threadStart(size_t numIOThreads) {
+		for (size_t i = 0; i < numIOThreads; i++) {
+			ioThreads.emplace_back([this]() {
+				// Set thread name.
+				portable_thread_set_name("ConfigServer");
+
+				// Run IO service.
+				while (!ioService.stopped()) {
+					ioService.run();
+				}
+			});
+		}
+	}
 
 	void threadStop() {
 		ioService.stop();
 
-		ioThread.join();
+		for (auto &t : ioThreads) {
+			t.join();
+		}
 	}
 };
 
 static struct {
 	std::unique_ptr<ConfigServer> server;
 	std::shared_timed_mutex operationsSharedMutex;
+	std::mutex subscriptionsLock;
+	std::vector<std::weak_ptr<ConfigServerSubscription>> subscriptions;
 } glConfigServerData;
 
+static void caerConfigServerRegisterSubscription(std::shared_ptr<ConfigServerSubscription> subscription) {
+	std::lock_guard<std::mutex> lock(glConfigServerData.subscriptionsLock);
+
+	// Forget about subscriptions that don't exist anymore.
+	glConfigServerData.subscriptions.erase(
+		std::remove_if(glConfigServerData.subscriptions.begin(), glConfigServerData.subscriptions.end(),
+			[](const std::weak_ptr<ConfigServerSubscription> &sub) { return (sub.expired()); }),
+		glConfigServerData.subscriptions.end());
+
+	glConfigServerData.subscriptions.push_back(subscription);
+}
+
+// End all subscriptions to nodes under nodePath, before they are removed.
+static void caerConfigServerStopSubscriptions(const std::string &nodePath) {
+	std::lock_guard<std::mutex> lock(glConfigServerData.subscriptionsLock);
+
+	for (const auto &sub : glConfigServerData.subscriptions) {
+		auto subscription = sub.lock();
+
+		if (subscription && boost::starts_with(subscription->getNodePath(), nodePath)) {
+			subscription->end();
+		}
+	}
+}
+
 void caerConfigServerStart(void) {
 	// Get the right configuration node first.
 	sshsNode serverNode = sshsGetNode(sshsGetGlobal(), "/caer/server/");
@@ -226,12 +932,20 @@ void caerConfigServerStart(void) {
 		"IPv4 address to listen on for configuration server connections.");
 	sshsNodeCreate(serverNode, "portNumber", 4040, 1, UINT16_MAX, SSHS_FLAGS_NORMAL,
 		"Port to listen on for configuration server connections.");
+	sshsNodeCreate(serverNode, "unixSocketPath", "", 0, PATH_MAX, SSHS_FLAGS_NORMAL,
+		"Path of a Unix domain socket to also listen on for local configuration server connections, "
+		"empty to disable.");
+	sshsNodeCreate(serverNode, "ioThreads", 2, 1, 64, SSHS_FLAGS_NORMAL,
+		"Number of threads handling configuration server connections.");
+	sshsNodeCreate(serverNode, "metricsPortNumber", 0, 0, UINT16_MAX, SSHS_FLAGS_NORMAL,
+		"Port to serve statistics on over HTTP (Prometheus text format, at /metrics), 0 to disable.");
 
 	// Start the thread.
 	try {
 		glConfigServerData.server = std::make_unique<ConfigServer>(
 			asioIP::address::from_string(sshsNodeGetStdString(serverNode, "ipAddress")),
-			sshsNodeGetInt(serverNode, "portNumber"));
+			sshsNodeGetInt(serverNode, "portNumber"), sshsNodeGetStdString(serverNode, "unixSocketPath"),
+			sshsNodeGetInt(serverNode, "metricsPortNumber"), (size_t) sshsNodeGetInt(serverNode, "ioThreads"));
 	}
 	catch (const std::system_error &ex) {
 		// Failed to create thread.
@@ -287,53 +1001,402 @@ static inline void caerConfigSendResponse(std::shared_ptr<ConfigServerConnection
 	const uint8_t *msg, size_t msgLength) {
 	size_t responseLength = 4 + msgLength;
 
-	uint8_t *response = client->getData();
+	uint8_t *response = client->getData();
+
+	response[0] = action;
+	response[1] = type;
+	setMsgLen(response, (uint16_t) msgLength);
+	memcpy(response + 4, msg, msgLength);
+	// Msg must already be NUL terminated!
+
+	client->writeResponse(responseLength);
+
+	logger::log(logger::logLevel::DEBUG, CONFIG_SERVER_NAME,
+		"Sent back message to client: action=%" PRIu8 ", type=%" PRIu8 ", msgLength=%zu.", action, type, msgLength);
+}
+
+static inline bool checkNodeExists(sshs configStore, const char *node, std::shared_ptr<ConfigServerConnection> client) {
+	bool nodeExists = sshsExistsNode(configStore, node);
+
+	// Only allow operations on existing nodes, this is for remote
+	// control, so we only manipulate what's already there!
+	if (!nodeExists) {
+		// Send back error message to client.
+		caerConfigSendError(client, "Node doesn't exist. Operations are only allowed on existing data.");
+	}
+
+	return (nodeExists);
+}
+
+static inline bool checkAttributeExists(sshsNode wantedNode, const char *key, enum sshs_node_attr_value_type type,
+	std::shared_ptr<ConfigServerConnection> client) {
+	// Check if attribute exists. Only allow operations on existing attributes!
+	bool attrExists = sshsNodeAttributeExists(wantedNode, key, type);
+
+	if (!attrExists) {
+		// Send back error message to client.
+		caerConfigSendError(
+			client, "Attribute of given type doesn't exist. Operations are only allowed on existing data.");
+	}
+
+	return (attrExists);
+}
+
+static inline void caerConfigSendBoolResponse(
+	std::shared_ptr<ConfigServerConnection> client, uint8_t action, bool result) {
+	// Send back result to client. Format is the same as incoming data.
+	const uint8_t *sendResult = (const uint8_t *) ((result) ? ("true") : ("false"));
+	size_t sendResultLength   = (result) ? (5) : (6);
+	caerConfigSendResponse(client, action, SSHS_BOOL, sendResult, sendResultLength);
+}
+
+// Split a field into its NUL terminated parts. Returns an empty vector if
+// the last part is missing its NUL termination.
+static std::vector<const char *> caerConfigSplitParts(const uint8_t *field, size_t fieldLength) {
+	std::vector<const char *> parts;
+
+	for (size_t i = 0; i < fieldLength;) {
+		const char *part  = (const char *) (field + i);
+		size_t partLength = strnlen(part, fieldLength - i);
+
+		if (partLength == (fieldLength - i)) {
+			parts.clear();
+			break;
+		}
+
+		parts.push_back(part);
+		i += partLength + 1;
+	}
+
+	return (parts);
+}
+
+static const char *caerConfigPutErrorMessage(int error) {
+	switch (error) {
+		case EINVAL:
+			return ("Impossible to convert value according to type.");
+
+		case ENOENT:
+			return ("Attribute of given type doesn't exist. Operations are only allowed on existing data.");
+
+		case EPERM:
+			return ("Cannot write to a read-only attribute.");
+
+		case ERANGE:
+			return ("Value out of attribute range.");
+
+		default:
+			return ("Unknown error.");
+	}
+}
+
+static std::string caerConfigRangeToString(enum sshs_node_attr_value_type type, union sshs_node_attr_range range) {
+	char buf[128];
+
+	switch (type) {
+		case SSHS_BOOL:
+		case SSHS_BYTE:
+			snprintf(buf, 128, "%" PRIi8, range.ibyteRange);
+			break;
+
+		case SSHS_SHORT:
+			snprintf(buf, 128, "%" PRIi16, range.ishortRange);
+			break;
+
+		case SSHS_INT:
+			snprintf(buf, 128, "%" PRIi32, range.iintRange);
+			break;
+
+		case SSHS_LONG:
+			snprintf(buf, 128, "%" PRIi64, range.ilongRange);
+			break;
+
+		case SSHS_FLOAT:
+			snprintf(buf, 128, "%g", (double) range.ffloatRange);
+			break;
+
+		case SSHS_DOUBLE:
+			snprintf(buf, 128, "%g", range.ddoubleRange);
+			break;
+
+		case SSHS_STRING:
+			snprintf(buf, 128, "%zu", range.stringRange);
+			break;
+
+		default:
+			buf[0] = '\0';
+			break;
+	}
+
+	return (std::string(buf));
+}
+
+static std::string caerConfigFlagsToString(int flags) {
+	std::string flagsStr;
+
+	if (flags & SSHS_FLAGS_READ_ONLY) {
+		flagsStr = "READ_ONLY";
+	}
+	else if (flags & SSHS_FLAGS_NOTIFY_ONLY) {
+		flagsStr = "NOTIFY_ONLY";
+	}
+	else {
+		flagsStr = "NORMAL";
+	}
+
+	if (flags & SSHS_FLAGS_NO_EXPORT) {
+		flagsStr += ",NO_EXPORT";
+	}
+
+	return (flagsStr);
+}
+
+// Append one response message (same format as above) to a buffer.
+static void caerConfigAppendResponse(
+	std::vector<uint8_t> &responses, uint8_t action, uint8_t type, const uint8_t *msg, size_t msgLength) {
+	const size_t offset = responses.size();
+
+	responses.resize(offset + 4 + msgLength);
+
+	responses[offset]     = action;
+	responses[offset + 1] = type;
+	setMsgLen(responses.data() + offset, (uint16_t) msgLength);
+	memcpy(responses.data() + offset + 4, msg, msgLength);
+}
+
+// Records for all attributes of node and its children, depth-first, in name order.
+static void caerConfigDumpNode(sshsNode node, std::vector<std::string> &records) {
+	size_t numKeys;
+	const char **attrKeys = sshsNodeGetAttributeKeys(node, &numKeys);
+
+	for (size_t i = 0; i < numKeys; i++) {
+		size_t numTypes;
+		enum sshs_node_attr_value_type *attrTypes = sshsNodeGetAttributeTypes(node, attrKeys[i], &numTypes);
+
+		for (size_t j = 0; j < numTypes; j++) {
+			enum sshs_node_attr_value_type type = attrTypes[j];
+
+			// Attributes could be removed concurrently by modules.
+			if (!sshsNodeAttributeExists(node, attrKeys[i], type)) {
+				continue;
+			}
+
+			struct sshs_node_attr_ranges ranges = sshsNodeGetAttributeRanges(node, attrKeys[i], type);
+			int flags                           = sshsNodeGetAttributeFlags(node, attrKeys[i], type);
+
+			union sshs_node_attr_value value = sshsNodeGetAttribute(node, attrKeys[i], type);
+			char *valueStr                   = sshsHelperValueToStringConverter(type, value);
+			if (type == SSHS_STRING) {
+				free(value.string);
+			}
+
+			if (valueStr == nullptr) {
+				continue;
+			}
+
+			std::string record;
+			auto appendPart = [&record](const std::string &part) {
+				record.append(part);
+				record.push_back('\0');
+			};
+
+			appendPart(sshsNodeGetPath(node));
+			appendPart(attrKeys[i]);
+			appendPart(sshsHelperTypeToStringConverter(type));
+			appendPart(caerConfigFlagsToString(flags));
+			appendPart(caerConfigRangeToString(type, ranges.min));
+			appendPart(caerConfigRangeToString(type, ranges.max));
+			appendPart(valueStr);
+
+			free(valueStr);
+
+			records.push_back(std::move(record));
+		}
+
+		free(attrTypes);
+	}
+
+	free(attrKeys);
+
+	size_t numChildren;
+	sshsNode *children = sshsNodeGetChildren(node, &numChildren);
+
+	for (size_t i = 0; i < numChildren; i++) {
+		caerConfigDumpNode(children[i], records);
+	}
+
+	free(children);
+}
+
+struct caerMetricFamily {
+	std::string help;
+	std::vector<std::string> samples;
+};
+
+// 'hotPixelFiltered' becomes 'caer_hot_pixel_filtered'.
+static std::string caerConfigMetricName(const std::string &key) {
+	std::string name("caer_");
+
+	for (size_t i = 0; i < key.length(); i++) {
+		const char c = key[i];
+
+		if (isupper(c)) {
+			if ((i > 0) && (islower(key[i - 1]) || isdigit(key[i - 1]))) {
+				name.push_back('_');
+			}
+
+			name.push_back((char) tolower(c));
+		}
+		else if (isalnum(c)) {
+			name.push_back(c);
+		}
+		else {
+			name.push_back('_');
+		}
+	}
+
+	return (name);
+}
+
+static std::string caerConfigMetricEscape(const std::string &str, bool escapeQuotes) {
+	std::string escaped;
+
+	for (const char c : str) {
+		if (c == '\\') {
+			escaped.append("\\\\");
+		}
+		else if (c == '\n') {
+			escaped.append("\\n");
+		}
+		else if ((c == '"') && escapeQuotes) {
+			escaped.append("\\\"");
+		}
+		else {
+			escaped.push_back(c);
+		}
+	}
+
+	return (escaped);
+}
+
+static std::string caerConfigMetricValue(enum sshs_node_attr_value_type type, union sshs_node_attr_value value) {
+	double floatValue;
+
+	switch (type) {
+		case SSHS_BOOL:
+			return ((value.boolean) ? ("1") : ("0"));
+
+		case SSHS_BYTE:
+			return (std::to_string(value.ibyte));
+
+		case SSHS_SHORT:
+			return (std::to_string(value.ishort));
+
+		case SSHS_INT:
+			return (std::to_string(value.iint));
+
+		case SSHS_LONG:
+			return (std::to_string(value.ilong));
+
+		case SSHS_FLOAT:
+			floatValue = value.ffloat;
+			break;
+
+		case SSHS_DOUBLE:
+			floatValue = value.ddouble;
+			break;
+
+		default:
+			return (std::string());
+	}
+
+	if (std::isnan(floatValue)) {
+		return ("NaN");
+	}
+
+	if (std::isinf(floatValue)) {
+		return ((floatValue > 0) ? ("+Inf") : ("-Inf"));
+	}
+
+	return (boost::str(boost::format("%.17g") % floatValue));
+}
+
+// Statistics are the numeric attributes with a '<key>PollTime' companion,
+// their read modifiers compute the current value on each get.
+static void caerConfigCollectMetrics(sshsNode node, std::map<std::string, caerMetricFamily> &families) {
+	const std::string nodeLabel = caerConfigMetricEscape(sshsNodeGetPath(node), true);
+
+	size_t numKeys;
+	const char **attrKeys = sshsNodeGetAttributeKeys(node, &numKeys);
+
+	for (size_t i = 0; i < numKeys; i++) {
+		const std::string pollTimeKey = std::string(attrKeys[i]) + "PollTime";
+
+		if (!sshsNodeAttributeExists(node, pollTimeKey.c_str(), SSHS_INT)) {
+			continue;
+		}
+
+		size_t numTypes;
+		enum sshs_node_attr_value_type *attrTypes = sshsNodeGetAttributeTypes(node, attrKeys[i], &numTypes);
+
+		for (size_t j = 0; j < numTypes; j++) {
+			enum sshs_node_attr_value_type type = attrTypes[j];
+
+			// Attributes could be removed concurrently by modules.
+			if ((type == SSHS_STRING) || !sshsNodeAttributeExists(node, attrKeys[i], type)) {
+				continue;
+			}
+
+			const std::string value = caerConfigMetricValue(type, sshsNodeGetAttribute(node, attrKeys[i], type));
+
+			caerMetricFamily &family = families[caerConfigMetricName(attrKeys[i])];
+
+			if (family.help.empty()) {
+				char *description = sshsNodeGetAttributeDescription(node, attrKeys[i], type);
+				family.help       = caerConfigMetricEscape(description, false);
+				free(description);
+			}
+
+			family.samples.push_back("{node=\"" + nodeLabel + "\"} " + value);
+		}
+
+		free(attrTypes);
+	}
+
+	free(attrKeys);
 
-	response[0] = action;
-	response[1] = type;
-	setMsgLen(response, (uint16_t) msgLength);
-	memcpy(response + 4, msg, msgLength);
-	// Msg must already be NUL terminated!
+	size_t numChildren;
+	sshsNode *children = sshsNodeGetChildren(node, &numChildren);
 
-	client->writeResponse(responseLength);
+	for (size_t i = 0; i < numChildren; i++) {
+		caerConfigCollectMetrics(children[i], families);
+	}
 
-	logger::log(logger::logLevel::DEBUG, CONFIG_SERVER_NAME,
-		"Sent back message to client: action=%" PRIu8 ", type=%" PRIu8 ", msgLength=%zu.", action, type, msgLength);
+	free(children);
 }
 
-static inline bool checkNodeExists(sshs configStore, const char *node, std::shared_ptr<ConfigServerConnection> client) {
-	bool nodeExists = sshsExistsNode(configStore, node);
+// Render all statistics in the Prometheus text exposition format.
+static std::string caerConfigServerRenderMetrics(void) {
+	std::map<std::string, caerMetricFamily> families;
 
-	// Only allow operations on existing nodes, this is for remote
-	// control, so we only manipulate what's already there!
-	if (!nodeExists) {
-		// Send back error message to client.
-		caerConfigSendError(client, "Node doesn't exist. Operations are only allowed on existing data.");
+	{
+		std::shared_lock<std::shared_timed_mutex> lock(glConfigServerData.operationsSharedMutex);
+
+		caerConfigCollectMetrics(sshsGetNode(sshsGetGlobal(), "/"), families);
 	}
 
-	return (nodeExists);
-}
+	std::string metrics;
 
-static inline bool checkAttributeExists(sshsNode wantedNode, const char *key, enum sshs_node_attr_value_type type,
-	std::shared_ptr<ConfigServerConnection> client) {
-	// Check if attribute exists. Only allow operations on existing attributes!
-	bool attrExists = sshsNodeAttributeExists(wantedNode, key, type);
+	for (const auto &family : families) {
+		metrics.append("# HELP " + family.first + " " + family.second.help + "\n");
+		metrics.append("# TYPE " + family.first + " untyped\n");
 
-	if (!attrExists) {
-		// Send back error message to client.
-		caerConfigSendError(
-			client, "Attribute of given type doesn't exist. Operations are only allowed on existing data.");
+		for (const auto &sample : family.second.samples) {
+			metrics.append(family.first + sample + "\n");
+		}
 	}
 
-	return (attrExists);
-}
-
-static inline void caerConfigSendBoolResponse(
-	std::shared_ptr<ConfigServerConnection> client, uint8_t action, bool result) {
-	// Send back result to client. Format is the same as incoming data.
-	const uint8_t *sendResult = (const uint8_t *) ((result) ? ("true") : ("false"));
-	size_t sendResultLength   = (result) ? (5) : (6);
-	caerConfigSendResponse(client, action, SSHS_BOOL, sendResult, sendResultLength);
+	return (metrics);
 }
 
 static void caerConfigServerHandleRequest(std::shared_ptr<ConfigServerConnection> client, uint8_t action, uint8_t type,
@@ -422,7 +1485,9 @@ static void caerConfigServerHandleRequest(std::shared_ptr<ConfigServerConnection
 		}
 
 		case CAER_CONFIG_PUT: {
-			std::unique_lock<std::shared_timed_mutex> lock(glConfigServerData.operationsSharedMutex);
+			// SSHS puts are thread-safe, shared access is enough to keep the nodes
+			// from being removed meanwhile. Same for the other PUT requests.
+			std::shared_lock<std::shared_timed_mutex> lock(glConfigServerData.operationsSharedMutex);
 
 			if (!checkNodeExists(configStore, (const char *) node, client)) {
 				break;
@@ -439,25 +1504,334 @@ static void caerConfigServerHandleRequest(std::shared_ptr<ConfigServerConnection
 			const char *typeStr = sshsHelperTypeToStringConverter((enum sshs_node_attr_value_type) type);
 			if (!sshsNodeStringToAttributeConverter(wantedNode, (const char *) key, typeStr, (const char *) value)) {
 				// Send back correct error message to client.
-				if (errno == EINVAL) {
-					caerConfigSendError(client, "Impossible to convert value according to type.");
+				caerConfigSendError(client, caerConfigPutErrorMessage(errno));
+
+				break;
+			}
+
+			// Send back confirmation to the client.
+			caerConfigSendBoolResponse(client, CAER_CONFIG_PUT, true);
+
+			break;
+		}
+
+		case CAER_CONFIG_PUT_TRANSACTION: {
+			std::shared_lock<std::shared_timed_mutex> lock(glConfigServerData.operationsSharedMutex);
+
+			if (!checkNodeExists(configStore, (const char *) node, client)) {
+				break;
+			}
+
+			// This cannot fail, since we know the node exists from above.
+			sshsNode wantedNode = sshsGetNode(configStore, (const char *) node);
+
+			// Split VALUE into its NUL terminated parts, three per attribute.
+			std::vector<const char *> parts = caerConfigSplitParts(value, valueLength);
+
+			if (parts.empty() || ((parts.size() % 3) != 0)) {
+				caerConfigSendError(client, "Transaction must contain key, type and value for each attribute.");
+				break;
+			}
+
+			sshsNodeTransaction transaction = sshsNodeTransactionBegin(wantedNode);
+
+			bool converted = true;
+
+			for (size_t i = 0; i < parts.size(); i += 3) {
+				if (!sshsNodeTransactionPutFromString(transaction, parts[i], parts[i + 1], parts[i + 2])) {
+					converted = false;
+					break;
 				}
-				else if (errno == EPERM) {
-					caerConfigSendError(client, "Cannot write to a read-only attribute.");
+			}
+
+			if (!converted) {
+				sshsNodeTransactionAbort(transaction);
+
+				caerConfigSendError(client, caerConfigPutErrorMessage(EINVAL));
+				break;
+			}
+
+			if (!sshsNodeTransactionCommit(transaction)) {
+				// Send back correct error message to client. Nothing was changed.
+				caerConfigSendError(client, caerConfigPutErrorMessage(errno));
+				break;
+			}
+
+			// Send back confirmation to the client.
+			caerConfigSendBoolResponse(client, CAER_CONFIG_PUT_TRANSACTION, true);
+
+			break;
+		}
+
+		case CAER_CONFIG_GET_MULTI: {
+			std::shared_lock<std::shared_timed_mutex> lock(glConfigServerData.operationsSharedMutex);
+
+			// Split VALUE into its NUL terminated parts, three per attribute.
+			std::vector<const char *> parts = caerConfigSplitParts(value, valueLength);
+
+			if (parts.empty() || ((parts.size() % 3) != 0)) {
+				caerConfigSendError(client, "Request must contain node, key and type for each attribute.");
+				break;
+			}
+
+			// Pack as many values as fit into each message, like a subtree dump.
+			auto responses = std::make_shared<std::vector<uint8_t>>();
+			std::string msg;
+			bool success = true;
+
+			for (size_t i = 0; i < parts.size(); i += 3) {
+				if (!checkNodeExists(configStore, parts[i], client)) {
+					success = false;
+					break;
 				}
-				else if (errno == ERANGE) {
-					caerConfigSendError(client, "Value out of attribute range.");
+
+				// This cannot fail, since we know the node exists from above.
+				sshsNode wantedNode = sshsGetNode(configStore, parts[i]);
+
+				enum sshs_node_attr_value_type attrType = sshsHelperStringToTypeConverter(parts[i + 2]);
+
+				if (!checkAttributeExists(wantedNode, parts[i + 1], attrType, client)) {
+					success = false;
+					break;
 				}
-				else {
-					// Unknown error.
-					caerConfigSendError(client, "Unknown error.");
+
+				union sshs_node_attr_value result = sshsNodeGetAttribute(wantedNode, parts[i + 1], attrType);
+
+				char *resultStr = sshsHelperValueToStringConverter(attrType, result);
+
+				// If this is a string, we must remember to free the original result.str
+				// too, since it will also be a copy of the string coming from SSHS.
+				if (attrType == SSHS_STRING) {
+					free(result.string);
 				}
 
+				if (resultStr == NULL) {
+					caerConfigSendError(client, "Failed to allocate memory for value string.");
+					success = false;
+					break;
+				}
+
+				// Values are never split across messages.
+				const size_t valueLength = strlen(resultStr) + 1;
+
+				if (valueLength > (CAER_CONFIG_SERVER_BUFFER_SIZE - 4)) {
+					free(resultStr);
+
+					const boost::format errorMsg
+						= boost::format("Value of attribute '%s' too large for a response.") % parts[i + 1];
+
+					caerConfigSendError(client, errorMsg.str().c_str());
+					success = false;
+					break;
+				}
+
+				if ((msg.length() + valueLength) > (CAER_CONFIG_SERVER_BUFFER_SIZE - 4)) {
+					caerConfigAppendResponse(
+						*responses, CAER_CONFIG_GET_MULTI, SSHS_STRING, (const uint8_t *) msg.data(), msg.length());
+					msg.clear();
+				}
+
+				msg.append(resultStr, valueLength);
+
+				free(resultStr);
+			}
+
+			if (success) {
+				caerConfigAppendResponse(
+					*responses, CAER_CONFIG_GET_MULTI, SSHS_STRING, (const uint8_t *) msg.data(), msg.length());
+
+				// Final message marks the end of the values.
+				caerConfigAppendResponse(
+					*responses, CAER_CONFIG_GET_MULTI, SSHS_BOOL, (const uint8_t *) "true", strlen("true") + 1);
+
+				client->writeResponses(responses);
+			}
+
+			break;
+		}
+
+		case CAER_CONFIG_PUT_MULTI: {
+			std::shared_lock<std::shared_timed_mutex> lock(glConfigServerData.operationsSharedMutex);
+
+			// Split VALUE into its NUL terminated parts, four per attribute.
+			std::vector<const char *> parts = caerConfigSplitParts(value, valueLength);
+
+			if (parts.empty() || ((parts.size() % 4) != 0)) {
+				caerConfigSendError(client, "Request must contain node, key, type and value for each attribute.");
 				break;
 			}
 
-			// Send back confirmation to the client.
-			caerConfigSendBoolResponse(client, CAER_CONFIG_PUT, true);
+			// Group attributes by node, in order of first appearance. All nodes
+			// must exist and all values must convert before anything is put.
+			std::vector<std::pair<std::string, sshsNodeTransaction>> transactions;
+			bool converted = true;
+
+			for (size_t i = 0; i < parts.size(); i += 4) {
+				if (!checkNodeExists(configStore, parts[i], client)) {
+					converted = false;
+					break;
+				}
+
+				auto transaction = std::find_if(transactions.begin(), transactions.end(),
+					[&parts, i](const std::pair<std::string, sshsNodeTransaction> &t) { return (t.first == parts[i]); });
+
+				if (transaction == transactions.end()) {
+					// This cannot fail, since we know the node exists from above.
+					transactions.emplace_back(
+						parts[i], sshsNodeTransactionBegin(sshsGetNode(configStore, parts[i])));
+					transaction = transactions.end() - 1;
+				}
+
+				if (!sshsNodeTransactionPutFromString(transaction->second, parts[i + 1], parts[i + 2], parts[i + 3])) {
+					caerConfigSendError(client, caerConfigPutErrorMessage(EINVAL));
+					converted = false;
+					break;
+				}
+			}
+
+			if (!converted) {
+				for (const auto &t : transactions) {
+					sshsNodeTransactionAbort(t.second);
+				}
+
+				break;
+			}
+
+			bool success = true;
+
+			for (const auto &t : transactions) {
+				if (!success) {
+					sshsNodeTransactionAbort(t.second);
+					continue;
+				}
+
+				if (!sshsNodeTransactionCommit(t.second)) {
+					const boost::format errorMsg = boost::format("Failed to put attributes of node '%s': %s")
+												   % t.first % caerConfigPutErrorMessage(errno);
+
+					caerConfigSendError(client, errorMsg.str().c_str());
+					success = false;
+				}
+			}
+
+			if (success) {
+				// Send back confirmation to the client.
+				caerConfigSendBoolResponse(client, CAER_CONFIG_PUT_MULTI, true);
+			}
+
+			break;
+		}
+
+		case CAER_CONFIG_DUMP_SUBTREE: {
+			std::shared_lock<std::shared_timed_mutex> lock(glConfigServerData.operationsSharedMutex);
+
+			if (!checkNodeExists(configStore, (const char *) node, client)) {
+				break;
+			}
+
+			// This cannot fail, since we know the node exists from above.
+			sshsNode wantedNode = sshsGetNode(configStore, (const char *) node);
+
+			std::vector<std::string> records;
+			caerConfigDumpNode(wantedNode, records);
+
+			// Pack as many records as fit into each message.
+			auto responses = std::make_shared<std::vector<uint8_t>>();
+			std::string msg;
+
+			for (const auto &record : records) {
+				if ((msg.length() + record.length()) > (CAER_CONFIG_SERVER_BUFFER_SIZE - 4)) {
+					if (!msg.empty()) {
+						caerConfigAppendResponse(*responses, CAER_CONFIG_DUMP_SUBTREE, SSHS_STRING,
+							(const uint8_t *) msg.data(), msg.length());
+						msg.clear();
+					}
+
+					if (record.length() > (CAER_CONFIG_SERVER_BUFFER_SIZE - 4)) {
+						const char *recordKey = record.c_str() + record.find('\0') + 1;
+
+						logger::log(logger::logLevel::WARNING, CONFIG_SERVER_NAME,
+							"Attribute '%s' too large for subtree dump, skipped.", recordKey);
+						continue;
+					}
+				}
+
+				msg.append(record);
+			}
+
+			if (!msg.empty()) {
+				caerConfigAppendResponse(
+					*responses, CAER_CONFIG_DUMP_SUBTREE, SSHS_STRING, (const uint8_t *) msg.data(), msg.length());
+			}
+
+			// Final message marks the end of the dump.
+			caerConfigAppendResponse(
+				*responses, CAER_CONFIG_DUMP_SUBTREE, SSHS_BOOL, (const uint8_t *) "true", strlen("true") + 1);
+
+			client->writeResponses(responses);
+
+			logger::log(logger::logLevel::DEBUG, CONFIG_SERVER_NAME,
+				"Sent back subtree dump to client: %zu attributes, %zu bytes.", records.size(), responses->size());
+
+			break;
+		}
+
+		case CAER_CONFIG_SUBSCRIBE: {
+			std::shared_lock<std::shared_timed_mutex> lock(glConfigServerData.operationsSharedMutex);
+
+			if (!checkNodeExists(configStore, (const char *) node, client)) {
+				break;
+			}
+
+			// This cannot fail, since we know the node exists from above.
+			sshsNode wantedNode = sshsGetNode(configStore, (const char *) node);
+
+			// Optional key to subscribe to a single attribute.
+			const std::string subscribeKey = (keyLength == 0) ? ("") : ((const char *) key);
+
+			if (!subscribeKey.empty()
+				&& !checkAttributeExists(
+					   wantedNode, subscribeKey.c_str(), (enum sshs_node_attr_value_type) type, client)) {
+				break;
+			}
+
+			// Optional minimum interval between notifications, in milliseconds.
+			long minInterval = CAER_CONFIG_SERVER_PUSH_INTERVAL;
+
+			if (valueLength != 0) {
+				char *endPtr = nullptr;
+				minInterval  = strtol((const char *) value, &endPtr, 10);
+
+				if ((endPtr == (const char *) value) || (*endPtr != '\0') || (minInterval < 0)) {
+					caerConfigSendError(client, "Invalid minimum notification interval.");
+					break;
+				}
+			}
+
+			auto subscription = std::make_shared<ConfigServerSubscription>(
+				client, wantedNode, subscribeKey, std::chrono::milliseconds(minInterval));
+
+			// Confirm first, so that the client gets the response before
+			// the notifications with the current values.
+			caerConfigSendBoolResponse(client, CAER_CONFIG_SUBSCRIBE, true);
+
+			if (!client->addSubscription(subscription)) {
+				logger::log(logger::logLevel::DEBUG, CONFIG_SERVER_NAME, "Already subscribed to '%s' '%s'.",
+					(const char *) node, subscribeKey.c_str());
+			}
+
+			break;
+		}
+
+		case CAER_CONFIG_UNSUBSCRIBE: {
+			const std::string subscribeKey = (keyLength == 0) ? ("") : ((const char *) key);
+
+			if ((node == nullptr) || !client->removeSubscription((const char *) node, subscribeKey)) {
+				caerConfigSendError(client, "No such subscription.");
+				break;
+			}
+
+			caerConfigSendBoolResponse(client, CAER_CONFIG_UNSUBSCRIBE, true);
 
 			break;
 		}
@@ -625,62 +1999,13 @@ static void caerConfigServerHandleRequest(std::shared_ptr<ConfigServerConnection
 
 			// We need to return a string with the two ranges,
 			// separated by a NUL character.
-			char buf[256];
-			size_t bufLen = 0;
-
-			switch (type) {
-				case SSHS_BOOL:
-				case SSHS_BYTE:
-					bufLen += snprintf(buf + bufLen, 256 - bufLen, "%" PRIi8, ranges.min.ibyteRange)
-							  + 1; // Terminating NUL byte.
-					bufLen += snprintf(buf + bufLen, 256 - bufLen, "%" PRIi8, ranges.max.ibyteRange)
-							  + 1; // Terminating NUL byte.
-					break;
-
-				case SSHS_SHORT:
-					bufLen += snprintf(buf + bufLen, 256 - bufLen, "%" PRIi16, ranges.min.ishortRange)
-							  + 1; // Terminating NUL byte.
-					bufLen += snprintf(buf + bufLen, 256 - bufLen, "%" PRIi16, ranges.max.ishortRange)
-							  + 1; // Terminating NUL byte.
-					break;
-
-				case SSHS_INT:
-					bufLen += snprintf(buf + bufLen, 256 - bufLen, "%" PRIi32, ranges.min.iintRange)
-							  + 1; // Terminating NUL byte.
-					bufLen += snprintf(buf + bufLen, 256 - bufLen, "%" PRIi32, ranges.max.iintRange)
-							  + 1; // Terminating NUL byte.
-					break;
-
-				case SSHS_LONG:
-					bufLen += snprintf(buf + bufLen, 256 - bufLen, "%" PRIi64, ranges.min.ilongRange)
-							  + 1; // Terminating NUL byte.
-					bufLen += snprintf(buf + bufLen, 256 - bufLen, "%" PRIi64, ranges.max.ilongRange)
-							  + 1; // Terminating NUL byte.
-					break;
+			std::string rangesStr = caerConfigRangeToString((enum sshs_node_attr_value_type) type, ranges.min);
+			rangesStr.push_back('\0');
+			rangesStr.append(caerConfigRangeToString((enum sshs_node_attr_value_type) type, ranges.max));
+			rangesStr.push_back('\0');
 
-				case SSHS_FLOAT:
-					bufLen += snprintf(buf + bufLen, 256 - bufLen, "%g", (double) ranges.min.ffloatRange)
-							  + 1; // Terminating NUL byte.
-					bufLen += snprintf(buf + bufLen, 256 - bufLen, "%g", (double) ranges.max.ffloatRange)
-							  + 1; // Terminating NUL byte.
-					break;
-
-				case SSHS_DOUBLE:
-					bufLen += snprintf(buf + bufLen, 256 - bufLen, "%g", ranges.min.ddoubleRange)
-							  + 1; // Terminating NUL byte.
-					bufLen += snprintf(buf + bufLen, 256 - bufLen, "%g", ranges.max.ddoubleRange)
-							  + 1; // Terminating NUL byte.
-					break;
-
-				case SSHS_STRING:
-					bufLen += snprintf(buf + bufLen, 256 - bufLen, "%zu", ranges.min.stringRange)
-							  + 1; // Terminating NUL byte.
-					bufLen += snprintf(buf + bufLen, 256 - bufLen, "%zu", ranges.max.stringRange)
-							  + 1; // Terminating NUL byte.
-					break;
-			}
-
-			caerConfigSendResponse(client, CAER_CONFIG_GET_RANGES, type, (const uint8_t *) buf, bufLen);
+			caerConfigSendResponse(client, CAER_CONFIG_GET_RANGES, type, (const uint8_t *) rangesStr.data(),
+				rangesStr.length());
 
 			break;
 		}
@@ -702,21 +2027,7 @@ static void caerConfigServerHandleRequest(std::shared_ptr<ConfigServerConnection
 			int flags
 				= sshsNodeGetAttributeFlags(wantedNode, (const char *) key, (enum sshs_node_attr_value_type) type);
 
-			std::string flagsStr;
-
-			if (flags & SSHS_FLAGS_READ_ONLY) {
-				flagsStr = "READ_ONLY";
-			}
-			else if (flags & SSHS_FLAGS_NOTIFY_ONLY) {
-				flagsStr = "NOTIFY_ONLY";
-			}
-			else {
-				flagsStr = "NORMAL";
-			}
-
-			if (flags & SSHS_FLAGS_NO_EXPORT) {
-				flagsStr += ",NO_EXPORT";
-			}
+			std::string flagsStr = caerConfigFlagsToString(flags);
 
 			caerConfigSendResponse(
 				client, CAER_CONFIG_GET_FLAGS, SSHS_STRING, (const uint8_t *) flagsStr.c_str(), flagsStr.length() + 1);
@@ -750,8 +2061,6 @@ static void caerConfigServerHandleRequest(std::shared_ptr<ConfigServerConnection
 		}
 
 		case CAER_CONFIG_ADD_MODULE: {
-			std::unique_lock<std::shared_timed_mutex> lock(glConfigServerData.operationsSharedMutex);
-
 			// Node is the module name, key the library.
 			const std::string moduleName((const char *) node);
 			const std::string moduleLibrary((const char *) key);
@@ -769,11 +2078,6 @@ static void caerConfigServerHandleRequest(std::shared_ptr<ConfigServerConnection
 				break;
 			}
 
-			if (sshsExistsNode(configStore, "/" + moduleName + "/")) {
-				caerConfigSendError(client, "Name is already in use.");
-				break;
-			}
-
 			// Check module library.
 			sshsNode modulesSysNode              = sshsGetNode(configStore, "/caer/modules/");
 			const std::string modulesListOptions = sshsNodeGetStdString(modulesSysNode, "modulesListOptions");
@@ -786,6 +2090,15 @@ static void caerConfigServerHandleRequest(std::shared_ptr<ConfigServerConnection
 				break;
 			}
 
+			// Name check, ID assignment and node creation need exclusive access,
+			// so that concurrent ADD_MODULE requests never get the same name or ID.
+			std::unique_lock<std::shared_timed_mutex> lock(glConfigServerData.operationsSharedMutex);
+
+			if (sshsExistsNode(configStore, "/" + moduleName + "/")) {
+				caerConfigSendError(client, "Name is already in use.");
+				break;
+			}
+
 			// Name and library are fine, let's determine the next free ID.
 			size_t rootNodesSize;
 			sshsNode *rootNodes = sshsNodeGetChildren(sshsGetNode(configStore, "/"), &rootNodesSize);
@@ -850,7 +2163,20 @@ static void caerConfigServerHandleRequest(std::shared_ptr<ConfigServerConnection
 			}
 
 			// Create static module configuration, so users can start
-			// changing it right away after module add.
+			// changing it right away after module add. This loads the module
+			// library, which is slow, so only keep shared access while doing it.
+			// REMOVE_MODULE could run in between, so look the node up again.
+			lock.unlock();
+
+			std::shared_lock<std::shared_timed_mutex> configLock(glConfigServerData.operationsSharedMutex);
+
+			if (!sshsExistsNode(configStore, "/" + moduleName + "/")) {
+				caerConfigSendError(client, "Module was removed while being added.");
+				break;
+			}
+
+			newModuleNode = sshsGetNode(configStore, "/" + moduleName + "/");
+
 			caerModuleConfigInit(newModuleNode);
 
 			// Send back confirmation to the client.
@@ -860,8 +2186,6 @@ static void caerConfigServerHandleRequest(std::shared_ptr<ConfigServerConnection
 		}
 
 		case CAER_CONFIG_REMOVE_MODULE: {
-			std::unique_lock<std::shared_timed_mutex> lock(glConfigServerData.operationsSharedMutex);
-
 			// Node is the module name.
 			const std::string moduleName((const char *) node);
 
@@ -871,6 +2195,10 @@ static void caerConfigServerHandleRequest(std::shared_ptr<ConfigServerConnection
 				break;
 			}
 
+			// Removing nodes needs exclusive access, all other requests may hold
+			// pointers to them.
+			std::unique_lock<std::shared_timed_mutex> lock(glConfigServerData.operationsSharedMutex);
+
 			if (!sshsExistsNode(configStore, "/" + moduleName + "/")) {
 				caerConfigSendError(client, "Name is not in use.");
 				break;
@@ -884,6 +2212,9 @@ static void caerConfigServerHandleRequest(std::shared_ptr<ConfigServerConnection
 				break;
 			}
 
+			// Subscriptions must not outlive their nodes.
+			caerConfigServerStopSubscriptions("/" + moduleName + "/");
+
 			// Truly delete the node and all its children.
 			sshsNodeRemoveNode(sshsGetNode(configStore, "/" + moduleName + "/"));
 
@@ -17,6 +17,10 @@ extern "C" {
 #define CAER_CONFIG_SERVER_BUFFER_SIZE 4096
 #define CAER_CONFIG_SERVER_HEADER_SIZE 10
 
+// Requests can be pipelined, but the server stops reading new ones while
+// this many responses are still waiting to be sent to a client.
+#define CAER_CONFIG_SERVER_MAX_QUEUED_WRITES 64
+
 enum caer_config_actions {
 	CAER_CONFIG_NODE_EXISTS     = 0,
 	CAER_CONFIG_ATTR_EXISTS     = 1,
@@ -31,8 +35,60 @@ enum caer_config_actions {
 	CAER_CONFIG_GET_DESCRIPTION = 10,
 	CAER_CONFIG_ADD_MODULE      = 11,
 	CAER_CONFIG_REMOVE_MODULE   = 12,
+	CAER_CONFIG_PUT_TRANSACTION = 13,
+	CAER_CONFIG_GET_MULTI       = 14,
+	CAER_CONFIG_PUT_MULTI       = 15,
+	CAER_CONFIG_DUMP_SUBTREE    = 16,
+	CAER_CONFIG_SUBSCRIBE       = 17,
+	CAER_CONFIG_UNSUBSCRIBE     = 18,
+	CAER_CONFIG_PUSH            = 19,
+	CAER_CONFIG_PUSH_END        = 20,
 };
 
+// CAER_CONFIG_PUT_TRANSACTION puts several attributes of NODE atomically:
+// either all are changed or none. VALUE holds one or more 'key', 'type',
+// 'value' triples, each part NUL terminated (key\0type\0value\0...).
+// TYPE and KEY are not used.
+//
+// CAER_CONFIG_GET_MULTI gets many attributes in one round trip. VALUE holds
+// 'node', 'key', 'type' triples. The response is a series of messages of type
+// STRING, each holding one or more NUL terminated value strings, one per
+// triple and in the same order, never split across messages. The last message
+// is a BOOL 'true' response. On error, a single ERROR response is sent.
+//
+// CAER_CONFIG_PUT_MULTI puts many attributes in one round trip. VALUE holds
+// 'node', 'key', 'type', 'value' quadruples. Attributes of the same node are
+// put atomically, like CAER_CONFIG_PUT_TRANSACTION, nodes one after the other
+// in order of appearance. On error, nodes before the failing one are changed.
+//
+// Requests, unlike responses, are always a single message, so a GET_MULTI or
+// PUT_MULTI request can name at most as many attributes as fit into VALUE
+// (about 80 with typical node paths). Clients must split larger sets across
+// several requests; PUT_MULTI is then only atomic within each request.
+//
+// CAER_CONFIG_DUMP_SUBTREE returns all attributes of NODE and its children.
+// The response is a series of messages of type STRING, each holding one or
+// more records of seven NUL terminated parts: 'node', 'key', 'type', 'flags',
+// 'min', 'max', 'value'. The last message is a BOOL 'true' response.
+// TYPE and KEY are not used.
+//
+// CAER_CONFIG_SUBSCRIBE asks the server to push changes of all attributes of
+// NODE, or only of KEY (of type TYPE) if given. VALUE optionally sets the
+// minimum interval between notifications in milliseconds, as a decimal
+// string (default CAER_CONFIG_SERVER_PUSH_INTERVAL). Changes in between are
+// coalesced to the latest value. CAER_CONFIG_UNSUBSCRIBE takes the same NODE
+// and KEY to cancel a subscription.
+// Notifications are sent as CAER_CONFIG_PUSH messages of type STRING, at any
+// time between responses, starting with the current values right after the
+// subscription is confirmed. Each holds one or more records of four NUL
+// terminated parts: 'node', 'key', 'type', 'value'.
+// A subscription whose node is removed ends on its own. The server then sends
+// one CAER_CONFIG_PUSH_END message of type STRING, holding the NUL terminated
+// 'node' and 'key' (empty for the whole node) it was created with. Attributes
+// that are removed and created again, like when a module restarts, don't end
+// a subscription, their new values are pushed as usual.
+#define CAER_CONFIG_SERVER_PUSH_INTERVAL 100
+
 void caerConfigServerStart(void);
 void caerConfigServerStop(void);
 
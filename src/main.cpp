@@ -12,6 +12,9 @@ int main(int argc, char **argv) {
 	// Initialize logging sub-system.
 	caerLogInit();
 
+	// Start background configuration write-back.
+	caerConfigWriteBackStart();
+
 	// TODO: implement service mode, use boost::process.
 
 	// Start the configuration server thread for run-time config changes.
@@ -24,5 +27,8 @@ int main(int argc, char **argv) {
 	// thread if needed.
 	caerConfigServerStop();
 
+	// Write back any configuration changes still pending.
+	caerConfigWriteBackStop();
+
 	return (EXIT_SUCCESS);
 }
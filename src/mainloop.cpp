@@ -61,6 +61,8 @@ static void caerUpdateModulesInformationListener(sshsNode node, void *userData,
 	const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue);
 static void caerWriteConfigurationListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
 	const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue);
+static void caerMainloopSetListenerDispatchMode();
+static void caerMainloopDispatchListeners();
 
 void caerMainloopRun(void) {
 	// Setup internal mainloop pointer for public support library.
@@ -179,6 +181,13 @@ void caerMainloopRun(void) {
 		systemNode, "running", true, SSHS_FLAGS_NORMAL | SSHS_FLAGS_NO_EXPORT, "Global system start/stop.");
 	sshsNodeAddAttributeListener(systemNode, nullptr, &caerMainloopSystemRunningListener);
 
+	sshsNodeCreate(systemNode, "listenerDispatchMode", "synchronous", 6, 11, SSHS_FLAGS_NORMAL,
+		"How configuration change listeners are called: synchronous (inside the change), thread (deferred to a "
+		"dedicated thread) or mainloop (deferred to the start of each mainloop iteration). Applied on mainloop "
+		"start.");
+	sshsNodeCreateAttributeListOptions(
+		systemNode, "listenerDispatchMode", SSHS_STRING, "synchronous,thread,mainloop", false);
+
 	// Mainloop running control.
 	glMainloopData.running.store(true);
 
@@ -188,6 +197,9 @@ void caerMainloopRun(void) {
 	sshsNodeAddAttributeListener(glMainloopData.configNode, nullptr, &caerMainloopRunningListener);
 
 	while (glMainloopData.systemRunning.load()) {
+		// Deferred listeners also control the running flags, so deliver them here too.
+		caerMainloopDispatchListeners();
+
 		if (!glMainloopData.running.load()) {
 			std::this_thread::sleep_for(std::chrono::seconds(1));
 			continue;
@@ -218,6 +230,9 @@ void caerMainloopRun(void) {
 		}
 	}
 
+	// Back to synchronous listeners, this delivers anything still queued.
+	sshsSetListenerDispatchMode(sshsGetGlobal(), SSHS_DISPATCH_SYNCHRONOUS);
+
 	// Remove attribute listeners for clean shutdown.
 	sshsNodeRemoveAttributeListener(glMainloopData.configNode, nullptr, &caerMainloopRunningListener);
 	sshsNodeRemoveAttributeListener(systemNode, nullptr, &caerMainloopSystemRunningListener);
@@ -1212,6 +1227,18 @@ static size_t getMaximumInputNumber() {
 	return (maxSize);
 }
 
+static bool moduleInputIsReadOnly(const ModuleInfo &m, int16_t typeId) {
+	for (size_t i = 0; i < m.libraryInfo->inputStreamsSize; i++) {
+		caerEventStreamIn inputStream = &m.libraryInfo->inputStreams[i];
+
+		if ((inputStream->type == -1 || inputStream->type == typeId) && !inputStream->readOnly) {
+			return (false);
+		}
+	}
+
+	return (true);
+}
+
 static void runModules(caerEventPacketContainer in) {
 	// Run through all modules in order.
 	for (const auto &m : glMainloopData.globalExecution) {
@@ -1231,7 +1258,21 @@ static void runModules(caerEventPacketContainer in) {
 			for (const auto &input : m.get().inputs) {
 				if (input.second == -1) {
 					// No copy needed.
-					in->eventPackets[inputsToPass] = glMainloopData.eventPackets[static_cast<size_t>(input.first)];
+					caerEventPacketHeader packet = glMainloopData.eventPackets[static_cast<size_t>(input.first)];
+
+					// Unless an output still holds a reference to this packet and this
+					// module modifies its inputs: then it gets its own private copy.
+					if ((packet != nullptr) && !moduleInputIsReadOnly(m.get(), caerEventPacketHeaderGetEventType(packet))
+						&& caerMainloopPacketIsShared(packet)) {
+						caerEventPacketHeader packetCopy = caerEventPacketCopyOnlyEvents(packet);
+
+						caerMainloopPacketRelease(packet);
+
+						packet                                                        = packetCopy;
+						glMainloopData.eventPackets[static_cast<size_t>(input.first)] = packetCopy;
+					}
+
+					in->eventPackets[inputsToPass] = packet;
 				}
 				else {
 					// Copy is needed. Do it and update the global event packet storage.
@@ -1274,9 +1315,19 @@ static void runModules(caerEventPacketContainer in) {
 			m.get().runtimeData, CAER_LOG_DEBUG, "Module Output: expecting %zu packets back out.", outputsExpectedBack);
 
 		// Run module state machine.
-		caerEventPacketContainer out = nullptr;
-		caerModuleSM(m.get().libraryInfo->functions, m.get().runtimeData, m.get().libraryInfo->memSize,
-			(inputsToPass > 0) ? (in) : (nullptr), (outputsExpectedBack > 0) ? (&out) : (nullptr));
+		caerEventPacketContainer out      = nullptr;
+		caerEventPacketContainer moduleIn = (inputsToPass > 0) ? (in) : (nullptr);
+
+		const auto runStart = std::chrono::steady_clock::now();
+
+		caerModuleSM(m.get().libraryInfo->functions, m.get().runtimeData, m.get().libraryInfo->memSize, moduleIn,
+			(outputsExpectedBack > 0) ? (&out) : (nullptr));
+
+		const auto runTime = std::chrono::steady_clock::now() - runStart;
+
+		// Output packets may be freed below, so account for them now.
+		caerModuleStatisticsUpdate(m.get().statistics.get(), moduleIn, out,
+			static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(runTime).count()));
 
 		// Parse possible output container.
 		if (out != nullptr) {
@@ -1342,9 +1393,10 @@ static void runModules(caerEventPacketContainer in) {
 	}
 
 	// To finish a run, clean up all the leftover packet memory.
+	// Packets retained by modules are only freed once they release them.
 	for (auto &p : glMainloopData.eventPackets) {
 		if (p != nullptr) {
-			free(p);
+			caerMainloopPacketRelease(p);
 			p = nullptr;
 		}
 	}
@@ -1352,6 +1404,10 @@ static void runModules(caerEventPacketContainer in) {
 
 static void cleanupGlobals() {
 	for (auto &m : glMainloopData.modules) {
+		if (m.second.statistics) {
+			caerModuleStatisticsExit(m.second.configNode);
+		}
+
 		if (m.second.libraryInfo != nullptr) {
 			caerUnloadModuleLibrary(m.second.libraryHandle);
 		}
@@ -1364,7 +1420,7 @@ static void cleanupGlobals() {
 	glMainloopData.copyCount = 0;
 
 	std::for_each(glMainloopData.eventPackets.begin(), glMainloopData.eventPackets.end(),
-		[](caerEventPacketHeader p) { free(p); });
+		[](caerEventPacketHeader p) { caerMainloopPacketRelease(p); });
 	glMainloopData.eventPackets.clear();
 }
 
@@ -1742,6 +1798,9 @@ static int caerMainloopRunner() {
 		}
 
 		m.get().runtimeData = runData;
+
+		m.get().statistics = std::make_shared<ModuleStatistics>();
+		caerModuleStatisticsInit(m.get().configNode, m.get().statistics.get());
 	}
 
 	// Allocate only one packet container to be re-used over all runModules() calls.
@@ -1760,6 +1819,8 @@ static int caerMainloopRunner() {
 
 	log(logLevel::INFO, "Mainloop", "Started successfully.");
 
+	caerMainloopSetListenerDispatchMode();
+
 	// Run modules once right away to give possibility of initializing and
 	// getting some initial data (dataAvailable > 0).
 	runModules(inputContainer);
@@ -1773,6 +1834,10 @@ static int caerMainloopRunner() {
 	size_t sleepCount = 0;
 
 	while (glMainloopData.running.load(std::memory_order_relaxed)) {
+		// Deliver queued configuration changes before modules run, so they
+		// see them in this iteration (listenerDispatchMode 'mainloop').
+		caerMainloopDispatchListeners();
+
 		// Run only if data available to consume, else sleep. But make a run
 		// anyway each second, to detect new devices for example.
 		if (glMainloopData.dataAvailable.load(std::memory_order_acquire) > 0 || sleepCount > 1000) {
@@ -1793,6 +1858,9 @@ static int caerMainloopRunner() {
 		sshsNodePut(m.get().configNode, "running", false);
 	}
 
+	// Modules must see the change before the last run, whatever the dispatch mode.
+	sshsDispatchListenerNotifications(sshsGetGlobal());
+
 	// Run through the loop one last time to correctly shutdown all the modules.
 	runModules(inputContainer);
 
@@ -1814,6 +1882,32 @@ static int caerMainloopRunner() {
 	return (EXIT_SUCCESS);
 }
 
+static void caerMainloopSetListenerDispatchMode() {
+	const std::string dispatchMode
+		= sshsNodeGetStdString(sshsGetNode(sshsGetGlobal(), "/caer/"), "listenerDispatchMode");
+
+	if (dispatchMode == "thread") {
+		sshsSetListenerDispatchMode(sshsGetGlobal(), SSHS_DISPATCH_THREAD);
+	}
+	else if (dispatchMode == "mainloop") {
+		sshsSetListenerDispatchMode(sshsGetGlobal(), SSHS_DISPATCH_MANUAL);
+	}
+	else {
+		sshsSetListenerDispatchMode(sshsGetGlobal(), SSHS_DISPATCH_SYNCHRONOUS);
+	}
+
+	log(logLevel::DEBUG, "Mainloop", "Configuration listener dispatch mode: %s.", dispatchMode.c_str());
+}
+
+// Only in 'mainloop' mode is delivery up to the mainloop. In 'thread' mode
+// the dispatch thread does it, and dispatching here too would make the
+// mainloop wait behind slow listeners, or run them itself.
+static void caerMainloopDispatchListeners() {
+	if (sshsGetListenerDispatchMode(sshsGetGlobal()) == SSHS_DISPATCH_MANUAL) {
+		sshsDispatchListenerNotifications(sshsGetGlobal());
+	}
+}
+
 static void printDebugInformation() {
 	// Debug output.
 	for (const auto &st : glMainloopData.streams) {
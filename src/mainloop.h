@@ -7,6 +7,7 @@
 
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -63,13 +64,29 @@ struct ModuleInfo {
 	caerModuleInfo libraryInfo;
 	// Module runtime data.
 	caerModuleData runtimeData;
+	// Execution statistics, shared with the SSHS read modifiers.
+	std::shared_ptr<ModuleStatistics> statistics;
 
 	ModuleInfo()
-		: id(-1), name(), configNode(nullptr), library(), libraryHandle(), libraryInfo(nullptr), runtimeData(nullptr) {
+		: id(-1),
+		  name(),
+		  configNode(nullptr),
+		  library(),
+		  libraryHandle(),
+		  libraryInfo(nullptr),
+		  runtimeData(nullptr),
+		  statistics() {
 	}
 
 	ModuleInfo(int16_t i, const std::string &n, sshsNode c, const std::string &l)
-		: id(i), name(n), configNode(c), library(l), libraryHandle(), libraryInfo(nullptr), runtimeData(nullptr) {
+		: id(i),
+		  name(n),
+		  configNode(c),
+		  library(l),
+		  libraryHandle(),
+		  libraryInfo(nullptr),
+		  runtimeData(nullptr),
+		  statistics() {
 	}
 };
 
@@ -164,6 +181,9 @@ struct MainloopData {
 	std::vector<ActiveStreams> streams;
 	std::vector<std::reference_wrapper<ModuleInfo>> globalExecution;
 	std::vector<caerEventPacketHeader> eventPackets;
+	// Event packets retained past the end of a run, with their reference count.
+	std::mutex retainedPacketsLock;
+	std::unordered_map<const void *, size_t> retainedPackets;
 };
 
 #ifdef __cplusplus
@@ -180,6 +200,12 @@ void caerMainloopRun(void);
  */
 void caerMainloopSDKLibInit(MainloopData *setMainloopPtr);
 
+/**
+ * Only for internal usage! True if somebody other than the mainloop
+ * holds a reference to the given event packet.
+ */
+bool caerMainloopPacketIsShared(caerEventPacketHeaderConst packet);
+
 #ifdef __cplusplus
 }
 #endif
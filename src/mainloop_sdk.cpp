@@ -229,3 +229,66 @@ sshsNode caerMainloopGetSourceInfo(int16_t sourceID) {
 
 	return (sshsGetRelativeNode(moduleData->moduleNode, "sourceInfo/"));
 }
+
+caerEventPacketHeaderConst caerMainloopPacketRetain(caerEventPacketHeaderConst packet) {
+	if (packet == nullptr) {
+		return (nullptr);
+	}
+
+	std::lock_guard<std::mutex> lock(glMainloopDataPtr->retainedPacketsLock);
+
+	try {
+		// First retain accounts for the mainloop's own reference too, which
+		// is dropped at the end of the run via caerMainloopPacketRelease().
+		auto result = glMainloopDataPtr->retainedPackets.emplace(packet, 1);
+		result.first->second++;
+	}
+	catch (const std::bad_alloc &) {
+		return (nullptr);
+	}
+
+	return (packet);
+}
+
+void caerMainloopPacketRelease(caerEventPacketHeaderConst packet) {
+	if (packet == nullptr) {
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(glMainloopDataPtr->retainedPacketsLock);
+
+		auto retained = glMainloopDataPtr->retainedPackets.find(packet);
+		if (retained != glMainloopDataPtr->retainedPackets.end()) {
+			if (--retained->second > 0) {
+				// Others still hold a reference.
+				return;
+			}
+
+			glMainloopDataPtr->retainedPackets.erase(retained);
+		}
+	}
+
+	// Last (or only) reference gone, free memory.
+	free(const_cast<caerEventPacketHeader>(packet));
+}
+
+void caerMainloopPacketContainerRelease(caerEventPacketContainer container) {
+	if (container == nullptr) {
+		return;
+	}
+
+	for (int32_t i = 0; i < caerEventPacketContainerGetEventPacketsNumber(container); i++) {
+		caerMainloopPacketRelease(caerEventPacketContainerGetEventPacketConst(container, i));
+	}
+
+	free(container);
+}
+
+bool caerMainloopPacketIsShared(caerEventPacketHeaderConst packet) {
+	std::lock_guard<std::mutex> lock(glMainloopDataPtr->retainedPacketsLock);
+
+	auto retained = glMainloopDataPtr->retainedPackets.find(packet);
+
+	return ((retained != glMainloopDataPtr->retainedPackets.end()) && (retained->second > 1));
+}
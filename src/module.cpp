@@ -20,6 +20,8 @@ static void caerModuleShutdownListener(sshsNode node, void *userData, enum sshs_
 	const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue);
 static void caerModuleLogLevelListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
 	const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue);
+static void caerModuleStatisticsRead(
+	void *userData, const char *key, enum sshs_node_attr_value_type type, union sshs_node_attr_value *value);
 
 void caerModuleConfigInit(sshsNode moduleNode) {
 	// Per-module log level support. Initialize with global log level value.
@@ -285,6 +287,121 @@ void caerModuleDestroy(caerModuleData moduleData) {
 	free(moduleData);
 }
 
+static const struct {
+	const char *key;
+	const char *description;
+} moduleStatisticsAttributes[] = {
+	{"eventsIn", "Number of valid events passed into this module."},
+	{"eventsOut", "Number of valid events produced by this module."},
+	{"runTimeP50", "Median run time of this module over the last runs, in nanoseconds."},
+	{"runTimeP90", "90th percentile run time of this module over the last runs, in nanoseconds."},
+	{"runTimeP99", "99th percentile run time of this module over the last runs, in nanoseconds."},
+	{"runTimeMax", "Maximum run time of this module over the last runs, in nanoseconds."},
+};
+
+void caerModuleStatisticsInit(sshsNode moduleNode, ModuleStatistics *statistics) {
+	sshsNode statNode = sshsGetRelativeNode(moduleNode, "statistics/");
+
+	for (const auto &attr : moduleStatisticsAttributes) {
+		sshsNodeCreateLong(
+			statNode, attr.key, 0, 0, INT64_MAX, SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, attr.description);
+		sshsNodeCreateAttributePollTime(statNode, attr.key, SSHS_LONG, 2);
+		sshsNodeAddAttributeReadModifier(statNode, attr.key, SSHS_LONG, statistics, &caerModuleStatisticsRead);
+	}
+}
+
+void caerModuleStatisticsExit(sshsNode moduleNode) {
+	sshsNode statNode = sshsGetRelativeNode(moduleNode, "statistics/");
+
+	// Only remove our own read modifiers, modules can publish their
+	// statistics in the same node.
+	for (const auto &attr : moduleStatisticsAttributes) {
+		sshsNodeRemoveAttributeReadModifier(statNode, attr.key, SSHS_LONG);
+	}
+}
+
+static uint64_t countValidEvents(caerEventPacketContainer container) {
+	uint64_t events = 0;
+
+	for (int32_t i = 0; i < caerEventPacketContainerGetEventPacketsNumber(container); i++) {
+		caerEventPacketHeaderConst packet = caerEventPacketContainerGetEventPacketConst(container, i);
+
+		if (packet != nullptr) {
+			events += U64T(caerEventPacketHeaderGetEventValid(packet));
+		}
+	}
+
+	return (events);
+}
+
+void caerModuleStatisticsUpdate(ModuleStatistics *statistics, caerEventPacketContainer in,
+	caerEventPacketContainer out, uint64_t runTimeNs) {
+	if (in != nullptr) {
+		statistics->eventsIn.fetch_add(countValidEvents(in), std::memory_order_relaxed);
+	}
+
+	if (out != nullptr) {
+		statistics->eventsOut.fetch_add(countValidEvents(out), std::memory_order_relaxed);
+	}
+
+	std::lock_guard<std::mutex> lock(statistics->runTimesLock);
+
+	statistics->runTimes[statistics->runTimesNext] = (runTimeNs > UINT32_MAX) ? (UINT32_MAX) : (U32T(runTimeNs));
+	statistics->runTimesNext                       = (statistics->runTimesNext + 1) % CAER_MODULE_STATISTICS_RUNS;
+
+	if (statistics->runTimesCount < CAER_MODULE_STATISTICS_RUNS) {
+		statistics->runTimesCount++;
+	}
+}
+
+static void caerModuleStatisticsRead(
+	void *userData, const char *key, enum sshs_node_attr_value_type type, union sshs_node_attr_value *value) {
+	UNUSED_ARGUMENT(type); // We know all statistics are always LONG.
+
+	ModuleStatistics *statistics = static_cast<ModuleStatistics *>(userData);
+
+	if (caerStrEquals(key, "eventsIn")) {
+		value->ilong = I64T(statistics->eventsIn.load(std::memory_order_relaxed));
+		return;
+	}
+
+	if (caerStrEquals(key, "eventsOut")) {
+		value->ilong = I64T(statistics->eventsOut.load(std::memory_order_relaxed));
+		return;
+	}
+
+	// Run-time percentiles: work on a copy, so the mainloop is only held up
+	// for as long as it takes to copy the samples.
+	std::vector<uint32_t> runTimes;
+
+	{
+		std::lock_guard<std::mutex> lock(statistics->runTimesLock);
+
+		runTimes.assign(statistics->runTimes.begin(), statistics->runTimes.begin() + statistics->runTimesCount);
+	}
+
+	if (runTimes.empty()) {
+		value->ilong = 0;
+		return;
+	}
+
+	size_t rank = runTimes.size() - 1;
+
+	if (caerStrEquals(key, "runTimeP50")) {
+		rank = (runTimes.size() * 50) / 100;
+	}
+	else if (caerStrEquals(key, "runTimeP90")) {
+		rank = (runTimes.size() * 90) / 100;
+	}
+	else if (caerStrEquals(key, "runTimeP99")) {
+		rank = (runTimes.size() * 99) / 100;
+	}
+
+	std::nth_element(runTimes.begin(), runTimes.begin() + static_cast<ssize_t>(rank), runTimes.end());
+
+	value->ilong = I64T(runTimes[rank]);
+}
+
 static void caerModuleShutdownListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
 	const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue) {
 	UNUSED_ARGUMENT(node);
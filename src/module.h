@@ -35,6 +35,9 @@ using ModuleLibrary = boost::dll::shared_library;
 using ModuleLibrary = void *;
 #endif
 
+#include <array>
+#include <atomic>
+#include <mutex>
 #include <string>
 #include <utility>
 
@@ -42,6 +45,31 @@ std::pair<ModuleLibrary, caerModuleInfo> caerLoadModuleLibrary(const std::string
 void caerUnloadModuleLibrary(ModuleLibrary &moduleLibrary);
 void caerUpdateModulesInformation();
 
+// Number of most recent runs used for the run-time percentiles.
+#define CAER_MODULE_STATISTICS_RUNS 1024
+
+/**
+ * Per-module execution statistics, collected by the mainloop around each
+ * module run and published in the module's "statistics/" node.
+ * Run times are in nanoseconds, the event counters are cumulative.
+ */
+struct ModuleStatistics {
+	std::atomic<uint64_t> eventsIn;
+	std::atomic<uint64_t> eventsOut;
+	std::mutex runTimesLock;
+	std::array<uint32_t, CAER_MODULE_STATISTICS_RUNS> runTimes;
+	size_t runTimesCount;
+	size_t runTimesNext;
+
+	ModuleStatistics() : eventsIn(0), eventsOut(0), runTimes(), runTimesCount(0), runTimesNext(0) {
+	}
+};
+
+void caerModuleStatisticsInit(sshsNode moduleNode, ModuleStatistics *statistics);
+void caerModuleStatisticsExit(sshsNode moduleNode);
+void caerModuleStatisticsUpdate(ModuleStatistics *statistics, caerEventPacketContainer in,
+	caerEventPacketContainer out, uint64_t runTimeNs);
+
 #endif
 
 #endif /* MODULE_H_ */
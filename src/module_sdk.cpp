@@ -38,6 +38,19 @@ void caerModuleConfigDefaultListener(sshsNode node, void *userData, enum sshs_no
 	}
 }
 
+void caerModuleConfigDefaultChangeSetListener(
+	sshsNode node, void *userData, const struct sshs_node_attr_change *changes, size_t numChanges) {
+	UNUSED_ARGUMENT(node);
+	UNUSED_ARGUMENT(changes);
+	UNUSED_ARGUMENT(numChanges);
+
+	caerModuleData data = (caerModuleData) userData;
+
+	// Simply set the config update flag to 1 on any attribute change.
+	// Called once per change set, so a transaction means one update.
+	data->configUpdate.store(1);
+}
+
 void caerModuleLog(caerModuleData moduleData, enum caer_log_level logLevel, const char *format, ...) {
 	va_list argumentList;
 	va_start(argumentList, format);
@@ -0,0 +1,266 @@
+#include "caer-sdk/queue.h"
+#include "caer-sdk/utils.h"
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <new>
+
+#if defined(OS_LINUX)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#else
+#include <condition_variable>
+#include <mutex>
+#endif
+
+// Keep producer and consumer data on different cache lines.
+#define QUEUE_CACHELINE_SIZE 64
+
+struct caer_queue {
+	// Producer side.
+	alignas(QUEUE_CACHELINE_SIZE) size_t putPos;
+	std::atomic<bool> producerWaiting;
+	std::atomic<uint32_t> spaceEvent;
+	// Consumer side.
+	alignas(QUEUE_CACHELINE_SIZE) size_t getPos;
+	std::atomic<bool> consumerWaiting;
+	std::atomic<uint32_t> dataEvent;
+	// Shared, read-only after creation.
+	alignas(QUEUE_CACHELINE_SIZE) size_t size;
+	std::atomic<void *> *elements;
+#if !defined(OS_LINUX)
+	std::mutex waitLock;
+	std::condition_variable waitCond;
+#endif
+};
+
+#if defined(OS_LINUX)
+// The futex syscall works directly on the atomic's 32 bit value.
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "Atomic uint32_t must not carry extra state.");
+#endif
+
+// Wait for the event counter to change from 'expected', or for the timeout.
+static void queueWait(caerQueue queue, std::atomic<uint32_t> &event, uint32_t expected, uint32_t timeoutUs) {
+#if defined(OS_LINUX)
+	UNUSED_ARGUMENT(queue);
+
+	struct timespec timeout;
+	timeout.tv_sec  = static_cast<time_t>(timeoutUs / 1000000);
+	timeout.tv_nsec = static_cast<long>((timeoutUs % 1000000) * 1000);
+
+	syscall(SYS_futex, reinterpret_cast<uint32_t *>(&event), FUTEX_WAIT_PRIVATE, expected, &timeout, nullptr, 0);
+#else
+	std::unique_lock<std::mutex> lock(queue->waitLock);
+
+	queue->waitCond.wait_for(lock, std::chrono::microseconds(timeoutUs),
+		[&event, expected]() { return (event.load(std::memory_order_acquire) != expected); });
+#endif
+}
+
+// Change the event counter and wake up whoever waits on it.
+static void queueWake(caerQueue queue, std::atomic<uint32_t> &event) {
+	event.fetch_add(1, std::memory_order_release);
+
+#if defined(OS_LINUX)
+	UNUSED_ARGUMENT(queue);
+
+	syscall(SYS_futex, reinterpret_cast<uint32_t *>(&event), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+#else
+	{
+		// Taking the lock ensures a waiter is either before its check or already waiting.
+		std::lock_guard<std::mutex> lock(queue->waitLock);
+	}
+
+	queue->waitCond.notify_all();
+#endif
+}
+
+caerQueue caerQueueInit(size_t size) {
+	if (size == 0) {
+		return (nullptr);
+	}
+
+	caerQueue queue = new (std::nothrow) caer_queue();
+	if (queue == nullptr) {
+		return (nullptr);
+	}
+
+	queue->elements = new (std::nothrow) std::atomic<void *>[size];
+	if (queue->elements == nullptr) {
+		delete queue;
+		return (nullptr);
+	}
+
+	for (size_t i = 0; i < size; i++) {
+		queue->elements[i].store(nullptr, std::memory_order_relaxed);
+	}
+
+	queue->size   = size;
+	queue->putPos = 0;
+	queue->getPos = 0;
+
+	queue->producerWaiting.store(false, std::memory_order_relaxed);
+	queue->consumerWaiting.store(false, std::memory_order_relaxed);
+	queue->spaceEvent.store(0, std::memory_order_relaxed);
+	queue->dataEvent.store(0, std::memory_order_relaxed);
+
+	// Make the initialized memory visible to the threads using the queue.
+	std::atomic_thread_fence(std::memory_order_release);
+
+	return (queue);
+}
+
+void caerQueueFree(caerQueue queue) {
+	if (queue == nullptr) {
+		return;
+	}
+
+	delete[] queue->elements;
+	delete queue;
+}
+
+bool caerQueuePut(caerQueue queue, void *elem) {
+	if (elem == nullptr) {
+		// NULL elements are disallowed (used as place-holders).
+		return (false);
+	}
+
+	if (queue->elements[queue->putPos].load(std::memory_order_seq_cst) != nullptr) {
+		// Full.
+		return (false);
+	}
+
+	// Sequentially consistent store and load, so that either the consumer sees the
+	// new element, or we see it waiting for one (and wake it up).
+	queue->elements[queue->putPos].store(elem, std::memory_order_seq_cst);
+
+	queue->putPos = (queue->putPos + 1) % queue->size;
+
+	if (queue->consumerWaiting.load(std::memory_order_seq_cst)) {
+		queueWake(queue, queue->dataEvent);
+	}
+
+	return (true);
+}
+
+bool caerQueuePutWait(caerQueue queue, void *elem, uint32_t timeoutUs) {
+	if (caerQueuePut(queue, elem)) {
+		return (true);
+	}
+
+	uint32_t event = queue->spaceEvent.load(std::memory_order_acquire);
+
+	queue->producerWaiting.store(true, std::memory_order_seq_cst);
+
+	// Check again, the consumer may have taken something before seeing us wait.
+	bool success = caerQueuePut(queue, elem);
+
+	if (!success) {
+		queueWait(queue, queue->spaceEvent, event, timeoutUs);
+
+		success = caerQueuePut(queue, elem);
+	}
+
+	queue->producerWaiting.store(false, std::memory_order_relaxed);
+
+	return (success);
+}
+
+void *caerQueueGet(caerQueue queue) {
+	void *elem = queue->elements[queue->getPos].load(std::memory_order_seq_cst);
+	if (elem == nullptr) {
+		// Empty.
+		return (nullptr);
+	}
+
+	// Same as on put: either the producer sees the free slot, or we see it waiting.
+	queue->elements[queue->getPos].store(nullptr, std::memory_order_seq_cst);
+
+	queue->getPos = (queue->getPos + 1) % queue->size;
+
+	if (queue->producerWaiting.load(std::memory_order_seq_cst)) {
+		queueWake(queue, queue->spaceEvent);
+	}
+
+	return (elem);
+}
+
+void *caerQueueGetWait(caerQueue queue, uint32_t timeoutUs) {
+	void *elem = caerQueueGet(queue);
+	if (elem != nullptr) {
+		return (elem);
+	}
+
+	uint32_t event = queue->dataEvent.load(std::memory_order_acquire);
+
+	queue->consumerWaiting.store(true, std::memory_order_seq_cst);
+
+	// Check again, the producer may have put something before seeing us wait.
+	elem = caerQueueGet(queue);
+
+	if (elem == nullptr) {
+		queueWait(queue, queue->dataEvent, event, timeoutUs);
+
+		elem = caerQueueGet(queue);
+	}
+
+	queue->consumerWaiting.store(false, std::memory_order_relaxed);
+
+	return (elem);
+}
+
+void *caerQueueLook(caerQueue queue) {
+	return (queue->elements[queue->getPos].load(std::memory_order_acquire));
+}
+
+size_t caerQueueOccupancy(caerQueue queue) {
+	// Neither position can be read from other threads, but used slots are
+	// exactly the non-NULL ones.
+	size_t occupancy = 0;
+
+	for (size_t i = 0; i < queue->size; i++) {
+		if (queue->elements[i].load(std::memory_order_relaxed) != nullptr) {
+			occupancy++;
+		}
+	}
+
+	return (occupancy);
+}
+
+// The producer can't look at getPos. But the consumer frees slots strictly in
+// order, so the queue is empty exactly when the last slot put into is free again.
+static inline bool queueIsEmptyProducer(caerQueue queue) {
+	size_t lastPos = (queue->putPos + queue->size - 1) % queue->size;
+
+	return (queue->elements[lastPos].load(std::memory_order_seq_cst) == nullptr);
+}
+
+bool caerQueueWaitEmpty(caerQueue queue, uint32_t timeoutUs) {
+	if (queueIsEmptyProducer(queue)) {
+		return (true);
+	}
+
+	uint32_t event = queue->spaceEvent.load(std::memory_order_acquire);
+
+	queue->producerWaiting.store(true, std::memory_order_seq_cst);
+
+	bool empty = queueIsEmptyProducer(queue);
+
+	if (!empty) {
+		queueWait(queue, queue->spaceEvent, event, timeoutUs);
+
+		empty = queueIsEmptyProducer(queue);
+	}
+
+	queue->producerWaiting.store(false, std::memory_order_relaxed);
+
+	return (empty);
+}
+
+void caerQueueWakeUp(caerQueue queue) {
+	queueWake(queue, queue->dataEvent);
+	queueWake(queue, queue->spaceEvent);
+}
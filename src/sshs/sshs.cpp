@@ -1,11 +1,12 @@
 #include "sshs_internal.hpp"
+#include "sshs_notifier.hpp"
 #include <boost/tokenizer.hpp>
 #include <iostream>
 #include <mutex>
-#include <regex>
 
 struct sshs_struct {
 	sshsNode root;
+	sshs_notifier *notifier;
 };
 
 static void sshsGlobalInitialize(void);
@@ -65,8 +66,12 @@ sshs sshsNew(void) {
 	sshs newSshs = (sshs) malloc(sizeof(*newSshs));
 	sshsMemoryCheck(newSshs, __func__);
 
-	// Create root node.
+	// Listener dispatch queue, shared by all nodes of this tree.
+	newSshs->notifier = new sshs_notifier();
+
+	// Create root node. Children inherit the notifier from it.
 	newSshs->root = sshsNodeNew("", nullptr);
+	sshsNodeSetNotifier(newSshs->root, newSshs->notifier);
 
 	return (newSshs);
 }
@@ -231,9 +236,46 @@ bool sshsEndTransaction(sshs st, const char *nodePaths[], size_t nodePathsLength
 	return (true);
 }
 
-#define ALLOWED_CHARS_REGEXP "([a-zA-Z-_\\d\\.]+/)"
-static const std::regex sshsAbsoluteNodePathRegexp("^/" ALLOWED_CHARS_REGEXP "*$");
-static const std::regex sshsRelativeNodePathRegexp("^" ALLOWED_CHARS_REGEXP "+$");
+void sshsSetListenerDispatchMode(sshs st, enum sshs_listener_dispatch_mode mode) {
+	st->notifier->setMode(mode);
+}
+
+enum sshs_listener_dispatch_mode sshsGetListenerDispatchMode(sshs st) {
+	return (st->notifier->getMode());
+}
+
+// Deliver all queued attribute notifications on the calling thread.
+// Can be used in any mode, for example to flush before a shutdown.
+size_t sshsDispatchListenerNotifications(sshs st) {
+	return (st->notifier->dispatch());
+}
+
+// Monotonic counter of changes to exported content (attribute values, adds
+// and removals of attributes without the NO_EXPORT flag). Compare two values
+// to know if the tree needs to be written back.
+uint64_t sshsGetChangeCount(sshs st) {
+	return (st->notifier->getChangeCount());
+}
+
+// Check that path is a sequence of one or more 'name/' components, starting
+// at offset start. Names are checked by sshsHelperCppCheckName().
+static bool sshsCheckNodePathComponents(const std::string &path, size_t start) {
+	if (start >= path.length()) {
+		return (false);
+	}
+
+	while (start < path.length()) {
+		size_t sep = path.find('/', start);
+
+		if (sep == std::string::npos || !sshsHelperCppCheckName(path, start, sep)) {
+			return (false);
+		}
+
+		start = sep + 1;
+	}
+
+	return (true);
+}
 
 static bool sshsCheckAbsoluteNodePath(const std::string &absolutePath) {
 	if (absolutePath.empty()) {
@@ -241,7 +283,8 @@ static bool sshsCheckAbsoluteNodePath(const std::string &absolutePath) {
 		return (false);
 	}
 
-	if (!std::regex_match(absolutePath, sshsAbsoluteNodePathRegexp)) {
+	// Either only the root '/', or '/' followed by 'name/' components.
+	if (absolutePath[0] != '/' || (absolutePath.length() > 1 && !sshsCheckNodePathComponents(absolutePath, 1))) {
 		boost::format errorMsg = boost::format("Invalid absolute node path format: '%s'.") % absolutePath;
 
 		(*sshsGetGlobalErrorLogCallback())(errorMsg.str().c_str());
@@ -258,7 +301,7 @@ static bool sshsCheckRelativeNodePath(const std::string &relativePath) {
 		return (false);
 	}
 
-	if (!std::regex_match(relativePath, sshsRelativeNodePathRegexp)) {
+	if (!sshsCheckNodePathComponents(relativePath, 0)) {
 		boost::format errorMsg = boost::format("Invalid relative node path format: '%s'.") % relativePath;
 
 		(*sshsGetGlobalErrorLogCallback())(errorMsg.str().c_str());
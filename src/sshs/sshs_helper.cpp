@@ -1,5 +1,8 @@
 #include "sshs_internal.hpp"
 
+#include <mutex>
+#include <unordered_set>
+
 static const std::string typeStrings[] = {"bool", "byte", "short", "int", "long", "float", "double", "string"};
 
 const std::string &sshsHelperCppTypeToStringConverter(enum sshs_node_attr_value_type type) {
@@ -134,6 +137,41 @@ sshs_value sshsHelperCppStringToValueConverter(enum sshs_node_attr_value_type ty
 	return (value);
 }
 
+// Node names and attribute keys may only contain [a-zA-Z0-9-_.] and
+// must not be empty. Checks the sub-string [start, end) of name.
+bool sshsHelperCppCheckName(const std::string &name, size_t start, size_t end) {
+	if (end > name.length()) {
+		end = name.length();
+	}
+
+	if (start >= end) {
+		return (false);
+	}
+
+	for (size_t i = start; i < end; i++) {
+		const char c = name[i];
+
+		if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-' || c == '_'
+				|| c == '.')) {
+			return (false);
+		}
+	}
+
+	return (true);
+}
+
+// Keys and node names repeat a lot between nodes (running, logLevel, ...),
+// so they are stored only once. The returned pointer is valid forever.
+const std::string *sshsInternString(const std::string &str) {
+	static std::unordered_set<std::string> internPool;
+	static std::mutex internPoolLock;
+
+	std::lock_guard<std::mutex> lock(internPoolLock);
+
+	// References to unordered_set elements are stable across rehashing.
+	return (&*internPool.insert(str).first);
+}
+
 /**
  * C11 wrappers for external use.
  */
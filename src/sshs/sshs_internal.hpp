@@ -8,16 +8,25 @@
 #include <stdexcept>
 #include <string>
 
+class sshs_notifier;
+class sshs_value;
+
 // C linkage to guarantee no name mangling.
 extern "C" {
 // Internal functions.
 sshsNode sshsNodeNew(const char *nodeName, sshsNode parent);
 sshsNode sshsNodeAddChild(sshsNode node, const char *childName);
 sshsNode sshsNodeGetChild(sshsNode node, const char *childName);
+void sshsNodeSetNotifier(sshsNode node, sshs_notifier *notifier);
 void sshsNodeTransactionLock(sshsNode node);
+bool sshsNodeTransactionTryLock(sshsNode node);
 void sshsNodeTransactionUnlock(sshsNode node);
 }
 
+// Call node's attribute listeners, node lock must be held.
+void sshsNodeDeliverAttributeNotification(
+	sshsNode node, enum sshs_node_attribute_events event, const std::string &key, const sshs_value &value);
+
 // Terminate process on failed memory allocation.
 template<typename T> static inline void sshsMemoryCheck(T *ptr, const std::string &funcName) {
 	if (ptr == nullptr) {
@@ -326,5 +335,7 @@ const std::string &sshsHelperCppTypeToStringConverter(enum sshs_node_attr_value_
 enum sshs_node_attr_value_type sshsHelperCppStringToTypeConverter(const std::string &typeString);
 std::string sshsHelperCppValueToStringConverter(const sshs_value &val);
 sshs_value sshsHelperCppStringToValueConverter(enum sshs_node_attr_value_type type, const std::string &valueString);
+bool sshsHelperCppCheckName(const std::string &name, size_t start = 0, size_t end = std::string::npos);
+const std::string *sshsInternString(const std::string &str);
 
 #endif /* SSHS_INTERNAL_HPP_ */
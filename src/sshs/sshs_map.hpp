@@ -0,0 +1,278 @@
+#ifndef SSHS_MAP_HPP_
+#define SSHS_MAP_HPP_
+
+#include "sshs_internal.hpp"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+// Minimum number of slots, must be a power of two.
+#define SSHS_MAP_MIN_CAPACITY 8
+
+/**
+ * Open-addressing (linear probing) hash map from string keys to values,
+ * used for node children and attributes. Keys are interned, so each
+ * entry only holds a pointer to the shared key string and its hash.
+ * Iteration order is unspecified, use sortedEntries() where the order
+ * matters (XML export, key listings).
+ * Not thread-safe, locking is done by the owning node.
+ */
+template<typename V> class sshs_map {
+public:
+	class entry {
+	private:
+		const std::string *key;
+		size_t hash;
+		V value;
+
+		friend class sshs_map;
+
+	public:
+		entry() : key(nullptr), hash(0), value() {
+		}
+
+		const std::string &getKey() const noexcept {
+			return (*key);
+		}
+
+		V &getValue() noexcept {
+			return (value);
+		}
+
+		const V &getValue() const noexcept {
+			return (value);
+		}
+
+		bool isUsed() const noexcept {
+			return (key != nullptr);
+		}
+	};
+
+	template<typename E> class iterator_base {
+	private:
+		E *curr;
+		E *end;
+
+		void skipUnused() noexcept {
+			while (curr != end && !curr->isUsed()) {
+				curr++;
+			}
+		}
+
+	public:
+		iterator_base(E *_curr, E *_end) : curr(_curr), end(_end) {
+			skipUnused();
+		}
+
+		E &operator*() const noexcept {
+			return (*curr);
+		}
+
+		E *operator->() const noexcept {
+			return (curr);
+		}
+
+		iterator_base &operator++() noexcept {
+			curr++;
+			skipUnused();
+			return (*this);
+		}
+
+		bool operator==(const iterator_base &rhs) const noexcept {
+			return (curr == rhs.curr);
+		}
+
+		bool operator!=(const iterator_base &rhs) const noexcept {
+			return (curr != rhs.curr);
+		}
+	};
+
+	using iterator       = iterator_base<entry>;
+	using const_iterator = iterator_base<const entry>;
+
+private:
+	std::vector<entry> slots;
+	size_t count;
+
+public:
+	sshs_map() : count(0) {
+	}
+
+	size_t size() const noexcept {
+		return (count);
+	}
+
+	bool empty() const noexcept {
+		return (count == 0);
+	}
+
+	void clear() {
+		slots.clear();
+		count = 0;
+	}
+
+	iterator begin() noexcept {
+		return (iterator(slots.data(), slots.data() + slots.size()));
+	}
+
+	iterator end() noexcept {
+		return (iterator(slots.data() + slots.size(), slots.data() + slots.size()));
+	}
+
+	const_iterator begin() const noexcept {
+		return (const_iterator(slots.data(), slots.data() + slots.size()));
+	}
+
+	const_iterator end() const noexcept {
+		return (const_iterator(slots.data() + slots.size(), slots.data() + slots.size()));
+	}
+
+	V *find(const std::string &key) noexcept {
+		ssize_t idx = findSlot(key, hashKey(key));
+
+		return ((idx < 0) ? (nullptr) : (&slots[static_cast<size_t>(idx)].value));
+	}
+
+	const V *find(const std::string &key) const noexcept {
+		ssize_t idx = findSlot(key, hashKey(key));
+
+		return ((idx < 0) ? (nullptr) : (&slots[static_cast<size_t>(idx)].value));
+	}
+
+	bool exists(const std::string &key) const noexcept {
+		return (findSlot(key, hashKey(key)) >= 0);
+	}
+
+	// Get the value for key, inserting a default constructed one if absent.
+	// References are invalidated by any later insertion or removal!
+	V &operator[](const std::string &key) {
+		size_t hash = hashKey(key);
+
+		ssize_t idx = findSlot(key, hash);
+		if (idx >= 0) {
+			return (slots[static_cast<size_t>(idx)].value);
+		}
+
+		// Keep load factor under 3/4.
+		if (((count + 1) * 4) > (slots.size() * 3)) {
+			rehash((slots.empty()) ? (SSHS_MAP_MIN_CAPACITY) : (slots.size() * 2));
+		}
+
+		entry &e = slots[findFreeSlot(hash)];
+		e.key    = sshsInternString(key);
+		e.hash   = hash;
+		count++;
+
+		return (e.value);
+	}
+
+	bool erase(const std::string &key) {
+		ssize_t found = findSlot(key, hashKey(key));
+		if (found < 0) {
+			return (false);
+		}
+
+		// Backward-shift deletion: move following entries of the same
+		// probe chain up, so that no tombstones are ever needed.
+		size_t mask = slots.size() - 1;
+		size_t hole = static_cast<size_t>(found);
+		size_t next = hole;
+
+		while (true) {
+			next = (next + 1) & mask;
+
+			if (!slots[next].isUsed()) {
+				break;
+			}
+
+			size_t home = slots[next].hash & mask;
+
+			// Entry can only move back if its home slot is not cyclically in (hole, next].
+			bool homeInRange = (hole <= next) ? ((hole < home) && (home <= next)) : ((hole < home) || (home <= next));
+			if (homeInRange) {
+				continue;
+			}
+
+			slots[hole] = std::move(slots[next]);
+			hole        = next;
+		}
+
+		slots[hole] = entry();
+		count--;
+
+		return (true);
+	}
+
+	// Entries sorted by key. Pointers are invalidated by any insertion or removal.
+	std::vector<const entry *> sortedEntries() const {
+		std::vector<const entry *> sorted;
+		sorted.reserve(count);
+
+		for (const auto &e : *this) {
+			sorted.push_back(&e);
+		}
+
+		std::sort(sorted.begin(), sorted.end(),
+			[](const entry *a, const entry *b) { return (a->getKey() < b->getKey()); });
+
+		return (sorted);
+	}
+
+private:
+	// 64-bit FNV-1a, good enough for short ASCII keys and cheap to compute.
+	static size_t hashKey(const std::string &key) noexcept {
+		uint64_t hash = UINT64_C(14695981039346656037);
+
+		for (const char c : key) {
+			hash ^= static_cast<uint8_t>(c);
+			hash *= UINT64_C(1099511628211);
+		}
+
+		return (static_cast<size_t>(hash ^ (hash >> 32)));
+	}
+
+	ssize_t findSlot(const std::string &key, size_t hash) const noexcept {
+		if (count == 0) {
+			return (-1);
+		}
+
+		size_t mask = slots.size() - 1;
+
+		for (size_t idx = hash & mask;; idx = (idx + 1) & mask) {
+			const entry &e = slots[idx];
+
+			if (!e.isUsed()) {
+				return (-1);
+			}
+
+			if (e.hash == hash && *e.key == key) {
+				return (static_cast<ssize_t>(idx));
+			}
+		}
+	}
+
+	size_t findFreeSlot(size_t hash) const noexcept {
+		size_t mask = slots.size() - 1;
+		size_t idx  = hash & mask;
+
+		while (slots[idx].isUsed()) {
+			idx = (idx + 1) & mask;
+		}
+
+		return (idx);
+	}
+
+	void rehash(size_t newCapacity) {
+		std::vector<entry> oldSlots(newCapacity);
+		oldSlots.swap(slots);
+
+		for (auto &e : oldSlots) {
+			if (e.isUsed()) {
+				slots[findFreeSlot(e.hash)] = std::move(e);
+			}
+		}
+	}
+};
+
+#endif /* SSHS_MAP_HPP_ */
@@ -0,0 +1,344 @@
+/**
+ * Microbenchmark for SSHS node storage: sshs_map with interned keys and
+ * hand-written name checks, against the std::map plus std::regex scheme
+ * it replaced. Runs create/get/put/iterate on a tree shaped like the
+ * configuration of a DAVIS camera module. Build with -DENABLE_BENCHMARKS=1.
+ */
+#include "sshs_internal.hpp"
+#include "sshs_map.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <regex>
+#include <vector>
+
+#define BENCH_REPETITIONS 200
+
+struct bench_node_spec {
+	std::string path;
+	std::vector<std::string> keys;
+};
+
+// About 60 nodes and 500 attributes, like a DAVIS346 module subtree.
+static std::vector<bench_node_spec> benchTreeSpec() {
+	static const struct {
+		const char *name;
+		size_t attributes;
+	} groups[] = {{"aps", 40}, {"dvs", 45}, {"imu", 15}, {"extInput", 20}, {"multiplexer", 10}, {"usb", 8},
+		{"system", 6}, {"chip", 35}, {"statistics", 12}};
+
+	std::vector<bench_node_spec> spec;
+
+	spec.push_back(bench_node_spec{"/mainloop/davis/", {"moduleId", "moduleLibrary", "logLevel", "runAtStartup",
+															"running", "autoRestart", "busNumber", "devAddress"}});
+
+	for (const auto &g : groups) {
+		bench_node_spec node{std::string("/mainloop/davis/") + g.name + "/", {}};
+
+		for (size_t i = 0; i < g.attributes; i++) {
+			node.keys.push_back(std::string(g.name) + "Setting" + std::to_string(i));
+		}
+
+		spec.push_back(node);
+	}
+
+	// Biases: many small nodes with the same keys.
+	for (size_t i = 0; i < 48; i++) {
+		spec.push_back(bench_node_spec{"/mainloop/davis/bias/Bias" + std::to_string(i) + "/",
+			{"coarseValue", "fineValue", "enable", "sex", "type", "currentLevel", "BiasValue"}});
+	}
+
+	return (spec);
+}
+
+/**
+ * Old scheme: sorted std::map keyed by std::string, names and paths
+ * validated with std::regex, attribute access with count() + operator[].
+ */
+class bench_regex_map {
+private:
+	struct node {
+		std::map<std::string, std::unique_ptr<node>> children;
+		std::map<std::string, sshs_value> attributes;
+	};
+
+	node root;
+	const std::regex keyRegexp{"^[a-zA-Z-_\\d\\.]+$"};
+	const std::regex pathRegexp{"^/([a-zA-Z-_\\d\\.]+/)*$"};
+
+	node *getNode(const std::string &path) {
+		if (!std::regex_match(path, pathRegexp)) {
+			return (nullptr);
+		}
+
+		node *curr = &root;
+
+		for (size_t start = 1, sep; (sep = path.find('/', start)) != std::string::npos; start = sep + 1) {
+			auto &child = curr->children[path.substr(start, sep - start)];
+			if (!child) {
+				child.reset(new node());
+			}
+
+			curr = child.get();
+		}
+
+		return (curr);
+	}
+
+public:
+	static const char *getName() {
+		return ("std::map + std::regex");
+	}
+
+	bool create(const std::string &path, const std::string &key, int32_t value) {
+		if (!std::regex_match(key, keyRegexp)) {
+			return (false);
+		}
+
+		node *n = getNode(path);
+		if (n == nullptr) {
+			return (false);
+		}
+
+		if (n->attributes.count(key) == 0) {
+			n->attributes[key].setInt(value);
+		}
+
+		return (true);
+	}
+
+	bool get(const std::string &path, const std::string &key, int32_t &value) {
+		node *n = getNode(path);
+		if ((n == nullptr) || (n->attributes.count(key) == 0)) {
+			return (false);
+		}
+
+		value = n->attributes[key].getInt();
+		return (true);
+	}
+
+	bool put(const std::string &path, const std::string &key, int32_t value) {
+		node *n = getNode(path);
+		if ((n == nullptr) || (n->attributes.count(key) == 0)) {
+			return (false);
+		}
+
+		n->attributes[key].setInt(value);
+		return (true);
+	}
+
+	// Export order: sorted by key, which std::map gives for free.
+	int64_t iterate() {
+		return (iterateNode(root));
+	}
+
+	int64_t iterateNode(const node &n) {
+		int64_t sum = 0;
+
+		for (const auto &attr : n.attributes) {
+			sum += attr.second.getInt();
+		}
+
+		for (const auto &child : n.children) {
+			sum += iterateNode(*child.second);
+		}
+
+		return (sum);
+	}
+};
+
+/**
+ * Current scheme: sshs_map with interned keys, names and paths checked
+ * by sshsHelperCppCheckName(), a single lookup per access.
+ */
+class bench_sshs_map {
+private:
+	struct node {
+		sshs_map<std::unique_ptr<node>> children;
+		sshs_map<sshs_value> attributes;
+	};
+
+	node root;
+
+	node *getNode(const std::string &path) {
+		if (path.empty() || (path[0] != '/')) {
+			return (nullptr);
+		}
+
+		node *curr = &root;
+
+		for (size_t start = 1; start < path.length();) {
+			size_t sep = path.find('/', start);
+			if ((sep == std::string::npos) || !sshsHelperCppCheckName(path, start, sep)) {
+				return (nullptr);
+			}
+
+			const std::string name = path.substr(start, sep - start);
+
+			auto child = curr->children.find(name);
+			if (child == nullptr) {
+				child = &curr->children[name];
+				child->reset(new node());
+			}
+
+			curr  = child->get();
+			start = sep + 1;
+		}
+
+		return (curr);
+	}
+
+public:
+	static const char *getName() {
+		return ("sshs_map");
+	}
+
+	bool create(const std::string &path, const std::string &key, int32_t value) {
+		if (!sshsHelperCppCheckName(key)) {
+			return (false);
+		}
+
+		node *n = getNode(path);
+		if (n == nullptr) {
+			return (false);
+		}
+
+		if (!n->attributes.exists(key)) {
+			n->attributes[key].setInt(value);
+		}
+
+		return (true);
+	}
+
+	bool get(const std::string &path, const std::string &key, int32_t &value) {
+		node *n = getNode(path);
+		if (n == nullptr) {
+			return (false);
+		}
+
+		const sshs_value *attr = n->attributes.find(key);
+		if (attr == nullptr) {
+			return (false);
+		}
+
+		value = attr->getInt();
+		return (true);
+	}
+
+	bool put(const std::string &path, const std::string &key, int32_t value) {
+		node *n = getNode(path);
+		if (n == nullptr) {
+			return (false);
+		}
+
+		sshs_value *attr = n->attributes.find(key);
+		if (attr == nullptr) {
+			return (false);
+		}
+
+		attr->setInt(value);
+		return (true);
+	}
+
+	// Export order: sorted by key, as sshsNodeToXML() does.
+	int64_t iterate() {
+		return (iterateNode(root));
+	}
+
+	int64_t iterateNode(const node &n) {
+		int64_t sum = 0;
+
+		for (const auto attr : n.attributes.sortedEntries()) {
+			sum += attr->getValue().getInt();
+		}
+
+		for (const auto child : n.children.sortedEntries()) {
+			sum += iterateNode(*child->getValue());
+		}
+
+		return (sum);
+	}
+};
+
+static double benchNanosSince(const std::chrono::steady_clock::time_point &start, size_t operations) {
+	std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+	return (elapsed.count() / static_cast<double>(operations));
+}
+
+template<typename B> static void benchRun(const std::vector<bench_node_spec> &spec) {
+	size_t attributes = 0;
+	for (const auto &n : spec) {
+		attributes += n.keys.size();
+	}
+
+	double createTime  = 0;
+	double getTime     = 0;
+	double putTime     = 0;
+	double iterateTime = 0;
+	int64_t checksum   = 0;
+
+	for (size_t r = 0; r < BENCH_REPETITIONS; r++) {
+		B tree;
+
+		auto start = std::chrono::steady_clock::now();
+
+		for (const auto &n : spec) {
+			for (const auto &key : n.keys) {
+				tree.create(n.path, key, 1);
+			}
+		}
+
+		createTime += benchNanosSince(start, attributes);
+
+		start = std::chrono::steady_clock::now();
+
+		for (const auto &n : spec) {
+			for (const auto &key : n.keys) {
+				int32_t value = 0;
+				tree.get(n.path, key, value);
+				checksum += value;
+			}
+		}
+
+		getTime += benchNanosSince(start, attributes);
+
+		start = std::chrono::steady_clock::now();
+
+		for (const auto &n : spec) {
+			for (const auto &key : n.keys) {
+				tree.put(n.path, key, static_cast<int32_t>(r));
+			}
+		}
+
+		putTime += benchNanosSince(start, attributes);
+
+		start = std::chrono::steady_clock::now();
+
+		checksum += tree.iterate();
+
+		iterateTime += benchNanosSince(start, attributes);
+	}
+
+	printf("%-24s create %7.1f  get %7.1f  put %7.1f  iterate %7.1f ns/attribute (checksum %lld)\n", B::getName(),
+		createTime / BENCH_REPETITIONS, getTime / BENCH_REPETITIONS, putTime / BENCH_REPETITIONS,
+		iterateTime / BENCH_REPETITIONS, static_cast<long long>(checksum));
+}
+
+int main() {
+	const std::vector<bench_node_spec> spec = benchTreeSpec();
+
+	size_t attributes = 0;
+	for (const auto &n : spec) {
+		attributes += n.keys.size();
+	}
+
+	printf("Tree: %zu nodes, %zu attributes, %d repetitions.\n", spec.size(), attributes, BENCH_REPETITIONS);
+
+	benchRun<bench_regex_map>(spec);
+	benchRun<bench_sshs_map>(spec);
+
+	return (EXIT_SUCCESS);
+}
@@ -1,4 +1,6 @@
 #include "sshs_internal.hpp"
+#include "sshs_map.hpp"
+#include "sshs_notifier.hpp"
 
 #include <algorithm>
 #include <boost/iostreams/device/file_descriptor.hpp>
@@ -7,14 +9,21 @@
 #include <boost/property_tree/xml_parser.hpp>
 #include <cfloat>
 #include <functional>
-#include <map>
 #include <memory>
 #include <mutex>
-#include <regex>
+#include <new>
 #include <shared_mutex>
 #include <utility>
 #include <vector>
 
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#if defined(OS_UNIX)
+#include <sys/mman.h>
+#endif
+
 // We don't care about unlocking anything here, as we exit hard on error anyway.
 static inline void sshsNodeError(const std::string &funcName, const std::string &key,
 	enum sshs_node_attr_value_type type, const std::string &msg, bool fatal = true) {
@@ -191,7 +200,39 @@ public:
 	}
 };
 
-static const std::regex sshsKeyRegexp("^[a-zA-Z-_\\d\\.]+$");
+class sshs_node_change_set_listener {
+private:
+	sshsAttributeChangeSetListener changeSetChanged;
+	void *userData;
+
+public:
+	sshs_node_change_set_listener(sshsAttributeChangeSetListener _listener, void *_userData)
+		: changeSetChanged(_listener), userData(_userData) {
+	}
+
+	sshsAttributeChangeSetListener getListener() const noexcept {
+		return (changeSetChanged);
+	}
+
+	void *getUserData() const noexcept {
+		return (userData);
+	}
+
+	// Comparison operators.
+	bool operator==(const sshs_node_change_set_listener &rhs) const noexcept {
+		return ((changeSetChanged == rhs.changeSetChanged) && (userData == rhs.userData));
+	}
+
+	bool operator!=(const sshs_node_change_set_listener &rhs) const noexcept {
+		return (!this->operator==(rhs));
+	}
+};
+
+// struct for C compatibility
+struct sshs_node_transaction {
+	sshsNode node;
+	std::vector<std::pair<std::string, sshs_value>> changes;
+};
 
 // struct for C compatibility
 struct sshs_node {
@@ -199,14 +240,17 @@ public:
 	std::string name;
 	std::string path;
 	sshsNode parent;
-	std::map<std::string, sshsNode> children;
-	std::map<std::string, sshs_node_attr> attributes;
+	sshs_map<sshsNode> children;
+	sshs_map<sshs_node_attr> attributes;
 	std::vector<sshs_node_listener> nodeListeners;
 	std::vector<sshs_node_attr_listener> attrListeners;
+	std::vector<sshs_node_change_set_listener> changeSetListeners;
 	std::shared_timed_mutex traversal_lock;
 	std::recursive_mutex node_lock;
+	sshs_notifier *notifier;
 
-	sshs_node(const std::string &_name, sshsNode _parent) : name(_name), parent(_parent) {
+	sshs_node(const std::string &_name, sshsNode _parent)
+		: name(_name), parent(_parent), notifier((_parent != nullptr) ? (_parent->notifier) : (nullptr)) {
 		// Path is based on parent.
 		if (_parent != nullptr) {
 			path = parent->path + _name + "/";
@@ -219,8 +263,8 @@ public:
 
 	void createAttribute(const std::string &key, const sshs_value &defaultValue,
 		const struct sshs_node_attr_ranges &ranges, int flags, const std::string &description) {
-		// Check key name string against allowed characters via regexp.
-		if (!std::regex_match(key, sshsKeyRegexp)) {
+		// Check key name string against allowed characters.
+		if (!sshsHelperCppCheckName(key)) {
 			boost::format errorMsg = boost::format("Invalid key name format: '%s'.") % key;
 
 			sshsNodeError("sshsNodeCreateAttribute", key, defaultValue.getType(), errorMsg.str());
@@ -270,17 +314,18 @@ public:
 		std::lock_guard<std::recursive_mutex> lock(node_lock);
 
 		// Add if not present. Else update value (below).
-		if (!attributes.count(key)) {
+		sshs_node_attr *existingAttr = attributes.find(key);
+
+		if (existingAttr == nullptr) {
 			attributes[key] = newAttr;
 
+			markExportedChange(newAttr);
+
 			// Listener support. Call only on change, which is always the case here.
-			for (const auto &l : attrListeners) {
-				(*l.getListener())(this, l.getUserData(), SSHS_ATTRIBUTE_ADDED, key.c_str(),
-					newAttr.getValue().getType(), newAttr.getValue().toCUnion(true));
-			}
+			notifyAttributeListeners(SSHS_ATTRIBUTE_ADDED, key, newAttr.getValue());
 		}
 		else {
-			const sshs_node_attr &oldAttr  = attributes[key];
+			const sshs_node_attr &oldAttr  = *existingAttr;
 			const sshs_value &oldAttrValue = oldAttr.getValue();
 
 			// To simplify things, we don't support multiple types per key (though the API does).
@@ -299,24 +344,29 @@ public:
 				newAttr.setReadModifier(readModifier.first, readModifier.second);
 			}
 
+			// Changing NO_EXPORT makes the attribute appear or vanish on export.
+			if (oldAttr.isFlagSet(SSHS_FLAGS_NO_EXPORT) != newAttr.isFlagSet(SSHS_FLAGS_NO_EXPORT)) {
+				markExportedChange();
+			}
+
 			// Check if the current value is still fine and within range; if it is
 			// we use it, else just use the new value.
 			if (oldAttrValue.inRange(ranges)) {
 				// Only update value, then use newAttr. No listeners called since this
 				// is by definition the old value and as such nothing can have changed.
 				newAttr.setValue(oldAttrValue);
-				attributes[key] = newAttr;
+				*existingAttr = newAttr;
 			}
 			else {
 				// If the old value is not in range anymore, the new value must be different,
 				// since it is guaranteed to be inside the new range. So we call the listeners.
-				attributes[key] = newAttr;
+				*existingAttr = newAttr;
+
+				markExportedChange(newAttr);
 
 				// Listener support. Call only on change, which is always the case here.
-				for (const auto &l : attrListeners) {
-					(*l.getListener())(this, l.getUserData(), SSHS_ATTRIBUTE_MODIFIED, key.c_str(),
-						newAttr.getValue().getType(), newAttr.getValue().toCUnion(true));
-				}
+				notifyAttributeListeners(SSHS_ATTRIBUTE_MODIFIED, key, newAttr.getValue());
+				notifyChangeSetListeners(key, newAttr.getValue());
 			}
 		}
 	}
@@ -324,19 +374,21 @@ public:
 	void removeAttribute(const std::string &key, enum sshs_node_attr_value_type type) {
 		std::lock_guard<std::recursive_mutex> lock(node_lock);
 
-		if (!attributeExists(key, type)) {
+		sshs_node_attr *attrPtr = findAttribute(key, type);
+		if (attrPtr == nullptr) {
 			// Ignore calls on non-existent attributes for remove, as it is used
 			// to clean-up attributes before re-creating them in a consistent way.
 			return;
 		}
 
-		sshs_node_attr &attr = attributes[key];
+		// Listeners could add attributes to this node, which would invalidate
+		// any reference into the attributes map, so we work on a copy.
+		const sshs_node_attr attr = *attrPtr;
+
+		markExportedChange(attr);
 
 		// Listener support.
-		for (const auto &l : attrListeners) {
-			(*l.getListener())(this, l.getUserData(), SSHS_ATTRIBUTE_REMOVED, key.c_str(), attr.getValue().getType(),
-				attr.getValue().toCUnion(true));
-		}
+		notifyAttributeListeners(SSHS_ATTRIBUTE_REMOVED, key, attr.getValue());
 
 		// Remove attribute from node.
 		attributes.erase(key);
@@ -345,49 +397,121 @@ public:
 	void removeAllAttributes() {
 		std::lock_guard<std::recursive_mutex> lock(node_lock);
 
-		for (const auto &attr : attributes) {
-			for (const auto &l : attrListeners) {
-				(*l.getListener())(this, l.getUserData(), SSHS_ATTRIBUTE_REMOVED, attr.first.c_str(),
-					attr.second.getValue().getType(), attr.second.getValue().toCUnion(true));
-			}
+		// Listeners could modify the attributes map, so we call them
+		// on a copy of all keys and values, in key order.
+		std::vector<std::pair<std::string, sshs_value>> removedAttributes;
+		removedAttributes.reserve(attributes.size());
+
+		for (const auto attr : attributes.sortedEntries()) {
+			removedAttributes.emplace_back(attr->getKey(), attr->getValue().getValue());
+
+			markExportedChange(attr->getValue());
+		}
+
+		for (const auto &attr : removedAttributes) {
+			notifyAttributeListeners(SSHS_ATTRIBUTE_REMOVED, attr.first, attr.second);
 		}
 
 		attributes.clear();
 	}
 
-	bool attributeExists(const std::string &key, enum sshs_node_attr_value_type type) {
-		std::lock_guard<std::recursive_mutex> lockNode(node_lock);
+	// Count a change to exported content, see sshsGetChangeCount().
+	void markExportedChange() noexcept {
+		if (notifier != nullptr) {
+			notifier->markChanged();
+		}
+	}
+
+	void markExportedChange(const sshs_node_attr &attr) noexcept {
+		if (!attr.isFlagSet(SSHS_FLAGS_NO_EXPORT)) {
+			markExportedChange();
+		}
+	}
 
-		if ((!attributes.count(key)) || (attributes[key].getValue().getType() != type)) {
+	// Call attribute listeners directly, or queue the change for deferred
+	// dispatch if the tree is not in synchronous mode. Node lock must be held.
+	// Removals are always delivered right away, as the node and its listeners
+	// may be gone by the time deferred dispatch would get to them. Anything
+	// still queued for that attribute is dropped, it's outdated now.
+	void notifyAttributeListeners(enum sshs_node_attribute_events event, const std::string &key,
+		const sshs_value &value, bool coalesce = true) {
+		if (notifier != nullptr) {
+			if (event == SSHS_ATTRIBUTE_REMOVED) {
+				notifier->discard(this, key);
+			}
+			else if (notifier->enqueue(this, key, event, value, coalesce)) {
+				return;
+			}
+		}
+
+		callAttributeListeners(event, key, value);
+	}
+
+	void callAttributeListeners(
+		enum sshs_node_attribute_events event, const std::string &key, const sshs_value &value) {
+		for (const auto &l : attrListeners) {
+			(*l.getListener())(this, l.getUserData(), event, key.c_str(), value.getType(), value.toCUnion(true));
+		}
+	}
+
+	// Change set listeners are always called synchronously. Node lock must be held.
+	void callChangeSetListeners(const std::vector<struct sshs_node_attr_change> &changeSet) {
+		for (const auto &l : changeSetListeners) {
+			(*l.getListener())(this, l.getUserData(), changeSet.data(), changeSet.size());
+		}
+	}
+
+	// A single modification is a change set of one.
+	void notifyChangeSetListeners(const std::string &key, const sshs_value &value) {
+		if (changeSetListeners.empty()) {
+			return;
+		}
+
+		callChangeSetListeners(
+			std::vector<struct sshs_node_attr_change>{{key.c_str(), value.getType(), value.toCUnion(true)}});
+	}
+
+	// Single lookup for key and type. Node lock must be held.
+	// Returns nullptr and sets errno to ENOENT if not found.
+	sshs_node_attr *findAttribute(const std::string &key, enum sshs_node_attr_value_type type) {
+		sshs_node_attr *attr = attributes.find(key);
+
+		if ((attr == nullptr) || (attr->getValue().getType() != type)) {
 			errno = ENOENT;
-			return (false);
+			return (nullptr);
 		}
 
 		// The specified attribute exists and has a matching type.
-		return (true);
+		return (attr);
 	}
 
-	const sshs_value getAttribute(const std::string &key, enum sshs_node_attr_value_type type) {
-		std::lock_guard<std::recursive_mutex> lockNode(node_lock);
+	// Like findAttribute(), but a missing attribute is a fatal usage error.
+	sshs_node_attr &getExistingAttribute(
+		const std::string &funcName, const std::string &key, enum sshs_node_attr_value_type type) {
+		sshs_node_attr *attr = findAttribute(key, type);
 
-		if (!attributeExists(key, type)) {
-			sshsNodeErrorNoAttribute("sshsNodeGetAttribute", key, type);
+		if (attr == nullptr) {
+			sshsNodeErrorNoAttribute(funcName, key, type);
 		}
 
-		// Return a copy of the final value.
-		return (attributes[key].getModifiedValue(key));
+		return (*attr);
 	}
 
-	bool putAttribute(const std::string &key, const sshs_value &value, bool forceReadOnlyUpdate = false) {
+	bool attributeExists(const std::string &key, enum sshs_node_attr_value_type type) {
 		std::lock_guard<std::recursive_mutex> lockNode(node_lock);
 
-		if (!attributeExists(key, value.getType())) {
-			sshsNodeErrorNoAttribute("sshsNodePutAttribute", key, value.getType());
-		}
+		return (findAttribute(key, type) != nullptr);
+	}
 
-		sshs_node_attr &attr = attributes[key];
+	const sshs_value getAttribute(const std::string &key, enum sshs_node_attr_value_type type) {
+		std::lock_guard<std::recursive_mutex> lockNode(node_lock);
+
+		// Return a copy of the final value.
+		return (getExistingAttribute("sshsNodeGetAttribute", key, type).getModifiedValue(key));
+	}
 
-		// Value must be present, so update old one, after checking range and flags.
+	// Check if value can be put into attr. Sets errno and returns false if not.
+	static bool checkPutAttribute(const sshs_node_attr &attr, const sshs_value &value, bool forceReadOnlyUpdate) {
 		if ((!forceReadOnlyUpdate && attr.isFlagSet(SSHS_FLAGS_READ_ONLY))
 			|| (forceReadOnlyUpdate && !attr.isFlagSet(SSHS_FLAGS_READ_ONLY))) {
 			// Read-only flag set, cannot put new value!
@@ -401,27 +525,111 @@ public:
 			return (false);
 		}
 
-		// Key and valueType have to be the same, so we first check that the
-		// actual values, that we want to update, are different. If not, there's
-		// nothing to do, no listeners to call, and it doesn't make sense to
-		// set the value twice to the same content.
-		if (attr.getValue() != value) {
-			if (!attr.isFlagSet(SSHS_FLAGS_NOTIFY_ONLY)) {
-				// Only update stored value if NOTIFY_ONLY is not set.
-				attr.setValue(value);
+		return (true);
+	}
+
+	// Store a checked value, returns true if it changed (listeners must be
+	// called). Key and valueType have to be the same, so we first check that
+	// the actual values, that we want to update, are different. If not,
+	// there's nothing to do, no listeners to call, and it doesn't make sense
+	// to set the value twice to the same content.
+	bool applyPutAttribute(sshs_node_attr &attr, const sshs_value &value) {
+		if (attr.getValue() == value) {
+			return (false);
+		}
+
+		if (!attr.isFlagSet(SSHS_FLAGS_NOTIFY_ONLY)) {
+			// Only update stored value if NOTIFY_ONLY is not set.
+			attr.setValue(value);
+
+			markExportedChange(attr);
+		}
+
+		return (true);
+	}
+
+	bool putAttribute(const std::string &key, const sshs_value &value, bool forceReadOnlyUpdate = false) {
+		std::lock_guard<std::recursive_mutex> lockNode(node_lock);
+
+		bool changed  = false;
+		bool coalesce = false;
+
+		{
+			// Listeners can create attributes on this node, which may rehash the
+			// attributes map, so don't keep this reference across their calls.
+			sshs_node_attr &attr = getExistingAttribute("sshsNodePutAttribute", key, value.getType());
+
+			// Value must be present, so update old one, after checking range and flags.
+			if (!checkPutAttribute(attr, value, forceReadOnlyUpdate)) {
+				return (false);
 			}
 
+			changed = applyPutAttribute(attr, value);
+
+			// Button presses (NOTIFY_ONLY) are never coalesced when dispatch is deferred.
+			coalesce = !attr.isFlagSet(SSHS_FLAGS_NOTIFY_ONLY);
+		}
+
+		if (changed) {
 			// Call the appropriate listeners, on change only, which is always
 			// true at this point. We use the new value directly, to support
 			// the case where NOTIFY_ONLY prevented the updated of the stored
 			// attribute, but the call to the listeners has to happen with the
 			// new value (call-listeners-only behavior).
-			for (const auto &l : attrListeners) {
-				(*l.getListener())(
-					this, l.getUserData(), SSHS_ATTRIBUTE_MODIFIED, key.c_str(), value.getType(), value.toCUnion(true));
+			notifyAttributeListeners(SSHS_ATTRIBUTE_MODIFIED, key, value, coalesce);
+			notifyChangeSetListeners(key, value);
+		}
+
+		return (true);
+	}
+
+	// Validate all changes first, then apply them together, so that nobody
+	// holding the node lock can ever see a partially applied set.
+	bool putAttributes(const std::vector<std::pair<std::string, sshs_value>> &changes) {
+		std::lock_guard<std::recursive_mutex> lockNode(node_lock);
+
+		for (const auto &change : changes) {
+			const sshs_node_attr *attr = findAttribute(change.first, change.second.getType());
+
+			if ((attr == nullptr) || !checkPutAttribute(*attr, change.second, false)) {
+				return (false);
+			}
+		}
+
+		// Listeners could modify the attributes map, so remember what
+		// changed and only call them once everything is applied.
+		std::vector<std::pair<const std::pair<std::string, sshs_value> *, bool>> applied;
+		applied.reserve(changes.size());
+
+		for (const auto &change : changes) {
+			sshs_node_attr &attr = *findAttribute(change.first, change.second.getType());
+
+			if (applyPutAttribute(attr, change.second)) {
+				applied.emplace_back(&change, !attr.isFlagSet(SSHS_FLAGS_NOTIFY_ONLY));
 			}
 		}
 
+		if (applied.empty()) {
+			return (true);
+		}
+
+		for (const auto &change : applied) {
+			notifyAttributeListeners(SSHS_ATTRIBUTE_MODIFIED, change.first->first, change.first->second, change.second);
+		}
+
+		// Change set listeners get everything at once.
+		if (!changeSetListeners.empty()) {
+			std::vector<struct sshs_node_attr_change> changeSet;
+			changeSet.reserve(applied.size());
+
+			for (const auto &change : applied) {
+				changeSet.push_back(sshs_node_attr_change{change.first->first.c_str(), change.first->second.getType(),
+					change.first->second.toCUnion(true)});
+			}
+
+			callChangeSetListeners(changeSet);
+		}
+
 		return (true);
 	}
 
@@ -429,28 +637,24 @@ public:
 		sshsAttributeReadModifier modify_read) {
 		std::lock_guard<std::recursive_mutex> lockNode(node_lock);
 
-		if (!attributeExists(key, type)) {
-			sshsNodeErrorNoAttribute("sshsNodeAddAttributeReadModifier", key, type);
-		}
-
 		// Set read modifier to supplied function pointer.
-		attributes[key].setReadModifier(modify_read, userData);
+		getExistingAttribute("sshsNodeAddAttributeReadModifier", key, type).setReadModifier(modify_read, userData);
 	}
 
 	void removeAttributeReadModifier(const std::string &key, enum sshs_node_attr_value_type type) {
 		std::lock_guard<std::recursive_mutex> lockNode(node_lock);
 
-		if (!attributeExists(key, type)) {
-			sshsNodeErrorNoAttribute("sshsNodeRemoveAttributeReadModifier", key, type);
-		}
-
-		sshs_node_attr &attr = attributes[key];
-
 		// Synchronize value in attribute with modified value on removal.
 		// This guarantees that the value in the node will be valid and expected
 		// after the read modifier is disabled. After that it will behave like
 		// any other normal attribute.
-		attr.setValue(attr.getModifiedValue(key));
+		const sshs_value modifiedValue
+			= getExistingAttribute("sshsNodeRemoveAttributeReadModifier", key, type).getModifiedValue(key);
+
+		// The read modifier could have created attributes, look it up again.
+		sshs_node_attr &attr = getExistingAttribute("sshsNodeRemoveAttributeReadModifier", key, type);
+
+		attr.setValue(modifiedValue);
 
 		// Reset read modifier to nullptr.
 		attr.resetReadModifier();
@@ -468,6 +672,8 @@ static bool sshsNodeToXML(sshsNode node, int fd, bool recursive);
 static boost::property_tree::ptree sshsNodeGenerateXML(sshsNode node, bool recursive);
 static bool sshsNodeFromXML(sshsNode node, int fd, bool recursive, bool strict);
 static void sshsNodeConsumeXML(sshsNode node, const boost::property_tree::ptree &content, bool recursive);
+static bool sshsNodePutOrCreateAttribute(
+	sshsNode node, const std::string &key, const sshs_value &value, const std::string &description);
 
 sshsNode sshsNodeNew(const char *nodeName, sshsNode parent) {
 	sshsNode newNode = new sshs_node(nodeName, parent);
@@ -478,9 +684,23 @@ sshsNode sshsNodeNew(const char *nodeName, sshsNode parent) {
 
 // children, attributes, and listeners must be cleaned up prior to this call.
 static void sshsNodeDestroy(sshsNode node) {
+	// Drop any queued notifications still referencing this node.
+	if (node->notifier != nullptr) {
+		node->notifier->purge(node);
+	}
+
 	delete node;
 }
 
+void sshsNodeSetNotifier(sshsNode node, sshs_notifier *notifier) {
+	node->notifier = notifier;
+}
+
+void sshsNodeDeliverAttributeNotification(
+	sshsNode node, enum sshs_node_attribute_events event, const std::string &key, const sshs_value &value) {
+	node->callAttributeListeners(event, key, value);
+}
+
 const char *sshsNodeGetName(sshsNode node) {
 	return (node->name.c_str());
 }
@@ -498,8 +718,10 @@ sshsNode sshsNodeAddChild(sshsNode node, const char *childName) {
 
 	// Atomic putIfAbsent: returns null if nothing was there before and the
 	// node is the new one, or it returns the old node if already present.
-	if (node->children.count(childName)) {
-		return (node->children[childName]);
+	const sshsNode *existingChild = node->children.find(childName);
+
+	if (existingChild != nullptr) {
+		return (*existingChild);
 	}
 	else {
 		// Create new child node with appropriate name and parent.
@@ -524,12 +746,9 @@ sshsNode sshsNodeAddChild(sshsNode node, const char *childName) {
 sshsNode sshsNodeGetChild(sshsNode node, const char *childName) {
 	std::shared_lock<std::shared_timed_mutex> lock(node->traversal_lock);
 
-	if (node->children.count(childName)) {
-		return (node->children[childName]);
-	}
-	else {
-		return (nullptr);
-	}
+	const sshsNode *child = node->children.find(childName);
+
+	return ((child != nullptr) ? (*child) : (nullptr));
 }
 
 // Remember to free the resulting array. This returns references to nodes,
@@ -549,8 +768,8 @@ sshsNode *sshsNodeGetChildren(sshsNode node, size_t *numChildren) {
 	sshsMemoryCheck(children, __func__);
 
 	size_t i = 0;
-	for (const auto &n : node->children) {
-		children[i++] = n.second;
+	for (const auto n : node->children.sortedEntries()) {
+		children[i++] = n->getValue();
 	}
 
 	*numChildren = childrenCount;
@@ -607,10 +826,118 @@ void sshsNodeRemoveAllAttributeListeners(sshsNode node) {
 	node->attrListeners.clear();
 }
 
+void sshsNodeAddAttributeChangeSetListener(
+	sshsNode node, void *userData, sshsAttributeChangeSetListener change_set_changed) {
+	sshs_node_change_set_listener listener(change_set_changed, userData);
+
+	std::lock_guard<std::recursive_mutex> lock(node->node_lock);
+
+	if (!findBool(node->changeSetListeners.begin(), node->changeSetListeners.end(), listener)) {
+		node->changeSetListeners.push_back(listener);
+	}
+}
+
+void sshsNodeRemoveAttributeChangeSetListener(
+	sshsNode node, void *userData, sshsAttributeChangeSetListener change_set_changed) {
+	sshs_node_change_set_listener listener(change_set_changed, userData);
+
+	std::lock_guard<std::recursive_mutex> lock(node->node_lock);
+
+	node->changeSetListeners.erase(
+		std::remove(node->changeSetListeners.begin(), node->changeSetListeners.end(), listener),
+		node->changeSetListeners.end());
+}
+
+void sshsNodeRemoveAllAttributeChangeSetListeners(sshsNode node) {
+	std::lock_guard<std::recursive_mutex> lock(node->node_lock);
+
+	node->changeSetListeners.clear();
+}
+
+sshsNodeTransaction sshsNodeTransactionBegin(sshsNode node) {
+	sshsNodeTransaction transaction = new (std::nothrow) sshs_node_transaction();
+	sshsMemoryCheck(transaction, __func__);
+
+	transaction->node = node;
+
+	return (transaction);
+}
+
+void sshsNodeTransactionPut(sshsNodeTransaction transaction, const char *key, enum sshs_node_attr_value_type type,
+	union sshs_node_attr_value value) {
+	sshs_value val;
+	val.fromCUnion(value, type);
+
+	// Later puts to the same attribute replace earlier ones.
+	for (auto &change : transaction->changes) {
+		if ((change.first == key) && (change.second.getType() == type)) {
+			change.second = val;
+			return;
+		}
+	}
+
+	transaction->changes.emplace_back(key, val);
+}
+
+// For more precise failure reason, look at errno.
+bool sshsNodeTransactionPutFromString(
+	sshsNodeTransaction transaction, const char *key, const char *typeStr, const char *valueStr) {
+	enum sshs_node_attr_value_type type = sshsHelperCppStringToTypeConverter(typeStr);
+
+	if (type == SSHS_UNKNOWN) {
+		errno = EINVAL;
+		return (false);
+	}
+
+	if ((type == SSHS_STRING) && (valueStr == nullptr)) {
+		// Empty string.
+		valueStr = "";
+	}
+
+	sshs_value value;
+	try {
+		value = sshsHelperCppStringToValueConverter(type, valueStr);
+	}
+	catch (const std::invalid_argument &) {
+		errno = EINVAL;
+		return (false);
+	}
+	catch (const std::out_of_range &) {
+		errno = EINVAL;
+		return (false);
+	}
+
+	union sshs_node_attr_value uValue = value.toCUnion(true);
+	sshsNodeTransactionPut(transaction, key, type, uValue);
+
+	return (true);
+}
+
+// Apply all puts atomically, or none of them. The transaction is freed.
+// For more precise failure reason, look at errno: ENOENT (attribute does
+// not exist), EPERM (read-only) or ERANGE (value out of range).
+bool sshsNodeTransactionCommit(sshsNodeTransaction transaction) {
+	bool result = transaction->node->putAttributes(transaction->changes);
+
+	int savedErrno = errno;
+	delete transaction;
+	errno = savedErrno;
+
+	return (result);
+}
+
+void sshsNodeTransactionAbort(sshsNodeTransaction transaction) {
+	delete transaction;
+}
+
 void sshsNodeTransactionLock(sshsNode node) {
 	node->node_lock.lock();
 }
 
+bool sshsNodeTransactionTryLock(sshsNode node) {
+	return (node->node_lock.try_lock());
+}
+
 void sshsNodeTransactionUnlock(sshsNode node) {
 	node->node_lock.unlock();
 }
@@ -622,6 +949,7 @@ void sshsNodeClearSubTree(sshsNode startNode, bool clearStartNode) {
 	if (clearStartNode) {
 		sshsNodeRemoveAllAttributes(startNode);
 		sshsNodeRemoveAllAttributeListeners(startNode);
+		sshsNodeRemoveAllAttributeChangeSetListeners(startNode);
 	}
 
 	// Recurse down children and remove all attributes.
@@ -639,15 +967,19 @@ void sshsNodeClearSubTree(sshsNode startNode, bool clearStartNode) {
 // be in the process of getting one, to this node or any of its children.
 // You need to make sure of this in your application!
 void sshsNodeRemoveNode(sshsNode node) {
-	std::lock_guard<std::recursive_mutex> lockNode(node->node_lock);
+	{
+		std::lock_guard<std::recursive_mutex> lockNode(node->node_lock);
 
-	// Now we can clear the subtree from all attribute related data.
-	sshsNodeClearSubTree(node, true);
+		// Now we can clear the subtree from all attribute related data.
+		sshsNodeClearSubTree(node, true);
 
-	// And finally remove the node related data and the node itself.
-	sshsNodeRemoveSubTree(node);
+		// And finally remove the node related data and the node itself.
+		sshsNodeRemoveSubTree(node);
+	}
 
 	// If this is the root node (parent == nullptr), it isn't fully removed.
+	// The node's own lock must be released first: the parent is locked next,
+	// and unlinking frees the node, lock included.
 	if (node->parent != nullptr) {
 		// Unlink this node from the parent.
 		// This also destroys the memory associated with the node.
@@ -675,41 +1007,63 @@ static void sshsNodeRemoveSubTree(sshsNode node) {
 // children, attributes, and listeners for the child to be removed
 // must be cleaned up prior to this call.
 static void sshsNodeRemoveChild(sshsNode node, const std::string childName) {
-	std::unique_lock<std::shared_timed_mutex> lock(node->traversal_lock);
-	std::lock_guard<std::recursive_mutex> lockNode(node->node_lock);
+	sshsNode childNode = nullptr;
 
-	if (!node->children.count(childName)) {
-		// Verify that a valid node exists, else simply return
-		// without doing anything. Node was already deleted.
-		return;
-	}
+	{
+		std::unique_lock<std::shared_timed_mutex> lock(node->traversal_lock);
+		std::lock_guard<std::recursive_mutex> lockNode(node->node_lock);
 
-	// Listener support.
-	for (const auto &l : node->nodeListeners) {
-		(*l.getListener())(node, l.getUserData(), SSHS_CHILD_NODE_REMOVED, childName.c_str());
-	}
+		const sshsNode *child = node->children.find(childName);
 
-	sshsNodeDestroy(node->children[childName]);
+		if (child == nullptr) {
+			// Verify that a valid node exists, else simply return
+			// without doing anything. Node was already deleted.
+			return;
+		}
+
+		childNode = *child;
 
-	// Remove attribute from node.
-	node->children.erase(childName);
+		// Listener support.
+		for (const auto &l : node->nodeListeners) {
+			(*l.getListener())(node, l.getUserData(), SSHS_CHILD_NODE_REMOVED, childName.c_str());
+		}
+
+		// Remove child from node.
+		node->children.erase(childName);
+	}
+
+	// Destroy only once the parent's locks are released: this waits on the
+	// child's lock, which notification delivery holds while its listeners
+	// may be locking the parent.
+	sshsNodeDestroy(childNode);
 }
 
 // children, attributes, and listeners for the children to be removed
 // must be cleaned up prior to this call.
 static void sshsNodeRemoveAllChildren(sshsNode node) {
-	std::unique_lock<std::shared_timed_mutex> lock(node->traversal_lock);
-	std::lock_guard<std::recursive_mutex> lockNode(node->node_lock);
+	std::vector<sshsNode> childNodes;
 
-	for (const auto &child : node->children) {
-		for (const auto &l : node->nodeListeners) {
-			(*l.getListener())(node, l.getUserData(), SSHS_CHILD_NODE_REMOVED, child.first.c_str());
+	{
+		std::unique_lock<std::shared_timed_mutex> lock(node->traversal_lock);
+		std::lock_guard<std::recursive_mutex> lockNode(node->node_lock);
+
+		childNodes.reserve(node->children.size());
+
+		for (const auto child : node->children.sortedEntries()) {
+			for (const auto &l : node->nodeListeners) {
+				(*l.getListener())(node, l.getUserData(), SSHS_CHILD_NODE_REMOVED, child->getKey().c_str());
+			}
+
+			childNodes.push_back(child->getValue());
 		}
 
-		sshsNodeDestroy(child.second);
+		node->children.clear();
 	}
 
-	node->children.clear();
+	// Destroy only once the parent's locks are released, see sshsNodeRemoveChild().
+	for (const auto childNode : childNodes) {
+		sshsNodeDestroy(childNode);
+	}
 }
 
 void sshsNodeAddAttributeReadModifier(sshsNode node, const char *key, enum sshs_node_attr_value_type type,
@@ -724,8 +1078,20 @@ void sshsNodeRemoveAttributeReadModifier(sshsNode node, const char *key, enum ss
 void sshsNodeRemoveAllAttributeReadModifiers(sshsNode node) {
 	std::lock_guard<std::recursive_mutex> lockNode(node->node_lock);
 
+	// Removing calls each read modifier one last time, and those could add
+	// attributes while we iterate, so collect the ones to update first.
+	std::vector<std::pair<std::string, enum sshs_node_attr_value_type>> withReadModifier;
+
 	for (const auto &attr : node->attributes) {
-		node->removeAttributeReadModifier(attr.first, attr.second.getValue().getType());
+		if (attr.getValue().getReadModifier().first != nullptr) {
+			withReadModifier.emplace_back(attr.getKey(), attr.getValue().getValue().getType());
+		}
+	}
+
+	for (const auto &attr : withReadModifier) {
+		if (node->findAttribute(attr.first, attr.second) != nullptr) {
+			node->removeAttributeReadModifier(attr.first, attr.second);
+		}
 	}
 }
 
@@ -1005,8 +1371,8 @@ static boost::property_tree::ptree sshsNodeGenerateXML(sshsNode node, bool recur
 	if (recursive) {
 		std::shared_lock<std::shared_timed_mutex> lock(node->traversal_lock);
 
-		for (const auto &child : node->children) {
-			auto childContent = sshsNodeGenerateXML(child.second, recursive);
+		for (const auto child : node->children.sortedEntries()) {
+			auto childContent = sshsNodeGenerateXML(child->getValue(), recursive);
 
 			if (!childContent.empty()) {
 				// Only add in nodes that have content (attributes or other nodes).
@@ -1019,17 +1385,19 @@ static boost::property_tree::ptree sshsNodeGenerateXML(sshsNode node, bool recur
 
 	// Then it's attributes (key:value pairs).
 	auto attrFirstIterator = content.begin();
-	for (const auto &attr : node->attributes) {
+	for (const auto attrEntry : node->attributes.sortedEntries()) {
+		const sshs_node_attr &attr = attrEntry->getValue();
+
 		// If an attribute is marked NO_EXPORT, we skip it.
-		if (attr.second.isFlagSet(SSHS_FLAGS_NO_EXPORT)) {
+		if (attr.isFlagSet(SSHS_FLAGS_NO_EXPORT)) {
 			continue;
 		}
 
-		const std::string type  = sshsHelperCppTypeToStringConverter(attr.second.getValue().getType());
-		const std::string value = sshsHelperCppValueToStringConverter(attr.second.getModifiedValue(attr.first));
+		const std::string type  = sshsHelperCppTypeToStringConverter(attr.getValue().getType());
+		const std::string value = sshsHelperCppValueToStringConverter(attr.getModifiedValue(attrEntry->getKey()));
 
 		boost::property_tree::ptree attrNode(value);
-		attrNode.put("<xmlattr>.key", attr.first);
+		attrNode.put("<xmlattr>.key", attrEntry->getKey());
 		attrNode.put("<xmlattr>.type", type);
 
 		// Attributes should be in order, but at the start of the node (before
@@ -1184,115 +1552,521 @@ static void sshsNodeConsumeXML(sshsNode node, const boost::property_tree::ptree
 	}
 }
 
-// For more precise failure reason, look at errno.
-bool sshsNodeStringToAttributeConverter(sshsNode node, const char *key, const char *typeStr, const char *valueStr) {
-	// Parse the values according to type and put them in the node.
-	enum sshs_node_attr_value_type type;
-	type = sshsHelperCppStringToTypeConverter(typeStr);
+// Binary snapshot format, a compact alternative to XML for fast load and
+// write-back of whole trees. Same content as the XML export (no NO_EXPORT
+// attributes, no empty nodes). All integers are little-endian.
+//   header: magic "SSHSBIN\0", uint32 version, uint32 reserved (0), uint64 payload length
+//   node:   uint16 name length, name, uint32 attribute count, attributes, uint32 child count, children
+//   attr:   uint16 key length, key, uint8 type, value (BOOL/BYTE 1, SHORT 2, INT/FLOAT 4, LONG/DOUBLE 8 bytes,
+//           STRING uint32 length + bytes)
+// Floating-point values are stored as their IEEE-754 bit patterns.
+static const char SSHS_BINARY_MAGIC[8] = {'S', 'S', 'H', 'S', 'B', 'I', 'N', '\0'};
+#define SSHS_BINARY_VERSION 1
+#define SSHS_BINARY_HEADER_SIZE 24
 
-	if (type == SSHS_UNKNOWN) {
-		errno = EINVAL;
-		return (false);
+class sshs_binary_writer {
+private:
+	std::string buffer;
+
+public:
+	template<typename T> void putUnsigned(T v) {
+		for (size_t i = 0; i < sizeof(T); i++) {
+			buffer.push_back(static_cast<char>(static_cast<uint8_t>(v >> (i * 8))));
+		}
 	}
 
-	if ((type == SSHS_STRING) && (valueStr == nullptr)) {
-		// Empty string.
-		valueStr = "";
+	void putBytes(const char *data, size_t length) {
+		buffer.append(data, length);
 	}
 
-	sshs_value value;
-	try {
-		value = sshsHelperCppStringToValueConverter(type, valueStr);
+	void putString16(const std::string &str) {
+		putUnsigned(static_cast<uint16_t>(str.length()));
+		putBytes(str.data(), str.length());
 	}
-	catch (const std::invalid_argument &) {
-		errno = EINVAL;
-		return (false);
+
+	// Overwrite an already written uint32, used for counts known only later.
+	void patchUint32(size_t offset, uint32_t v) {
+		for (size_t i = 0; i < sizeof(uint32_t); i++) {
+			buffer[offset + i] = static_cast<char>(static_cast<uint8_t>(v >> (i * 8)));
+		}
 	}
-	catch (const std::out_of_range &) {
-		errno = EINVAL;
+
+	void truncate(size_t length) {
+		buffer.resize(length);
+	}
+
+	size_t size() const noexcept {
+		return (buffer.size());
+	}
+
+	const std::string &data() const noexcept {
+		return (buffer);
+	}
+};
+
+class sshs_binary_reader {
+private:
+	const uint8_t *curr;
+	const uint8_t *end;
+
+public:
+	sshs_binary_reader(const uint8_t *data, size_t length) : curr(data), end(data + length) {
+	}
+
+	template<typename T> T getUnsigned() {
+		if (remaining() < sizeof(T)) {
+			throw std::out_of_range("unexpected end of binary data.");
+		}
+
+		T v = 0;
+		for (size_t i = 0; i < sizeof(T); i++) {
+			v = static_cast<T>(v | (static_cast<T>(curr[i]) << (i * 8)));
+		}
+
+		curr += sizeof(T);
+		return (v);
+	}
+
+	std::string getString(size_t length) {
+		if (remaining() < length) {
+			throw std::out_of_range("unexpected end of binary data.");
+		}
+
+		std::string str(reinterpret_cast<const char *>(curr), length);
+
+		curr += length;
+		return (str);
+	}
+
+	std::string getString16() {
+		return (getString(getUnsigned<uint16_t>()));
+	}
+
+	size_t remaining() const noexcept {
+		return (static_cast<size_t>(end - curr));
+	}
+};
+
+static bool sshsNodeGenerateBinary(sshsNode node, sshs_binary_writer &out) {
+	const size_t nodeStart = out.size();
+
+	out.putString16(node->name);
+
+	// Attribute count is patched in after filtering out NO_EXPORT ones.
+	const size_t attrCountOffset = out.size();
+	out.putUnsigned(static_cast<uint32_t>(0));
+
+	uint32_t attrCount = 0;
+
+	{
+		std::lock_guard<std::recursive_mutex> lockNode(node->node_lock);
+
+		for (const auto attrEntry : node->attributes.sortedEntries()) {
+			const sshs_node_attr &attr = attrEntry->getValue();
+
+			// If an attribute is marked NO_EXPORT, we skip it.
+			if (attr.isFlagSet(SSHS_FLAGS_NO_EXPORT)) {
+				continue;
+			}
+
+			const sshs_value value = attr.getModifiedValue(attrEntry->getKey());
+
+			out.putString16(attrEntry->getKey());
+			out.putUnsigned(static_cast<uint8_t>(value.getType()));
+
+			switch (value.getType()) {
+				case SSHS_BOOL:
+					out.putUnsigned(static_cast<uint8_t>(value.getBool()));
+					break;
+
+				case SSHS_BYTE:
+					out.putUnsigned(static_cast<uint8_t>(value.getByte()));
+					break;
+
+				case SSHS_SHORT:
+					out.putUnsigned(static_cast<uint16_t>(value.getShort()));
+					break;
+
+				case SSHS_INT:
+					out.putUnsigned(static_cast<uint32_t>(value.getInt()));
+					break;
+
+				case SSHS_LONG:
+					out.putUnsigned(static_cast<uint64_t>(value.getLong()));
+					break;
+
+				case SSHS_FLOAT: {
+					float f = value.getFloat();
+					uint32_t bits;
+					memcpy(&bits, &f, sizeof(bits));
+					out.putUnsigned(bits);
+					break;
+				}
+
+				case SSHS_DOUBLE: {
+					double d = value.getDouble();
+					uint64_t bits;
+					memcpy(&bits, &d, sizeof(bits));
+					out.putUnsigned(bits);
+					break;
+				}
+
+				case SSHS_STRING:
+					out.putUnsigned(static_cast<uint32_t>(value.getString().length()));
+					out.putBytes(value.getString().data(), value.getString().length());
+					break;
+
+				case SSHS_UNKNOWN:
+				default:
+					break;
+			}
+
+			attrCount++;
+		}
+	}
+
+	out.patchUint32(attrCountOffset, attrCount);
+
+	const size_t childCountOffset = out.size();
+	out.putUnsigned(static_cast<uint32_t>(0));
+
+	uint32_t childCount = 0;
+
+	{
+		std::shared_lock<std::shared_timed_mutex> lock(node->traversal_lock);
+
+		for (const auto child : node->children.sortedEntries()) {
+			if (sshsNodeGenerateBinary(child->getValue(), out)) {
+				childCount++;
+			}
+		}
+	}
+
+	out.patchUint32(childCountOffset, childCount);
+
+	// Only keep nodes that have content (attributes or other nodes),
+	// so that empty nodes are really empty, like in XML.
+	if ((attrCount == 0) && (childCount == 0)) {
+		out.truncate(nodeStart);
 		return (false);
 	}
 
-	// IFF attribute already exists, we update it using sshsNodePut(), else
-	// we create the attribute with maximum range and a default description.
-	// These XMl-loaded attributes are also marked NO_EXPORT.
-	// This happens on XML load only. More restrictive ranges and flags can be
-	// enabled later by calling sshsNodeCreate*() again as needed.
-	bool result = false;
+	return (true);
+}
 
-	if (node->attributeExists(key, type)) {
-		result = node->putAttribute(key, value);
+bool sshsNodeExportSubTreeToBinary(sshsNode node, int fd) {
+	sshs_binary_writer payload;
+
+	if (!sshsNodeGenerateBinary(node, payload)) {
+		// Empty root node: still write it, so the snapshot is valid.
+		payload.putString16(node->name);
+		payload.putUnsigned(static_cast<uint32_t>(0));
+		payload.putUnsigned(static_cast<uint32_t>(0));
 	}
-	else {
-		// Create never fails, it may exit the program, but not fail!
-		result = true;
-		struct sshs_node_attr_ranges ranges;
+
+	sshs_binary_writer header;
+	header.putBytes(SSHS_BINARY_MAGIC, sizeof(SSHS_BINARY_MAGIC));
+	header.putUnsigned(static_cast<uint32_t>(SSHS_BINARY_VERSION));
+	header.putUnsigned(static_cast<uint32_t>(0));
+	header.putUnsigned(static_cast<uint64_t>(payload.size()));
+
+	for (const std::string *block : {&header.data(), &payload.data()}) {
+		const char *data = block->data();
+		size_t length    = block->length();
+
+		while (length > 0) {
+			ssize_t written = write(fd, data, length);
+
+			if (written < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+
+				const std::string errorMsg
+					= std::string("Failed to write binary snapshot to file descriptor. Error: ") + strerror(errno);
+				(*sshsGetGlobalErrorLogCallback())(errorMsg.c_str());
+				return (false);
+			}
+
+			data += written;
+			length -= static_cast<size_t>(written);
+		}
+	}
+
+	return (true);
+}
+
+static void sshsNodeConsumeBinary(sshsNode node, sshs_binary_reader &in) {
+	const uint32_t attrCount = in.getUnsigned<uint32_t>();
+
+	for (uint32_t i = 0; i < attrCount; i++) {
+		const std::string key = in.getString16();
+		const auto type       = static_cast<enum sshs_node_attr_value_type>(in.getUnsigned<uint8_t>());
+
+		sshs_value value;
 
 		switch (type) {
 			case SSHS_BOOL:
-				ranges.min.ilongRange = 0;
-				ranges.max.ilongRange = 0;
-				node->createAttribute(
-					key, value, ranges, SSHS_FLAGS_NORMAL | SSHS_FLAGS_NO_EXPORT, "XML loaded value.");
+				value.setBool(in.getUnsigned<uint8_t>() != 0);
 				break;
 
 			case SSHS_BYTE:
-				ranges.min.ibyteRange = INT8_MIN;
-				ranges.max.ibyteRange = INT8_MAX;
-				node->createAttribute(
-					key, value, ranges, SSHS_FLAGS_NORMAL | SSHS_FLAGS_NO_EXPORT, "XML loaded value.");
+				value.setByte(static_cast<int8_t>(in.getUnsigned<uint8_t>()));
 				break;
 
 			case SSHS_SHORT:
-				ranges.min.ishortRange = INT16_MIN;
-				ranges.max.ishortRange = INT16_MAX;
-				node->createAttribute(
-					key, value, ranges, SSHS_FLAGS_NORMAL | SSHS_FLAGS_NO_EXPORT, "XML loaded value.");
+				value.setShort(static_cast<int16_t>(in.getUnsigned<uint16_t>()));
 				break;
 
 			case SSHS_INT:
-				ranges.min.iintRange = INT32_MIN;
-				ranges.max.iintRange = INT32_MAX;
-				node->createAttribute(
-					key, value, ranges, SSHS_FLAGS_NORMAL | SSHS_FLAGS_NO_EXPORT, "XML loaded value.");
+				value.setInt(static_cast<int32_t>(in.getUnsigned<uint32_t>()));
 				break;
 
 			case SSHS_LONG:
-				ranges.min.ilongRange = INT64_MIN;
-				ranges.max.ilongRange = INT64_MAX;
-				node->createAttribute(
-					key, value, ranges, SSHS_FLAGS_NORMAL | SSHS_FLAGS_NO_EXPORT, "XML loaded value.");
+				value.setLong(static_cast<int64_t>(in.getUnsigned<uint64_t>()));
 				break;
 
-			case SSHS_FLOAT:
-				ranges.min.ffloatRange = -FLT_MAX;
-				ranges.max.ffloatRange = FLT_MAX;
-				node->createAttribute(
-					key, value, ranges, SSHS_FLAGS_NORMAL | SSHS_FLAGS_NO_EXPORT, "XML loaded value.");
+			case SSHS_FLOAT: {
+				uint32_t bits = in.getUnsigned<uint32_t>();
+				float f;
+				memcpy(&f, &bits, sizeof(f));
+				value.setFloat(f);
 				break;
+			}
 
-			case SSHS_DOUBLE:
-				ranges.min.ddoubleRange = -DBL_MAX;
-				ranges.max.ddoubleRange = DBL_MAX;
-				node->createAttribute(
-					key, value, ranges, SSHS_FLAGS_NORMAL | SSHS_FLAGS_NO_EXPORT, "XML loaded value.");
+			case SSHS_DOUBLE: {
+				uint64_t bits = in.getUnsigned<uint64_t>();
+				double d;
+				memcpy(&d, &bits, sizeof(d));
+				value.setDouble(d);
 				break;
+			}
 
 			case SSHS_STRING:
-				ranges.min.stringRange = 0;
-				ranges.max.stringRange = INT32_MAX;
-				node->createAttribute(
-					key, value, ranges, SSHS_FLAGS_NORMAL | SSHS_FLAGS_NO_EXPORT, "XML loaded value.");
+				value.setString(in.getString(in.getUnsigned<uint32_t>()));
 				break;
 
 			case SSHS_UNKNOWN:
-				errno  = EINVAL;
-				result = false;
-				break;
+			default:
+				// Can't know the value length, so nothing after this can be trusted.
+				throw std::invalid_argument("unknown attribute type in binary data.");
+		}
+
+		if (!sshsHelperCppCheckName(key)) {
+			continue;
+		}
+
+		if (!sshsNodePutOrCreateAttribute(node, key, value, "Snapshot loaded value.")) {
+			// Ignore read-only/range errors.
+			if (errno == EPERM || errno == ERANGE) {
+				continue;
+			}
+
+			sshsNodeError("sshsNodeConsumeBinary", key, type, "failed to load attribute from binary snapshot", false);
 		}
 	}
 
-	return (result);
+	const uint32_t childCount = in.getUnsigned<uint32_t>();
+
+	for (uint32_t i = 0; i < childCount; i++) {
+		const std::string childName = in.getString16();
+
+		if (!sshsHelperCppCheckName(childName)) {
+			throw std::invalid_argument("invalid node name in binary data.");
+		}
+
+		// Get the child node.
+		sshsNode childNode = sshsNodeGetChild(node, childName.c_str());
+
+		// If not existing, try to create.
+		if (childNode == nullptr) {
+			childNode = sshsNodeAddChild(node, childName.c_str());
+		}
+
+		// And call recursively.
+		sshsNodeConsumeBinary(childNode, in);
+	}
+}
+
+static bool sshsNodeFromBinaryData(sshsNode node, const uint8_t *data, size_t length, bool strict) {
+	try {
+		sshs_binary_reader in(data, length);
+
+		if (in.getString(sizeof(SSHS_BINARY_MAGIC)) != std::string(SSHS_BINARY_MAGIC, sizeof(SSHS_BINARY_MAGIC))) {
+			throw std::invalid_argument("not an SSHS binary snapshot.");
+		}
+
+		if (in.getUnsigned<uint32_t>() != SSHS_BINARY_VERSION) {
+			throw std::invalid_argument("unsupported SSHS binary version (supported: '1').");
+		}
+
+		in.getUnsigned<uint32_t>(); // Reserved.
+
+		if (in.getUnsigned<uint64_t>() != in.remaining()) {
+			throw std::invalid_argument("payload length doesn't match, snapshot truncated?");
+		}
+
+		const std::string rootNodeName = in.getString16();
+
+		// Strict mode: check if names match.
+		if (strict && (rootNodeName != node->name)) {
+			throw std::invalid_argument("names don't match (required in 'strict' mode).");
+		}
+
+		sshsNodeConsumeBinary(node, in);
+	}
+	catch (const std::logic_error &ex) {
+		const std::string errorMsg = std::string("Invalid binary snapshot content. Exception: ") + ex.what();
+		(*sshsGetGlobalErrorLogCallback())(errorMsg.c_str());
+		return (false);
+	}
+
+	return (true);
+}
+
+bool sshsNodeImportSubTreeFromBinary(sshsNode node, int fd, bool strict) {
+	struct stat fdStat;
+
+	if ((fstat(fd, &fdStat) != 0) || (fdStat.st_size < SSHS_BINARY_HEADER_SIZE)) {
+		(*sshsGetGlobalErrorLogCallback())("Failed to load binary snapshot: file missing or too short.");
+		return (false);
+	}
+
+	const size_t length = static_cast<size_t>(fdStat.st_size);
+
+#if defined(OS_UNIX)
+	// Map the snapshot directly, there is no parsing stage besides walking it.
+	void *data = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+
+	if (data != MAP_FAILED) {
+		bool result = sshsNodeFromBinaryData(node, static_cast<const uint8_t *>(data), length, strict);
+
+		munmap(data, length);
+
+		return (result);
+	}
+#endif
+
+	// Fall back to reading it all into memory.
+	std::vector<uint8_t> buffer(length);
+	size_t readBytes = 0;
+
+	while (readBytes < length) {
+		ssize_t result = read(fd, buffer.data() + readBytes, length - readBytes);
+
+		if (result <= 0) {
+			if ((result < 0) && (errno == EINTR)) {
+				continue;
+			}
+
+			(*sshsGetGlobalErrorLogCallback())("Failed to load binary snapshot: read error.");
+			return (false);
+		}
+
+		readBytes += static_cast<size_t>(result);
+	}
+
+	return (sshsNodeFromBinaryData(node, buffer.data(), length, strict));
+}
+
+// For more precise failure reason, look at errno.
+bool sshsNodeStringToAttributeConverter(sshsNode node, const char *key, const char *typeStr, const char *valueStr) {
+	// Parse the values according to type and put them in the node.
+	enum sshs_node_attr_value_type type;
+	type = sshsHelperCppStringToTypeConverter(typeStr);
+
+	if (type == SSHS_UNKNOWN) {
+		errno = EINVAL;
+		return (false);
+	}
+
+	if ((type == SSHS_STRING) && (valueStr == nullptr)) {
+		// Empty string.
+		valueStr = "";
+	}
+
+	sshs_value value;
+	try {
+		value = sshsHelperCppStringToValueConverter(type, valueStr);
+	}
+	catch (const std::invalid_argument &) {
+		errno = EINVAL;
+		return (false);
+	}
+	catch (const std::out_of_range &) {
+		errno = EINVAL;
+		return (false);
+	}
+
+	return (sshsNodePutOrCreateAttribute(node, key, value, "XML loaded value."));
+}
+
+// IFF attribute already exists, we update it using sshsNodePut(), else
+// we create the attribute with maximum range and a default description.
+// These loaded attributes are also marked NO_EXPORT.
+// This happens on XML/binary load only. More restrictive ranges and flags can
+// be enabled later by calling sshsNodeCreate*() again as needed.
+static bool sshsNodePutOrCreateAttribute(
+	sshsNode node, const std::string &key, const sshs_value &value, const std::string &description) {
+	enum sshs_node_attr_value_type type = value.getType();
+
+	if (node->attributeExists(key, type)) {
+		return (node->putAttribute(key, value));
+	}
+
+	struct sshs_node_attr_ranges ranges;
+
+	switch (type) {
+		case SSHS_BOOL:
+			ranges.min.ilongRange = 0;
+			ranges.max.ilongRange = 0;
+			break;
+
+		case SSHS_BYTE:
+			ranges.min.ibyteRange = INT8_MIN;
+			ranges.max.ibyteRange = INT8_MAX;
+			break;
+
+		case SSHS_SHORT:
+			ranges.min.ishortRange = INT16_MIN;
+			ranges.max.ishortRange = INT16_MAX;
+			break;
+
+		case SSHS_INT:
+			ranges.min.iintRange = INT32_MIN;
+			ranges.max.iintRange = INT32_MAX;
+			break;
+
+		case SSHS_LONG:
+			ranges.min.ilongRange = INT64_MIN;
+			ranges.max.ilongRange = INT64_MAX;
+			break;
+
+		case SSHS_FLOAT:
+			ranges.min.ffloatRange = -FLT_MAX;
+			ranges.max.ffloatRange = FLT_MAX;
+			break;
+
+		case SSHS_DOUBLE:
+			ranges.min.ddoubleRange = -DBL_MAX;
+			ranges.max.ddoubleRange = DBL_MAX;
+			break;
+
+		case SSHS_STRING:
+			ranges.min.stringRange = 0;
+			ranges.max.stringRange = INT32_MAX;
+			break;
+
+		case SSHS_UNKNOWN:
+		default:
+			errno = EINVAL;
+			return (false);
+	}
+
+	// Create never fails, it may exit the program, but not fail!
+	node->createAttribute(key, value, ranges, SSHS_FLAGS_NORMAL | SSHS_FLAGS_NO_EXPORT, description);
+
+	return (true);
 }
 
 // Remember to free the resulting array.
@@ -1305,15 +2079,16 @@ const char **sshsNodeGetChildNames(sshsNode node, size_t *numNames) {
 		return (nullptr);
 	}
 
-	size_t numChildren = node->children.size();
+	const auto children = node->children.sortedEntries();
+	size_t numChildren  = children.size();
 
 	// Nodes can be deleted, so we copy the string's contents into
 	// memory that will be guaranteed to exist.
 	size_t childNamesLength = 0;
 
-	for (const auto &child : node->children) {
+	for (const auto child : children) {
 		// Length plus one for terminating NUL byte.
-		childNamesLength += child.first.length() + 1;
+		childNamesLength += child->getKey().length() + 1;
 	}
 
 	char **childNames = (char **) malloc((numChildren * sizeof(char *)) + childNamesLength);
@@ -1322,14 +2097,14 @@ const char **sshsNodeGetChildNames(sshsNode node, size_t *numNames) {
 	size_t offset = (numChildren * sizeof(char *));
 
 	size_t i = 0;
-	for (const auto &child : node->children) {
+	for (const auto child : children) {
 		// We have all the memory, so now copy the strings over and set the
 		// pointers as if an array of pointers was the only result.
 		childNames[i] = (char *) (((uint8_t *) childNames) + offset);
-		strcpy(childNames[i], child.first.c_str());
+		strcpy(childNames[i], child->getKey().c_str());
 
 		// Length plus one for terminating NUL byte.
-		offset += child.first.length() + 1;
+		offset += child->getKey().length() + 1;
 		i++;
 	}
 
@@ -1347,15 +2122,16 @@ const char **sshsNodeGetAttributeKeys(sshsNode node, size_t *numKeys) {
 		return (nullptr);
 	}
 
-	size_t numAttributes = node->attributes.size();
+	const auto attributes = node->attributes.sortedEntries();
+	size_t numAttributes  = attributes.size();
 
 	// Attributes can be deleted, so we copy the key string's contents into
 	// memory that will be guaranteed to exist.
 	size_t attributeKeysLength = 0;
 
-	for (const auto &attr : node->attributes) {
+	for (const auto attr : attributes) {
 		// Length plus one for terminating NUL byte.
-		attributeKeysLength += attr.first.length() + 1;
+		attributeKeysLength += attr->getKey().length() + 1;
 	}
 
 	char **attributeKeys = (char **) malloc((numAttributes * sizeof(char *)) + attributeKeysLength);
@@ -1364,14 +2140,14 @@ const char **sshsNodeGetAttributeKeys(sshsNode node, size_t *numKeys) {
 	size_t offset = (numAttributes * sizeof(char *));
 
 	size_t i = 0;
-	for (const auto &attr : node->attributes) {
+	for (const auto attr : attributes) {
 		// We have all the memory, so now copy the strings over and set the
 		// pointers as if an array of pointers was the only result.
 		attributeKeys[i] = (char *) (((uint8_t *) attributeKeys) + offset);
-		strcpy(attributeKeys[i], attr.first.c_str());
+		strcpy(attributeKeys[i], attr->getKey().c_str());
 
 		// Length plus one for terminating NUL byte.
-		offset += attr.first.length() + 1;
+		offset += attr->getKey().length() + 1;
 		i++;
 	}
 
@@ -1383,7 +2159,9 @@ const char **sshsNodeGetAttributeKeys(sshsNode node, size_t *numKeys) {
 enum sshs_node_attr_value_type *sshsNodeGetAttributeTypes(sshsNode node, const char *key, size_t *numTypes) {
 	std::lock_guard<std::recursive_mutex> lockNode(node->node_lock);
 
-	if (!node->attributes.count(key)) {
+	const sshs_node_attr *attr = node->attributes.find(key);
+
+	if (attr == nullptr) {
 		*numTypes = 0;
 		errno     = ENOENT;
 		return (nullptr);
@@ -1396,7 +2174,7 @@ enum sshs_node_attr_value_type *sshsNodeGetAttributeTypes(sshsNode node, const c
 
 	// Check each attribute if it matches, and save its type if true.
 	// We only support one type per attribute key here.
-	attributeTypes[0] = node->attributes[key].getValue().getType();
+	attributeTypes[0] = attr->getValue().getType();
 
 	*numTypes = 1;
 	return (attributeTypes);
@@ -1406,32 +2184,21 @@ struct sshs_node_attr_ranges sshsNodeGetAttributeRanges(
 	sshsNode node, const char *key, enum sshs_node_attr_value_type type) {
 	std::lock_guard<std::recursive_mutex> lockNode(node->node_lock);
 
-	if (!node->attributeExists(key, type)) {
-		sshsNodeErrorNoAttribute("sshsNodeGetAttributeRanges", key, type);
-	}
-
-	return (node->attributes[key].getRanges());
+	return (node->getExistingAttribute("sshsNodeGetAttributeRanges", key, type).getRanges());
 }
 
 int sshsNodeGetAttributeFlags(sshsNode node, const char *key, enum sshs_node_attr_value_type type) {
 	std::lock_guard<std::recursive_mutex> lockNode(node->node_lock);
 
-	if (!node->attributeExists(key, type)) {
-		sshsNodeErrorNoAttribute("sshsNodeGetAttributeFlags", key, type);
-	}
-
-	return (node->attributes[key].getFlags());
+	return (node->getExistingAttribute("sshsNodeGetAttributeFlags", key, type).getFlags());
 }
 
 // Remember to free the resulting string.
 char *sshsNodeGetAttributeDescription(sshsNode node, const char *key, enum sshs_node_attr_value_type type) {
 	std::lock_guard<std::recursive_mutex> lockNode(node->node_lock);
 
-	if (!node->attributeExists(key, type)) {
-		sshsNodeErrorNoAttribute("sshsNodeGetAttributeDescription", key, type);
-	}
-
-	char *descriptionCopy = strdup(node->attributes[key].getDescription().c_str());
+	char *descriptionCopy
+		= strdup(node->getExistingAttribute("sshsNodeGetAttributeDescription", key, type).getDescription().c_str());
 	sshsMemoryCheck(descriptionCopy, __func__);
 
 	return (descriptionCopy);
@@ -0,0 +1,279 @@
+#include "sshs_notifier.hpp"
+
+// Set while the current thread is delivering notifications.
+static thread_local bool sshsNotifierDispatching = false;
+
+sshs_notifier::sshs_notifier() : mode(SSHS_DISPATCH_SYNCHRONOUS), dispatchThreadStop(false), changeCount(0) {
+}
+
+sshs_notifier::~sshs_notifier() {
+	setMode(SSHS_DISPATCH_SYNCHRONOUS);
+}
+
+enum sshs_listener_dispatch_mode sshs_notifier::getMode() {
+	std::lock_guard<std::mutex> lock(queueLock);
+
+	return (mode);
+}
+
+// Must not be called from inside a listener, as that could join the
+// dispatch thread from itself.
+void sshs_notifier::setMode(enum sshs_listener_dispatch_mode newMode) {
+	std::lock_guard<std::mutex> modeGuard(modeLock);
+
+	enum sshs_listener_dispatch_mode oldMode;
+
+	{
+		std::lock_guard<std::mutex> lock(queueLock);
+
+		oldMode = mode;
+		mode    = newMode;
+	}
+
+	if (oldMode == newMode) {
+		return;
+	}
+
+	if (oldMode == SSHS_DISPATCH_THREAD) {
+		threadStop();
+	}
+
+	if (newMode == SSHS_DISPATCH_THREAD) {
+		threadStart();
+	}
+	else if (newMode == SSHS_DISPATCH_SYNCHRONOUS) {
+		// Nothing is queued from now on, deliver what's left. Nodes locked by
+		// others are skipped by dispatch(), so retry until all is delivered.
+		while (hasPending()) {
+			if (dispatch() == 0) {
+				std::unique_lock<std::mutex> lock(queueLock);
+				queueCond.wait_for(lock, std::chrono::milliseconds(1));
+			}
+		}
+	}
+}
+
+bool sshs_notifier::hasPending() {
+	std::lock_guard<std::mutex> lock(queueLock);
+
+	return (!pending.empty());
+}
+
+// Returns false if the notification was not queued, because the tree is in
+// synchronous mode. The caller must then call the listeners itself.
+bool sshs_notifier::enqueue(sshsNode node, const std::string &key, enum sshs_node_attribute_events event,
+	const sshs_value &value, bool coalesce) {
+	std::lock_guard<std::mutex> lock(queueLock);
+
+	if (mode == SSHS_DISPATCH_SYNCHRONOUS) {
+		return (false);
+	}
+
+	const std::string *internedKey = sshsInternString(key);
+	const auto indexKey            = std::make_pair(node, internedKey);
+
+	// Coalesce with a still pending modification of the same attribute.
+	if (coalesce && event == SSHS_ATTRIBUTE_MODIFIED) {
+		const auto idx = pendingIndex.find(indexKey);
+
+		if (idx != pendingIndex.end()) {
+			pending[idx->second].value = value;
+			return (true);
+		}
+	}
+
+	pending.push_back(sshs_notification{node, internedKey, event, value, coalesce});
+
+	if (coalesce && event == SSHS_ATTRIBUTE_MODIFIED) {
+		pendingIndex[indexKey] = pending.size() - 1;
+	}
+	else {
+		// Anything else ends the coalescing window for this attribute,
+		// so listeners still see ADDED/REMOVED in the right order.
+		pendingIndex.erase(indexKey);
+	}
+
+	if (mode == SSHS_DISPATCH_THREAD) {
+		queueCond.notify_one();
+	}
+
+	return (true);
+}
+
+// Deliver all currently pending notifications on the calling thread.
+// Must not be called while holding any node lock. Notifications for nodes
+// currently locked by somebody else are put back, in order, to be delivered
+// by a later call. Returns the number of notifications delivered.
+size_t sshs_notifier::dispatch() {
+	// Listeners calling back into dispatch() are ignored, the outer call
+	// is already delivering everything.
+	if (sshsNotifierDispatching) {
+		return (0);
+	}
+
+	std::lock_guard<std::mutex> dispatchGuard(dispatchLock);
+	std::unique_lock<std::mutex> lock(queueLock);
+
+	if (pending.empty()) {
+		return (0);
+	}
+
+	sshsNotifierDispatching = true;
+
+	inFlight.swap(pending);
+	pendingIndex.clear();
+
+	size_t delivered = 0;
+
+	// Nodes whose notifications are put back for later. Once one notification
+	// for a node is put back, all later ones must be too. They stay in inFlight
+	// until the end, so purge() can still find them.
+	std::vector<sshsNode> deferredNodes;
+
+	for (size_t i = 0; i < inFlight.size(); i++) {
+		sshsNode node = inFlight[i].node;
+
+		if (node == nullptr) {
+			// Node was removed in the meantime.
+			continue;
+		}
+
+		// Writers hold the node lock while taking the queue lock, so we can
+		// only try here. Holding the queue lock while locking the node
+		// guarantees purge() can't destroy the node under us.
+		if (std::find(deferredNodes.cbegin(), deferredNodes.cend(), node) != deferredNodes.cend()) {
+			continue;
+		}
+
+		if (!sshsNodeTransactionTryLock(node)) {
+			deferredNodes.push_back(node);
+			continue;
+		}
+
+		sshs_notification notification = std::move(inFlight[i]);
+		inFlight[i].node                = nullptr;
+
+		lock.unlock();
+
+		sshsNodeDeliverAttributeNotification(node, notification.event, *notification.key, notification.value);
+
+		sshsNodeTransactionUnlock(node);
+
+		delivered++;
+
+		lock.lock();
+	}
+
+	// Whatever still has a node was put back. Move it in front of anything
+	// queued meanwhile, which is newer. Those entries are never coalesced
+	// into, so the index only needs shifting.
+	inFlight.erase(std::remove_if(inFlight.begin(), inFlight.end(),
+					   [](const sshs_notification &n) { return (n.node == nullptr); }),
+		inFlight.end());
+
+	if (!inFlight.empty()) {
+		for (auto &idx : pendingIndex) {
+			idx.second += inFlight.size();
+		}
+
+		pending.insert(
+			pending.begin(), std::make_move_iterator(inFlight.begin()), std::make_move_iterator(inFlight.end()));
+	}
+
+	inFlight.clear();
+
+	sshsNotifierDispatching = false;
+
+	return (delivered);
+}
+
+// Drop all queued notifications for one attribute. Used before delivering
+// its removal synchronously, so nothing older arrives after it.
+// The node lock must be held, so no delivery to this node can be in progress.
+void sshs_notifier::discard(sshsNode node, const std::string &key) {
+	std::lock_guard<std::mutex> lock(queueLock);
+
+	const std::string *internedKey = sshsInternString(key);
+
+	for (auto &n : pending) {
+		if (n.node == node && n.key == internedKey) {
+			n.node = nullptr;
+		}
+	}
+
+	for (auto &n : inFlight) {
+		if (n.node == node && n.key == internedKey) {
+			n.node = nullptr;
+		}
+	}
+
+	pendingIndex.erase(std::make_pair(node, internedKey));
+}
+
+// Called before a node is destroyed: drop its notifications and wait for
+// an eventual delivery to it to complete.
+void sshs_notifier::purge(sshsNode node) {
+	{
+		std::lock_guard<std::mutex> lock(queueLock);
+
+		for (auto &n : pending) {
+			if (n.node == node) {
+				n.node = nullptr;
+			}
+		}
+
+		for (auto &n : inFlight) {
+			if (n.node == node) {
+				n.node = nullptr;
+			}
+		}
+
+		auto idx = pendingIndex.lower_bound(std::make_pair(node, static_cast<const std::string *>(nullptr)));
+		while (idx != pendingIndex.end() && idx->first.first == node) {
+			idx = pendingIndex.erase(idx);
+		}
+	}
+
+	sshsNodeTransactionLock(node);
+	sshsNodeTransactionUnlock(node);
+}
+
+void sshs_notifier::threadStart() {
+	{
+		std::lock_guard<std::mutex> lock(queueLock);
+		dispatchThreadStop = false;
+	}
+
+	dispatchThread = std::thread([this]() {
+		while (true) {
+			{
+				std::unique_lock<std::mutex> lock(queueLock);
+
+				queueCond.wait(lock, [this]() { return (dispatchThreadStop || !pending.empty()); });
+
+				if (dispatchThreadStop) {
+					break;
+				}
+			}
+
+			// If nothing could be delivered, because all nodes with pending
+			// notifications are locked, wait a bit before trying again.
+			if (dispatch() == 0) {
+				std::unique_lock<std::mutex> lock(queueLock);
+
+				queueCond.wait_for(lock, std::chrono::milliseconds(1), [this]() { return (dispatchThreadStop); });
+			}
+		}
+	});
+}
+
+void sshs_notifier::threadStop() {
+	{
+		std::lock_guard<std::mutex> lock(queueLock);
+		dispatchThreadStop = true;
+	}
+
+	queueCond.notify_all();
+
+	dispatchThread.join();
+}
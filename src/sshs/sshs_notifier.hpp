@@ -0,0 +1,74 @@
+#ifndef SSHS_NOTIFIER_HPP_
+#define SSHS_NOTIFIER_HPP_
+
+#include "sshs_internal.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+struct sshs_notification {
+	sshsNode node; // nullptr if purged.
+	const std::string *key;
+	enum sshs_node_attribute_events event;
+	sshs_value value;
+	bool coalesce;
+};
+
+/**
+ * Per-tree queue for deferred attribute listener calls.
+ * In SSHS_DISPATCH_SYNCHRONOUS mode nothing is queued and nodes call their
+ * listeners directly. In the other modes consecutive modifications of the
+ * same attribute are coalesced into one notification carrying the latest
+ * value, and delivered either by a dedicated thread or by whoever calls
+ * dispatch(). Listeners are always called with the node lock held.
+ * It also counts changes to exported (persistent) content of the tree, so
+ * that configuration write-back can be skipped if nothing changed.
+ */
+class sshs_notifier {
+private:
+	enum sshs_listener_dispatch_mode mode;
+	std::mutex queueLock;
+	std::condition_variable queueCond;
+	std::vector<sshs_notification> pending;
+	std::map<std::pair<sshsNode, const std::string *>, size_t> pendingIndex;
+	std::vector<sshs_notification> inFlight;
+	std::mutex dispatchLock;
+	std::mutex modeLock;
+	std::thread dispatchThread;
+	bool dispatchThreadStop;
+	std::atomic<uint64_t> changeCount;
+
+public:
+	sshs_notifier();
+	~sshs_notifier();
+
+	enum sshs_listener_dispatch_mode getMode();
+	void setMode(enum sshs_listener_dispatch_mode newMode);
+	bool enqueue(sshsNode node, const std::string &key, enum sshs_node_attribute_events event,
+		const sshs_value &value, bool coalesce);
+	size_t dispatch();
+	bool hasPending();
+	void discard(sshsNode node, const std::string &key);
+	void purge(sshsNode node);
+
+	void markChanged() noexcept {
+		changeCount.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	uint64_t getChangeCount() const noexcept {
+		return (changeCount.load(std::memory_order_relaxed));
+	}
+
+private:
+	void threadStart();
+	void threadStop();
+};
+
+#endif /* SSHS_NOTIFIER_HPP_ */
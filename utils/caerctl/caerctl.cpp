@@ -2,19 +2,30 @@
 #include "src/config_server.h"
 #include "utils/ext/linenoise-ng/linenoise.h"
 
+#include <algorithm>
+#include <chrono>
+#include <fstream>
 #include <iostream>
+#include <map>
+#include <set>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include <boost/algorithm/string.hpp>
 #include <boost/algorithm/string/join.hpp>
 #include <boost/asio.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/format.hpp>
 #include <boost/program_options.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/xml_parser.hpp>
 
 namespace asio   = boost::asio;
 namespace asioIP = boost::asio::ip;
 using asioTCP    = boost::asio::ip::tcp;
+using asioStream = boost::asio::generic::stream_protocol;
 namespace po     = boost::program_options;
 
 #if defined(OS_UNIX) && OS_UNIX == 1
@@ -23,6 +34,12 @@ namespace po     = boost::program_options;
 #endif
 
 #define CAERCTL_HISTORY_FILE_NAME ".caer-ctl.history"
+// Maximum number of requests sent ahead of their responses in batch and watch mode.
+#define CAERCTL_PIPELINE_DEPTH 32
+// Default time-to-live of the auto-completion tree cache, in seconds.
+#define CAERCTL_CACHE_TTL 30
+// Shortest update interval of watch and top mode, in milliseconds.
+#define CAERCTL_MIN_INTERVAL 10
 
 static inline boost::filesystem::path getHomeDirectory() {
 	// First query main environment variables: HOME on Unix, USERPROFILE on Windows.
@@ -60,7 +77,11 @@ static inline boost::filesystem::path getHomeDirectory() {
 		boost::system::errc::make_error_code(boost::system::errc::no_such_file_or_directory));
 }
 
-static void handleInputLine(const char *buf, size_t bufLength);
+static bool handleInputLine(const char *buf, size_t bufLength);
+static bool loadBatchFile(const std::string &fileName, std::vector<std::vector<std::string>> &commands);
+static int runBatch(const std::vector<std::vector<std::string>> &commands);
+static int runWatch(const std::vector<std::vector<std::string>> &commands, std::chrono::milliseconds interval);
+static int runTop(std::chrono::milliseconds interval);
 static void handleCommandCompletion(const char *buf, linenoiseCompletions *autoComplete);
 
 static void actionCompletion(const char *buf, size_t bufLength, linenoiseCompletions *autoComplete,
@@ -90,7 +111,25 @@ static const struct {
 static const size_t actionsLength = sizeof(actions) / sizeof(actions[0]);
 
 static asio::io_service ioService;
-static asioTCP::socket netSocket(ioService);
+// Generic socket, so that TCP and Unix domain sockets can both be used.
+static asioStream::socket netSocket(ioService);
+
+struct cachedNode {
+	std::chrono::steady_clock::time_point fetched;
+	// Attribute key -> type -> current value.
+	std::map<std::string, std::map<std::string, std::string>> attributes;
+};
+
+// Local copy of the configuration tree, so that auto-completion doesn't need
+// a round trip to the server on every key press. A node and all its children
+// are fetched with one CAER_CONFIG_DUMP_SUBTREE request, when first needed
+// and again once older than the TTL. Nodes changed by our own commands are
+// marked stale, changes made by others show up after the TTL at the latest.
+// Current values offered as completion are always fetched live.
+static struct {
+	std::map<std::string, cachedNode> nodes;
+	std::chrono::seconds ttl;
+} treeCache;
 
 [[noreturn]] static inline void printHelpAndExit(po::options_description &desc) {
 	std::cout << std::endl << desc << std::endl;
@@ -101,10 +140,28 @@ int main(int argc, char *argv[]) {
 	// Allowed command-line options for caer-ctl.
 	po::options_description cliDescription("Command-line options");
 	cliDescription.add_options()("help,h", "print help text")("ipaddress,i", po::value<std::string>(),
-		"IP-address or hostname to connect to")("port,p", po::value<std::string>(), "port to connect to")("script,s",
+		"IP-address or hostname to connect to")("port,p", po::value<std::string>(), "port to connect to")("unix,u",
+		po::value<std::string>(), "Unix domain socket path to connect to, instead of IP-address and port")("script,s",
 		po::value<std::vector<std::string>>()->multitoken(),
 		"script mode, sends the given command directly to the server as if typed in and exits.\n"
-		"Format: <action> <node> [<attribute> <type> [<value>]]\nExample: set /caer/logger/ logLevel byte 7");
+		"Format: <action> <node> [<attribute> <type> [<value>]]\nExample: set /caer/logger/ logLevel byte 7")(
+		"batch,b", po::value<std::string>(),
+		"batch mode, sends all commands from the given file ('-' for standard input) over one connection, "
+		"pipelined, and exits. Returns failure if any command fails.\n"
+		"Files ending in '.json' hold an array of commands, each either a command string or an object with "
+		"'action', 'node', 'key', 'type' and 'value' members. Files ending in '.xml' are configuration "
+		"exports, all their attributes are put. Anything else is read as one command per line, '#' starts "
+		"a comment.")(
+		"watch,w", po::value<std::vector<std::string>>()->multitoken()->composing(),
+		"watch mode, prints the value of the given attributes periodically until interrupted.\n"
+		"Format: <node> <attribute> <type> [...]\nExample: -w /1-DAVIS/statistics/ muxDroppedDVS long")("top,t",
+		"top mode, shows a periodically updated table of all modules with their status, event rates, run "
+		"times, ring buffer usage and drop counters, until interrupted.")("interval",
+		po::value<int32_t>()->default_value(1000),
+		"watch and top mode update interval, in milliseconds, at least 10")("cache-ttl",
+		po::value<uint32_t>()->default_value(CAERCTL_CACHE_TTL),
+		"seconds after which the configuration tree cached for auto-completion is fetched again, 0 to always "
+		"fetch it on completion");
 
 	po::variables_map cliVarMap;
 	try {
@@ -131,6 +188,11 @@ int main(int argc, char *argv[]) {
 		portNumber = cliVarMap["port"].as<std::string>();
 	}
 
+	std::string unixSocketPath;
+	if (cliVarMap.count("unix")) {
+		unixSocketPath = cliVarMap["unix"].as<std::string>();
+	}
+
 	bool scriptMode = false;
 	if (cliVarMap.count("script")) {
 		std::vector<std::string> commandComponents = cliVarMap["script"].as<std::vector<std::string>>();
@@ -155,6 +217,50 @@ int main(int argc, char *argv[]) {
 		scriptMode = true;
 	}
 
+	std::vector<std::vector<std::string>> batchCommands;
+	if (cliVarMap.count("batch")) {
+		if (scriptMode) {
+			std::cout << "Batch mode cannot be combined with script mode!" << std::endl;
+			printHelpAndExit(cliDescription);
+		}
+
+		if (!loadBatchFile(cliVarMap["batch"].as<std::string>(), batchCommands)) {
+			return (EXIT_FAILURE);
+		}
+	}
+
+	std::vector<std::vector<std::string>> watchCommands;
+	if (cliVarMap.count("watch")) {
+		std::vector<std::string> watchComponents = cliVarMap["watch"].as<std::vector<std::string>>();
+
+		if (scriptMode || cliVarMap.count("batch")) {
+			std::cout << "Watch mode cannot be combined with script or batch mode!" << std::endl;
+			printHelpAndExit(cliDescription);
+		}
+
+		if (watchComponents.empty() || (watchComponents.size() % 3) != 0) {
+			std::cout << "Watch mode needs one or more <node> <attribute> <type> triples!" << std::endl;
+			printHelpAndExit(cliDescription);
+		}
+
+		for (size_t i = 0; i < watchComponents.size(); i += 3) {
+			watchCommands.push_back({"get", watchComponents[i], watchComponents[i + 1], watchComponents[i + 2]});
+		}
+	}
+
+	if (cliVarMap.count("top")) {
+		if (scriptMode || cliVarMap.count("batch") || cliVarMap.count("watch")) {
+			std::cout << "Top mode cannot be combined with script, batch or watch mode!" << std::endl;
+			printHelpAndExit(cliDescription);
+		}
+	}
+
+	// Negative values would otherwise wrap around to huge intervals.
+	if (cliVarMap["interval"].as<int32_t>() < CAERCTL_MIN_INTERVAL) {
+		std::cout << "Update interval must be at least " << CAERCTL_MIN_INTERVAL << " milliseconds!" << std::endl;
+		printHelpAndExit(cliDescription);
+	}
+
 	// Generate command history file path (in user home).
 	boost::filesystem::path commandHistoryFilePath;
 
@@ -169,20 +275,69 @@ int main(int argc, char *argv[]) {
 	commandHistoryFilePath.append(CAERCTL_HISTORY_FILE_NAME, boost::filesystem::path::codecvt());
 
 	// Connect to the remote cAER config server.
-	try {
-		asioTCP::resolver resolver(ioService);
-		asio::connect(netSocket, resolver.resolve({ipAddress, portNumber}));
-	}
-	catch (const boost::system::system_error &ex) {
-		boost::format exMsg = boost::format("Failed to connect to %s:%s, error message is:\n\t%s.") % ipAddress
-							  % portNumber % ex.what();
-		std::cerr << exMsg.str() << std::endl;
+	if (!unixSocketPath.empty()) {
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+		try {
+			netSocket.connect(boost::asio::local::stream_protocol::endpoint(unixSocketPath));
+		}
+		catch (const boost::system::system_error &ex) {
+			boost::format exMsg = boost::format("Failed to connect to %s, error message is:\n\t%s.") % unixSocketPath
+								  % ex.what();
+			std::cerr << exMsg.str() << std::endl;
+			return (EXIT_FAILURE);
+		}
+#else
+		std::cerr << "Unix domain sockets are not supported on this platform." << std::endl;
 		return (EXIT_FAILURE);
+#endif
+	}
+	else {
+		try {
+			asioTCP::resolver resolver(ioService);
+			asioTCP::resolver::iterator iter = resolver.resolve({ipAddress, portNumber});
+
+			// Try all resolved addresses in turn, as asio::connect() would.
+			boost::system::error_code error = asio::error::host_not_found;
+
+			for (; iter != asioTCP::resolver::iterator(); iter++) {
+				netSocket.close(error);
+				netSocket.connect(asioStream::endpoint(iter->endpoint()), error);
+
+				if (!error) {
+					break;
+				}
+			}
+
+			if (error) {
+				throw boost::system::system_error(error);
+			}
+		}
+		catch (const boost::system::system_error &ex) {
+			boost::format exMsg = boost::format("Failed to connect to %s:%s, error message is:\n\t%s.") % ipAddress
+								  % portNumber % ex.what();
+			std::cerr << exMsg.str() << std::endl;
+			return (EXIT_FAILURE);
+		}
+	}
+
+	// Non-interactive modes don't touch the command history.
+	if (cliVarMap.count("batch")) {
+		return (runBatch(batchCommands));
+	}
+
+	if (cliVarMap.count("watch")) {
+		return (runWatch(watchCommands, std::chrono::milliseconds(cliVarMap["interval"].as<int32_t>())));
+	}
+
+	if (cliVarMap.count("top")) {
+		return (runTop(std::chrono::milliseconds(cliVarMap["interval"].as<int32_t>())));
 	}
 
 	// Load command history file.
 	linenoiseHistoryLoad(commandHistoryFilePath.string().c_str());
 
+	bool scriptResult = true;
+
 	if (scriptMode) {
 		std::vector<std::string> commandComponents = cliVarMap["script"].as<std::vector<std::string>>();
 
@@ -196,14 +351,17 @@ int main(int argc, char *argv[]) {
 		size_t inputLineLength = strlen(inputLine);
 
 		if (inputLineLength > 0) {
-			handleInputLine(inputLine, inputLineLength);
+			scriptResult = handleInputLine(inputLine, inputLineLength);
 		}
 	}
 	else {
 		// Create a shell prompt with the IP:Port displayed.
-		boost::format shellPrompt = boost::format("cAER @ %s:%s >> ") % ipAddress % portNumber;
+		boost::format shellPrompt = (unixSocketPath.empty())
+										? (boost::format("cAER @ %s:%s >> ") % ipAddress % portNumber)
+										: (boost::format("cAER @ %s >> ") % unixSocketPath);
 
 		// Set our own command completion function.
+		treeCache.ttl = std::chrono::seconds(cliVarMap["cache-ttl"].as<uint32_t>());
 		linenoiseSetCompletionCallback(&handleCommandCompletion);
 
 		while (true) {
@@ -241,7 +399,7 @@ int main(int argc, char *argv[]) {
 	// Save command history file.
 	linenoiseHistorySave(commandHistoryFilePath.string().c_str());
 
-	return (EXIT_SUCCESS);
+	return ((scriptResult) ? (EXIT_SUCCESS) : (EXIT_FAILURE));
 }
 
 static inline void setExtraLen(uint8_t *buf, uint16_t extraLen) {
@@ -268,35 +426,52 @@ static inline void setValueLen(uint8_t *buf, uint16_t valueLen) {
 #define CMD_PART_TYPE 3
 #define CMD_PART_VALUE 4
 
-static void handleInputLine(const char *buf, size_t bufLength) {
-	// First let's split up the command into its constituents.
-	char *commandParts[MAX_CMD_PARTS + 1] = {nullptr};
-
+// Split a command line into its space separated parts.
+static bool splitCommandLine(
+	const char *buf, size_t bufLength, std::vector<std::string> &commandParts, std::string &errorMsg) {
 	// Create a copy of buf, so that strtok_r() can modify it.
 	char bufCopy[bufLength + 1];
 	strcpy(bufCopy, buf);
 
 	// Split string into usable parts.
-	size_t idx         = 0;
 	char *tokenSavePtr = nullptr, *nextCmdPart = nullptr, *currCmdPart = bufCopy;
 	while ((nextCmdPart = strtok_r(currCmdPart, " ", &tokenSavePtr)) != nullptr) {
-		if (idx < MAX_CMD_PARTS) {
-			commandParts[idx] = nextCmdPart;
-		}
-		else {
+		if (commandParts.size() >= MAX_CMD_PARTS) {
 			// Abort, too many parts.
-			std::cerr << "Error: command is made up of too many parts." << std::endl;
-			return;
+			errorMsg = "command is made up of too many parts.";
+			return (false);
 		}
 
-		idx++;
+		commandParts.push_back(nextCmdPart);
 		currCmdPart = nullptr;
 	}
 
 	// Check that we got something.
-	if (commandParts[CMD_PART_ACTION] == nullptr) {
-		std::cerr << "Error: empty command." << std::endl;
-		return;
+	if (commandParts.empty()) {
+		errorMsg = "empty command.";
+		return (false);
+	}
+
+	return (true);
+}
+
+// Encode a command into a request message for the configuration server.
+static bool buildRequest(
+	const std::vector<std::string> &commandPartsVector, std::vector<uint8_t> &request, std::string &errorMsg) {
+	const char *commandParts[MAX_CMD_PARTS + 1] = {nullptr};
+
+	if (commandPartsVector.empty()) {
+		errorMsg = "empty command.";
+		return (false);
+	}
+
+	if (commandPartsVector.size() > MAX_CMD_PARTS) {
+		errorMsg = "command is made up of too many parts.";
+		return (false);
+	}
+
+	for (size_t i = 0; i < commandPartsVector.size(); i++) {
+		commandParts[i] = commandPartsVector[i].c_str();
 	}
 
 	// Let's get the action code first thing.
@@ -318,17 +493,27 @@ static void handleInputLine(const char *buf, size_t bufLength) {
 	uint8_t dataBuffer[CAER_CONFIG_SERVER_BUFFER_SIZE];
 	size_t dataBufferLength = 0;
 
+	size_t totalLength = CAER_CONFIG_SERVER_HEADER_SIZE;
+	for (size_t i = CMD_PART_NODE; i < commandPartsVector.size(); i++) {
+		totalLength += commandPartsVector[i].length() + 1; // +1 for terminating NUL byte.
+	}
+
+	if (totalLength > CAER_CONFIG_SERVER_BUFFER_SIZE) {
+		errorMsg = "command is too long.";
+		return (false);
+	}
+
 	// Now that we know what we want to do, let's decode the command line.
 	switch (actionCode) {
 		case CAER_CONFIG_NODE_EXISTS: {
 			// Check parameters needed for operation.
 			if (commandParts[CMD_PART_NODE] == nullptr) {
-				std::cerr << "Error: missing node parameter." << std::endl;
-				return;
+				errorMsg = "missing node parameter.";
+				return (false);
 			}
 			if (commandParts[CMD_PART_NODE + 1] != nullptr) {
-				std::cerr << "Error: too many parameters for command." << std::endl;
-				return;
+				errorMsg = "too many parameters for command.";
+				return (false);
 			}
 
 			size_t nodeLength = strlen(commandParts[CMD_PART_NODE]) + 1; // +1 for terminating NUL byte.
@@ -352,20 +537,20 @@ static void handleInputLine(const char *buf, size_t bufLength) {
 		case CAER_CONFIG_GET_DESCRIPTION: {
 			// Check parameters needed for operation.
 			if (commandParts[CMD_PART_NODE] == nullptr) {
-				std::cerr << "Error: missing node parameter." << std::endl;
-				return;
+				errorMsg = "missing node parameter.";
+				return (false);
 			}
 			if (commandParts[CMD_PART_KEY] == nullptr) {
-				std::cerr << "Error: missing key parameter." << std::endl;
-				return;
+				errorMsg = "missing key parameter.";
+				return (false);
 			}
 			if (commandParts[CMD_PART_TYPE] == nullptr) {
-				std::cerr << "Error: missing type parameter." << std::endl;
-				return;
+				errorMsg = "missing type parameter.";
+				return (false);
 			}
 			if (commandParts[CMD_PART_TYPE + 1] != nullptr) {
-				std::cerr << "Error: too many parameters for command." << std::endl;
-				return;
+				errorMsg = "too many parameters for command.";
+				return (false);
 			}
 
 			size_t nodeLength = strlen(commandParts[CMD_PART_NODE]) + 1; // +1 for terminating NUL byte.
@@ -373,8 +558,8 @@ static void handleInputLine(const char *buf, size_t bufLength) {
 
 			enum sshs_node_attr_value_type type = sshsHelperStringToTypeConverter(commandParts[CMD_PART_TYPE]);
 			if (type == SSHS_UNKNOWN) {
-				std::cerr << "Error: invalid type parameter." << std::endl;
-				return;
+				errorMsg = "invalid type parameter.";
+				return (false);
 			}
 
 			dataBuffer[0] = actionCode;
@@ -395,24 +580,24 @@ static void handleInputLine(const char *buf, size_t bufLength) {
 		case CAER_CONFIG_PUT: {
 			// Check parameters needed for operation.
 			if (commandParts[CMD_PART_NODE] == nullptr) {
-				std::cerr << "Error: missing node parameter." << std::endl;
-				return;
+				errorMsg = "missing node parameter.";
+				return (false);
 			}
 			if (commandParts[CMD_PART_KEY] == nullptr) {
-				std::cerr << "Error: missing key parameter." << std::endl;
-				return;
+				errorMsg = "missing key parameter.";
+				return (false);
 			}
 			if (commandParts[CMD_PART_TYPE] == nullptr) {
-				std::cerr << "Error: missing type parameter." << std::endl;
-				return;
+				errorMsg = "missing type parameter.";
+				return (false);
 			}
 			if (commandParts[CMD_PART_VALUE] == nullptr) {
-				std::cerr << "Error: missing value parameter." << std::endl;
-				return;
+				errorMsg = "missing value parameter.";
+				return (false);
 			}
 			if (commandParts[CMD_PART_VALUE + 1] != nullptr) {
-				std::cerr << "Error: too many parameters for command." << std::endl;
-				return;
+				errorMsg = "too many parameters for command.";
+				return (false);
 			}
 
 			size_t nodeLength  = strlen(commandParts[CMD_PART_NODE]) + 1;  // +1 for terminating NUL byte.
@@ -421,8 +606,8 @@ static void handleInputLine(const char *buf, size_t bufLength) {
 
 			enum sshs_node_attr_value_type type = sshsHelperStringToTypeConverter(commandParts[CMD_PART_TYPE]);
 			if (type == SSHS_UNKNOWN) {
-				std::cerr << "Error: invalid type parameter." << std::endl;
-				return;
+				errorMsg = "invalid type parameter.";
+				return (false);
 			}
 
 			dataBuffer[0] = actionCode;
@@ -445,16 +630,16 @@ static void handleInputLine(const char *buf, size_t bufLength) {
 		case CAER_CONFIG_ADD_MODULE: {
 			// Check parameters needed for operation. Reuse node parameters.
 			if (commandParts[CMD_PART_NODE] == nullptr) {
-				std::cerr << "Error: missing module name." << std::endl;
-				return;
+				errorMsg = "missing module name.";
+				return (false);
 			}
 			if (commandParts[CMD_PART_KEY] == nullptr) {
-				std::cerr << "Error: missing library name." << std::endl;
-				return;
+				errorMsg = "missing library name.";
+				return (false);
 			}
 			if (commandParts[CMD_PART_KEY + 1] != nullptr) {
-				std::cerr << "Error: too many parameters for command." << std::endl;
-				return;
+				errorMsg = "too many parameters for command.";
+				return (false);
 			}
 
 			size_t nodeLength = strlen(commandParts[CMD_PART_NODE]) + 1; // +1 for terminating NUL byte.
@@ -478,12 +663,12 @@ static void handleInputLine(const char *buf, size_t bufLength) {
 		case CAER_CONFIG_REMOVE_MODULE: {
 			// Check parameters needed for operation. Reuse node parameters.
 			if (commandParts[CMD_PART_NODE] == nullptr) {
-				std::cerr << "Error: missing module name." << std::endl;
-				return;
+				errorMsg = "missing module name.";
+				return (false);
 			}
 			if (commandParts[CMD_PART_NODE + 1] != nullptr) {
-				std::cerr << "Error: too many parameters for command." << std::endl;
-				return;
+				errorMsg = "too many parameters for command.";
+				return (false);
 			}
 
 			size_t nodeLength = strlen(commandParts[CMD_PART_NODE]) + 1; // +1 for terminating NUL byte.
@@ -503,72 +688,704 @@ static void handleInputLine(const char *buf, size_t bufLength) {
 		}
 
 		default:
-			std::cerr << "Error: unknown command." << std::endl;
-			return;
+			errorMsg = "unknown command.";
+			return (false);
+	}
+
+	request.assign(dataBuffer, dataBuffer + dataBufferLength);
+
+	return (true);
+}
+
+struct configResponse {
+	uint8_t action;
+	uint8_t type;
+	// Always NUL terminated.
+	std::vector<char> msg;
+};
+
+// Read the next response message from the configuration server.
+// Throws boost::system::system_error on failure.
+static configResponse readResponse(void) {
+	// The response from the server follows a simplified version of the request
+	// protocol. A byte for ACTION, a byte for TYPE, 2 bytes for MSG_LEN and then
+	// up to 4092 bytes of MSG, for a maximum total of 4096 bytes again.
+	// MSG must be NUL terminated, and the NUL byte shall be part of the length.
+	uint8_t header[4];
+	asio::read(netSocket, asio::buffer(header, 4));
+
+	configResponse response;
+
+	// Decode response header fields (all in little-endian).
+	response.action    = header[0];
+	response.type      = header[1];
+	uint16_t msgLength = le16toh(*(uint16_t *) (header + 2));
+
+	// Total length to get for response.
+	response.msg.resize(msgLength + 1);
+	asio::read(netSocket, asio::buffer(response.msg.data(), msgLength));
+	response.msg[msgLength] = '\0';
+
+	return (response);
+}
+
+// One attribute from a CAER_CONFIG_DUMP_SUBTREE response.
+struct configAttribute {
+	std::string node;
+	std::string key;
+	std::string type;
+	std::string flags;
+	std::string min;
+	std::string max;
+	std::string value;
+};
+
+// Get all attributes of node and its children with one request.
+// Throws boost::system::system_error on failure to communicate, and
+// std::runtime_error if the server refuses the request.
+static std::vector<configAttribute> dumpSubtree(const std::string &node) {
+	const size_t nodeLength = node.length() + 1; // +1 for terminating NUL byte.
+
+	if ((CAER_CONFIG_SERVER_HEADER_SIZE + nodeLength) > CAER_CONFIG_SERVER_BUFFER_SIZE) {
+		throw std::runtime_error("node path is too long.");
+	}
+
+	std::vector<uint8_t> request(CAER_CONFIG_SERVER_HEADER_SIZE + nodeLength);
+
+	request[0] = CAER_CONFIG_DUMP_SUBTREE;
+	request[1] = 0;                 // UNUSED.
+	setExtraLen(request.data(), 0); // UNUSED.
+	setNodeLen(request.data(), (uint16_t) nodeLength);
+	setKeyLen(request.data(), 0);   // UNUSED.
+	setValueLen(request.data(), 0); // UNUSED.
+
+	memcpy(request.data() + CAER_CONFIG_SERVER_HEADER_SIZE, node.c_str(), nodeLength);
+
+	asio::write(netSocket, asio::buffer(request));
+
+	std::vector<configAttribute> attributes;
+
+	while (true) {
+		configResponse response = readResponse();
+
+		if (response.action == CAER_CONFIG_ERROR) {
+			throw std::runtime_error(response.msg.data());
+		}
+
+		// The dump ends with a BOOL 'true' response.
+		if (response.type != SSHS_STRING) {
+			break;
+		}
+
+		// Split message into its NUL terminated parts, seven per attribute.
+		std::vector<std::string> parts;
+		const char *curr = response.msg.data();
+		const char *end  = curr + (response.msg.size() - 1);
+
+		while (curr < end) {
+			parts.emplace_back(curr);
+			curr += parts.back().length() + 1;
+		}
+
+		for (size_t i = 0; (i + 7) <= parts.size(); i += 7) {
+			attributes.push_back(configAttribute{parts[i], parts[i + 1], parts[i + 2], parts[i + 3], parts[i + 4],
+				parts[i + 5], parts[i + 6]});
+		}
+	}
+
+	return (attributes);
+}
+
+static void treeCacheRefresh(const std::string &node) {
+	std::vector<configAttribute> attributes = dumpSubtree(node);
+
+	const auto now = std::chrono::steady_clock::now();
+
+	// Replace the whole subtree, children could have been removed.
+	auto iter = treeCache.nodes.lower_bound(node);
+	while (iter != treeCache.nodes.end() && boost::algorithm::starts_with(iter->first, node)) {
+		iter = treeCache.nodes.erase(iter);
+	}
+
+	treeCache.nodes[node].fetched = now;
+
+	for (const auto &attr : attributes) {
+		// Also add intermediate nodes, they may have no attributes of their own.
+		for (size_t pos = attr.node.find('/', node.length()); pos != std::string::npos;
+			 pos        = attr.node.find('/', pos + 1)) {
+			treeCache.nodes[attr.node.substr(0, pos + 1)].fetched = now;
+		}
+
+		treeCache.nodes[attr.node].attributes[attr.key][attr.type] = attr.value;
+	}
+}
+
+// Returns nullptr if the node doesn't exist or can't be fetched.
+static const cachedNode *treeCacheGetNode(const std::string &node) {
+	const auto iter = treeCache.nodes.find(node);
+
+	if (iter == treeCache.nodes.end() || (std::chrono::steady_clock::now() - iter->second.fetched) >= treeCache.ttl) {
+		try {
+			treeCacheRefresh(node);
+		}
+		catch (const std::exception &) {
+			// Not existing or failed to contact remote host.
+			return (nullptr);
+		}
+	}
+
+	return (&treeCache.nodes[node]);
+}
+
+static std::vector<std::string> treeCacheGetChildren(const std::string &node) {
+	std::vector<std::string> children;
+
+	if (treeCacheGetNode(node) == nullptr) {
+		return (children);
+	}
+
+	// Direct children are the following entries with exactly one more level.
+	for (auto iter = treeCache.nodes.upper_bound(node);
+		 iter != treeCache.nodes.end() && boost::algorithm::starts_with(iter->first, node); iter++) {
+		const std::string childPath = iter->first.substr(node.length());
+
+		if (childPath.find('/') == (childPath.length() - 1)) {
+			children.push_back(childPath.substr(0, childPath.length() - 1));
+		}
+	}
+
+	return (children);
+}
+
+// Successful commands that change the tree make the affected part stale.
+static void treeCacheInvalidate(const std::vector<std::string> &commandParts) {
+	if (commandParts[CMD_PART_ACTION] == "put") {
+		const auto iter = treeCache.nodes.find(commandParts[CMD_PART_NODE]);
+
+		if (iter != treeCache.nodes.end()) {
+			iter->second.fetched = std::chrono::steady_clock::time_point();
+		}
+	}
+	else if (commandParts[CMD_PART_ACTION] == "add_module" || commandParts[CMD_PART_ACTION] == "remove_module") {
+		treeCache.nodes.clear();
+	}
+}
+
+static std::string formatResponse(const configResponse &response) {
+	// Convert action back to a string.
+	const char *actionString = nullptr;
+
+	// Detect error response.
+	if (response.action == CAER_CONFIG_ERROR) {
+		actionString = "error";
+	}
+	else {
+		for (size_t i = 0; i < actionsLength; i++) {
+			if (actions[i].code == response.action) {
+				actionString = actions[i].name;
+			}
+		}
+	}
+
+	// Display results.
+	boost::format resultMsg = boost::format("Result: action=%s, type=%s, msgLength=%" PRIu16 ", msg='%s'.")
+							  % actionString
+							  % sshsHelperTypeToStringConverter((enum sshs_node_attr_value_type) response.type)
+							  % (response.msg.size() - 1) % response.msg.data();
+
+	return (resultMsg.str());
+}
+
+static bool handleInputLine(const char *buf, size_t bufLength) {
+	std::vector<std::string> commandParts;
+	std::vector<uint8_t> request;
+	std::string errorMsg;
+
+	if (!splitCommandLine(buf, bufLength, commandParts, errorMsg) || !buildRequest(commandParts, request, errorMsg)) {
+		std::cerr << "Error: " << errorMsg << std::endl;
+		return (false);
 	}
 
 	// Send formatted command to configuration server.
 	try {
-		asio::write(netSocket, asio::buffer(dataBuffer, dataBufferLength));
+		asio::write(netSocket, asio::buffer(request));
 	}
 	catch (const boost::system::system_error &ex) {
 		boost::format exMsg
 			= boost::format("Unable to send data to config server, error message is:\n\t%s.") % ex.what();
 		std::cerr << exMsg.str() << std::endl;
-		return;
+		return (false);
 	}
 
-	// The response from the server follows a simplified version of the request
-	// protocol. A byte for ACTION, a byte for TYPE, 2 bytes for MSG_LEN and then
-	// up to 4092 bytes of MSG, for a maximum total of 4096 bytes again.
-	// MSG must be NUL terminated, and the NUL byte shall be part of the length.
+	configResponse response;
+
 	try {
-		asio::read(netSocket, asio::buffer(dataBuffer, 4));
+		response = readResponse();
 	}
 	catch (const boost::system::system_error &ex) {
 		boost::format exMsg
 			= boost::format("Unable to receive data from config server, error message is:\n\t%s.") % ex.what();
 		std::cerr << exMsg.str() << std::endl;
-		return;
+		return (false);
 	}
 
-	// Decode response header fields (all in little-endian).
-	uint8_t action     = dataBuffer[0];
-	uint8_t type       = dataBuffer[1];
-	uint16_t msgLength = le16toh(*(uint16_t *) (dataBuffer + 2));
+	std::cout << formatResponse(response) << std::endl;
+
+	if (response.action == CAER_CONFIG_ERROR) {
+		return (false);
+	}
+
+	treeCacheInvalidate(commandParts);
+
+	return (true);
+}
+
+// Configuration exports hold nodes with attributes, turn each into a 'put'.
+static void xmlNodeToCommands(
+	const boost::property_tree::ptree &xmlNode, std::vector<std::vector<std::string>> &commands) {
+	const std::string path = xmlNode.get("<xmlattr>.path", "");
+
+	for (const auto &child : xmlNode) {
+		if (child.first == "attr") {
+			commands.push_back({"put", path, child.second.get("<xmlattr>.key", ""),
+				child.second.get("<xmlattr>.type", ""), child.second.get_value("")});
+		}
+		else if (child.first == "node") {
+			xmlNodeToCommands(child.second, commands);
+		}
+	}
+}
+
+static bool loadBatchFile(const std::string &fileName, std::vector<std::vector<std::string>> &commands) {
+	std::ifstream fileStream;
+
+	if (fileName != "-") {
+		fileStream.open(fileName);
+
+		if (!fileStream) {
+			std::cerr << "Failed to open batch file '" << fileName << "'." << std::endl;
+			return (false);
+		}
+	}
+
+	std::istream &input = (fileName == "-") ? (std::cin) : (fileStream);
+
+	try {
+		if (boost::algorithm::iends_with(fileName, ".json")) {
+			boost::property_tree::ptree jsonTree;
+			boost::property_tree::read_json(input, jsonTree);
+
+			for (const auto &command : jsonTree) {
+				if (command.second.empty()) {
+					// Plain command string, split like typed in.
+					std::vector<std::string> commandParts;
+					std::string errorMsg;
+					const std::string line = command.second.get_value("");
+
+					if (!splitCommandLine(line.c_str(), line.length(), commandParts, errorMsg)) {
+						std::cerr << "Error: invalid command '" << line << "': " << errorMsg << std::endl;
+						return (false);
+					}
+
+					commands.push_back(commandParts);
+				}
+				else {
+					std::vector<std::string> commandParts;
+
+					for (const char *part : {"action", "node", "key", "type", "value"}) {
+						auto value = command.second.get_optional<std::string>(part);
+
+						if (!value) {
+							break;
+						}
+
+						commandParts.push_back(*value);
+					}
+
+					commands.push_back(commandParts);
+				}
+			}
+		}
+		else if (boost::algorithm::iends_with(fileName, ".xml")) {
+			boost::property_tree::ptree xmlTree;
+			boost::property_tree::read_xml(input, xmlTree, boost::property_tree::xml_parser::trim_whitespace);
+
+			for (const auto &node : xmlTree.get_child("sshs")) {
+				if (node.first == "node") {
+					xmlNodeToCommands(node.second, commands);
+				}
+			}
+		}
+		else {
+			std::string line;
+			size_t lineNumber = 0;
+
+			while (std::getline(input, line)) {
+				lineNumber++;
+
+				boost::algorithm::trim(line);
+
+				if (line.empty() || line[0] == '#') {
+					continue;
+				}
+
+				std::vector<std::string> commandParts;
+				std::string errorMsg;
+
+				if (!splitCommandLine(line.c_str(), line.length(), commandParts, errorMsg)) {
+					std::cerr << "Error: line " << lineNumber << ": " << errorMsg << std::endl;
+					return (false);
+				}
+
+				commands.push_back(commandParts);
+			}
+		}
+	}
+	catch (const boost::property_tree::ptree_error &ex) {
+		std::cerr << "Failed to parse batch file '" << fileName << "': " << ex.what() << std::endl;
+		return (false);
+	}
+
+	return (true);
+}
+
+// Send all requests, keeping up to CAERCTL_PIPELINE_DEPTH of them in flight,
+// and get the response to each. Requests go out in as few writes as possible.
+// Throws boost::system::system_error on failure.
+static std::vector<configResponse> pipelineRequests(const std::vector<std::vector<uint8_t>> &requests) {
+	std::vector<configResponse> responses;
+	responses.reserve(requests.size());
+
+	size_t sent = 0;
+	std::vector<uint8_t> sendBuffer;
+
+	while (responses.size() < requests.size()) {
+		sendBuffer.clear();
+
+		while ((sent < requests.size()) && ((sent - responses.size()) < CAERCTL_PIPELINE_DEPTH)) {
+			sendBuffer.insert(sendBuffer.end(), requests[sent].begin(), requests[sent].end());
+			sent++;
+		}
+
+		if (!sendBuffer.empty()) {
+			asio::write(netSocket, asio::buffer(sendBuffer));
+		}
+
+		// Wait for one response, then take all others that already arrived,
+		// so the window is refilled with as many requests as possible at once.
+		do {
+			responses.push_back(readResponse());
+		} while ((responses.size() < sent) && (netSocket.available() > 0));
+	}
+
+	return (responses);
+}
+
+static int runBatch(const std::vector<std::vector<std::string>> &commands) {
+	std::vector<std::vector<uint8_t>> requests;
+	std::vector<size_t> requestCommands;
+	size_t failed = 0;
+
+	// Invalid commands are reported and skipped, the rest is still applied.
+	for (size_t i = 0; i < commands.size(); i++) {
+		std::vector<uint8_t> request;
+		std::string errorMsg;
+
+		if (!buildRequest(commands[i], request, errorMsg)) {
+			std::cerr << "[" << i + 1 << "] " << boost::algorithm::join(commands[i], " ") << ": Error: " << errorMsg
+					  << std::endl;
+			failed++;
+			continue;
+		}
+
+		requests.push_back(std::move(request));
+		requestCommands.push_back(i);
+	}
+
+	std::vector<configResponse> responses;
 
-	// Total length to get for response.
 	try {
-		asio::read(netSocket, asio::buffer(dataBuffer + 4, msgLength));
+		responses = pipelineRequests(requests);
 	}
 	catch (const boost::system::system_error &ex) {
 		boost::format exMsg
-			= boost::format("Unable to receive data from config server, error message is:\n\t%s.") % ex.what();
+			= boost::format("Unable to communicate with config server, error message is:\n\t%s.") % ex.what();
 		std::cerr << exMsg.str() << std::endl;
-		return;
+		return (EXIT_FAILURE);
 	}
 
-	// Convert action back to a string.
-	const char *actionString = nullptr;
+	for (size_t i = 0; i < responses.size(); i++) {
+		const size_t commandIndex = requestCommands[i];
 
-	// Detect error response.
-	if (action == CAER_CONFIG_ERROR) {
-		actionString = "error";
+		std::ostream &output = (responses[i].action == CAER_CONFIG_ERROR) ? (std::cerr) : (std::cout);
+
+		output << "[" << commandIndex + 1 << "] " << boost::algorithm::join(commands[commandIndex], " ") << ": "
+			   << formatResponse(responses[i]) << std::endl;
+
+		if (responses[i].action == CAER_CONFIG_ERROR) {
+			failed++;
+		}
 	}
-	else {
-		for (size_t i = 0; i < actionsLength; i++) {
-			if (actions[i].code == action) {
-				actionString = actions[i].name;
+
+	std::cout << "Batch: " << (commands.size() - failed) << " of " << commands.size() << " commands succeeded."
+			  << std::endl;
+
+	return ((failed == 0) ? (EXIT_SUCCESS) : (EXIT_FAILURE));
+}
+
+static int runWatch(const std::vector<std::vector<std::string>> &commands, std::chrono::milliseconds interval) {
+	std::vector<std::vector<uint8_t>> requests;
+
+	for (const auto &command : commands) {
+		std::vector<uint8_t> request;
+		std::string errorMsg;
+
+		if (!buildRequest(command, request, errorMsg)) {
+			std::cerr << "Error: " << boost::algorithm::join(command, " ") << ": " << errorMsg << std::endl;
+			return (EXIT_FAILURE);
+		}
+
+		requests.push_back(std::move(request));
+	}
+
+	auto nextUpdate = std::chrono::steady_clock::now();
+
+	while (true) {
+		std::vector<configResponse> responses;
+
+		try {
+			responses = pipelineRequests(requests);
+		}
+		catch (const boost::system::system_error &ex) {
+			boost::format exMsg
+				= boost::format("Unable to communicate with config server, error message is:\n\t%s.") % ex.what();
+			std::cerr << exMsg.str() << std::endl;
+			return (EXIT_FAILURE);
+		}
+
+		// One line per update: time, then 'node/key=value' for each attribute.
+		time_t currentTime = time(nullptr);
+		char timeString[32];
+		strftime(timeString, 32, "%H:%M:%S", localtime(&currentTime));
+
+		std::cout << timeString;
+
+		for (size_t i = 0; i < responses.size(); i++) {
+			std::cout << "  " << commands[i][CMD_PART_NODE] << commands[i][CMD_PART_KEY] << "="
+					  << ((responses[i].action == CAER_CONFIG_ERROR) ? ("<error>") : (responses[i].msg.data()));
+		}
+
+		std::cout << std::endl;
+
+		nextUpdate += interval;
+		std::this_thread::sleep_until(nextUpdate);
+	}
+}
+
+struct topModule {
+	int16_t id;
+	std::string name;
+	std::string library;
+	bool running;
+	// All polled statistics of the module and its sub-nodes, by 'node/key'.
+	std::map<std::string, double> statistics;
+
+	topModule() : id(-1), running(false) {
+	}
+};
+
+static bool parseStatistic(const std::string &value, double &result) {
+	char *endPtr = nullptr;
+
+	result = strtod(value.c_str(), &endPtr);
+
+	return (!value.empty() && (*endPtr == '\0'));
+}
+
+// Statistics summed up in the RING and DROPS columns, by their exact key,
+// in whatever node of the module they are published.
+static const std::set<std::string> topRingStatistics{"transferRingPacketsOccupancy",
+	"transferRingPacketContainersOccupancy", "compressorRingOccupancy", "outputRingOccupancy"};
+static const std::set<std::string> topDropStatistics{"eventsDropped", "udpPacketsDropped"};
+
+// Sum of all statistics with one of the given keys.
+// Returns false if the module publishes no such statistic.
+static bool sumStatistics(const topModule &module, const std::set<std::string> &keys, double &result) {
+	bool found = false;
+	result     = 0;
+
+	for (const auto &stat : module.statistics) {
+		const std::string key = stat.first.substr(stat.first.rfind('/') + 1);
+
+		if (keys.count(key)) {
+			result += stat.second;
+			found = true;
+		}
+	}
+
+	return (found);
+}
+
+// Collect modules from a dump of the whole tree. Modules are the top-level
+// nodes with a 'moduleId' attribute, statistics are recognized by their
+// companion '<key>PollTime' attribute.
+static std::vector<topModule> collectTopModules(const std::vector<configAttribute> &attributes) {
+	std::map<std::string, topModule> modules;
+	std::set<std::string> polledAttributes;
+
+	for (const auto &attr : attributes) {
+		if (boost::algorithm::ends_with(attr.key, "PollTime")) {
+			polledAttributes.insert(attr.node + attr.key.substr(0, attr.key.length() - strlen("PollTime")));
+		}
+	}
+
+	for (const auto &attr : attributes) {
+		// Node paths are of the form '/module/sub/node/'.
+		const size_t nameEnd = attr.node.find('/', 1);
+		if (nameEnd == std::string::npos) {
+			continue;
+		}
+
+		const std::string moduleName = attr.node.substr(1, nameEnd - 1);
+		topModule &module            = modules[moduleName];
+
+		if (attr.node.length() == (nameEnd + 1)) {
+			if (attr.key == "moduleId") {
+				module.id = (int16_t) strtol(attr.value.c_str(), nullptr, 10);
+			}
+			else if (attr.key == "moduleLibrary") {
+				module.library = attr.value;
 			}
+			else if (attr.key == "running") {
+				module.running = (attr.value == "true");
+			}
+		}
+
+		double value;
+		if (polledAttributes.count(attr.node + attr.key) && parseStatistic(attr.value, value)) {
+			module.statistics[attr.node.substr(nameEnd + 1) + attr.key] = value;
 		}
 	}
 
-	// Display results.
-	boost::format resultMsg = boost::format("Result: action=%s, type=%s, msgLength=%" PRIu16 ", msg='%s'.")
-							  % actionString % sshsHelperTypeToStringConverter((enum sshs_node_attr_value_type) type)
-							  % msgLength % (dataBuffer + 4);
+	std::vector<topModule> result;
 
-	std::cout << resultMsg.str() << std::endl;
+	for (auto &module : modules) {
+		if (module.second.id != -1) {
+			module.second.name = module.first;
+			result.push_back(std::move(module.second));
+		}
+	}
+
+	std::sort(result.begin(), result.end(), [](const topModule &a, const topModule &b) { return (a.id < b.id); });
+
+	return (result);
+}
+
+static int runTop(std::chrono::milliseconds interval) {
+	// Event counters of the previous update, to get rates.
+	std::map<std::string, std::pair<double, double>> lastEvents;
+	auto lastUpdate = std::chrono::steady_clock::now();
+	auto nextUpdate = lastUpdate;
+
+	while (true) {
+		std::vector<configAttribute> attributes;
+
+		try {
+			attributes = dumpSubtree("/");
+		}
+		catch (const std::exception &ex) {
+			boost::format exMsg
+				= boost::format("Unable to communicate with config server, error message is:\n\t%s.") % ex.what();
+			std::cerr << exMsg.str() << std::endl;
+			return (EXIT_FAILURE);
+		}
+
+		const auto now = std::chrono::steady_clock::now();
+		const double elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(now - lastUpdate).count();
+		lastUpdate           = now;
+
+		const std::vector<topModule> modules = collectTopModules(attributes);
+
+		time_t currentTime = time(nullptr);
+		char timeString[32];
+		strftime(timeString, 32, "%H:%M:%S", localtime(&currentTime));
+
+		// Clear screen and move cursor to top-left, then draw the table.
+		std::cout << "\x1b[H\x1b[2J";
+		std::cout << "caerctl top - " << timeString << " - " << modules.size() << " modules" << std::endl << std::endl;
+
+		boost::format row("%5s %-20s %-20s %-8s %12s %12s %10s %10s %10s %10s %10s");
+		std::cout << (row % "ID" % "MODULE" % "LIBRARY" % "STATUS" % "EV_IN/S" % "EV_OUT/S" % "P50_US" % "P99_US"
+						 % "MAX_US" % "RING" % "DROPS")
+				  << std::endl;
+
+		// Missing statistics are shown as '-'.
+		auto findStat = [](const topModule &module, const std::string &name, double &value) {
+			const auto stat = module.statistics.find(name);
+			if (stat == module.statistics.end()) {
+				return (false);
+			}
+
+			value = stat->second;
+			return (true);
+		};
+
+		auto formatRate = [&](const topModule &module, const std::string &name, double last) -> std::string {
+			double value;
+			if (!findStat(module, name, value) || !lastEvents.count(module.name) || (value < last) || (elapsed <= 0)) {
+				return ("-");
+			}
+
+			return ((boost::format("%.0f") % ((value - last) / elapsed)).str());
+		};
+
+		auto formatRunTime = [&](const topModule &module, const std::string &name) -> std::string {
+			double value;
+			if (!findStat(module, name, value)) {
+				return ("-");
+			}
+
+			// Published in nanoseconds.
+			return ((boost::format("%.1f") % (value / 1000.0)).str());
+		};
+
+		auto formatSum = [&](const topModule &module, const std::set<std::string> &keys) -> std::string {
+			double value;
+			if (!sumStatistics(module, keys, value)) {
+				return ("-");
+			}
+
+			return ((boost::format("%.0f") % value).str());
+		};
+
+		std::map<std::string, std::pair<double, double>> currentEvents;
+
+		for (const auto &module : modules) {
+			const auto last      = lastEvents.find(module.name);
+			const double lastIn  = (last != lastEvents.end()) ? (last->second.first) : (0);
+			const double lastOut = (last != lastEvents.end()) ? (last->second.second) : (0);
+
+			std::cout << (row % module.id % module.name.substr(0, 20) % module.library.substr(0, 20)
+							 % ((module.running) ? ("running") : ("stopped"))
+							 % formatRate(module, "statistics/eventsIn", lastIn)
+							 % formatRate(module, "statistics/eventsOut", lastOut)
+							 % formatRunTime(module, "statistics/runTimeP50")
+							 % formatRunTime(module, "statistics/runTimeP99")
+							 % formatRunTime(module, "statistics/runTimeMax") % formatSum(module, topRingStatistics)
+							 % formatSum(module, topDropStatistics))
+					  << std::endl;
+
+			double eventsIn = 0, eventsOut = 0;
+			findStat(module, "statistics/eventsIn", eventsIn);
+			findStat(module, "statistics/eventsOut", eventsOut);
+			currentEvents[module.name] = std::make_pair(eventsIn, eventsOut);
+		}
+
+		lastEvents.swap(currentEvents);
+
+		nextUpdate += interval;
+		std::this_thread::sleep_until(nextUpdate);
+	}
 }
 
 static void handleCommandCompletion(const char *buf, linenoiseCompletions *autoComplete) {
@@ -759,63 +1576,10 @@ static void nodeCompletion(const char *buf, size_t bufLength, linenoiseCompletio
 
 	size_t lastNodeLength = (size_t)(lastNode - partialNodeString) + 1;
 
-	uint8_t dataBuffer[CAER_CONFIG_SERVER_BUFFER_SIZE];
-
-	// Send request for all children names.
-	dataBuffer[0] = CAER_CONFIG_GET_CHILDREN;
-	dataBuffer[1] = 0;                                      // UNUSED.
-	setExtraLen(dataBuffer, 0);                             // UNUSED.
-	setNodeLen(dataBuffer, (uint16_t)(lastNodeLength + 1)); // +1 for terminating NUL byte.
-	setKeyLen(dataBuffer, 0);                               // UNUSED.
-	setValueLen(dataBuffer, 0);                             // UNUSED.
-
-	memcpy(dataBuffer + CAER_CONFIG_SERVER_HEADER_SIZE, partialNodeString, lastNodeLength);
-	dataBuffer[CAER_CONFIG_SERVER_HEADER_SIZE + lastNodeLength] = '\0';
-
-	try {
-		asio::write(netSocket, asio::buffer(dataBuffer, CAER_CONFIG_SERVER_HEADER_SIZE + lastNodeLength + 1));
-	}
-	catch (const boost::system::system_error &) {
-		// Failed to contact remote host, no auto-completion!
-		return;
-	}
-
-	try {
-		asio::read(netSocket, asio::buffer(dataBuffer, 4));
-	}
-	catch (const boost::system::system_error &) {
-		// Failed to contact remote host, no auto-completion!
-		return;
-	}
-
-	// Decode response header fields (all in little-endian).
-	uint8_t action     = dataBuffer[0];
-	uint8_t type       = dataBuffer[1];
-	uint16_t msgLength = le16toh(*(uint16_t *) (dataBuffer + 2));
-
-	// Total length to get for response.
-	try {
-		asio::read(netSocket, asio::buffer(dataBuffer + 4, msgLength));
-	}
-	catch (const boost::system::system_error &) {
-		// Failed to contact remote host, no auto-completion!
-		return;
-	}
-
-	if (action == CAER_CONFIG_ERROR || type != SSHS_STRING) {
-		// Invalid request made, no auto-completion.
-		return;
-	}
-
-	// At this point we made a valid request and got back a full response.
-	for (size_t i = 0; i < msgLength; i++) {
-		if (strncasecmp((const char *) dataBuffer + 4 + i, lastNode + 1, strlen(lastNode + 1)) == 0) {
-			addCompletionSuffix(
-				autoComplete, buf, bufLength - strlen(lastNode + 1), (const char *) dataBuffer + 4 + i, false, true);
+	for (const auto &child : treeCacheGetChildren(std::string(partialNodeString, lastNodeLength))) {
+		if (strncasecmp(child.c_str(), lastNode + 1, strlen(lastNode + 1)) == 0) {
+			addCompletionSuffix(autoComplete, buf, bufLength - strlen(lastNode + 1), child.c_str(), false, true);
 		}
-
-		// Jump to the NUL character after this string.
-		i += strlen((const char *) dataBuffer + 4 + i);
 	}
 }
 
@@ -823,63 +1587,17 @@ static void keyCompletion(const char *buf, size_t bufLength, linenoiseCompletion
 	const char *nodeString, size_t nodeStringLength, const char *partialKeyString, size_t partialKeyStringLength) {
 	UNUSED_ARGUMENT(actionCode);
 
-	uint8_t dataBuffer[CAER_CONFIG_SERVER_BUFFER_SIZE];
-
-	// Send request for all attribute names for this node.
-	dataBuffer[0] = CAER_CONFIG_GET_ATTRIBUTES;
-	dataBuffer[1] = 0;                                        // UNUSED.
-	setExtraLen(dataBuffer, 0);                               // UNUSED.
-	setNodeLen(dataBuffer, (uint16_t)(nodeStringLength + 1)); // +1 for terminating NUL byte.
-	setKeyLen(dataBuffer, 0);                                 // UNUSED.
-	setValueLen(dataBuffer, 0);                               // UNUSED.
-
-	memcpy(dataBuffer + CAER_CONFIG_SERVER_HEADER_SIZE, nodeString, nodeStringLength);
-	dataBuffer[CAER_CONFIG_SERVER_HEADER_SIZE + nodeStringLength] = '\0';
-
-	try {
-		asio::write(netSocket, asio::buffer(dataBuffer, CAER_CONFIG_SERVER_HEADER_SIZE + nodeStringLength + 1));
-	}
-	catch (const boost::system::system_error &) {
-		// Failed to contact remote host, no auto-completion!
-		return;
-	}
-
-	try {
-		asio::read(netSocket, asio::buffer(dataBuffer, 4));
-	}
-	catch (const boost::system::system_error &) {
-		// Failed to contact remote host, no auto-completion!
-		return;
-	}
-
-	// Decode response header fields (all in little-endian).
-	uint8_t action     = dataBuffer[0];
-	uint8_t type       = dataBuffer[1];
-	uint16_t msgLength = le16toh(*(uint16_t *) (dataBuffer + 2));
-
-	// Total length to get for response.
-	try {
-		asio::read(netSocket, asio::buffer(dataBuffer + 4, msgLength));
-	}
-	catch (const boost::system::system_error &) {
-		// Failed to contact remote host, no auto-completion!
-		return;
-	}
-
-	if (action == CAER_CONFIG_ERROR || type != SSHS_STRING) {
-		// Invalid request made, no auto-completion.
+	const cachedNode *node = treeCacheGetNode(std::string(nodeString, nodeStringLength));
+	if (node == nullptr) {
+		// Invalid node, no auto-completion.
 		return;
 	}
 
-	// At this point we made a valid request and got back a full response.
-	for (size_t i = 0; i < msgLength; i++) {
-		if (strncasecmp((const char *) dataBuffer + 4 + i, partialKeyString, partialKeyStringLength) == 0) {
+	for (const auto &attr : node->attributes) {
+		if (strncasecmp(attr.first.c_str(), partialKeyString, partialKeyStringLength) == 0) {
 			addCompletionSuffix(
-				autoComplete, buf, bufLength - partialKeyStringLength, (const char *) dataBuffer + 4 + i, true, false);
+				autoComplete, buf, bufLength - partialKeyStringLength, attr.first.c_str(), true, false);
 		}
-
-		// Jump to the NUL character after this string.
-		i += strlen((const char *) dataBuffer + 4 + i);
 	}
 }
 
@@ -888,67 +1606,23 @@ static void typeCompletion(const char *buf, size_t bufLength, linenoiseCompletio
 	const char *partialTypeString, size_t partialTypeStringLength) {
 	UNUSED_ARGUMENT(actionCode);
 
-	uint8_t dataBuffer[CAER_CONFIG_SERVER_BUFFER_SIZE];
-
-	// Send request for all type names for this key on this node.
-	dataBuffer[0] = CAER_CONFIG_GET_TYPES;
-	dataBuffer[1] = 0;                                        // UNUSED.
-	setExtraLen(dataBuffer, 0);                               // UNUSED.
-	setNodeLen(dataBuffer, (uint16_t)(nodeStringLength + 1)); // +1 for terminating NUL byte.
-	setKeyLen(dataBuffer, (uint16_t)(keyStringLength + 1));   // +1 for terminating NUL byte.
-	setValueLen(dataBuffer, 0);                               // UNUSED.
-
-	memcpy(dataBuffer + CAER_CONFIG_SERVER_HEADER_SIZE, nodeString, nodeStringLength);
-	dataBuffer[CAER_CONFIG_SERVER_HEADER_SIZE + nodeStringLength] = '\0';
-
-	memcpy(dataBuffer + CAER_CONFIG_SERVER_HEADER_SIZE + nodeStringLength + 1, keyString, keyStringLength);
-	dataBuffer[CAER_CONFIG_SERVER_HEADER_SIZE + nodeStringLength + 1 + keyStringLength] = '\0';
-
-	try {
-		asio::write(netSocket,
-			asio::buffer(dataBuffer, CAER_CONFIG_SERVER_HEADER_SIZE + nodeStringLength + 1 + keyStringLength + 1));
-	}
-	catch (const boost::system::system_error &) {
-		// Failed to contact remote host, no auto-completion!
-		return;
-	}
-
-	try {
-		asio::read(netSocket, asio::buffer(dataBuffer, 4));
-	}
-	catch (const boost::system::system_error &) {
-		// Failed to contact remote host, no auto-completion!
-		return;
-	}
-
-	// Decode response header fields (all in little-endian).
-	uint8_t action     = dataBuffer[0];
-	uint8_t type       = dataBuffer[1];
-	uint16_t msgLength = le16toh(*(uint16_t *) (dataBuffer + 2));
-
-	// Total length to get for response.
-	try {
-		asio::read(netSocket, asio::buffer(dataBuffer + 4, msgLength));
-	}
-	catch (const boost::system::system_error &) {
-		// Failed to contact remote host, no auto-completion!
+	const cachedNode *node = treeCacheGetNode(std::string(nodeString, nodeStringLength));
+	if (node == nullptr) {
+		// Invalid node, no auto-completion.
 		return;
 	}
 
-	if (action == CAER_CONFIG_ERROR || type != SSHS_STRING) {
-		// Invalid request made, no auto-completion.
+	const auto attr = node->attributes.find(std::string(keyString, keyStringLength));
+	if (attr == node->attributes.end()) {
+		// Invalid key, no auto-completion.
 		return;
 	}
 
-	// At this point we made a valid request and got back a full response.
-	for (size_t i = 0; i < msgLength; i++) {
-		if (strncasecmp((const char *) dataBuffer + 4 + i, partialTypeString, partialTypeStringLength) == 0) {
+	for (const auto &type : attr->second) {
+		if (strncasecmp(type.first.c_str(), partialTypeString, partialTypeStringLength) == 0) {
 			addCompletionSuffix(
-				autoComplete, buf, bufLength - partialTypeStringLength, (const char *) dataBuffer + 4 + i, true, false);
+				autoComplete, buf, bufLength - partialTypeStringLength, type.first.c_str(), true, false);
 		}
-
-		// Jump to the NUL character after this string.
-		i += strlen((const char *) dataBuffer + 4 + i);
 	}
 }
 
@@ -980,64 +1654,47 @@ static void valueCompletion(const char *buf, size_t bufLength, linenoiseCompleti
 		return;
 	}
 
-	uint8_t dataBuffer[CAER_CONFIG_SERVER_BUFFER_SIZE];
-
-	// Send request for the current value, so we can auto-complete with it as default.
-	dataBuffer[0] = CAER_CONFIG_GET;
-	dataBuffer[1] = (uint8_t) type;
-	setExtraLen(dataBuffer, 0);                               // UNUSED.
-	setNodeLen(dataBuffer, (uint16_t)(nodeStringLength + 1)); // +1 for terminating NUL byte.
-	setKeyLen(dataBuffer, (uint16_t)(keyStringLength + 1));   // +1 for terminating NUL byte.
-	setValueLen(dataBuffer, 0);                               // UNUSED.
+	// Auto-complete with the current value as default. The cached tree can be
+	// up to its TTL old, so get the value live from the server.
+	const std::string nodePath(nodeString, nodeStringLength);
+	const std::string key(keyString, keyStringLength);
 
-	memcpy(dataBuffer + CAER_CONFIG_SERVER_HEADER_SIZE, nodeString, nodeStringLength);
-	dataBuffer[CAER_CONFIG_SERVER_HEADER_SIZE + nodeStringLength] = '\0';
+	std::vector<uint8_t> request;
+	std::string errorMsg;
 
-	memcpy(dataBuffer + CAER_CONFIG_SERVER_HEADER_SIZE + nodeStringLength + 1, keyString, keyStringLength);
-	dataBuffer[CAER_CONFIG_SERVER_HEADER_SIZE + nodeStringLength + 1 + keyStringLength] = '\0';
-
-	try {
-		asio::write(netSocket,
-			asio::buffer(dataBuffer, CAER_CONFIG_SERVER_HEADER_SIZE + nodeStringLength + 1 + keyStringLength + 1));
-	}
-	catch (const boost::system::system_error &) {
-		// Failed to contact remote host, no auto-completion!
+	if (!buildRequest({"get", nodePath, key, sshsHelperTypeToStringConverter(type)}, request, errorMsg)) {
 		return;
 	}
 
+	configResponse response;
+
 	try {
-		asio::read(netSocket, asio::buffer(dataBuffer, 4));
+		asio::write(netSocket, asio::buffer(request));
+		response = readResponse();
 	}
 	catch (const boost::system::system_error &) {
-		// Failed to contact remote host, no auto-completion!
+		// Failed to contact remote host.
 		return;
 	}
 
-	// Decode response header fields (all in little-endian).
-	uint8_t action     = dataBuffer[0];
-	uint16_t msgLength = le16toh(*(uint16_t *) (dataBuffer + 2));
-
-	// Total length to get for response.
-	try {
-		asio::read(netSocket, asio::buffer(dataBuffer + 4, msgLength));
-	}
-	catch (const boost::system::system_error &) {
-		// Failed to contact remote host, no auto-completion!
+	if (response.action == CAER_CONFIG_ERROR) {
+		// Invalid node, key or type, no auto-completion.
 		return;
 	}
 
-	if (action == CAER_CONFIG_ERROR) {
-		// Invalid request made, no auto-completion.
-		return;
+	const std::string value(response.msg.data());
+
+	// Keep the cache up to date, if it has the node already.
+	const auto cached = treeCache.nodes.find(nodePath);
+	if (cached != treeCache.nodes.end()) {
+		cached->second.attributes[key][sshsHelperTypeToStringConverter(type)] = value;
 	}
 
-	// At this point we made a valid request and got back a full response.
-	// We can just use it directly and paste it in as completion.
-	addCompletionSuffix(autoComplete, buf, bufLength, (const char *) dataBuffer + 4, false, false);
+	addCompletionSuffix(autoComplete, buf, bufLength, value.c_str(), false, false);
 
 	// If this is a boolean value, we can also add the inverse as a second completion.
 	if (type == SSHS_BOOL) {
-		if (strcmp((const char *) dataBuffer + 4, "true") == 0) {
+		if (value == "true") {
 			addCompletionSuffix(autoComplete, buf, bufLength, "false", false, false);
 		}
 		else {